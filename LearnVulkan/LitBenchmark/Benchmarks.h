@@ -0,0 +1,29 @@
+#pragma once
+
+// std
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// Every benchmark takes the command line arguments after its name and returns the process exit code
+	using BenchmarkFunction = int (*)(const std::vector<std::string>& args);
+
+	// ACMR/ATVR of the bundled models before and after the LitMeshOptimizer passes, and their LOD chains
+	int RunMeshOptimizeBenchmark(const std::vector<std::string>& args);
+
+	// meshlet build time and cluster culling rates from cameras orbiting the model
+	int RunMeshletBenchmark(const std::vector<std::string>& args);
+
+	// BVH build, frustum / ray / range queries against brute force and refit drift [object counts...]
+	int RunBvhBenchmark(const std::vector<std::string>& args);
+
+	// pick latency of cursor rays into a grid of instanced meshes, checked against brute force [triangle count]
+	int RunPickBenchmark(const std::vector<std::string>& args);
+
+	// cost of a CPU profiler zone on one and several threads, and writing a Chrome trace [zones per thread]
+	int RunProfilerBenchmark(const std::vector<std::string>& args);
+
+	// CPU mip generation, BC encode / decode throughput and PSNR of a synthetic image and the bundled textures [images...]
+	int RunTextureBenchmark(const std::vector<std::string>& args);
+}
@@ -0,0 +1,189 @@
+#include "Benchmarks.h"
+
+#include "Core/LitBvh.h"
+#include "Core/LitCamera.h"
+
+// std
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace Lit
+{
+	static const uint32_t DEFAULT_OBJECT_COUNTS[] = { 1000, 10000, 100000 };
+	static const uint32_t FRUSTUM_QUERY_COUNT = 64;
+	static const uint32_t RAY_QUERY_COUNT = 4096;
+	static const uint32_t RANGE_QUERY_COUNT = 4096;
+	// objects moved a little between two refits, as a fraction of the scene
+	static const float MOVED_FRACTION = 0.1f;
+
+	static double MicrosecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	static void PrintQueryRow(const char* query, uint32_t queryCount, double bvhTime, double bruteTime, size_t bvhHits, size_t bruteHits)
+	{
+		std::printf("  %-8s %8.2f us/query bvh, %10.2f us/query brute force, %6.1fx, %.1f hits/query%s\n",
+			query, bvhTime / queryCount, bruteTime / queryCount, bruteTime / std::max(bvhTime, 1e-3),
+			static_cast<double>(bvhHits) / queryCount, bvhHits == bruteHits ? "" : " (MISMATCH)");
+	}
+
+	static void BenchmarkObjectCount(uint32_t objectCount)
+	{
+		// constant density, the scene grows with the object count and queries stay the same size
+		const float sceneSize = 10.0f * std::cbrt(static_cast<float>(objectCount));
+		std::mt19937 random{ objectCount };
+		std::uniform_real_distribution<float> position{ -0.5f * sceneSize, 0.5f * sceneSize };
+		std::uniform_real_distribution<float> halfSize{ 0.1f, 1.5f };
+		std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+		std::vector<LitAABB> boxes(objectCount);
+		for (auto& box : boxes)
+		{
+			const glm::vec3 center{ position(random), position(random), position(random) };
+			const glm::vec3 extent{ halfSize(random), halfSize(random), halfSize(random) };
+			box.min = center - extent;
+			box.max = center + extent;
+		}
+
+		// no margin so the hits compare exactly with the brute force loop
+		LitBvh bvh{ 0.0f };
+		std::vector<LitBvh::ProxyId> proxies(objectCount);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			proxies[i] = bvh.Insert(boxes[i], i);
+		}
+		const double insertTime = MicrosecondsSince(start);
+		const float insertSah = bvh.GetSahCost();
+		const uint32_t insertHeight = bvh.GetHeight();
+
+		start = std::chrono::high_resolution_clock::now();
+		bvh.Rebuild();
+		const double rebuildTime = MicrosecondsSince(start);
+		std::printf("%u objects: insert %.2f ms (height %u, SAH %.1f), SAH rebuild %.2f ms (height %u, SAH %.1f)\n",
+			objectCount, insertTime / 1000.0, insertHeight, insertSah, rebuildTime / 1000.0, bvh.GetHeight(), bvh.GetSahCost());
+
+		// frustums from random points in the scene, looking at 50 units
+		std::vector<LitFrustum> frustums(FRUSTUM_QUERY_COUNT);
+		LitCamera camera;
+		camera.SetPerspectiveProjection(glm::radians(50.0f), 16.0f / 9.0f, 0.1f, 50.0f);
+		for (auto& frustum : frustums)
+		{
+			const glm::vec3 eye{ position(random), position(random), position(random) };
+			camera.SetViewDirection(eye, glm::normalize(glm::vec3{ unit(random), unit(random), unit(random) }));
+			frustum = LitFrustum::FromMatrix(camera.GetProjection() * camera.GetView());
+		}
+
+		std::vector<uint32_t> results;
+		std::vector<uint32_t> offsets;
+		start = std::chrono::high_resolution_clock::now();
+		bvh.QueryFrustums(frustums.data(), frustums.size(), results, offsets);
+		double bvhTime = MicrosecondsSince(start);
+		size_t bruteHits = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (const auto& frustum : frustums)
+		{
+			for (const auto& box : boxes)
+			{
+				bruteHits += frustum.Intersects(box) ? 1 : 0;
+			}
+		}
+		PrintQueryRow("frustum", FRUSTUM_QUERY_COUNT, bvhTime, MicrosecondsSince(start), results.size(), bruteHits);
+
+		// closest hit of rays from random points in random directions
+		std::vector<LitRay> rays(RAY_QUERY_COUNT);
+		for (auto& ray : rays)
+		{
+			ray = LitRay{ glm::vec3{ position(random), position(random), position(random) },
+				glm::normalize(glm::vec3{ unit(random), unit(random), unit(random) }) };
+		}
+		const float maxDistance = sceneSize;
+		std::vector<LitBvh::RayHit> hits(RAY_QUERY_COUNT);
+		start = std::chrono::high_resolution_clock::now();
+		bvh.Raycasts(rays.data(), rays.size(), maxDistance, hits.data());
+		bvhTime = MicrosecondsSince(start);
+		size_t bvhHits = 0;
+		for (const auto& hit : hits)
+		{
+			bvhHits += hit.IsHit() ? 1 : 0;
+		}
+		bruteHits = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (const auto& ray : rays)
+		{
+			float closest = maxDistance;
+			bool bHit = false;
+			for (const auto& box : boxes)
+			{
+				float distance;
+				if (ray.Intersects(box, closest, distance))
+				{
+					closest = distance;
+					bHit = true;
+				}
+			}
+			bruteHits += bHit ? 1 : 0;
+		}
+		PrintQueryRow("ray", RAY_QUERY_COUNT, bvhTime, MicrosecondsSince(start), bvhHits, bruteHits);
+
+		// 10 unit boxes, about what a proximity or selection query covers
+		std::vector<LitAABB> ranges(RANGE_QUERY_COUNT);
+		for (auto& range : ranges)
+		{
+			const glm::vec3 center{ position(random), position(random), position(random) };
+			range.min = center - glm::vec3(5.0f);
+			range.max = center + glm::vec3(5.0f);
+		}
+		results.clear();
+		start = std::chrono::high_resolution_clock::now();
+		bvh.QueryRanges(ranges.data(), ranges.size(), results, offsets);
+		bvhTime = MicrosecondsSince(start);
+		bruteHits = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (const auto& range : ranges)
+		{
+			for (const auto& box : boxes)
+			{
+				bruteHits += range.Overlaps(box) ? 1 : 0;
+			}
+		}
+		PrintQueryRow("range", RANGE_QUERY_COUNT, bvhTime, MicrosecondsSince(start), results.size(), bruteHits);
+
+		// nudge a fraction of the objects, refit them and see how far the SAH cost drifts
+		const uint32_t movedCount = static_cast<uint32_t>(objectCount * MOVED_FRACTION);
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < movedCount; i++)
+		{
+			const uint32_t object = random() % objectCount;
+			const glm::vec3 offset{ unit(random), unit(random), unit(random) };
+			boxes[object].min += offset;
+			boxes[object].max += offset;
+			bvh.Update(proxies[object], boxes[object]);
+		}
+		std::printf("  refit of %u moved objects %.2f ms, SAH %.1f -> %.1f\n",
+			movedCount, MicrosecondsSince(start) / 1000.0, bvh.GetRebuildSahCost(), bvh.GetSahCost());
+	}
+
+	int RunBvhBenchmark(const std::vector<std::string>& args)
+	{
+		std::vector<uint32_t> objectCounts(std::begin(DEFAULT_OBJECT_COUNTS), std::end(DEFAULT_OBJECT_COUNTS));
+		if (!args.empty())
+		{
+			objectCounts.clear();
+			for (const auto& arg : args)
+			{
+				objectCounts.push_back(static_cast<uint32_t>(std::stoul(arg)));
+			}
+		}
+
+		for (uint32_t objectCount : objectCounts)
+		{
+			BenchmarkObjectCount(objectCount);
+		}
+		return EXIT_SUCCESS;
+	}
+}
@@ -0,0 +1,87 @@
+#include "Benchmarks.h"
+
+#include "Core/LitMeshOptimizer.h"
+#include "Core/LitModel.h"
+
+// std
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+namespace Lit
+{
+	static const char* DEFAULT_MODELS[] =
+	{
+		"../models/colored_cube.obj",
+		"../models/cone.obj",
+		"../models/cube.obj",
+		"../models/flat_vase.obj",
+		"../models/smooth_vase.obj",
+		"../models/sphere.obj",
+	};
+
+	static void PrintRow(const char* pass, const VertexCacheStatistics& statistics, double milliseconds)
+	{
+		std::printf("  %-22s ACMR %6.3f  ATVR %6.3f  %9.3f ms\n", pass, statistics.acmr, statistics.atvr, milliseconds);
+	}
+
+	static double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	int RunMeshOptimizeBenchmark(const std::vector<std::string>& args)
+	{
+		std::vector<std::string> models = args;
+		if (models.empty())
+		{
+			models.assign(std::begin(DEFAULT_MODELS), std::end(DEFAULT_MODELS));
+		}
+
+		std::printf("post-transform cache simulated as a %u entry FIFO\n", LitMeshOptimizer::DEFAULT_CACHE_SIZE);
+		for (const auto& model : models)
+		{
+			LitModel::Builder builder{};
+			auto start = std::chrono::high_resolution_clock::now();
+			builder.LoadModel(model);
+			const double loadTime = MillisecondsSince(start);
+
+			const uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+			std::printf("%s: %zu triangles, %u vertices\n", model.c_str(), builder.indices.size() / 3, vertexCount);
+			PrintRow("obj order", LitMeshOptimizer::AnalyzeVertexCache(builder.indices, vertexCount), loadTime);
+
+			LitModel::LoadOptions options{};
+			options.bOptimizeOverdraw = false;
+			options.bOptimizeVertexFetch = false;
+			LitModel::Builder cacheOptimized = builder;
+			start = std::chrono::high_resolution_clock::now();
+			cacheOptimized.Optimize(options);
+			PrintRow("vertex cache", LitMeshOptimizer::AnalyzeVertexCache(cacheOptimized.indices, vertexCount), MillisecondsSince(start));
+
+			options.bOptimizeOverdraw = true;
+			LitModel::Builder overdrawOptimized = builder;
+			start = std::chrono::high_resolution_clock::now();
+			overdrawOptimized.Optimize(options);
+			PrintRow("vertex cache+overdraw", LitMeshOptimizer::AnalyzeVertexCache(overdrawOptimized.indices, vertexCount), MillisecondsSince(start));
+
+			// the default load path
+			options = LitModel::LoadOptions{};
+			LitModel::Builder fetchOptimized = builder;
+			start = std::chrono::high_resolution_clock::now();
+			fetchOptimized.Optimize(options);
+			PrintRow("vertex cache+fetch", LitMeshOptimizer::AnalyzeVertexCache(
+				fetchOptimized.indices, static_cast<uint32_t>(fetchOptimized.vertices.size())), MillisecondsSince(start));
+
+			LitModel::Builder lodBuilder = builder;
+			start = std::chrono::high_resolution_clock::now();
+			lodBuilder.GenerateLods(LitModel::LoadOptions{});
+			std::printf("  LOD chain generated in %.3f ms\n", MillisecondsSince(start));
+			for (size_t lod = 0; lod < lodBuilder.lods.size(); lod++)
+			{
+				std::printf("    LOD%zu %8u triangles  error %.5f\n", lod, lodBuilder.lods[lod].indexCount / 3, lodBuilder.lods[lod].error);
+			}
+		}
+		return EXIT_SUCCESS;
+	}
+}
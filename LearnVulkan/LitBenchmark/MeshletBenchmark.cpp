@@ -0,0 +1,117 @@
+#include "Benchmarks.h"
+
+#include "Core/LitCamera.h"
+#include "Core/LitMeshOptimizer.h"
+#include "Core/LitMeshlet.h"
+#include "Core/LitModel.h"
+
+// std
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+namespace Lit
+{
+	static const char* DEFAULT_MESHLET_MODELS[] =
+	{
+		"../models/flat_vase.obj",
+		"../models/smooth_vase.obj",
+		"../models/sphere.obj",
+	};
+
+	// number of cameras spread over a sphere around the model for the culling part
+	static const uint32_t CULL_VIEW_COUNT = 1000;
+
+	int RunMeshletBenchmark(const std::vector<std::string>& args)
+	{
+		std::vector<std::string> models = args;
+		if (models.empty())
+		{
+			models.assign(std::begin(DEFAULT_MESHLET_MODELS), std::end(DEFAULT_MESHLET_MODELS));
+		}
+
+		for (const auto& model : models)
+		{
+			LitModel::Builder builder{};
+			builder.LoadModel(model);
+			LitModel::LoadOptions options{};
+			options.bBuildMeshlets = false;
+			builder.Optimize(options);
+
+			std::vector<glm::vec3> positions;
+			positions.reserve(builder.vertices.size());
+			for (const auto& vertex : builder.vertices)
+			{
+				positions.push_back(vertex.position);
+			}
+
+			std::vector<uint32_t> indices = builder.indices;
+			auto start = std::chrono::high_resolution_clock::now();
+			const std::vector<LitMeshlet> meshlets = LitMeshOptimizer::BuildMeshlets(indices, positions);
+			const double buildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			uint32_t vertexSum = 0;
+			uint32_t triangleSum = 0;
+			uint32_t coneCount = 0;
+			for (const auto& meshlet : meshlets)
+			{
+				vertexSum += meshlet.vertexCount;
+				triangleSum += meshlet.triangleCount;
+				coneCount += meshlet.coneCutoff < 1.0f ? 1 : 0;
+			}
+			const float meshletCount = static_cast<float>(std::max<size_t>(meshlets.size(), 1));
+			std::printf("%s: %zu triangles -> %zu meshlets (avg %.1f vertices, %.1f triangles, %u with a usable cone), built in %.3f ms\n",
+				model.c_str(), builder.indices.size() / 3, meshlets.size(), vertexSum / meshletCount, triangleSum / meshletCount,
+				coneCount, buildTime);
+
+			// orbit the model with the camera inside or just outside so both frustum and cone culling kick in
+			LitAABB bounds;
+			for (const auto& position : positions)
+			{
+				bounds.Expand(position);
+			}
+			const LitSphere sphere = bounds.BoundingSphere();
+
+			LitCamera camera;
+			camera.SetPerspectiveProjection(glm::radians(50.0f), 16.0f / 9.0f, 0.01f, 100.0f);
+			MeshletCullStatistics total{};
+			std::vector<VkDrawIndexedIndirectCommand> draws;
+			double cullTime = 0.0;
+			for (uint32_t view = 0; view < CULL_VIEW_COUNT; view++)
+			{
+				// fibonacci sphere directions, distance alternating between close up and the whole model in view
+				const float y = 1.0f - 2.0f * (view + 0.5f) / CULL_VIEW_COUNT;
+				const float ringRadius = std::sqrt(1.0f - y * y);
+				const float angle = view * 2.39996323f;
+				const glm::vec3 direction{ std::cos(angle) * ringRadius, y, std::sin(angle) * ringRadius };
+				const float distance = sphere.radius * (view % 2 == 0 ? 1.2f : 3.0f);
+				camera.SetViewTarget(sphere.center + direction * distance, sphere.center);
+
+				start = std::chrono::high_resolution_clock::now();
+				LitMeshletCuller culler{ camera.GetProjection() * camera.GetView(), camera.GetPosition() };
+				draws.clear();
+				culler.Cull(meshlets, glm::mat4{ 1.0f }, draws);
+				cullTime += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+
+				const MeshletCullStatistics& statistics = culler.GetStatistics();
+				total.meshletCount += statistics.meshletCount;
+				total.frustumCulled += statistics.frustumCulled;
+				total.backfaceCulled += statistics.backfaceCulled;
+				total.drawCount += statistics.drawCount;
+				total.triangleCount += statistics.triangleCount;
+			}
+
+			const float views = static_cast<float>(CULL_VIEW_COUNT);
+			std::printf("  culling over %u views: %.2f us/view, %.1f%% frustum culled, %.1f%% backface culled, "
+				"%.1f draws and %.0f of %zu triangles left per view\n",
+				CULL_VIEW_COUNT, cullTime / views,
+				100.0f * total.frustumCulled / std::max(total.meshletCount, 1u),
+				100.0f * total.backfaceCulled / std::max(total.meshletCount, 1u),
+				total.drawCount / views, total.triangleCount / views, builder.indices.size() / 3);
+		}
+		return EXIT_SUCCESS;
+	}
+}
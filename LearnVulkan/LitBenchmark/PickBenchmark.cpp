@@ -0,0 +1,188 @@
+#include "Benchmarks.h"
+
+#include "Core/LitCamera.h"
+#include "Core/LitPicker.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+namespace Lit
+{
+	static const uint32_t DEFAULT_TRIANGLE_COUNT = 1u << 20;
+	// a 64 x 64 segment sphere, 8064 triangles per object
+	static const uint32_t SPHERE_SEGMENTS = 64;
+	static const uint32_t PICK_COUNT = 1000;
+	// picks that are checked against testing every triangle of the scene
+	static const uint32_t VERIFY_COUNT = 32;
+	static const float SCREEN_WIDTH = 1280.0f;
+	static const float SCREEN_HEIGHT = 720.0f;
+
+	static double MicrosecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	static void BuildSphere(uint32_t segments, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+	{
+		const float pi = 3.14159265f;
+		for (uint32_t ring = 0; ring <= segments; ring++)
+		{
+			const float theta = pi * ring / segments;
+			for (uint32_t segment = 0; segment <= segments; segment++)
+			{
+				const float phi = 2.0f * pi * segment / segments;
+				positions.push_back(glm::vec3{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+			}
+		}
+		for (uint32_t ring = 0; ring < segments; ring++)
+		{
+			for (uint32_t segment = 0; segment < segments; segment++)
+			{
+				const uint32_t a = ring * (segments + 1) + segment;
+				const uint32_t b = a + segments + 1;
+				// the pole rows collapse to a point, skip their degenerate halves
+				if (ring != 0)
+				{
+					indices.insert(indices.end(), { a, b, a + 1 });
+				}
+				if (ring != segments - 1)
+				{
+					indices.insert(indices.end(), { a + 1, b, b + 1 });
+				}
+			}
+		}
+	}
+
+	// translate * rotate about y * scale, what the instances of a prop placed on the ground use
+	static glm::mat4 PlacementMatrix(const glm::vec3& translation, float yaw, const glm::vec3& scale)
+	{
+		const float c = std::cos(yaw);
+		const float s = std::sin(yaw);
+		glm::mat4 matrix{ 1.0f };
+		matrix[0] = glm::vec4{ c * scale.x, 0.0f, -s * scale.x, 0.0f };
+		matrix[1] = glm::vec4{ 0.0f, scale.y, 0.0f, 0.0f };
+		matrix[2] = glm::vec4{ s * scale.z, 0.0f, c * scale.z, 0.0f };
+		matrix[3] = glm::vec4{ translation, 1.0f };
+		return matrix;
+	}
+
+	// reference: every triangle of every object with the scalar Moller-Trumbore test, in world space
+	static float BruteForcePick(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+		const std::vector<glm::mat4>& modelMatrices, const LitRay& ray, uint32_t& objectIndex)
+	{
+		float closest = std::numeric_limits<float>::max();
+		objectIndex = UINT32_MAX;
+		for (uint32_t object = 0; object < static_cast<uint32_t>(modelMatrices.size()); object++)
+		{
+			const glm::mat4& model = modelMatrices[object];
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const glm::vec3 v0 = glm::vec3(model * glm::vec4(positions[indices[i]], 1.0f));
+				const glm::vec3 edge1 = glm::vec3(model * glm::vec4(positions[indices[i + 1]], 1.0f)) - v0;
+				const glm::vec3 edge2 = glm::vec3(model * glm::vec4(positions[indices[i + 2]], 1.0f)) - v0;
+				const glm::vec3 p = glm::cross(ray.direction, edge2);
+				const float determinant = glm::dot(edge1, p);
+				if (std::abs(determinant) < 1e-20f)
+				{
+					continue;
+				}
+				const float inverseDeterminant = 1.0f / determinant;
+				const glm::vec3 s = ray.origin - v0;
+				const float u = glm::dot(s, p) * inverseDeterminant;
+				const glm::vec3 q = glm::cross(s, edge1);
+				const float v = glm::dot(ray.direction, q) * inverseDeterminant;
+				const float t = glm::dot(edge2, q) * inverseDeterminant;
+				if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < closest)
+				{
+					closest = t;
+					objectIndex = object;
+				}
+			}
+		}
+		return closest;
+	}
+
+	int RunPickBenchmark(const std::vector<std::string>& args)
+	{
+		const uint32_t targetTriangles = args.empty() ? DEFAULT_TRIANGLE_COUNT : static_cast<uint32_t>(std::stoul(args[0]));
+
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> indices;
+		BuildSphere(SPHERE_SEGMENTS, positions, indices);
+		auto start = std::chrono::high_resolution_clock::now();
+		const LitMeshBvh meshBvh{ positions, indices.data(), static_cast<uint32_t>(indices.size()) };
+		const double buildTime = MicrosecondsSince(start);
+
+		// one shared mesh instanced on a square grid, like a scene of repeated props
+		const uint32_t objectCount = (targetTriangles + meshBvh.GetTriangleCount() - 1) / meshBvh.GetTriangleCount();
+		const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+		std::mt19937 random{ objectCount };
+		std::uniform_real_distribution<float> scale{ 0.5f, 1.2f };
+		std::uniform_real_distribution<float> angle{ 0.0f, 6.2831853f };
+
+		LitBvh sceneBvh;
+		std::vector<glm::mat4> modelMatrices(objectCount);
+		std::vector<LitPickInstance> instances(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			const glm::vec3 translation{ 3.0f * (i % gridSize), 0.0f, 3.0f * (i / gridSize) };
+			const glm::vec3 size{ scale(random), scale(random), scale(random) };
+			modelMatrices[i] = PlacementMatrix(translation, angle(random), size);
+			instances[i] = LitPickInstance{ &meshBvh, glm::inverse(modelMatrices[i]) };
+			sceneBvh.Insert(meshBvh.GetBounds().Transform(modelMatrices[i]), i);
+		}
+		sceneBvh.Rebuild();
+		std::printf("%u objects, %u triangles (%u per object, mesh BVH %u nodes built in %.2f ms)\n",
+			objectCount, objectCount * meshBvh.GetTriangleCount(), meshBvh.GetTriangleCount(),
+			meshBvh.GetNodeCount(), buildTime / 1000.0);
+
+		// looking down at the grid from above one corner, so rays cross many boxes before they hit
+		const float extent = 3.0f * gridSize;
+		LitCamera camera;
+		camera.SetPerspectiveProjection(glm::radians(50.0f), SCREEN_WIDTH / SCREEN_HEIGHT, 0.1f, 4.0f * extent);
+		camera.SetViewTarget(glm::vec3{ -0.2f * extent, -0.5f * extent, -0.2f * extent }, glm::vec3{ 0.5f * extent, 0.0f, 0.5f * extent });
+
+		std::uniform_real_distribution<float> cursorX{ 0.0f, SCREEN_WIDTH };
+		std::uniform_real_distribution<float> cursorY{ 0.0f, SCREEN_HEIGHT };
+		std::vector<LitRay> rays;
+		rays.reserve(PICK_COUNT);
+		for (uint32_t i = 0; i < PICK_COUNT; i++)
+		{
+			rays.push_back(camera.ScreenPointToRay(glm::vec2{ cursorX(random), cursorY(random) }, glm::vec2{ SCREEN_WIDTH, SCREEN_HEIGHT }));
+		}
+
+		std::vector<LitPickResult> results(PICK_COUNT);
+		double totalTime = 0.0;
+		double maxTime = 0.0;
+		uint32_t hitCount = 0;
+		for (uint32_t i = 0; i < PICK_COUNT; i++)
+		{
+			start = std::chrono::high_resolution_clock::now();
+			results[i] = LitPicker::Pick(sceneBvh, instances, rays[i], std::numeric_limits<float>::max());
+			const double pickTime = MicrosecondsSince(start);
+			totalTime += pickTime;
+			maxTime = std::max(maxTime, pickTime);
+			hitCount += results[i].IsHit() ? 1 : 0;
+		}
+		std::printf("  %u picks: %.2f us average, %.2f us max, %u hits\n", PICK_COUNT, totalTime / PICK_COUNT, maxTime, hitCount);
+
+		uint32_t mismatches = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < VERIFY_COUNT; i++)
+		{
+			uint32_t objectIndex;
+			const float distance = BruteForcePick(positions, indices, modelMatrices, rays[i], objectIndex);
+			const bool bMatches = objectIndex == results[i].objectIndex &&
+				(objectIndex == UINT32_MAX || std::abs(distance - results[i].distance) <= 1e-3f * std::max(1.0f, distance));
+			mismatches += bMatches ? 0 : 1;
+		}
+		std::printf("  brute force %.2f us/pick, %u of %u picks mismatched\n", MicrosecondsSince(start) / VERIFY_COUNT, mismatches, VERIFY_COUNT);
+		return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+}
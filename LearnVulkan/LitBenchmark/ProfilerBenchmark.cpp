@@ -0,0 +1,79 @@
+#include "Benchmarks.h"
+
+#include "Core/LitCpuProfiler.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace Lit
+{
+	static const uint32_t DEFAULT_ZONE_COUNT = 10000000;
+	static const double ZONE_BUDGET_NANOSECONDS = 50.0;
+	// per thread, a bit less than a ring so the capture drops nothing
+	static const uint32_t CAPTURE_ZONE_COUNT = LitCpuProfiler::RING_CAPACITY / 2;
+	static const char* CAPTURE_PATH = "profiler_benchmark_trace.json";
+
+	static double NanosecondsPerZone(uint32_t zoneCount, uint32_t threadCount)
+	{
+		auto recordZones = [zoneCount]()
+		{
+			for (uint32_t i = 0; i < zoneCount; i++)
+			{
+				LIT_CPU_ZONE("benchmark zone");
+			}
+		};
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		std::vector<std::thread> threads;
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			threads.emplace_back(recordZones);
+		}
+		recordZones();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		// the threads run side by side, the time of one thread's zones
+		return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / zoneCount;
+	}
+
+	int RunProfilerBenchmark(const std::vector<std::string>& args)
+	{
+		const uint32_t zoneCount = args.empty() ? DEFAULT_ZONE_COUNT : static_cast<uint32_t>(std::stoul(args[0]));
+		const uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+		// registers the ring of the main thread before timing
+		LitCpuProfiler::SetThreadName("main");
+		LitCpuProfiler::SetEnabled(false);
+		std::printf("%u zones per thread, budget %.0f ns/zone\n", zoneCount, ZONE_BUDGET_NANOSECONDS);
+		std::printf("  disabled            %6.2f ns/zone\n", NanosecondsPerZone(zoneCount, 1));
+		LitCpuProfiler::SetEnabled(true);
+		const double singleThreadCost = NanosecondsPerZone(zoneCount, 1);
+		std::printf("  1 thread            %6.2f ns/zone\n", singleThreadCost);
+		for (uint32_t threadCount = 2; threadCount <= maxThreads; threadCount *= 2)
+		{
+			std::printf("  %-2u threads          %6.2f ns/zone\n", threadCount, NanosecondsPerZone(zoneCount, threadCount));
+		}
+
+		LitCpuProfiler::BeginCapture();
+		NanosecondsPerZone(CAPTURE_ZONE_COUNT, std::min(maxThreads, 4u));
+		const auto start = std::chrono::high_resolution_clock::now();
+		const bool bWritten = LitCpuProfiler::EndCapture(CAPTURE_PATH);
+		std::printf("  capture of %u zones on %u threads %s %s in %.2f ms, %llu dropped\n", CAPTURE_ZONE_COUNT,
+			std::min(maxThreads, 4u), bWritten ? "written to" : "failed to write", CAPTURE_PATH,
+			std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+			static_cast<unsigned long long>(LitCpuProfiler::GetDroppedZoneCount()));
+
+		if (singleThreadCost > ZONE_BUDGET_NANOSECONDS)
+		{
+			std::printf("zones are over budget\n");
+			return EXIT_FAILURE;
+		}
+		return bWritten ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,150 @@
+#include "Benchmarks.h"
+
+#include "Core/LitBlockCompression.h"
+
+// std
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+
+namespace Lit
+{
+	static const char* DEFAULT_TEXTURES[] =
+	{
+		"../textures/checker.tga",
+		"../textures/stripes.tga",
+	};
+	static const uint32_t SYNTHETIC_SIZE = 1024;
+	// below this something is broken rather than lossy
+	static const double MIN_PSNR = 30.0;
+
+	static double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// smooth gradients, hard edges and noise, so no encoder gets an easy image
+	static LitImageData CreateSyntheticImage(uint32_t size)
+	{
+		std::mt19937 random{ 1 };
+		std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				uint8_t* texel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+				const bool bEdge = ((x / 64) + (y / 64)) % 2 == 0;
+				texel[0] = static_cast<uint8_t>(x * 255 / size);
+				texel[1] = static_cast<uint8_t>((bEdge ? y * 239 / size : 239 - y * 239 / size) + random() % 16);
+				texel[2] = static_cast<uint8_t>(128 + 127 * std::sin(x * 0.05f + y * 0.03f));
+				texel[3] = static_cast<uint8_t>(bEdge ? 255 : random() % 256);
+			}
+		}
+		return LitImage::CreateRgba8(size, size, true, std::move(pixels));
+	}
+
+	// of level 0 over the channels the format keeps
+	static double Psnr(const LitImageData& reference, const LitImageData& decoded, uint32_t channels)
+	{
+		double squaredError = 0.0;
+		const size_t texelCount = static_cast<size_t>(reference.width) * reference.height;
+		for (size_t i = 0; i < texelCount; i++)
+		{
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				const double delta = static_cast<double>(reference.data[i * 4 + c]) - decoded.data[i * 4 + c];
+				squaredError += delta * delta;
+			}
+		}
+		const double meanSquaredError = squaredError / (texelCount * channels);
+		return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+	}
+
+	static bool BenchmarkImage(const std::string& name, LitImageData image)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		LitImage::GenerateMips(image);
+		const double mipTime = MillisecondsSince(start);
+		double megapixels = 0.0;
+		for (const auto& level : image.levels)
+		{
+			megapixels += static_cast<double>(level.width) * level.height / 1e6;
+		}
+		std::printf("%s: %ux%u, %zu levels, %.2f MB RGBA8, mips in %.2f ms\n", name.c_str(), image.width, image.height,
+			image.levels.size(), image.data.size() / (1024.0 * 1024.0), mipTime);
+
+		bool bPassed = true;
+		for (auto format : { LitBlockCompression::Format::BC1, LitBlockCompression::Format::BC3,
+			LitBlockCompression::Format::BC5, LitBlockCompression::Format::BC7 })
+		{
+			LitImageData compressed;
+			start = std::chrono::high_resolution_clock::now();
+			LitBlockCompression::Compress(image, format, compressed);
+			const double encodeTime = MillisecondsSince(start);
+
+			LitImageData decoded;
+			std::string error;
+			start = std::chrono::high_resolution_clock::now();
+			const bool bDecoded = LitBlockCompression::Decompress(compressed, decoded, error);
+			const double decodeTime = MillisecondsSince(start);
+			if (!bDecoded)
+			{
+				std::printf("  %s failed to decode: %s\n", LitBlockCompression::GetFormatName(format), error.c_str());
+				bPassed = false;
+				continue;
+			}
+
+			// BC1 drops alpha, BC5 keeps red and green
+			const uint32_t channels = format == LitBlockCompression::Format::BC1 ? 3 : format == LitBlockCompression::Format::BC5 ? 2 : 4;
+			const double psnr = Psnr(image, decoded, channels);
+			std::printf("  %s  %4.1f bpp  encode %8.2f ms %7.2f MPix/s  decode %7.2f ms %8.2f MPix/s  PSNR %5.2f dB\n",
+				LitBlockCompression::GetFormatName(format), compressed.data.size() * 8.0 / (megapixels * 1e6),
+				encodeTime, megapixels / (encodeTime / 1000.0), decodeTime, megapixels / (decodeTime / 1000.0), psnr);
+			bPassed = bPassed && psnr >= MIN_PSNR;
+		}
+		return bPassed;
+	}
+
+	int RunTextureBenchmark(const std::vector<std::string>& args)
+	{
+		std::vector<std::string> textures = args;
+		if (textures.empty())
+		{
+			textures.assign(std::begin(DEFAULT_TEXTURES), std::end(DEFAULT_TEXTURES));
+		}
+
+		bool bPassed = BenchmarkImage("synthetic", CreateSyntheticImage(SYNTHETIC_SIZE));
+		for (const auto& texture : textures)
+		{
+			LitImageData image;
+			std::string error;
+			if (!LitImage::Load(texture, true, image, error))
+			{
+				std::printf("%s: %s\n", texture.c_str(), error.c_str());
+				bPassed = false;
+				continue;
+			}
+			if (LitImage::IsBlockCompressed(image.format))
+			{
+				LitImageData compressed = std::move(image);
+				if (!LitBlockCompression::Decompress(compressed, image, error))
+				{
+					std::printf("%s: %s\n", texture.c_str(), error.c_str());
+					bPassed = false;
+					continue;
+				}
+			}
+			bPassed = BenchmarkImage(texture, std::move(image)) && bPassed;
+		}
+
+		if (!bPassed)
+		{
+			std::printf("a format fell below %.0f dB PSNR or failed to decode\n", MIN_PSNR);
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+}
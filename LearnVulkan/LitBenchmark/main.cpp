@@ -0,0 +1,66 @@
+#include "Benchmarks.h"
+
+// std
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	struct BenchmarkEntry
+	{
+		const char* name;
+		Lit::BenchmarkFunction function;
+		const char* description;
+	};
+
+	const BenchmarkEntry benchmarks[] =
+	{
+		{ "mesh", Lit::RunMeshOptimizeBenchmark, "vertex cache / overdraw / vertex fetch optimization [models...]" },
+		{ "meshlet", Lit::RunMeshletBenchmark, "meshlet build and frustum / normal cone culling [models...]" },
+		{ "bvh", Lit::RunBvhBenchmark, "scene BVH queries against brute force [object counts...]" },
+		{ "pick", Lit::RunPickBenchmark, "mouse picking through scene and mesh BVHs [triangle count]" },
+		{ "profiler", Lit::RunProfilerBenchmark, "CPU profiler zone cost and trace capture [zones per thread]" },
+		{ "texture", Lit::RunTextureBenchmark, "BC1/3/5/7 encode and decode speed and quality [images...]" },
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "usage: LitBenchmark <benchmark> [args...]" << std::endl;
+		for (const auto& benchmark : benchmarks)
+		{
+			std::cout << "  " << benchmark.name << "\t" << benchmark.description << std::endl;
+		}
+	}
+}
+
+// CPU side benchmarks of the engine systems, they don't create a Vulkan device so they run without a GPU
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> args(argv + 2, argv + argc);
+	for (const auto& benchmark : benchmarks)
+	{
+		if (std::strcmp(argv[1], benchmark.name) == 0)
+		{
+			try
+			{
+				return benchmark.function(args);
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << e.what() << '\n';
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	PrintUsage();
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,114 @@
+#include "Core/LitBlockCompression.h"
+
+// std
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::printf("usage: LitTextureCooker <input> <output> [--format bc1|bc3|bc5|bc7|rgba8] [--linear] [--no-mips]\n");
+		std::printf("  bc1\topaque color, 4 bits per texel\n");
+		std::printf("  bc3\tcolor and alpha, 8 bits per texel\n");
+		std::printf("  bc5\ttwo channels such as normal maps, always linear\n");
+		std::printf("  bc7\tcolor and alpha at higher quality than bc3, the default\n");
+		std::printf("  rgba8\tuncompressed, for devices and tools without BC\n");
+		std::printf("  --linear\tthe input is data rather than sRGB color\n");
+	}
+}
+
+// Cooks TGA and PPM images into the texture container of LitImage: the full mip chain, filtered once on the CPU, in
+// a BC format the GPU samples directly. LitTextureManager picks the cooked levels up as they are
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+	const std::string input = argv[1];
+	const std::string output = argv[2];
+	std::string formatName = "bc7";
+	bool bSrgb = true;
+	bool bMips = true;
+	for (int i = 3; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--format" && i + 1 < argc)
+		{
+			formatName = argv[++i];
+		}
+		else if (arg == "--linear")
+		{
+			bSrgb = false;
+		}
+		else if (arg == "--no-mips")
+		{
+			bMips = false;
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+	Lit::LitBlockCompression::Format format = Lit::LitBlockCompression::Format::BC7;
+	const bool bCompress = formatName != "rgba8";
+	if (bCompress && !Lit::LitBlockCompression::ParseFormat(formatName, format))
+	{
+		std::printf("unknown format %s\n", formatName.c_str());
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	Lit::LitImageData image;
+	std::string error;
+	if (!Lit::LitImage::Load(input, bSrgb, image, error))
+	{
+		std::printf("%s: %s\n", input.c_str(), error.c_str());
+		return EXIT_FAILURE;
+	}
+	// an already cooked input is recooked from its first level
+	if (Lit::LitImage::IsBlockCompressed(image.format))
+	{
+		Lit::LitImageData compressed = std::move(image);
+		if (!Lit::LitBlockCompression::Decompress(compressed, image, error))
+		{
+			std::printf("%s: %s\n", input.c_str(), error.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	if (bMips)
+	{
+		Lit::LitImage::GenerateMips(image);
+	}
+	else
+	{
+		image.levels.resize(1);
+		image.data.resize(image.levels[0].size);
+	}
+
+	Lit::LitImageData cooked;
+	if (bCompress)
+	{
+		Lit::LitBlockCompression::Compress(image, format, cooked);
+	}
+	else
+	{
+		cooked = std::move(image);
+	}
+	if (!Lit::LitImage::SaveContainer(output, cooked))
+	{
+		std::printf("failed to write %s\n", output.c_str());
+		return EXIT_FAILURE;
+	}
+	std::printf("%s: %ux%u, %zu levels, %s%s, %.1f KB in %.1f ms\n", output.c_str(), cooked.width, cooked.height,
+		cooked.levels.size(), formatName.c_str(), Lit::LitImage::IsSrgb(cooked.format) ? " sRGB" : "",
+		cooked.data.size() / 1024.0,
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	return EXIT_SUCCESS;
+}
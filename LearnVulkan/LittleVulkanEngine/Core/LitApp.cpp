@@ -1,5 +1,6 @@
 #include "LitApp.h"
 #include "LitCamera.h"
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 #include <chrono>
@@ -9,18 +10,18 @@
 #include "System/simple_render_system.h"
 #include "System/InputSystem.h"
 #include "LitFrameInfo.h"
+#include "LitPicker.h"
+#include "LitRenderTarget.h"
+#include "LitDynamicResolution.h"
+#include "LitRenderGraph.h"
+#include "LitResizeTest.h"
+#include "LitCpuProfiler.h"
+#include "LitCameraPath.h"
 
 #include "ImGui/LitImGui.h"
 
 namespace Lit
 {
-	struct GlobalUBO
-	{
-		glm::mat4 projectionView{ 1.0f };
-		glm::vec3 lightDirection = glm::normalize(glm::vec3(1.0f, -3.0f, -1.0f));
-	};
-
-
 	LitApp::LitApp() 
 	{
 		globalDescriptorPool = LitDescriptorPool::Builder(device)
@@ -34,8 +35,16 @@ namespace Lit
 	LitApp::~LitApp()
 	{
 	}
+
+	// frames in a CPU trace capture, a couple of seconds
+	static const uint32_t CPU_CAPTURE_FRAMES = 120;
+	static const char* CPU_TRACE_PATH = "cpu_trace.json";
+	// replayed by the headless benchmark with --camera-path
+	static const char* CAMERA_PATH_FILE = "camera_path.txt";
+
 	void LitApp::Run()
 	{
+		LitCpuProfiler::SetThreadName("main");
 		VkDeviceSize uniformBufferSize = sizeof(GlobalUBO);
 		std::vector<std::unique_ptr<LitBuffer>> uboBuffers(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
 		for (int i = 0; i < uboBuffers.size(); i++) {
@@ -44,7 +53,8 @@ namespace Lit
 				uniformBufferSize,
 				1,
 				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+				MemoryCategory::Uniform);
 			uboBuffers[i]->Map();
 		}
 
@@ -70,59 +80,358 @@ namespace Lit
 				.Build(globalDescriptorSets[i]);
 		}
 
-		SimpleRenderSystem simpleRenderSystem{ device, litRenderer.GetSwapChainRenderPass(), globalSetLayout->GetDescriptorSetLayout() };
+		SimpleRenderSystem simpleRenderSystem{ device, litRenderer.GetSwapChainRenderPass(), globalSetLayout->GetDescriptorSetLayout(),
+			textureManager };
+
+		// the scene renders here and is shown in the viewport window, same formats as the swap chain so the
+		// pipelines above work with its render pass
+		LitRenderTarget sceneTarget{ device, litRenderer.GetSwapChainImageFormat(), litRenderer.GetDepthFormat() };
+		std::vector<ImTextureID> viewportTextures;
+		LitDynamicResolution dynamicResolution;
+		LitRenderGraph renderGraph{ device };
+		LitGpuProfiler gpuProfiler{ device };
+		renderGraph.SetProfiler(&gpuProfiler);
+		LitResizeTest resizeTest;
+		uint32_t cpuCaptureFramesLeft = 0;
+		const char* cpuTraceStatus = nullptr;
+		LitCameraPath cameraPath;
+		bool bRecordingCameraPath = false;
+		float cameraPathTime = 0.0f;
+		const char* cameraPathStatus = nullptr;
 
 		auto viewerObject = LitGameObject::CreateGameObject();
 		InputSystem inputSystem;
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		while (!window.ShouldClose())
 		{
-			glfwPollEvents();
+			// between two frames, the trace holds whole frames
+			if (cpuCaptureFramesLeft > 0 && --cpuCaptureFramesLeft == 0)
+			{
+				cpuTraceStatus = LitCpuProfiler::EndCapture(CPU_TRACE_PATH) ? "written" : "failed to write";
+			}
+			LIT_CPU_ZONE("frame");
+			{
+				LIT_CPU_ZONE("poll events");
+				glfwPollEvents();
+			}
 			auto newTime = std::chrono::high_resolution_clock::now();
 			float frameTime =
 				std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
 			currentTime = newTime;
+			dynamicResolution.Update(frameTime * 1000.0f);
+			if (resizeTest.IsRunning())
+			{
+				const VkExtent2D windowExtent = resizeTest.Step(frameTime * 1000.0f, litRenderer.GetSwapChainRecreateCount());
+				glfwSetWindowSize(window.GetWindow(), static_cast<int>(windowExtent.width), static_cast<int>(windowExtent.height));
+				if (!resizeTest.IsRunning())
+				{
+					resizeTest.WriteCsv("resize_trace.csv");
+				}
+			}
 
 			inputSystem.MoveInPlaneXZ(window.GetWindow(), frameTime, viewerObject);
 
 			camera.SetViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
+			if (bRecordingCameraPath)
+			{
+				cameraPathTime += cameraPath.IsEmpty() ? 0.0f : frameTime;
+				cameraPath.AddKeyframe(cameraPathTime, viewerObject.transform.translation, viewerObject.transform.rotation);
+			}
 
-			float aspect = litRenderer.GetAspectRatio();
-			camera.SetPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 10.f);
+			// polled every frame to see the button go down
+			glm::vec2 cursor;
+			const bool bPick = inputSystem.PollPick(window.GetWindow(), cursor);
 			if (auto commandBuffer = litRenderer.BeginFrame())
 			{
 				int frameIndex = litRenderer.GetFrameIndex();
-				FrameInfo frameInfo{ frameIndex, frameTime, commandBuffer, camera , globalDescriptorSets[frameIndex]};
+				gpuProfiler.BeginFrame(commandBuffer, frameIndex);
+				// what the workers decoded since the last frame, before the draws pick their descriptor sets
+				textureManager.Update();
+
+				// tell imgui that we're starting a new frame
+				litImgui.NewFrame();
+
+				// the viewport window decides the output resolution of the scene, dynamic resolution
+				// renders a part of it that the window scales up
+				ImGui::SetNextWindowSize(ImVec2(static_cast<float>(WIDTH) * 0.6f, static_cast<float>(HEIGHT) * 0.6f), ImGuiCond_FirstUseEver);
+				ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+				ImGui::Begin("Viewport", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+				ImGui::PopStyleVar();
+				const ImVec2 viewportSize = ImGui::GetContentRegionAvail();
+				const VkExtent2D viewportExtent{
+					std::max(static_cast<uint32_t>(viewportSize.x), 1u), std::max(static_cast<uint32_t>(viewportSize.y), 1u) };
+				if (sceneTarget.Resize(viewportExtent) || viewportTextures.empty())
+				{
+					// frames in flight may still draw the old textures
+					for (ImTextureID texture : viewportTextures)
+					{
+						device.GetDeletionQueue().Push([&litImgui, texture]() { litImgui.RemoveTexture(texture); });
+					}
+					viewportTextures.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+					for (int i = 0; i < LitSwapChain::MAX_FRAMES_IN_FLIGHT; i++)
+					{
+						viewportTextures[i] = litImgui.AddTexture(sceneTarget.GetSampler(),
+							sceneTarget.GetColorImageView(i), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+					}
+				}
+				const VkExtent2D renderExtent = dynamicResolution.ScaleExtent(viewportExtent);
+				const ImVec2 renderUv{
+					static_cast<float>(renderExtent.width) / static_cast<float>(viewportExtent.width),
+					static_cast<float>(renderExtent.height) / static_cast<float>(viewportExtent.height) };
+				ImGui::Image(viewportTextures[frameIndex], viewportSize, ImVec2(0.0f, 0.0f), renderUv);
+				const bool bViewportHovered = ImGui::IsItemHovered();
+				const ImVec2 viewportMin = ImGui::GetItemRectMin();
+				ImGui::End();
+
+				const float aspect = static_cast<float>(viewportExtent.width) / static_cast<float>(viewportExtent.height);
+				camera.SetPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 10.f);
+
+				// clicks on other imgui windows belong to them
+				if (bPick && bViewportHovered)
+				{
+					UpdateSceneBvh();
+					PickGameObject(camera, cursor - glm::vec2(viewportMin.x, viewportMin.y), glm::vec2(viewportSize.x, viewportSize.y));
+				}
+
+				FrameInfo frameInfo{ frameIndex, frameTime, commandBuffer, camera , globalDescriptorSets[frameIndex], &gpuProfiler };
 
 				//update
 				GlobalUBO ubo{};
 				ubo.projectionView = camera.GetProjection() * camera.GetView();
 				uboBuffers[frameIndex]->WriteToBuffer(&ubo);
-				uboBuffers[frameIndex]->Flush();
+				uboBuffers[frameIndex]->QueueFlush();
 
-				// tell imgui that we're starting a new frame
-				litImgui.NewFrame();
-				
-				litRenderer.BeginSwapChainRenderPass(commandBuffer);
-				// render game objects first, so they will be rendered in the background. This
-				// is the best we can do for now.
-				// Once we cover offscreen rendering, we can render the scene to a image/texture rather than
-				// directly to the swap chain. This texture of the scene can then be rendered to an imgui
-				// subwindow
-				simpleRenderSystem.RenderGameObjects(frameInfo, gameObjects);
+				// latched before the UI below can change it, prepare and the late pass have to agree
+				const bool bOcclusionCulling = simpleRenderSystem.IsOcclusionCullingEnabled();
+				UpdateSceneBvh();
+				simpleRenderSystem.PrepareGameObjects(frameInfo, gameObjects, sceneBvh, renderExtent);
+
+				// the passes of the frame, the graph orders them and places the barriers between them
+				renderGraph.Reset();
+				// the scene passes clear the render target, nothing of it is needed after the UI sampled it
+				auto sceneColor = renderGraph.ImportImage("scene color", sceneTarget.GetColorImage(frameIndex),
+					sceneTarget.GetColorImageView(frameIndex), sceneTarget.GetColorFormat(), sceneTarget.GetExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+				auto sceneDepth = renderGraph.ImportImage("scene depth", sceneTarget.GetDepthImage(frameIndex),
+					sceneTarget.GetDepthImageView(frameIndex), sceneTarget.GetDepthFormat(), sceneTarget.GetExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+				auto swapChainColor = renderGraph.ImportImage("swap chain color", litRenderer.GetCurrentImage(),
+					litRenderer.GetCurrentImageView(), litRenderer.GetSwapChainImageFormat(), litRenderer.GetSwapChainExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+				auto swapChainDepth = renderGraph.ImportImage("swap chain depth", litRenderer.GetCurrentDepthImage(),
+					litRenderer.GetCurrentDepthImageView(), litRenderer.GetDepthFormat(), litRenderer.GetSwapChainExtent(),
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+				const VkClearColorValue clearColor{ { 0.1f, 0.2f, 0.4f, 1.0f } };
+				const VkClearDepthStencilValue clearDepth{ 1.0f, 0 };
+				renderGraph.AddGraphicsPass("scene", [&](LitRenderGraph::PassBuilder& builder)
+				{
+					sceneColor = builder.WriteColor(sceneColor, &clearColor);
+					sceneDepth = builder.WriteDepth(sceneDepth, &clearDepth);
+					builder.SetRenderArea(renderExtent);
+				}, [&](VkCommandBuffer) { simpleRenderSystem.RenderGameObjects(frameInfo); });
+				if (bOcclusionCulling)
+				{
+					// the depth pyramid and the late draw commands stay inside the occlusion culler
+					renderGraph.AddComputePass("occlusion cull", [&](LitRenderGraph::PassBuilder& builder)
+					{
+						builder.ReadImage(sceneDepth, LitRenderGraph::ImageUsage::SampledCompute);
+						builder.SetSideEffect();
+					}, [&](VkCommandBuffer)
+					{
+						simpleRenderSystem.CullOccludedGameObjects(frameInfo, sceneTarget.GetDepthImageView(frameIndex));
+					});
+					renderGraph.AddGraphicsPass("late scene", [&](LitRenderGraph::PassBuilder& builder)
+					{
+						sceneColor = builder.WriteColor(sceneColor);
+						sceneDepth = builder.WriteDepth(sceneDepth);
+						builder.SetRenderArea(renderExtent);
+					}, [&](VkCommandBuffer) { simpleRenderSystem.RenderLateGameObjects(frameInfo); });
+				}
+				// the swap chain only gets the UI, at window resolution
+				renderGraph.AddGraphicsPass("ui", [&](LitRenderGraph::PassBuilder& builder)
+				{
+					builder.ReadImage(sceneColor, LitRenderGraph::ImageUsage::SampledFragment);
+					swapChainColor = builder.WriteColor(swapChainColor, &clearColor);
+					// unused, it keeps the pass compatible with the swap chain render pass imgui was created for
+					builder.WriteDepth(swapChainDepth, &clearDepth);
+				}, [&](VkCommandBuffer uiCommandBuffer) { litImgui.Render(uiCommandBuffer); });
+				{
+					LIT_CPU_ZONE("compile render graph");
+					renderGraph.Compile(frameIndex);
+				}
 
 				// example code telling imgui what windows to render, and their contents
 				// this can be replaced with whatever code/classes you set up configuring your
 				// desired engine UI
 				litImgui.RunExample();
-				// as last step in render pass, record the imgui draw commands
-				litImgui.Render(commandBuffer);
 
-				litRenderer.EndSwapChainRenderPass(commandBuffer);
+				const RenderQueueStatistics& queueStatistics = simpleRenderSystem.GetRenderQueueStatistics();
+				const MeshletCullStatistics& meshletStatistics = simpleRenderSystem.GetMeshletCullStatistics();
+				ImGui::Begin("Renderer Stats");
+				bool bDepthPrePass = simpleRenderSystem.IsDepthPrePassEnabled();
+				if (ImGui::Checkbox("depth pre-pass", &bDepthPrePass))
+				{
+					simpleRenderSystem.SetDepthPrePass(bDepthPrePass);
+				}
+				if (bDepthPrePass)
+				{
+					const RenderQueueStatistics& prePassStatistics = simpleRenderSystem.GetDepthPrePassStatistics();
+					ImGui::Text("pre-pass draws %u, state changes %u", prePassStatistics.drawCount, prePassStatistics.StateChanges());
+				}
+				bool bOcclusionCullingEnabled = bOcclusionCulling;
+				if (ImGui::Checkbox("occlusion culling", &bOcclusionCullingEnabled))
+				{
+					simpleRenderSystem.SetOcclusionCulling(bOcclusionCullingEnabled);
+				}
+				if (bOcclusionCulling)
+				{
+					const OcclusionCullStatistics& occlusionStatistics = simpleRenderSystem.GetOcclusionCullStatistics();
+					ImGui::Text("occlusion: %u tested, %u occluded, %u early draws, %u late draws",
+						occlusionStatistics.tested, occlusionStatistics.occluded,
+						occlusionStatistics.earlyDraws, occlusionStatistics.lateDraws);
+				}
+				bool bDynamicResolution = dynamicResolution.IsEnabled();
+				if (ImGui::Checkbox("dynamic resolution", &bDynamicResolution))
+				{
+					dynamicResolution.SetEnabled(bDynamicResolution);
+				}
+				if (bDynamicResolution)
+				{
+					float targetFrameMilliseconds = dynamicResolution.GetTargetFrameMilliseconds();
+					if (ImGui::SliderFloat("frame time target (ms)", &targetFrameMilliseconds, 4.0f, 33.3f))
+					{
+						dynamicResolution.SetTargetFrameMilliseconds(targetFrameMilliseconds);
+					}
+					ImGui::Text("frame time %.2f ms", dynamicResolution.GetSmoothedFrameMilliseconds());
+				}
+				ImGui::Text("scene %ux%u of %ux%u (%.0f%%)", renderExtent.width, renderExtent.height,
+					viewportExtent.width, viewportExtent.height, dynamicResolution.GetScale() * 100.0f);
+				ImGui::Text("draws %u, state changes %u", queueStatistics.drawCount, queueStatistics.StateChanges());
+				ImGui::Text("pipeline binds %u, descriptor binds %u, geometry binds %u",
+					queueStatistics.pipelineBinds, queueStatistics.descriptorBinds, queueStatistics.geometryBinds);
+				ImGui::Text("meshlets %u: %u frustum culled, %u backface culled, %u indirect draws",
+					meshletStatistics.meshletCount, meshletStatistics.frustumCulled,
+					meshletStatistics.backfaceCulled, meshletStatistics.drawCount);
+				const LitRenderGraph::Statistics& graphStatistics = renderGraph.GetStatistics();
+				ImGui::Text("render graph: %u passes (%u culled), %u barrier batches, %u image barriers",
+					graphStatistics.passCount, graphStatistics.culledPassCount,
+					graphStatistics.barrierBatchCount, graphStatistics.imageBarrierCount);
+				ImGui::Text("transient images %u: %.1f MB in %.1f MB", graphStatistics.transientImageCount,
+					graphStatistics.transientBytes / (1024.0 * 1024.0), graphStatistics.allocatedBytes / (1024.0 * 1024.0));
+				LitTimeline& timeline = device.GetTimeline();
+				ImGui::Text("timeline (%s): %llu submitted, %llu completed, %zu deletions pending",
+					timeline.UsesTimelineSemaphore() ? "semaphore" : "fences",
+					static_cast<unsigned long long>(timeline.GetLastSubmittedValue()),
+					static_cast<unsigned long long>(timeline.GetCompletedValue()),
+					device.GetDeletionQueue().GetPendingCount());
+				const LitTextureManager::Statistics textureStatistics = textureManager.GetStatistics();
+				ImGui::Text("textures %u: %u resident (%.1f MB), %u loading, %u failed, %zu samplers",
+					textureStatistics.textureCount, textureStatistics.residentCount,
+					textureStatistics.residentBytes / (1024.0 * 1024.0), textureStatistics.loadingCount,
+					textureStatistics.failedCount, textureStatistics.samplerCount);
+				ImGui::Text("last texture upload: %u textures, %.1f MB staging, %u in flight",
+					textureStatistics.lastBatchTextureCount, textureStatistics.lastBatchBytes / (1024.0 * 1024.0),
+					textureStatistics.uploadsInFlight);
+				ImGui::Text("block compressed: %u resident, %u decoded on the CPU", textureStatistics.compressedCount,
+					textureStatistics.cpuDecodedCount);
+				bool bTextureStreaming = textureManager.IsStreamingEnabled();
+				if (ImGui::Checkbox("texture streaming", &bTextureStreaming))
+				{
+					textureManager.SetStreamingEnabled(bTextureStreaming);
+				}
+				ImGui::Text("texture mips: %.1f MB of %.1f MB resident, %u levels streamed, %u streamed in, %u out",
+					textureStatistics.residentBytes / (1024.0 * 1024.0), textureStatistics.systemBytes / (1024.0 * 1024.0),
+					textureStatistics.streamedLevelCount, textureStatistics.streamedInCount, textureStatistics.streamedOutCount);
+				if (!resizeTest.IsRunning() && ImGui::Button("resize test"))
+				{
+					resizeTest.Start(window.GetExtent(), litRenderer.GetSwapChainRecreateCount());
+				}
+				const LitResizeTest::Summary& resizeSummary = resizeTest.GetSummary();
+				if (resizeSummary.frameCount > 0)
+				{
+					ImGui::Text("resize test: %u frames, %u recreations, median %.2f ms, p99 %.2f ms, max %.2f ms",
+						resizeSummary.frameCount, resizeSummary.recreateCount, resizeSummary.medianMilliseconds,
+						resizeSummary.p99Milliseconds, resizeSummary.maxMilliseconds);
+				}
+				if (cpuCaptureFramesLeft == 0 && ImGui::Button("capture CPU trace"))
+				{
+					LitCpuProfiler::BeginCapture();
+					cpuCaptureFramesLeft = CPU_CAPTURE_FRAMES;
+				}
+				if (cpuCaptureFramesLeft > 0)
+				{
+					ImGui::Text("capturing CPU trace, %u frames left", cpuCaptureFramesLeft);
+				}
+				else if (cpuTraceStatus != nullptr)
+				{
+					ImGui::Text("CPU trace %s %s, %llu zones dropped", cpuTraceStatus, CPU_TRACE_PATH,
+						static_cast<unsigned long long>(LitCpuProfiler::GetDroppedZoneCount()));
+				}
+				if (!bRecordingCameraPath && ImGui::Button("record camera path"))
+				{
+					cameraPath.Clear();
+					cameraPathTime = 0.0f;
+					bRecordingCameraPath = true;
+				}
+				else if (bRecordingCameraPath && ImGui::Button("stop recording"))
+				{
+					bRecordingCameraPath = false;
+					cameraPathStatus = cameraPath.Save(CAMERA_PATH_FILE) ? "written to" : "failed to write";
+				}
+				if (bRecordingCameraPath)
+				{
+					ImGui::Text("recording camera path, %.1f s", cameraPathTime);
+				}
+				else if (cameraPathStatus != nullptr)
+				{
+					ImGui::Text("camera path of %.1f s %s %s", cameraPath.GetDuration(), cameraPathStatus, CAMERA_PATH_FILE);
+				}
+				ImGui::End();
+				DrawInspector();
+				litImgui.DrawGpuProfiler(gpuProfiler);
+				litImgui.DrawMemoryBudget(device.GetMemoryBudget());
+
+				// the UI pass records the imgui draw commands, everything above is in
+				{
+					LIT_CPU_ZONE("record commands");
+					renderGraph.Execute(commandBuffer);
+				}
+				gpuProfiler.EndFrame(commandBuffer);
 				litRenderer.EndFrame();
 			}
 		}
 		vkDeviceWaitIdle(device.GetDevice());
+		// some deletions need objects that go away before the device
+		device.GetDeletionQueue().Flush();
+	}
+
+	// rebuild once refitting made the tree this much more expensive to traverse than a fresh SAH build
+	static const float SCENE_BVH_REBUILD_RATIO = 1.5f;
+
+	void LitApp::UpdateSceneBvh()
+	{
+		LIT_CPU_ZONE("update scene bvh");
+		bool bChanged = false;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(gameObjects.size()); i++)
+		{
+			auto& obj = gameObjects[i];
+			const LitAABB bounds = obj.model->GetBounds().Transform(obj.transform.mat4());
+			if (i == gameObjectProxies.size())
+			{
+				gameObjectProxies.push_back(sceneBvh.Insert(bounds, i));
+				bChanged = true;
+			}
+			else
+			{
+				bChanged |= sceneBvh.Update(gameObjectProxies[i], bounds);
+			}
+		}
+
+		if (bChanged && sceneBvh.GetSahCost() > sceneBvh.GetRebuildSahCost() * SCENE_BVH_REBUILD_RATIO)
+		{
+			sceneBvh.Rebuild();
+		}
 	}
 
 	std::unique_ptr<LitModel> CreateCubeModel(LitDevice& device, glm::vec3 offset)
@@ -178,6 +487,7 @@ namespace Lit
 	}
 	void LitApp::LoadGameObjects()
 	{
+		LIT_CPU_ZONE("load game objects");
 		/*std::shared_ptr<LitModel> lveModel = CreateCubeModel(device, glm::vec3{ .0f, .0f, .0f });
 		auto cube = LitGameObject::CreateGameObject();
 		cube.model = lveModel;
@@ -200,11 +510,55 @@ namespace Lit
 		flatVase.transform.scale = glm::vec3{ 3.f, 1.5f, 3.f };
 		gameObjects.push_back(std::move(flatVase));*/
 
-		litModel = LitModel::CreateModelFromFile(device, "../models/smooth_vase.obj");
+		LitModel::LoadOptions loadOptions{};
+		loadOptions.geometryPool = &geometryPool;
+		litModel = LitModel::CreateModelFromFile(device, "../models/smooth_vase.obj", loadOptions);
 		auto smoothVase = LitGameObject::CreateGameObject();
 		smoothVase.model = litModel;
+		smoothVase.texture = textureManager.Load("../textures/stripes.ltex");
 		smoothVase.transform.translation = glm::vec3{ .5f, .5f, 2.5f };
 		smoothVase.transform.scale = glm::vec3{ 3.f, 1.5f, 3.f };
 		gameObjects.push_back(std::move(smoothVase));
 	}
+
+	void LitApp::PickGameObject(const LitCamera& camera, const glm::vec2& cursor, const glm::vec2& viewportSize)
+	{
+		LIT_CPU_ZONE("pick");
+		auto start = std::chrono::high_resolution_clock::now();
+
+		const LitRay ray = camera.ScreenPointToRay(cursor, viewportSize);
+
+		std::vector<LitPickInstance> instances(gameObjects.size());
+		for (size_t i = 0; i < gameObjects.size(); i++)
+		{
+			instances[i].meshBvh = gameObjects[i].model->GetMeshBvh();
+			instances[i].inverseModelMatrix = glm::inverse(gameObjects[i].transform.mat4());
+		}
+		const LitPickResult result = LitPicker::Pick(sceneBvh, instances, ray, std::numeric_limits<float>::max());
+		selectedObject = result.objectIndex;
+
+		lastPickMicroseconds = std::chrono::duration<float, std::chrono::microseconds::period>(
+			std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void LitApp::DrawInspector()
+	{
+		ImGui::Begin("Inspector");
+		ImGui::Text("pick %.1f us", lastPickMicroseconds);
+		if (selectedObject < gameObjects.size())
+		{
+			auto& obj = gameObjects[selectedObject];
+			ImGui::Text("object %u", obj.GetID());
+			ImGui::DragFloat3("translation", &obj.transform.translation.x, 0.01f);
+			ImGui::DragFloat3("rotation", &obj.transform.rotation.x, 0.01f);
+			ImGui::DragFloat3("scale", &obj.transform.scale.x, 0.01f);
+			ImGui::Text("vertices %u, triangles %u", obj.model->GetVertexCount(),
+				obj.model->GetMeshBvh() ? obj.model->GetMeshBvh()->GetTriangleCount() : 0u);
+		}
+		else
+		{
+			ImGui::Text("click an object to select it");
+		}
+		ImGui::End();
+	}
 }
\ No newline at end of file
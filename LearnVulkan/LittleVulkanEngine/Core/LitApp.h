@@ -6,6 +6,10 @@
 #include "LitGameObject.h"
 #include "LitRenderer.h"
 #include "LitDescriptors.h"
+#include "LitGeometryPool.h"
+#include "LitTextureManager.h"
+#include "LitBvh.h"
+#include "LitCamera.h"
 
 namespace Lit
 {
@@ -36,6 +40,11 @@ namespace Lit
 
 		// 
 		void LoadGameObjects();
+		// refits the proxies of objects that moved and rebuilds once the tree got too loose
+		void UpdateSceneBvh();
+		// selects the object under the cursor, or none when the ray misses. cursor is relative to the viewport
+		void PickGameObject(const LitCamera& camera, const glm::vec2& cursor, const glm::vec2& viewportSize);
+		void DrawInspector();
 
 	private:
 		LitWindow window = { WIDTH, HEIGHT, "Hello Vulkan" };
@@ -43,6 +52,16 @@ namespace Lit
 		LitRenderer litRenderer { window, device };
 
 		std::unique_ptr<LitDescriptorPool> globalDescriptorPool{};
+		// declared before gameObjects so the models release their ranges before the pool goes away
+		LitGeometryPool geometryPool{ device };
+		// declared before gameObjects for the same reason, the textures free their descriptor sets from its pool
+		LitTextureManager textureManager{ device };
 		std::vector<LitGameObject> gameObjects;
+		// world space bounds of gameObjects, user data is the index in gameObjects
+		LitBvh sceneBvh;
+		std::vector<LitBvh::ProxyId> gameObjectProxies;
+		// index in gameObjects shown by the inspector
+		uint32_t selectedObject = UINT32_MAX;
+		float lastPickMicroseconds = 0.0f;
 	};
 }
\ No newline at end of file
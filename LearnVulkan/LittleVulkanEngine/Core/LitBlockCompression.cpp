@@ -0,0 +1,826 @@
+#include "LitBlockCompression.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Lit
+{
+	static const int BLOCK_TEXELS = 16;
+	static const int POWER_ITERATIONS = 8;
+	// least squares passes over the endpoints after the first choice of indices, each only kept when it helps
+	static const int REFINE_ITERATIONS = 2;
+	static const int BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+	static const int BC7_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	static const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	// share of the second color endpoint of a BC1 index
+	static const float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	using BlockTexels = float[BLOCK_TEXELS][4];
+
+	// bits of a BC7 block, least significant first
+	struct BitWriter
+	{
+		uint8_t* bytes;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++, position++)
+			{
+				bytes[position / 8] |= static_cast<uint8_t>(((value >> i) & 1u) << (position % 8));
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		const uint8_t* bytes;
+		uint32_t position = 0;
+
+		uint32_t Read(uint32_t count)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; i++, position++)
+			{
+				value |= ((bytes[position / 8] >> (position % 8)) & 1u) << i;
+			}
+			return value;
+		}
+	};
+
+	static float Clamp255(float value)
+	{
+		return std::min(std::max(value, 0.0f), 255.0f);
+	}
+
+	// the extremes of the texels along their principal axis, found by power iteration on the covariance. The first
+	// N channels count, low and high get the same value for a block of one color
+	template <int N>
+	static void FitPrincipalAxis(const BlockTexels& texels, float* low, float* high)
+	{
+		float mean[N] = {};
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			for (int c = 0; c < N; c++)
+			{
+				mean[c] += texels[i][c] / BLOCK_TEXELS;
+			}
+		}
+		float covariance[N][N] = {};
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			for (int a = 0; a < N; a++)
+			{
+				for (int b = 0; b < N; b++)
+				{
+					covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+				}
+			}
+		}
+
+		// starting from the row of the largest variance, which can't be orthogonal to the axis
+		int largest = 0;
+		for (int c = 1; c < N; c++)
+		{
+			largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+		}
+		float axis[N];
+		std::copy(covariance[largest], covariance[largest] + N, axis);
+		for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++)
+		{
+			float next[N] = {};
+			float length = 0.0f;
+			for (int a = 0; a < N; a++)
+			{
+				for (int b = 0; b < N; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, std::abs(next[a]));
+			}
+			if (length < 1e-6f)
+			{
+				std::fill(axis, axis + N, 0.0f);
+				break;
+			}
+			for (int c = 0; c < N; c++)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+		float axisLength = 0.0f;
+		for (int c = 0; c < N; c++)
+		{
+			axisLength += axis[c] * axis[c];
+		}
+
+		float minT = 0.0f;
+		float maxT = 0.0f;
+		if (axisLength > 0.0f)
+		{
+			minT = 1e30f;
+			maxT = -1e30f;
+			for (int i = 0; i < BLOCK_TEXELS; i++)
+			{
+				float t = 0.0f;
+				for (int c = 0; c < N; c++)
+				{
+					t += (texels[i][c] - mean[c]) * axis[c];
+				}
+				minT = std::min(minT, t / axisLength);
+				maxT = std::max(maxT, t / axisLength);
+			}
+		}
+		for (int c = 0; c < N; c++)
+		{
+			low[c] = Clamp255(mean[c] + axis[c] * minT);
+			high[c] = Clamp255(mean[c] + axis[c] * maxT);
+		}
+	}
+
+	// the endpoints that reproduce the texels best by least squares, weights being the share of e1 in each texel.
+	// False when the weights can't tell the endpoints apart
+	template <int N>
+	static bool RefineEndpoints(const BlockTexels& texels, const float* weights, float* e0, float* e1)
+	{
+		float aa = 0.0f;
+		float ab = 0.0f;
+		float bb = 0.0f;
+		float ax[N] = {};
+		float bx[N] = {};
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			const float b = weights[i];
+			const float a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < N; c++)
+			{
+				ax[c] += a * texels[i][c];
+				bx[c] += b * texels[i][c];
+			}
+		}
+		const float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+		for (int c = 0; c < N; c++)
+		{
+			e0[c] = Clamp255((ax[c] * bb - bx[c] * ab) / determinant);
+			e1[c] = Clamp255((bx[c] * aa - ax[c] * ab) / determinant);
+		}
+		return true;
+	}
+
+	static void LoadTexels(const uint8_t* texels, BlockTexels& block)
+	{
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				block[i][c] = texels[i * 4 + c];
+			}
+		}
+	}
+
+	// BC1 color
+
+	static uint16_t QuantizeRgb565(const float* color)
+	{
+		const uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+		const uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+		const uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	static void BuildColorPalette(uint16_t c0, uint16_t c1, bool bFourColor, int palette[4][4])
+	{
+		for (int e = 0; e < 2; e++)
+		{
+			const uint32_t color = e == 0 ? c0 : c1;
+			const uint32_t r = (color >> 11) & 31u;
+			const uint32_t g = (color >> 5) & 63u;
+			const uint32_t b = color & 31u;
+			palette[e][0] = static_cast<int>((r << 3) | (r >> 2));
+			palette[e][1] = static_cast<int>((g << 2) | (g >> 4));
+			palette[e][2] = static_cast<int>((b << 3) | (b >> 2));
+			palette[e][3] = 255;
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			if (bFourColor)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		// transparent black, the RGB formats sample it opaque
+		palette[3][3] = bFourColor ? 255 : 0;
+	}
+
+	// orders the endpoints for four color mode and picks the indices, returns the squared error
+	static float EvaluateColorEndpoints(const BlockTexels& texels, uint16_t& c0, uint16_t& c1, uint32_t& indices)
+	{
+		if (c0 < c1)
+		{
+			std::swap(c0, c1);
+		}
+		int palette[4][4];
+		BuildColorPalette(c0, c1, true, palette);
+		float error = 0.0f;
+		indices = 0;
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			float bestError = 1e30f;
+			uint32_t bestIndex = 0;
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				float texelError = 0.0f;
+				for (int c = 0; c < 3; c++)
+				{
+					const float delta = texels[i][c] - palette[p][c];
+					texelError += delta * delta;
+				}
+				if (texelError < bestError)
+				{
+					bestError = texelError;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 2);
+			error += bestError;
+		}
+		return error;
+	}
+
+	static void EncodeColorBlock(const BlockTexels& texels, uint8_t* block)
+	{
+		float low[4];
+		float high[4];
+		FitPrincipalAxis<3>(texels, low, high);
+		uint16_t c0 = QuantizeRgb565(high);
+		uint16_t c1 = QuantizeRgb565(low);
+		uint32_t indices = 0;
+		float error = EvaluateColorEndpoints(texels, c0, c1, indices);
+		for (int iteration = 0; iteration < REFINE_ITERATIONS && error > 0.0f; iteration++)
+		{
+			float weights[BLOCK_TEXELS];
+			for (int i = 0; i < BLOCK_TEXELS; i++)
+			{
+				weights[i] = BC1_WEIGHTS[(indices >> (i * 2)) & 3u];
+			}
+			float e0[4];
+			float e1[4];
+			if (!RefineEndpoints<3>(texels, weights, e0, e1))
+			{
+				break;
+			}
+			uint16_t refined0 = QuantizeRgb565(e0);
+			uint16_t refined1 = QuantizeRgb565(e1);
+			uint32_t refinedIndices = 0;
+			const float refinedError = EvaluateColorEndpoints(texels, refined0, refined1, refinedIndices);
+			if (refinedError >= error)
+			{
+				break;
+			}
+			c0 = refined0;
+			c1 = refined1;
+			indices = refinedIndices;
+			error = refinedError;
+		}
+
+		block[0] = static_cast<uint8_t>(c0);
+		block[1] = static_cast<uint8_t>(c0 >> 8);
+		block[2] = static_cast<uint8_t>(c1);
+		block[3] = static_cast<uint8_t>(c1 >> 8);
+		std::memcpy(block + 4, &indices, sizeof(indices));
+	}
+
+	// BC2 and BC3 color blocks are four color whatever the order of the endpoints
+	static void DecodeColorBlock(const uint8_t* block, uint8_t* texels, bool bForceFourColor)
+	{
+		const uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+		const uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+		uint32_t indices;
+		std::memcpy(&indices, block + 4, sizeof(indices));
+		int palette[4][4];
+		BuildColorPalette(c0, c1, bForceFourColor || c0 > c1, palette);
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			const int* color = palette[(indices >> (i * 2)) & 3u];
+			for (int c = 0; c < 3; c++)
+			{
+				texels[i * 4 + c] = static_cast<uint8_t>(color[c]);
+			}
+			// BC1 is decoded as the opaque RGB format
+			texels[i * 4 + 3] = 255;
+		}
+	}
+
+	// BC4 single channel, the alpha of BC3 and both channels of BC5
+
+	static void BuildChannelPalette(int v0, int v1, int palette[8])
+	{
+		palette[0] = v0;
+		palette[1] = v1;
+		if (v0 > v1)
+		{
+			for (int i = 1; i <= 6; i++)
+			{
+				palette[i + 1] = ((7 - i) * v0 + i * v1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 1; i <= 4; i++)
+			{
+				palette[i + 1] = ((5 - i) * v0 + i * v1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	static void EncodeChannelBlock(const BlockTexels& texels, int channel, uint8_t* block)
+	{
+		float minValue = 255.0f;
+		float maxValue = 0.0f;
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			minValue = std::min(minValue, texels[i][channel]);
+			maxValue = std::max(maxValue, texels[i][channel]);
+		}
+		// eight values between the extremes
+		const int v0 = static_cast<int>(maxValue);
+		const int v1 = static_cast<int>(minValue);
+		int palette[8];
+		BuildChannelPalette(v0, v1, palette);
+
+		uint64_t indices = 0;
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			float bestError = 1e30f;
+			uint64_t bestIndex = 0;
+			for (uint64_t p = 0; p < 8; p++)
+			{
+				const float error = std::abs(texels[i][channel] - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+		block[0] = static_cast<uint8_t>(v0);
+		block[1] = static_cast<uint8_t>(v1);
+		for (int i = 0; i < 6; i++)
+		{
+			block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	static void DecodeChannelBlock(const uint8_t* block, uint8_t* texels, int channel)
+	{
+		int palette[8];
+		BuildChannelPalette(block[0], block[1], palette);
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			texels[i * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7u]);
+		}
+	}
+
+	// BC7
+
+	static int InterpolateBc7(int e0, int e1, int weight)
+	{
+		return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+	}
+
+	// 7 bits per channel and a p-bit shared by the channels, whichever p-bit reproduces endpoint closer
+	static void QuantizeMode6Endpoint(const float* endpoint, int* quantized)
+	{
+		float bestError = 1e30f;
+		for (int pBit = 0; pBit < 2; pBit++)
+		{
+			int candidate[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				const int value = std::min(std::max(static_cast<int>(std::lround((endpoint[c] - pBit) / 2.0f)), 0), 127);
+				candidate[c] = (value << 1) | pBit;
+				error += (candidate[c] - endpoint[c]) * (candidate[c] - endpoint[c]);
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				std::copy(candidate, candidate + 4, quantized);
+			}
+		}
+	}
+
+	static float EvaluateMode6Endpoints(const BlockTexels& texels, const int* e0, const int* e1, uint8_t* indices)
+	{
+		int palette[16][4];
+		for (int p = 0; p < 16; p++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				palette[p][c] = InterpolateBc7(e0[c], e1[c], BC7_WEIGHTS4[p]);
+			}
+		}
+		float error = 0.0f;
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			float bestError = 1e30f;
+			for (int p = 0; p < 16; p++)
+			{
+				float texelError = 0.0f;
+				for (int c = 0; c < 4; c++)
+				{
+					const float delta = texels[i][c] - palette[p][c];
+					texelError += delta * delta;
+				}
+				if (texelError < bestError)
+				{
+					bestError = texelError;
+					indices[i] = static_cast<uint8_t>(p);
+				}
+			}
+			error += bestError;
+		}
+		return error;
+	}
+
+	static void EncodeMode6Block(const BlockTexels& texels, uint8_t* block)
+	{
+		float low[4];
+		float high[4];
+		FitPrincipalAxis<4>(texels, low, high);
+		int e0[4];
+		int e1[4];
+		QuantizeMode6Endpoint(low, e0);
+		QuantizeMode6Endpoint(high, e1);
+		uint8_t indices[BLOCK_TEXELS];
+		float error = EvaluateMode6Endpoints(texels, e0, e1, indices);
+		for (int iteration = 0; iteration < REFINE_ITERATIONS && error > 0.0f; iteration++)
+		{
+			float weights[BLOCK_TEXELS];
+			for (int i = 0; i < BLOCK_TEXELS; i++)
+			{
+				weights[i] = BC7_WEIGHTS4[indices[i]] / 64.0f;
+			}
+			float refinedLow[4];
+			float refinedHigh[4];
+			if (!RefineEndpoints<4>(texels, weights, refinedLow, refinedHigh))
+			{
+				break;
+			}
+			int refined0[4];
+			int refined1[4];
+			uint8_t refinedIndices[BLOCK_TEXELS];
+			QuantizeMode6Endpoint(refinedLow, refined0);
+			QuantizeMode6Endpoint(refinedHigh, refined1);
+			const float refinedError = EvaluateMode6Endpoints(texels, refined0, refined1, refinedIndices);
+			if (refinedError >= error)
+			{
+				break;
+			}
+			std::copy(refined0, refined0 + 4, e0);
+			std::copy(refined1, refined1 + 4, e1);
+			std::copy(refinedIndices, refinedIndices + BLOCK_TEXELS, indices);
+			error = refinedError;
+		}
+
+		// the most significant bit of the first index is implied 0, swapping the endpoints makes it so
+		if (indices[0] >= 8)
+		{
+			std::swap_ranges(e0, e0 + 4, e1);
+			for (uint8_t& index : indices)
+			{
+				index = static_cast<uint8_t>(15 - index);
+			}
+		}
+
+		std::memset(block, 0, 16);
+		BitWriter writer{ block };
+		writer.Write(1u << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write(static_cast<uint32_t>(e0[c] >> 1), 7);
+			writer.Write(static_cast<uint32_t>(e1[c] >> 1), 7);
+		}
+		writer.Write(static_cast<uint32_t>(e0[0] & 1), 1);
+		writer.Write(static_cast<uint32_t>(e1[0] & 1), 1);
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			writer.Write(indices[i], i == 0 ? 3 : 4);
+		}
+	}
+
+	static const int* GetBc7Weights(uint32_t indexBits)
+	{
+		return indexBits == 2 ? BC7_WEIGHTS2 : indexBits == 3 ? BC7_WEIGHTS3 : BC7_WEIGHTS4;
+	}
+
+	// an endpoint of bits to 8 bits, repeating the high bits in the low ones
+	static int ExpandBc7(uint32_t value, uint32_t bits)
+	{
+		return bits >= 8 ? static_cast<int>(value) : static_cast<int>((value << (8 - bits)) | (value >> (2 * bits - 8)));
+	}
+
+	// the single subset modes: 4 and 5 with separate color and alpha indices and a channel rotation, and 6
+	static bool DecodeBc7Block(const uint8_t* block, uint8_t* texels)
+	{
+		uint32_t mode = 0;
+		while (mode < 8 && (block[0] & (1u << mode)) == 0)
+		{
+			mode++;
+		}
+		if (mode < 4 || mode > 6)
+		{
+			return false;
+		}
+
+		BitReader reader{ block };
+		reader.Read(mode + 1);
+		const uint32_t rotation = mode == 6 ? 0 : reader.Read(2);
+		const uint32_t indexMode = mode == 4 ? reader.Read(1) : 0;
+		const uint32_t colorBits = mode == 4 ? 5 : 7;
+		const uint32_t alphaBits = mode == 4 ? 6 : mode == 5 ? 8 : 7;
+		uint32_t endpoints[2][4];
+		for (int c = 0; c < 3; c++)
+		{
+			endpoints[0][c] = reader.Read(colorBits);
+			endpoints[1][c] = reader.Read(colorBits);
+		}
+		endpoints[0][3] = reader.Read(alphaBits);
+		endpoints[1][3] = reader.Read(alphaBits);
+		int colors[2][4];
+		for (int e = 0; e < 2; e++)
+		{
+			const uint32_t pBit = mode == 6 ? reader.Read(1) : 0;
+			for (int c = 0; c < 4; c++)
+			{
+				colors[e][c] = mode == 6 ? static_cast<int>((endpoints[e][c] << 1) | pBit) :
+					ExpandBc7(endpoints[e][c], c < 3 ? colorBits : alphaBits);
+			}
+		}
+
+		// mode 6 has one set of indices, 4 and 5 a second one read after the first
+		const uint32_t primaryBits = mode == 6 ? 4 : 2;
+		const uint32_t secondaryBits = mode == 4 ? 3 : mode == 5 ? 2 : 0;
+		uint32_t primary[BLOCK_TEXELS];
+		uint32_t secondary[BLOCK_TEXELS] = {};
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			primary[i] = reader.Read(i == 0 ? primaryBits - 1 : primaryBits);
+		}
+		for (int i = 0; secondaryBits > 0 && i < BLOCK_TEXELS; i++)
+		{
+			secondary[i] = reader.Read(i == 0 ? secondaryBits - 1 : secondaryBits);
+		}
+		const bool bSwapIndices = indexMode == 1;
+		const uint32_t* colorIndices = mode == 6 || !bSwapIndices ? primary : secondary;
+		const uint32_t* alphaIndices = mode == 6 ? primary : bSwapIndices ? primary : secondary;
+		const int* colorWeights = GetBc7Weights(mode == 6 ? 4 : bSwapIndices ? secondaryBits : primaryBits);
+		const int* alphaWeights = GetBc7Weights(mode == 6 ? 4 : bSwapIndices ? primaryBits : secondaryBits);
+
+		for (int i = 0; i < BLOCK_TEXELS; i++)
+		{
+			uint8_t* texel = texels + i * 4;
+			for (int c = 0; c < 3; c++)
+			{
+				texel[c] = static_cast<uint8_t>(InterpolateBc7(colors[0][c], colors[1][c], colorWeights[colorIndices[i]]));
+			}
+			texel[3] = static_cast<uint8_t>(InterpolateBc7(colors[0][3], colors[1][3], alphaWeights[alphaIndices[i]]));
+			// rotation 1, 2 and 3 swap alpha with red, green and blue
+			if (rotation != 0)
+			{
+				std::swap(texel[3], texel[rotation - 1]);
+			}
+		}
+		return true;
+	}
+
+	const char* LitBlockCompression::GetFormatName(Format format)
+	{
+		switch (format)
+		{
+		case Format::BC1: return "bc1";
+		case Format::BC3: return "bc3";
+		case Format::BC5: return "bc5";
+		case Format::BC7: return "bc7";
+		}
+		return "unknown";
+	}
+
+	bool LitBlockCompression::ParseFormat(const std::string& name, Format& format)
+	{
+		for (Format candidate : { Format::BC1, Format::BC3, Format::BC5, Format::BC7 })
+		{
+			if (name == GetFormatName(candidate))
+			{
+				format = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	VkFormat LitBlockCompression::GetVkFormat(Format format, bool bSrgb)
+	{
+		switch (format)
+		{
+		case Format::BC1: return bSrgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case Format::BC3: return bSrgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+		case Format::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case Format::BC7: return bSrgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		}
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	bool LitBlockCompression::GetFormat(VkFormat vkFormat, Format& format)
+	{
+		switch (vkFormat)
+		{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			format = Format::BC1;
+			return true;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+			format = Format::BC3;
+			return true;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			format = Format::BC5;
+			return true;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			format = Format::BC7;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	uint32_t LitBlockCompression::GetBlockBytes(Format format)
+	{
+		return format == Format::BC1 ? 8 : 16;
+	}
+
+	void LitBlockCompression::EncodeBlock(Format format, const uint8_t* texels, uint8_t* block)
+	{
+		BlockTexels blockTexels;
+		LoadTexels(texels, blockTexels);
+		switch (format)
+		{
+		case Format::BC1:
+			EncodeColorBlock(blockTexels, block);
+			break;
+		case Format::BC3:
+			EncodeChannelBlock(blockTexels, 3, block);
+			EncodeColorBlock(blockTexels, block + 8);
+			break;
+		case Format::BC5:
+			EncodeChannelBlock(blockTexels, 0, block);
+			EncodeChannelBlock(blockTexels, 1, block + 8);
+			break;
+		case Format::BC7:
+			EncodeMode6Block(blockTexels, block);
+			break;
+		}
+	}
+
+	bool LitBlockCompression::DecodeBlock(Format format, const uint8_t* block, uint8_t* texels)
+	{
+		switch (format)
+		{
+		case Format::BC1:
+			DecodeColorBlock(block, texels, false);
+			return true;
+		case Format::BC3:
+			DecodeColorBlock(block + 8, texels, true);
+			DecodeChannelBlock(block, texels, 3);
+			return true;
+		case Format::BC5:
+			for (int i = 0; i < BLOCK_TEXELS; i++)
+			{
+				texels[i * 4 + 2] = 0;
+				texels[i * 4 + 3] = 255;
+			}
+			DecodeChannelBlock(block, texels, 0);
+			DecodeChannelBlock(block + 8, texels, 1);
+			return true;
+		case Format::BC7:
+			return DecodeBc7Block(block, texels);
+		}
+		return false;
+	}
+
+	void LitBlockCompression::Compress(const LitImageData& source, Format format, LitImageData& compressed)
+	{
+		if (source.format != VK_FORMAT_R8G8B8A8_UNORM && source.format != VK_FORMAT_R8G8B8A8_SRGB)
+		{
+			throw std::runtime_error("failed to compress image, it isn't RGBA8!");
+		}
+		compressed.format = GetVkFormat(format, LitImage::IsSrgb(source.format));
+		compressed.width = source.width;
+		compressed.height = source.height;
+		compressed.levels.clear();
+		compressed.data.clear();
+		const uint32_t blockBytes = GetBlockBytes(format);
+		for (size_t l = 0; l < source.levels.size(); l++)
+		{
+			const LitImageData::Level& sourceLevel = source.levels[l];
+			LitImageData::Level level = sourceLevel;
+			level.offset = compressed.data.size();
+			level.size = LitImage::GetLevelSize(compressed.format, level.width, level.height);
+			compressed.data.resize(level.offset + level.size);
+			compressed.levels.push_back(level);
+
+			const uint8_t* sourceTexels = source.GetLevelData(l);
+			uint8_t* block = compressed.GetLevelData(l);
+			for (uint32_t by = 0; by < level.height; by += 4)
+			{
+				for (uint32_t bx = 0; bx < level.width; bx += 4, block += blockBytes)
+				{
+					uint8_t texels[BLOCK_TEXELS * 4];
+					for (uint32_t y = 0; y < 4; y++)
+					{
+						const uint32_t sourceY = std::min(by + y, level.height - 1);
+						for (uint32_t x = 0; x < 4; x++)
+						{
+							const uint32_t sourceX = std::min(bx + x, level.width - 1);
+							std::memcpy(&texels[(y * 4 + x) * 4], sourceTexels + (static_cast<size_t>(sourceY) * level.width + sourceX) * 4, 4);
+						}
+					}
+					EncodeBlock(format, texels, block);
+				}
+			}
+		}
+	}
+
+	bool LitBlockCompression::Decompress(const LitImageData& compressed, LitImageData& decompressed, std::string& error)
+	{
+		Format format;
+		if (!GetFormat(compressed.format, format))
+		{
+			error = "not block compressed";
+			return false;
+		}
+		decompressed.format = LitImage::IsSrgb(compressed.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		decompressed.width = compressed.width;
+		decompressed.height = compressed.height;
+		decompressed.levels.clear();
+		decompressed.data.clear();
+		const uint32_t blockBytes = GetBlockBytes(format);
+		for (size_t l = 0; l < compressed.levels.size(); l++)
+		{
+			LitImageData::Level level = compressed.levels[l];
+			level.offset = decompressed.data.size();
+			level.size = LitImage::GetLevelSize(decompressed.format, level.width, level.height);
+			decompressed.data.resize(level.offset + level.size);
+			decompressed.levels.push_back(level);
+
+			const uint8_t* block = compressed.GetLevelData(l);
+			uint8_t* texels = decompressed.GetLevelData(l);
+			for (uint32_t by = 0; by < level.height; by += 4)
+			{
+				for (uint32_t bx = 0; bx < level.width; bx += 4, block += blockBytes)
+				{
+					uint8_t blockTexels[BLOCK_TEXELS * 4];
+					if (!DecodeBlock(format, block, blockTexels))
+					{
+						error = "unsupported BC7 mode in level " + std::to_string(l);
+						return false;
+					}
+					// only the texels inside the level
+					for (uint32_t y = 0; y < 4 && by + y < level.height; y++)
+					{
+						const uint32_t width = std::min(4u, level.width - bx);
+						std::memcpy(texels + (static_cast<size_t>(by + y) * level.width + bx) * 4, &blockTexels[y * 16], width * 4);
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "LitImage.h"
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace Lit
+{
+	// CPU encoders and decoders of the BC formats, for cooking textures offline and for devices that can't sample
+	// them. BC1 is opaque color, BC3 color with alpha, BC5 two channels for normal maps. The BC7 encoder only writes
+	// mode 6, one subset with 7 bit endpoints and 4 bit indices, and the decoder reads the single subset modes 4, 5
+	// and 6; the partitioned modes need the partition tables and a far slower encoder to pay off
+	class LitBlockCompression
+	{
+	public:
+		enum class Format
+		{
+			BC1,
+			BC3,
+			BC5,
+			BC7,
+		};
+
+		static const char* GetFormatName(Format format);
+		static bool ParseFormat(const std::string& name, Format& format);
+		// BC5 has no sRGB variant, its channels are data
+		static VkFormat GetVkFormat(Format format, bool bSrgb);
+		// false for formats that aren't BC
+		static bool GetFormat(VkFormat vkFormat, Format& format);
+		static uint32_t GetBlockBytes(Format format);
+
+		// 16 RGBA8 texels, row by row, to one block
+		static void EncodeBlock(Format format, const uint8_t* texels, uint8_t* block);
+		// false for a BC7 block in a mode other than 4, 5 and 6
+		static bool DecodeBlock(Format format, const uint8_t* block, uint8_t* texels);
+
+		// every level of an RGBA8 image. Blocks over the edge of a level repeat its last row and column
+		static void Compress(const LitImageData& source, Format format, LitImageData& compressed);
+		// to RGBA8 with the same levels. BC5 decodes to red and green with blue 0 and alpha 255, as the GPU samples it
+		static bool Decompress(const LitImageData& compressed, LitImageData& decompressed, std::string& error);
+	};
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <limits>
+
+namespace Lit
+{
+	struct LitSphere
+	{
+		glm::vec3 center{ 0.0f };
+		float radius = 0.0f;
+	};
+
+	// axis aligned bounding box, starts out empty (min > max) so the first Expand sets it
+	struct LitAABB
+	{
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+		bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+		glm::vec3 Center() const { return (min + max) * 0.5f; }
+		glm::vec3 Extent() const { return max - min; }
+		LitSphere BoundingSphere() const { return LitSphere{ Center(), glm::length(Extent()) * 0.5f }; }
+
+		void Expand(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+		void Expand(const LitAABB& other)
+		{
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+
+		bool Contains(const LitAABB& other) const
+		{
+			return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+				max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+		}
+		bool Overlaps(const LitAABB& other) const
+		{
+			return min.x <= other.max.x && min.y <= other.max.y && min.z <= other.max.z &&
+				max.x >= other.min.x && max.y >= other.min.y && max.z >= other.min.z;
+		}
+		float SurfaceArea() const
+		{
+			const glm::vec3 extent = Extent();
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+
+		// box around the transformed box (Arvo), looser than the transformed corners would be for rotations
+		LitAABB Transform(const glm::mat4& matrix) const
+		{
+			const glm::vec3 center = glm::vec3(matrix * glm::vec4(Center(), 1.0f));
+			const glm::vec3 halfExtent = Extent() * 0.5f;
+			const glm::mat3 absMatrix{ glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])) };
+			const glm::vec3 newHalfExtent = absMatrix * halfExtent;
+			LitAABB result;
+			result.min = center - newHalfExtent;
+			result.max = center + newHalfExtent;
+			return result;
+		}
+	};
+
+	// direction doesn't have to be normalized, distances are then in units of its length
+	struct LitRay
+	{
+		glm::vec3 origin{ 0.0f };
+		glm::vec3 direction{ 0.0f, 0.0f, 1.0f };
+		glm::vec3 inverseDirection{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), 1.0f };
+
+		LitRay() = default;
+		LitRay(const glm::vec3& inOrigin, const glm::vec3& inDirection)
+			: origin{ inOrigin }, direction{ inDirection }, inverseDirection{ 1.0f / inDirection }
+		{
+		}
+
+		glm::vec3 At(float distance) const { return origin + direction * distance; }
+
+		// slab test, distance receives where the ray enters the box (0 when it starts inside)
+		bool Intersects(const LitAABB& box, float maxDistance, float& distance) const
+		{
+			const glm::vec3 t0 = (box.min - origin) * inverseDirection;
+			const glm::vec3 t1 = (box.max - origin) * inverseDirection;
+			const glm::vec3 tNear = glm::min(t0, t1);
+			const glm::vec3 tFar = glm::max(t0, t1);
+			const float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+			const float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+			distance = enter;
+			return enter <= exit;
+		}
+	};
+
+	// six planes facing inwards, xyz is the unit normal and w the distance so dot(n, p) + w >= 0 is inside
+	struct LitFrustum
+	{
+		enum Plane { Left, Right, Top, Bottom, Near, Far, PlaneCount };
+		glm::vec4 planes[PlaneCount];
+
+		// Gribb/Hartmann plane extraction, with a 0..1 depth range. Passing projection * view * model gives
+		// the planes in model space
+		static LitFrustum FromMatrix(const glm::mat4& matrix)
+		{
+			const glm::vec4 row0{ matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0] };
+			const glm::vec4 row1{ matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1] };
+			const glm::vec4 row2{ matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2] };
+			const glm::vec4 row3{ matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3] };
+
+			LitFrustum frustum;
+			frustum.planes[Left] = row3 + row0;
+			frustum.planes[Right] = row3 - row0;
+			frustum.planes[Top] = row3 + row1;
+			frustum.planes[Bottom] = row3 - row1;
+			frustum.planes[Near] = row2;
+			frustum.planes[Far] = row3 - row2;
+			for (auto& plane : frustum.planes)
+			{
+				plane /= glm::length(glm::vec3(plane));
+			}
+			return frustum;
+		}
+
+		bool Intersects(const LitSphere& sphere) const
+		{
+			for (const auto& plane : planes)
+			{
+				if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool Intersects(const LitAABB& box) const
+		{
+			for (const auto& plane : planes)
+			{
+				// corner furthest along the plane normal
+				const glm::vec3 corner{
+					plane.x >= 0.0f ? box.max.x : box.min.x,
+					plane.y >= 0.0f ? box.max.y : box.min.y,
+					plane.z >= 0.0f ? box.max.z : box.min.z };
+				if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+}
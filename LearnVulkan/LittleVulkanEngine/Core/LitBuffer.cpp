@@ -26,20 +26,29 @@ namespace Lit
 
 	LitBuffer::LitBuffer(LitDevice& device, VkDeviceSize& instanceSize, 
 		uint32_t instanceCount, VkBufferUsageFlags usageFlags, 
-		VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment /* = 1 */)
+		VkMemoryPropertyFlags memoryPropertyFlags, MemoryCategory category, VkDeviceSize minOffsetAlignment /* = 1 */)
 		:litDevice(device), instanceSize(instanceSize),instanceCount(instanceCount),
 		usageFlags(usageFlags), memoryPropertyFlags(memoryPropertyFlags)
 	{
 		alignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
 		bufferSize = alignmentSize * instanceCount;
-		device.CreateBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, memory);
+		VkMemoryPropertyFlags allocatedProperties = 0;
+		device.CreateBuffer(bufferSize, usageFlags, memoryPropertyFlags, category, buffer, memory, &allocatedProperties);
+		bIsHostCoherent = (allocatedProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
 	}
 
 	LitBuffer::~LitBuffer()
 	{
 		UnMap();
-		vkDestroyBuffer(litDevice.GetDevice(), buffer, nullptr);
-		vkFreeMemory(litDevice.GetDevice(), memory, nullptr);
+		// frames in flight may still read the buffer
+		LitDevice* device = &litDevice;
+		VkBuffer oldBuffer = buffer;
+		VkDeviceMemory oldMemory = memory;
+		litDevice.GetDeletionQueue().Push([device, oldBuffer, oldMemory]()
+			{
+				vkDestroyBuffer(device->GetDevice(), oldBuffer, nullptr);
+				device->FreeMemory(oldMemory);
+			});
 	}
 
 	/**
@@ -99,10 +108,39 @@ namespace Lit
 		}
 	}
 
+	/**
+	 * Expands a memory range to nonCoherentAtomSize boundaries, as required for flush and invalidate
+	 *
+	 * @param size Size of the memory range. VK_WHOLE_SIZE is kept as is.
+	 * @param offset Byte offset from beginning
+	 *
+	 * @return VkMappedMemoryRange covering at least the requested range
+	 */
+	VkMappedMemoryRange LitBuffer::GetAtomAlignedRange(VkDeviceSize size, VkDeviceSize offset)
+	{
+		const VkDeviceSize atomSize = litDevice.GetNonCoherentAtomSize();
+
+		VkMappedMemoryRange mappedRange = {};
+		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedRange.memory = memory;
+		mappedRange.offset = (offset / atomSize) * atomSize;
+		mappedRange.size = VK_WHOLE_SIZE;
+		if (size != VK_WHOLE_SIZE)
+		{
+			VkDeviceSize end = ((offset + size + atomSize - 1) / atomSize) * atomSize;
+			// the end of the allocation is always a valid end, even when not atom aligned
+			if (end < bufferSize)
+			{
+				mappedRange.size = end - mappedRange.offset;
+			}
+		}
+		return mappedRange;
+	}
+
 	/**
 	 * Flush a memory range of the buffer to make it visible to the device
 	 *
-	 * @note Only required for non-coherent memory
+	 * @note Only required for non-coherent memory, does nothing for coherent memory
 	 *
 	 * @param size (Optional) Size of the memory range to flush. Pass VK_WHOLE_SIZE to flush the
 	 * complete buffer range.
@@ -112,18 +150,38 @@ namespace Lit
 	 */
 	VkResult LitBuffer::Flush(VkDeviceSize size, VkDeviceSize offset)
 	{
-		VkMappedMemoryRange mappedRange = {};
-		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-		mappedRange.memory = memory;
-		mappedRange.offset = offset;
-		mappedRange.size = size;
+		if (bIsHostCoherent)
+		{
+			return VK_SUCCESS;
+		}
+		VkMappedMemoryRange mappedRange = GetAtomAlignedRange(size, offset);
 		return vkFlushMappedMemoryRanges(litDevice.GetDevice(), 1, &mappedRange);
 	}
 
+	/**
+	 * Queue a memory range of the buffer to be flushed with all other dirty ranges of the frame
+	 *
+	 * @note Only required for non-coherent memory, does nothing for coherent memory. The ranges are
+	 * flushed by LitDevice::FlushMappedMemoryRanges, which the renderer calls before submitting the frame.
+	 *
+	 * @param size (Optional) Size of the memory range to flush. Pass VK_WHOLE_SIZE to flush the
+	 * complete buffer range.
+	 * @param offset (Optional) Byte offset from beginning
+	 */
+	void LitBuffer::QueueFlush(VkDeviceSize size, VkDeviceSize offset)
+	{
+		if (bIsHostCoherent)
+		{
+			return;
+		}
+		VkMappedMemoryRange mappedRange = GetAtomAlignedRange(size, offset);
+		litDevice.QueueMappedMemoryFlush(mappedRange.memory, mappedRange.offset, mappedRange.size);
+	}
+
 	/**
 	 * Invalidate a memory range of the buffer to make it visible to the host
 	 *
-	 * @note Only required for non-coherent memory
+	 * @note Only required for non-coherent memory, does nothing for coherent memory
 	 *
 	 * @param size (Optional) Size of the memory range to invalidate. Pass VK_WHOLE_SIZE to invalidate
 	 * the complete buffer range.
@@ -133,11 +191,11 @@ namespace Lit
 	 */
 	VkResult LitBuffer::Invalidate(VkDeviceSize size, VkDeviceSize offset) 
 	{
-		VkMappedMemoryRange mappedRange = {};
-		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-		mappedRange.memory = memory;
-		mappedRange.offset = offset;
-		mappedRange.size = size;
+		if (bIsHostCoherent)
+		{
+			return VK_SUCCESS;
+		}
+		VkMappedMemoryRange mappedRange = GetAtomAlignedRange(size, offset);
 		return vkInvalidateMappedMemoryRanges(litDevice.GetDevice(), 1, &mappedRange);
 	}
 
@@ -165,6 +223,8 @@ namespace Lit
 
 	VkResult LitBuffer::FlushIndex(int index) { return Flush(alignmentSize, index * alignmentSize); }
 
+	void LitBuffer::QueueFlushIndex(int index) { QueueFlush(alignmentSize, index * alignmentSize); }
+
 	VkDescriptorBufferInfo LitBuffer::DescriptorInfoForIndex(int index)
 	{
 		return DescriptorInfo(alignmentSize, index * alignmentSize);
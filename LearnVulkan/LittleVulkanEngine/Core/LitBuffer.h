@@ -7,7 +7,7 @@ namespace Lit
 	{
 	public:
 		LitBuffer(LitDevice& device, VkDeviceSize& instanceSize, uint32_t instanceCount, VkBufferUsageFlags usageFlags,
-			VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize minOffsetAlignment = 1);
+			VkMemoryPropertyFlags memoryPropertyFlags, MemoryCategory category, VkDeviceSize minOffsetAlignment = 1);
 
 		~LitBuffer();
 
@@ -19,15 +19,18 @@ namespace Lit
 
 		void WriteToBuffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 		VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		void QueueFlush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 		VkResult Invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
 		void WriteToIndex(void* data, int index);
 		VkResult FlushIndex(int index);
+		void QueueFlushIndex(int index);
 		VkDescriptorBufferInfo DescriptorInfoForIndex(int index);
 		VkResult InvalidateIndex(int index);
 
 		VkBuffer GetBuffer() const { return buffer; }
+		VkDeviceMemory GetMemory() const { return memory; }
 		void* GetMappedMemory() const { return mapped; }
 		uint32_t GetInstanceCount() const { return instanceCount; }
 		VkDeviceSize GetInstanceSize() const { return instanceSize; }
@@ -36,9 +39,11 @@ namespace Lit
 
 		VkMemoryPropertyFlags GetMemoryPropertyFlags() const { return memoryPropertyFlags; }
 		VkDeviceSize GetBufferSize() const { return bufferSize; }
+		bool IsHostCoherent() const { return bIsHostCoherent; }
 
 	private:
 		static VkDeviceSize GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+		VkMappedMemoryRange GetAtomAlignedRange(VkDeviceSize size, VkDeviceSize offset);
 
 
 		LitDevice& litDevice;
@@ -52,5 +57,6 @@ namespace Lit
 		VkDeviceSize alignmentSize;
 		VkBufferUsageFlags usageFlags;
 		VkMemoryPropertyFlags memoryPropertyFlags;
+		bool bIsHostCoherent = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,601 @@
+#include "LitBvh.h"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace Lit
+{
+	static const uint32_t SAH_BIN_COUNT = 16;
+	static const uint32_t ALL_PLANES_MASK = (1u << LitFrustum::PlaneCount) - 1;
+
+	static LitAABB Union(const LitAABB& a, const LitAABB& b)
+	{
+		LitAABB result = a;
+		result.Expand(b);
+		return result;
+	}
+
+	static bool operator==(const LitAABB& a, const LitAABB& b)
+	{
+		return a.min == b.min && a.max == b.max;
+	}
+
+	LitBvh::LitBvh(float inMargin) : margin{ inMargin }
+	{
+	}
+
+	uint32_t LitBvh::AllocateNode()
+	{
+		if (freeList == NULL_NODE)
+		{
+			nodes.emplace_back();
+			nodes.back().height = 0;
+			return static_cast<uint32_t>(nodes.size() - 1);
+		}
+
+		const uint32_t node = freeList;
+		freeList = nodes[node].parent;
+		nodes[node] = Node{};
+		nodes[node].height = 0;
+		return node;
+	}
+
+	void LitBvh::FreeNode(uint32_t node)
+	{
+		nodes[node].parent = freeList;
+		nodes[node].height = -1;
+		freeList = node;
+	}
+
+	LitBvh::ProxyId LitBvh::Insert(const LitAABB& bounds, uint32_t userData)
+	{
+		const uint32_t leaf = AllocateNode();
+		nodes[leaf].bounds.min = bounds.min - glm::vec3(margin);
+		nodes[leaf].bounds.max = bounds.max + glm::vec3(margin);
+		nodes[leaf].userData = userData;
+		InsertLeaf(leaf);
+		proxyCount++;
+		return leaf;
+	}
+
+	void LitBvh::Remove(ProxyId proxy)
+	{
+		assert(proxy < nodes.size() && nodes[proxy].IsLeaf() && nodes[proxy].height == 0 && "Invalid bvh proxy");
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		proxyCount--;
+	}
+
+	bool LitBvh::Update(ProxyId proxy, const LitAABB& bounds)
+	{
+		assert(proxy < nodes.size() && nodes[proxy].IsLeaf() && nodes[proxy].height == 0 && "Invalid bvh proxy");
+		Node& leaf = nodes[proxy];
+		if (leaf.bounds.Contains(bounds))
+		{
+			return false;
+		}
+
+		leaf.bounds.min = bounds.min - glm::vec3(margin);
+		leaf.bounds.max = bounds.max + glm::vec3(margin);
+
+		// refit only, the ancestors may grow or shrink but keep their children
+		for (uint32_t node = leaf.parent; node != NULL_NODE; node = nodes[node].parent)
+		{
+			const LitAABB refitted = Union(nodes[nodes[node].children[0]].bounds, nodes[nodes[node].children[1]].bounds);
+			if (refitted == nodes[node].bounds)
+			{
+				break;
+			}
+			nodes[node].bounds = refitted;
+		}
+		return true;
+	}
+
+	void LitBvh::Clear()
+	{
+		nodes.clear();
+		root = NULL_NODE;
+		freeList = NULL_NODE;
+		proxyCount = 0;
+		rebuildSahCost = 0.0f;
+	}
+
+	uint32_t LitBvh::GetHeight() const
+	{
+		return root == NULL_NODE ? 0 : static_cast<uint32_t>(nodes[root].height);
+	}
+
+	float LitBvh::GetSahCost() const
+	{
+		if (root == NULL_NODE)
+		{
+			return 0.0f;
+		}
+
+		float internalArea = 0.0f;
+		for (const auto& node : nodes)
+		{
+			if (node.height > 0)
+			{
+				internalArea += node.bounds.SurfaceArea();
+			}
+		}
+		const float rootArea = nodes[root].bounds.SurfaceArea();
+		return rootArea > 0.0f ? internalArea / rootArea : 0.0f;
+	}
+
+	void LitBvh::InsertLeaf(uint32_t leaf)
+	{
+		if (root == NULL_NODE)
+		{
+			root = leaf;
+			nodes[root].parent = NULL_NODE;
+			return;
+		}
+
+		// descend to the sibling that adds the least surface area, counting the growth of every ancestor on the way
+		const LitAABB leafBounds = nodes[leaf].bounds;
+		uint32_t index = root;
+		while (!nodes[index].IsLeaf())
+		{
+			const Node& node = nodes[index];
+			const float area = node.bounds.SurfaceArea();
+			const float combinedArea = Union(node.bounds, leafBounds).SurfaceArea();
+
+			// pairing with this node creates a parent of combinedArea, going further down grows this node
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			float childCosts[2];
+			for (int i = 0; i < 2; i++)
+			{
+				const Node& child = nodes[node.children[i]];
+				const float unionArea = Union(leafBounds, child.bounds).SurfaceArea();
+				childCosts[i] = (child.IsLeaf() ? unionArea : unionArea - child.bounds.SurfaceArea()) + inheritanceCost;
+			}
+
+			if (cost < childCosts[0] && cost < childCosts[1])
+			{
+				break;
+			}
+			index = childCosts[0] < childCosts[1] ? node.children[0] : node.children[1];
+		}
+
+		const uint32_t sibling = index;
+		const uint32_t oldParent = nodes[sibling].parent;
+		const uint32_t newParent = AllocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].bounds = Union(leafBounds, nodes[sibling].bounds);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].children[0] = sibling;
+		nodes[newParent].children[1] = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent == NULL_NODE)
+		{
+			root = newParent;
+		}
+		else
+		{
+			Node& parent = nodes[oldParent];
+			parent.children[parent.children[0] == sibling ? 0 : 1] = newParent;
+		}
+
+		FixUpwards(nodes[leaf].parent);
+	}
+
+	void LitBvh::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == root)
+		{
+			root = NULL_NODE;
+			return;
+		}
+
+		const uint32_t parent = nodes[leaf].parent;
+		const uint32_t grandParent = nodes[parent].parent;
+		const uint32_t sibling = nodes[parent].children[0] == leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+		// the sibling takes the place of the parent
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		if (grandParent == NULL_NODE)
+		{
+			root = sibling;
+			return;
+		}
+
+		Node& node = nodes[grandParent];
+		node.children[node.children[0] == parent ? 0 : 1] = sibling;
+		FixUpwards(grandParent);
+	}
+
+	void LitBvh::FixUpwards(uint32_t index)
+	{
+		while (index != NULL_NODE)
+		{
+			index = Balance(index);
+
+			Node& node = nodes[index];
+			const Node& child0 = nodes[node.children[0]];
+			const Node& child1 = nodes[node.children[1]];
+			node.height = 1 + std::max(child0.height, child1.height);
+			node.bounds = Union(child0.bounds, child1.bounds);
+			index = node.parent;
+		}
+	}
+
+	// rotates the taller grandchild up when the children heights differ by more than one, returns the node
+	// now at the position of a
+	uint32_t LitBvh::Balance(uint32_t a)
+	{
+		Node& nodeA = nodes[a];
+		if (nodeA.IsLeaf() || nodeA.height < 2)
+		{
+			return a;
+		}
+
+		const int32_t balance = nodes[nodeA.children[1]].height - nodes[nodeA.children[0]].height;
+		if (balance >= -1 && balance <= 1)
+		{
+			return a;
+		}
+
+		// b is the taller child that moves up, c stays below a
+		const int upSide = balance > 1 ? 1 : 0;
+		const uint32_t b = nodeA.children[upSide];
+		const uint32_t c = nodeA.children[1 - upSide];
+		Node& nodeB = nodes[b];
+		const uint32_t f = nodeB.children[0];
+		const uint32_t g = nodeB.children[1];
+
+		// b takes a's place
+		nodeB.children[0] = a;
+		nodeB.parent = nodeA.parent;
+		nodeA.parent = b;
+		if (nodeB.parent == NULL_NODE)
+		{
+			root = b;
+		}
+		else
+		{
+			Node& parent = nodes[nodeB.parent];
+			parent.children[parent.children[0] == a ? 0 : 1] = b;
+		}
+
+		// the taller grandchild stays with b, the other one replaces b below a
+		const bool bKeepF = nodes[f].height > nodes[g].height;
+		const uint32_t keep = bKeepF ? f : g;
+		const uint32_t move = bKeepF ? g : f;
+		nodeB.children[1] = keep;
+		nodeA.children[upSide] = move;
+		nodes[move].parent = a;
+
+		nodeA.bounds = Union(nodes[c].bounds, nodes[move].bounds);
+		nodeA.height = 1 + std::max(nodes[c].height, nodes[move].height);
+		nodeB.bounds = Union(nodeA.bounds, nodes[keep].bounds);
+		nodeB.height = 1 + std::max(nodeA.height, nodes[keep].height);
+		return b;
+	}
+
+	void LitBvh::Rebuild()
+	{
+		// keep the leaves so the proxy ids survive, every internal node is recreated
+		std::vector<uint32_t> leaves;
+		leaves.reserve(proxyCount);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(nodes.size()); i++)
+		{
+			if (nodes[i].height == 0 && nodes[i].IsLeaf())
+			{
+				leaves.push_back(i);
+			}
+			else if (nodes[i].height > 0)
+			{
+				FreeNode(i);
+			}
+		}
+
+		root = leaves.empty() ? NULL_NODE : BuildSah(leaves.data(), static_cast<uint32_t>(leaves.size()));
+		if (root != NULL_NODE)
+		{
+			nodes[root].parent = NULL_NODE;
+		}
+		rebuildSahCost = GetSahCost();
+	}
+
+	uint32_t LitBvh::BuildSah(uint32_t* leaves, uint32_t count)
+	{
+		if (count == 1)
+		{
+			return leaves[0];
+		}
+
+		LitAABB centroidBounds;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			centroidBounds.Expand(nodes[leaves[i]].bounds.Center());
+		}
+
+		// evaluate SAH_BIN_COUNT - 1 split planes per axis, cost is area * count on both sides
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		const glm::vec3 centroidExtent = centroidBounds.Extent();
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (centroidExtent[axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			LitAABB binBounds[SAH_BIN_COUNT];
+			uint32_t binCounts[SAH_BIN_COUNT] = {};
+			const float binScale = SAH_BIN_COUNT / centroidExtent[axis];
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const LitAABB& bounds = nodes[leaves[i]].bounds;
+				const uint32_t bin = std::min(static_cast<uint32_t>((bounds.Center()[axis] - centroidBounds.min[axis]) * binScale), SAH_BIN_COUNT - 1);
+				binBounds[bin].Expand(bounds);
+				binCounts[bin]++;
+			}
+
+			// sweep from the right to get the cost of everything after each plane
+			float rightCosts[SAH_BIN_COUNT];
+			LitAABB rightBounds;
+			uint32_t rightCount = 0;
+			for (uint32_t bin = SAH_BIN_COUNT - 1; bin > 0; bin--)
+			{
+				rightBounds.Expand(binBounds[bin]);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = rightCount > 0 ? rightBounds.SurfaceArea() * rightCount : 0.0f;
+			}
+
+			LitAABB leftBounds;
+			uint32_t leftCount = 0;
+			for (uint32_t split = 1; split < SAH_BIN_COUNT; split++)
+			{
+				leftBounds.Expand(binBounds[split - 1]);
+				leftCount += binCounts[split - 1];
+				if (leftCount == 0 || leftCount == count)
+				{
+					continue;
+				}
+				const float cost = leftBounds.SurfaceArea() * leftCount + rightCosts[split];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		uint32_t middle = count / 2;
+		if (bestAxis >= 0)
+		{
+			const float binScale = SAH_BIN_COUNT / centroidExtent[bestAxis];
+			const float splitMin = centroidBounds.min[bestAxis];
+			uint32_t* partition = std::partition(leaves, leaves + count, [&](uint32_t leaf)
+				{
+					const float center = nodes[leaf].bounds.Center()[bestAxis];
+					return std::min(static_cast<uint32_t>((center - splitMin) * binScale), SAH_BIN_COUNT - 1) < bestSplit;
+				});
+			middle = static_cast<uint32_t>(partition - leaves);
+		}
+		if (middle == 0 || middle == count)
+		{
+			// every centroid in the same place, any split is as good as another
+			middle = count / 2;
+		}
+
+		const uint32_t left = BuildSah(leaves, middle);
+		const uint32_t right = BuildSah(leaves + middle, count - middle);
+		const uint32_t node = AllocateNode();
+		nodes[node].children[0] = left;
+		nodes[node].children[1] = right;
+		nodes[node].bounds = Union(nodes[left].bounds, nodes[right].bounds);
+		nodes[node].height = 1 + std::max(nodes[left].height, nodes[right].height);
+		nodes[left].parent = node;
+		nodes[right].parent = node;
+		return node;
+	}
+
+	void LitBvh::QueryFrustum(const LitFrustum& frustum, std::vector<uint32_t>& results) const
+	{
+		std::vector<uint64_t> stack;
+		QueryFrustum(frustum, results, stack);
+	}
+
+	void LitBvh::QueryRange(const LitAABB& range, std::vector<uint32_t>& results) const
+	{
+		std::vector<uint32_t> stack;
+		QueryRange(range, results, stack);
+	}
+
+	LitBvh::RayHit LitBvh::Raycast(const LitRay& ray, float maxDistance, const RayCallback& callback) const
+	{
+		std::vector<uint32_t> stack;
+		return Raycast(ray, maxDistance, callback, stack);
+	}
+
+	void LitBvh::QueryFrustums(const LitFrustum* frustums, size_t count,
+		std::vector<uint32_t>& results, std::vector<uint32_t>& offsets) const
+	{
+		std::vector<uint64_t> stack;
+		offsets.resize(count + 1);
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[i] = static_cast<uint32_t>(results.size());
+			QueryFrustum(frustums[i], results, stack);
+		}
+		offsets[count] = static_cast<uint32_t>(results.size());
+	}
+
+	void LitBvh::QueryRanges(const LitAABB* ranges, size_t count,
+		std::vector<uint32_t>& results, std::vector<uint32_t>& offsets) const
+	{
+		std::vector<uint32_t> stack;
+		offsets.resize(count + 1);
+		for (size_t i = 0; i < count; i++)
+		{
+			offsets[i] = static_cast<uint32_t>(results.size());
+			QueryRange(ranges[i], results, stack);
+		}
+		offsets[count] = static_cast<uint32_t>(results.size());
+	}
+
+	void LitBvh::Raycasts(const LitRay* rays, size_t count, float maxDistance, RayHit* hits, const RayCallback& callback) const
+	{
+		std::vector<uint32_t> stack;
+		for (size_t i = 0; i < count; i++)
+		{
+			hits[i] = Raycast(rays[i], maxDistance, callback, stack);
+		}
+	}
+
+	void LitBvh::QueryFrustum(const LitFrustum& frustum, std::vector<uint32_t>& results, std::vector<uint64_t>& stack) const
+	{
+		if (root == NULL_NODE)
+		{
+			return;
+		}
+
+		// each entry carries the planes its box still straddles, a box inside a plane skips it for the whole
+		// subtree and a box inside all of them adds its leaves without further tests
+		stack.clear();
+		stack.push_back(static_cast<uint64_t>(ALL_PLANES_MASK) << 32 | root);
+		while (!stack.empty())
+		{
+			const uint32_t index = static_cast<uint32_t>(stack.back());
+			uint32_t planeMask = static_cast<uint32_t>(stack.back() >> 32);
+			stack.pop_back();
+			const Node& node = nodes[index];
+
+			bool bOutside = false;
+			for (uint32_t plane = 0; plane < LitFrustum::PlaneCount && !bOutside; plane++)
+			{
+				if ((planeMask & (1u << plane)) == 0)
+				{
+					continue;
+				}
+
+				const glm::vec4& p = frustum.planes[plane];
+				const glm::vec3 positive{
+					p.x >= 0.0f ? node.bounds.max.x : node.bounds.min.x,
+					p.y >= 0.0f ? node.bounds.max.y : node.bounds.min.y,
+					p.z >= 0.0f ? node.bounds.max.z : node.bounds.min.z };
+				const glm::vec3 negative{
+					p.x >= 0.0f ? node.bounds.min.x : node.bounds.max.x,
+					p.y >= 0.0f ? node.bounds.min.y : node.bounds.max.y,
+					p.z >= 0.0f ? node.bounds.min.z : node.bounds.max.z };
+				if (glm::dot(glm::vec3(p), positive) + p.w < 0.0f)
+				{
+					bOutside = true;
+				}
+				else if (glm::dot(glm::vec3(p), negative) + p.w >= 0.0f)
+				{
+					planeMask &= ~(1u << plane);
+				}
+			}
+			if (bOutside)
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				results.push_back(node.userData);
+				continue;
+			}
+			stack.push_back(static_cast<uint64_t>(planeMask) << 32 | node.children[0]);
+			stack.push_back(static_cast<uint64_t>(planeMask) << 32 | node.children[1]);
+		}
+	}
+
+	void LitBvh::QueryRange(const LitAABB& range, std::vector<uint32_t>& results, std::vector<uint32_t>& stack) const
+	{
+		if (root == NULL_NODE)
+		{
+			return;
+		}
+
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.Overlaps(range))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				results.push_back(node.userData);
+				continue;
+			}
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+
+	LitBvh::RayHit LitBvh::Raycast(const LitRay& ray, float maxDistance, const RayCallback& callback, std::vector<uint32_t>& stack) const
+	{
+		RayHit hit{};
+		hit.distance = maxDistance;
+		float entry;
+		if (root == NULL_NODE || !ray.Intersects(nodes[root].bounds, maxDistance, entry))
+		{
+			return hit;
+		}
+
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			// the box may have been pushed before a closer hit shortened the ray
+			if (!ray.Intersects(node.bounds, hit.distance, entry))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (callback == nullptr)
+				{
+					hit.userData = node.userData;
+					hit.distance = entry;
+				}
+				else if (callback(node.userData, ray, entry, hit.distance))
+				{
+					hit.userData = node.userData;
+				}
+				continue;
+			}
+
+			// visit the nearer child first, it is pushed last
+			float distances[2];
+			bool bHits[2];
+			for (int i = 0; i < 2; i++)
+			{
+				bHits[i] = ray.Intersects(nodes[node.children[i]].bounds, hit.distance, distances[i]);
+			}
+			const int nearChild = bHits[0] && (!bHits[1] || distances[0] <= distances[1]) ? 0 : 1;
+			const int farChild = 1 - nearChild;
+			if (bHits[farChild])
+			{
+				stack.push_back(node.children[farChild]);
+			}
+			if (bHits[nearChild])
+			{
+				stack.push_back(node.children[nearChild]);
+			}
+		}
+		return hit;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "LitBounds.h"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Lit
+{
+	// Dynamic bounding volume hierarchy over world space boxes, one leaf per proxy. Inserting walks down to the
+	// cheapest sibling by surface area and keeps the tree AVL balanced with rotations (as Box2D's dynamic tree),
+	// moving a proxy only refits its ancestors and Rebuild redoes the whole tree with a binned SAH build.
+	// Leaves store the box enlarged by a margin so small motions don't touch the tree at all
+	class LitBvh
+	{
+	public:
+		using ProxyId = uint32_t;
+		static constexpr ProxyId NULL_PROXY = UINT32_MAX;
+
+		struct RayHit
+		{
+			uint32_t userData = UINT32_MAX;
+			float distance = 0.0f;
+
+			bool IsHit() const { return userData != UINT32_MAX; }
+		};
+
+		// exact test of a leaf whose box the ray enters at entry: lowers distance and returns true when it found a closer hit
+		using RayCallback = std::function<bool(uint32_t userData, const LitRay& ray, float entry, float& distance)>;
+
+		// margin is added on every side of the boxes given to Insert and Update, in world units
+		explicit LitBvh(float margin = 0.1f);
+
+		ProxyId Insert(const LitAABB& bounds, uint32_t userData);
+		void Remove(ProxyId proxy);
+		// refits the ancestors when bounds left the enlarged box of the leaf, returns whether the tree changed.
+		// The structure stays as it was, call Rebuild once the SAH cost degraded too much
+		bool Update(ProxyId proxy, const LitAABB& bounds);
+		// top down binned SAH build over the current leaves, proxy ids stay valid
+		void Rebuild();
+		void Clear();
+
+		const LitAABB& GetBounds(ProxyId proxy) const { return nodes[proxy].bounds; }
+		uint32_t GetUserData(ProxyId proxy) const { return nodes[proxy].userData; }
+		uint32_t GetProxyCount() const { return proxyCount; }
+		uint32_t GetHeight() const;
+		// sum of the internal node surface areas relative to the root, the expected number of nodes a random ray visits
+		float GetSahCost() const;
+		// GetSahCost right after the last Rebuild, 0 if there was none
+		float GetRebuildSahCost() const { return rebuildSahCost; }
+
+		// results receive the user data of the hits, appended in no particular order
+		void QueryFrustum(const LitFrustum& frustum, std::vector<uint32_t>& results) const;
+		void QueryRange(const LitAABB& range, std::vector<uint32_t>& results) const;
+		// closest leaf along the ray, by its box or by the callback when one is given
+		RayHit Raycast(const LitRay& ray, float maxDistance, const RayCallback& callback = nullptr) const;
+
+		// batched variants sharing one traversal stack, the hits of query i are
+		// results[offsets[i]] .. results[offsets[i + 1]], offsets gets count + 1 entries
+		void QueryFrustums(const LitFrustum* frustums, size_t count,
+			std::vector<uint32_t>& results, std::vector<uint32_t>& offsets) const;
+		void QueryRanges(const LitAABB* ranges, size_t count,
+			std::vector<uint32_t>& results, std::vector<uint32_t>& offsets) const;
+		void Raycasts(const LitRay* rays, size_t count, float maxDistance, RayHit* hits,
+			const RayCallback& callback = nullptr) const;
+
+	private:
+		static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+		struct Node
+		{
+			LitAABB bounds;
+			uint32_t parent = NULL_NODE;	// next free node while on the free list
+			uint32_t children[2] = { NULL_NODE, NULL_NODE };
+			uint32_t userData = 0;
+			int32_t height = -1;			// 0 for leaves, -1 while free
+
+			bool IsLeaf() const { return children[0] == NULL_NODE; }
+		};
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t node);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		// walks from node to the root rebalancing and recomputing bounds and heights
+		void FixUpwards(uint32_t node);
+		uint32_t Balance(uint32_t node);
+		uint32_t BuildSah(uint32_t* leaves, uint32_t count);
+
+		void QueryFrustum(const LitFrustum& frustum, std::vector<uint32_t>& results, std::vector<uint64_t>& stack) const;
+		void QueryRange(const LitAABB& range, std::vector<uint32_t>& results, std::vector<uint32_t>& stack) const;
+		RayHit Raycast(const LitRay& ray, float maxDistance, const RayCallback& callback, std::vector<uint32_t>& stack) const;
+
+		std::vector<Node> nodes;
+		uint32_t root = NULL_NODE;
+		uint32_t freeList = NULL_NODE;
+		uint32_t proxyCount = 0;
+		float margin;
+		float rebuildSahCost = 0.0f;
+	};
+}
@@ -77,4 +77,24 @@ namespace Lit
 		viewMatrix[3][2] = -glm::dot(w, position);
 	}
 
-}
\ No newline at end of file
+	LitRay LitCamera::ScreenPointToRay(const glm::vec2& screenPoint, const glm::vec2& screenSize) const
+	{
+		// the viewport maps ndc y = -1 to the top, like the cursor
+		const glm::vec2 ndc = screenPoint / screenSize * 2.0f - 1.0f;
+		const glm::mat4 inverseProjectionView = glm::inverse(projectionMatrix * viewMatrix);
+		glm::vec4 nearPoint = inverseProjectionView * glm::vec4(ndc, 0.0f, 1.0f);
+		glm::vec4 farPoint = inverseProjectionView * glm::vec4(ndc, 1.0f, 1.0f);
+		nearPoint /= nearPoint.w;
+		farPoint /= farPoint.w;
+		return LitRay{ glm::vec3(nearPoint), glm::normalize(glm::vec3(farPoint - nearPoint)) };
+	}
+
+	glm::vec3 LitCamera::GetPosition() const
+	{
+		// the view matrix is rotation and translation only, so the inverse is the transposed rotation: p = -R^T * t
+		const glm::vec3 u{ viewMatrix[0][0], viewMatrix[1][0], viewMatrix[2][0] };
+		const glm::vec3 v{ viewMatrix[0][1], viewMatrix[1][1], viewMatrix[2][1] };
+		const glm::vec3 w{ viewMatrix[0][2], viewMatrix[1][2], viewMatrix[2][2] };
+		return -(u * viewMatrix[3][0] + v * viewMatrix[3][1] + w * viewMatrix[3][2]);
+	}
+}
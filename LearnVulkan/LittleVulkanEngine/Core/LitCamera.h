@@ -1,4 +1,6 @@
 #pragma once
+#include "LitBounds.h"
+
 // libs
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -15,6 +17,10 @@ namespace Lit
 
 		const glm::mat4& GetProjection() const { return projectionMatrix; }
 		const glm::mat4& GetView() const { return viewMatrix; }
+		glm::vec3 GetPosition() const;
+		// world space ray through a point in screen pixels (origin top left), starting on the near plane.
+		// The direction is normalized so ray distances are world units
+		LitRay ScreenPointToRay(const glm::vec2& screenPoint, const glm::vec2& screenSize) const;
 
 		void SetViewDirection(
 			glm::vec3 position, glm::vec3 direction, glm::vec3 up = glm::vec3{ 0.f, -1.f, 0.f });
@@ -0,0 +1,131 @@
+#include "LitCameraPath.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace Lit
+{
+	static const uint32_t ORBIT_KEYFRAMES = 128;
+	static const float PI = 3.14159265f;
+
+	// the short way around, so a yaw that wrapped from 2 pi to 0 doesn't spin the camera
+	static float LerpAngle(float a, float b, float t)
+	{
+		float delta = std::fmod(b - a, 2.0f * PI);
+		if (delta > PI)
+		{
+			delta -= 2.0f * PI;
+		}
+		else if (delta < -PI)
+		{
+			delta += 2.0f * PI;
+		}
+		return a + delta * t;
+	}
+
+	LitCameraPath LitCameraPath::CreateOrbit(const LitAABB& bounds, float duration, float distance, float height)
+	{
+		LitCameraPath path;
+		const glm::vec3 center = bounds.Center();
+		const float radius = std::max(bounds.BoundingSphere().radius, 0.1f);
+		for (uint32_t i = 0; i <= ORBIT_KEYFRAMES; i++)
+		{
+			const float t = static_cast<float>(i) / static_cast<float>(ORBIT_KEYFRAMES);
+			const float angle = 2.0f * PI * t;
+			// y points down
+			const glm::vec3 position = center + glm::vec3{ std::sin(angle), -height, -std::cos(angle) } * (radius * distance);
+			// the angles of SetViewYXZ that look along direction
+			const glm::vec3 direction = glm::normalize(center - position);
+			const glm::vec3 rotation{ std::asin(-direction.y), std::atan2(direction.x, direction.z), 0.0f };
+			path.AddKeyframe(duration * t, position, rotation);
+		}
+		return path;
+	}
+
+	void LitCameraPath::AddKeyframe(float time, const glm::vec3& position, const glm::vec3& rotation)
+	{
+		keyframes.push_back(Keyframe{ time, position, rotation });
+	}
+
+	void LitCameraPath::Sample(float time, glm::vec3& position, glm::vec3& rotation) const
+	{
+		if (keyframes.empty())
+		{
+			position = glm::vec3{ 0.0f };
+			rotation = glm::vec3{ 0.0f };
+			return;
+		}
+		const float start = keyframes.front().time;
+		const float length = keyframes.back().time - start;
+		if (length <= 0.0f)
+		{
+			position = keyframes.front().position;
+			rotation = keyframes.front().rotation;
+			return;
+		}
+		time = start + std::fmod(std::max(time, 0.0f), length);
+
+		auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+			[](float value, const Keyframe& keyframe) { return value < keyframe.time; });
+		if (next == keyframes.end())
+		{
+			position = keyframes.back().position;
+			rotation = keyframes.back().rotation;
+			return;
+		}
+		if (next == keyframes.begin())
+		{
+			position = next->position;
+			rotation = next->rotation;
+			return;
+		}
+		const Keyframe& a = *(next - 1);
+		const Keyframe& b = *next;
+		const float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0f;
+		position = glm::mix(a.position, b.position, t);
+		rotation = glm::vec3{ LerpAngle(a.rotation.x, b.rotation.x, t), LerpAngle(a.rotation.y, b.rotation.y, t),
+			LerpAngle(a.rotation.z, b.rotation.z, t) };
+	}
+
+	bool LitCameraPath::Save(const std::string& path) const
+	{
+		std::ofstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		// enough digits for the floats to read back unchanged
+		file.precision(9);
+		for (const Keyframe& keyframe : keyframes)
+		{
+			file << keyframe.time << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+				<< keyframe.rotation.x << " " << keyframe.rotation.y << " " << keyframe.rotation.z << "\n";
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool LitCameraPath::Load(const std::string& path)
+	{
+		std::ifstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		keyframes.clear();
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream stream{ line };
+			Keyframe keyframe{};
+			if (stream >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+				>> keyframe.rotation.x >> keyframe.rotation.y >> keyframe.rotation.z)
+			{
+				keyframes.push_back(keyframe);
+			}
+		}
+		return !keyframes.empty();
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "LitBounds.h"
+
+// std
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// Camera positions and rotations over time, for replaying a flight through a scene. Recorded in LitApp, replayed
+	// by LitHeadlessApp. Rotations are the YXZ angles of LitCamera::SetViewYXZ
+	class LitCameraPath
+	{
+	public:
+		struct Keyframe
+		{
+			// seconds since the start of the path
+			float time;
+			glm::vec3 position;
+			glm::vec3 rotation;
+		};
+
+		// one orbit around bounds in duration seconds, distance and height in bounding sphere radii
+		static LitCameraPath CreateOrbit(const LitAABB& bounds, float duration, float distance, float height);
+
+		bool IsEmpty() const { return keyframes.empty(); }
+		float GetDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+		const std::vector<Keyframe>& GetKeyframes() const { return keyframes; }
+
+		// keyframes must come in time order
+		void AddKeyframe(float time, const glm::vec3& position, const glm::vec3& rotation);
+		void Clear() { keyframes.clear(); }
+
+		// interpolated between the keyframes around time, the path loops
+		void Sample(float time, glm::vec3& position, glm::vec3& rotation) const;
+
+		// text, one keyframe per line: time x y z rx ry rz
+		bool Save(const std::string& path) const;
+		// false when the file can't be read or has no keyframes
+		bool Load(const std::string& path);
+
+	private:
+		std::vector<Keyframe> keyframes;
+	};
+}
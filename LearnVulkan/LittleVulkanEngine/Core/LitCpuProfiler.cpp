@@ -0,0 +1,246 @@
+#include "LitCpuProfiler.h"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Lit
+{
+	namespace
+	{
+		// a seqlock per zone, the capture may read a slot while its thread overwrites it
+		struct ZoneSlot
+		{
+			// 2 * (zone index + 1) once written, odd while it is written
+			std::atomic<uint64_t> sequence{ 0 };
+			std::atomic<const char*> name{ nullptr };
+			std::atomic<uint64_t> begin{ 0 };
+			std::atomic<uint64_t> end{ 0 };
+		};
+
+		struct ThreadRing
+		{
+			std::unique_ptr<ZoneSlot[]> slots{ new ZoneSlot[LitCpuProfiler::RING_CAPACITY] };
+			// zones ever written, only the thread that owns the ring writes it
+			std::atomic<uint64_t> head{ 0 };
+			uint32_t threadId = 0;
+			// the rest is guarded by the profiler mutex
+			std::string threadName;
+			uint64_t captureStart = 0;
+		};
+
+		struct CapturedZone
+		{
+			const char* name;
+			uint64_t begin;
+			uint64_t end;
+			uint32_t threadId;
+		};
+
+		// rings stay after their thread exits, the capture may still need its zones
+		struct ProfilerState
+		{
+			std::mutex mutex;
+			std::vector<std::unique_ptr<ThreadRing>> rings;
+			std::atomic<bool> bCapturing{ false };
+			uint64_t captureBeginTicks = 0;
+			std::chrono::steady_clock::time_point captureBeginTime;
+			uint64_t droppedZoneCount = 0;
+		};
+
+		// never destroyed, threads may still end zones while statics are destroyed at exit
+		ProfilerState& GetState()
+		{
+			static ProfilerState* state = new ProfilerState();
+			return *state;
+		}
+
+		std::atomic<bool> bProfilerEnabled{ true };
+		thread_local ThreadRing* threadRing = nullptr;
+
+		ThreadRing* RegisterThread()
+		{
+			ProfilerState& state = GetState();
+			std::lock_guard<std::mutex> lock{ state.mutex };
+			auto ring = std::make_unique<ThreadRing>();
+			ring->threadId = static_cast<uint32_t>(state.rings.size());
+			ring->threadName = "thread " + std::to_string(ring->threadId);
+			threadRing = ring.get();
+			state.rings.push_back(std::move(ring));
+			return threadRing;
+		}
+
+		void WriteJsonString(std::ostream& out, const char* text)
+		{
+			out << '"';
+			for (const char* c = text; *c != '\0'; c++)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					out << '\\' << *c;
+				}
+				else if (static_cast<unsigned char>(*c) >= 0x20)
+				{
+					out << *c;
+				}
+			}
+			out << '"';
+		}
+	}
+
+	void LitCpuProfiler::RecordZone(const char* name, uint64_t begin, uint64_t end)
+	{
+		if (!bProfilerEnabled.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		ThreadRing* ring = threadRing != nullptr ? threadRing : RegisterThread();
+
+		const uint64_t index = ring->head.load(std::memory_order_relaxed);
+		ZoneSlot& slot = ring->slots[index & (RING_CAPACITY - 1)];
+		slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.begin.store(begin, std::memory_order_relaxed);
+		slot.end.store(end, std::memory_order_relaxed);
+		slot.sequence.store(index * 2 + 2, std::memory_order_release);
+		ring->head.store(index + 1, std::memory_order_release);
+	}
+
+	void LitCpuProfiler::SetThreadName(const char* name)
+	{
+		ThreadRing* ring = threadRing != nullptr ? threadRing : RegisterThread();
+		std::lock_guard<std::mutex> lock{ GetState().mutex };
+		ring->threadName = name;
+	}
+
+	void LitCpuProfiler::SetEnabled(bool bEnabled)
+	{
+		bProfilerEnabled.store(bEnabled, std::memory_order_relaxed);
+	}
+
+	bool LitCpuProfiler::IsEnabled()
+	{
+		return bProfilerEnabled.load(std::memory_order_relaxed);
+	}
+
+	void LitCpuProfiler::BeginCapture()
+	{
+		ProfilerState& state = GetState();
+		std::lock_guard<std::mutex> lock{ state.mutex };
+		for (auto& ring : state.rings)
+		{
+			ring->captureStart = ring->head.load(std::memory_order_acquire);
+		}
+		state.captureBeginTicks = Now();
+		state.captureBeginTime = std::chrono::steady_clock::now();
+		state.bCapturing.store(true);
+	}
+
+	bool LitCpuProfiler::IsCapturing()
+	{
+		return GetState().bCapturing.load();
+	}
+
+	bool LitCpuProfiler::EndCapture(const std::string& path)
+	{
+		ProfilerState& state = GetState();
+		std::vector<CapturedZone> zones;
+		std::vector<std::string> threadNames;
+		uint64_t beginTicks;
+		double ticksPerMicrosecond;
+		{
+			std::lock_guard<std::mutex> lock{ state.mutex };
+			if (!state.bCapturing.load())
+			{
+				return false;
+			}
+			state.bCapturing.store(false);
+			state.droppedZoneCount = 0;
+
+			// the clock rate from the capture itself, the TSC runs at a fixed rate but nothing reports it
+			const uint64_t endTicks = Now();
+			const double microseconds = std::chrono::duration<double, std::micro>(
+				std::chrono::steady_clock::now() - state.captureBeginTime).count();
+			beginTicks = state.captureBeginTicks;
+			ticksPerMicrosecond = microseconds > 0.0 ? static_cast<double>(endTicks - beginTicks) / microseconds : 1.0;
+
+			for (auto& ring : state.rings)
+			{
+				threadNames.push_back(ring->threadName);
+				const uint64_t head = ring->head.load(std::memory_order_acquire);
+				uint64_t first = ring->captureStart;
+				if (head - first > RING_CAPACITY)
+				{
+					state.droppedZoneCount += head - first - RING_CAPACITY;
+					first = head - RING_CAPACITY;
+				}
+				for (uint64_t index = first; index < head; index++)
+				{
+					const ZoneSlot& slot = ring->slots[index & (RING_CAPACITY - 1)];
+					const uint64_t sequence = index * 2 + 2;
+					if (slot.sequence.load(std::memory_order_acquire) != sequence)
+					{
+						state.droppedZoneCount++;
+						continue;
+					}
+					CapturedZone zone{ slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed),
+						slot.end.load(std::memory_order_relaxed), ring->threadId };
+					std::atomic_thread_fence(std::memory_order_acquire);
+					// the thread wrapped around and wrote into the slot meanwhile
+					if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+					{
+						state.droppedZoneCount++;
+						continue;
+					}
+					zones.push_back(zone);
+				}
+			}
+		}
+
+		// zones that began before the capture start before 0
+		for (const auto& zone : zones)
+		{
+			beginTicks = std::min(beginTicks, zone.begin);
+		}
+
+		std::ofstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		const char* separator = "\n";
+		for (uint32_t threadId = 0; threadId < threadNames.size(); threadId++)
+		{
+			file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadId << ",\"args\":{\"name\":";
+			WriteJsonString(file, threadNames[threadId].c_str());
+			file << "}}";
+			separator = ",\n";
+		}
+		for (const auto& zone : zones)
+		{
+			file << separator << "{\"name\":";
+			WriteJsonString(file, zone.name);
+			file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.threadId
+				<< ",\"ts\":" << static_cast<double>(zone.begin - beginTicks) / ticksPerMicrosecond
+				<< ",\"dur\":" << static_cast<double>(zone.end - zone.begin) / ticksPerMicrosecond << '}';
+			separator = ",\n";
+		}
+		file << "\n]}\n";
+		return static_cast<bool>(file);
+	}
+
+	uint64_t LitCpuProfiler::GetDroppedZoneCount()
+	{
+		ProfilerState& state = GetState();
+		std::lock_guard<std::mutex> lock{ state.mutex };
+		return state.droppedZoneCount;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Lit
+{
+	// Named CPU zones for frame breakdowns, from any thread. Every thread writes its zones into a ring buffer of its
+	// own without locks or allocations, a capture copies out what the rings recorded since it began and writes it as
+	// a Chrome trace (chrome://tracing or ui.perfetto.dev). Zones are stamped with the TSC on x86, steady_clock elsewhere
+	class LitCpuProfiler
+	{
+	public:
+		// zones per thread, a capture loses the oldest zones of a thread that records more while it runs
+		static constexpr uint32_t RING_CAPACITY = 1u << 16;
+
+		static uint64_t Now()
+		{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+			return __rdtsc();
+#else
+			return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+		}
+
+		// name has to stay valid until the capture is written, string literals
+		static void RecordZone(const char* name, uint64_t begin, uint64_t end);
+		// shown for the thread in the trace, before or after its first zone
+		static void SetThreadName(const char* name);
+
+		// zones end in a disabled profiler without being recorded
+		static void SetEnabled(bool bEnabled);
+		static bool IsEnabled();
+
+		static void BeginCapture();
+		static bool IsCapturing();
+		// writes the zones recorded since BeginCapture on any thread, false if the file couldn't be written
+		static bool EndCapture(const std::string& path);
+		// zones of the last capture that were overwritten before it was written
+		static uint64_t GetDroppedZoneCount();
+	};
+
+	// records the time between its construction and destruction as a zone of the calling thread
+	class LitCpuZone
+	{
+	public:
+		explicit LitCpuZone(const char* inName) : name{ inName }, begin{ LitCpuProfiler::Now() } {}
+		~LitCpuZone() { LitCpuProfiler::RecordZone(name, begin, LitCpuProfiler::Now()); }
+
+		LitCpuZone(const LitCpuZone&) = delete;
+		LitCpuZone& operator=(const LitCpuZone&) = delete;
+
+	private:
+		const char* name;
+		uint64_t begin;
+	};
+}
+
+#define LIT_CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define LIT_CPU_ZONE_CONCAT(a, b) LIT_CPU_ZONE_CONCAT_INNER(a, b)
+// times the rest of the enclosing scope
+#define LIT_CPU_ZONE(name) ::Lit::LitCpuZone LIT_CPU_ZONE_CONCAT(litCpuZone, __LINE__){ name }
@@ -0,0 +1,94 @@
+#include "LitDeletionQueue.h"
+
+namespace Lit
+{
+	LitDeletionQueue::LitDeletionQueue(LitTimeline& inTimeline) : timeline{ inTimeline }
+	{
+	}
+
+	LitDeletionQueue::~LitDeletionQueue()
+	{
+		Flush();
+	}
+
+	void LitDeletionQueue::Push(Deleter deleter)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			if (bFrameInProgress || !timeline.IsComplete(timeline.GetLastSubmittedValue()))
+			{
+				frameDeleters.push_back(std::move(deleter));
+				return;
+			}
+		}
+		// nothing recorded or in flight can use the objects anymore
+		deleter();
+	}
+
+	void LitDeletionQueue::BeginFrame()
+	{
+		std::vector<Deleter> readyDeleters;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			bFrameInProgress = true;
+			const uint64_t completedValue = entries.empty() ? 0 : timeline.GetCompletedValue();
+			while (!entries.empty() && entries.front().timelineValue <= completedValue)
+			{
+				readyDeleters.push_back(std::move(entries.front().deleter));
+				entries.pop_front();
+			}
+		}
+		// outside the lock, destroying an object may push more
+		for (auto& deleter : readyDeleters)
+		{
+			deleter();
+		}
+	}
+
+	void LitDeletionQueue::EndFrame(uint64_t timelineValue)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		bFrameInProgress = false;
+		for (auto& deleter : frameDeleters)
+		{
+			entries.push_back(Entry{ timelineValue, std::move(deleter) });
+		}
+		frameDeleters.clear();
+	}
+
+	void LitDeletionQueue::Flush()
+	{
+		timeline.WaitIdle();
+		for (;;)
+		{
+			std::vector<Deleter> readyDeleters;
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				for (auto& entry : entries)
+				{
+					readyDeleters.push_back(std::move(entry.deleter));
+				}
+				entries.clear();
+				for (auto& deleter : frameDeleters)
+				{
+					readyDeleters.push_back(std::move(deleter));
+				}
+				frameDeleters.clear();
+			}
+			if (readyDeleters.empty())
+			{
+				return;
+			}
+			for (auto& deleter : readyDeleters)
+			{
+				deleter();
+			}
+		}
+	}
+
+	size_t LitDeletionQueue::GetPendingCount()
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		return frameDeleters.size() + entries.size();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "LitTimeline.h"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Lit
+{
+	// Destroys Vulkan objects once the GPU is done with them instead of waiting for the device. What is pushed while
+	// a frame records may be used by that frame or the ones in flight, so it runs once the timeline reaches the value
+	// the frame gets at submission. Pushed while the GPU is idle and no frame records, it runs right away
+	class LitDeletionQueue
+	{
+	public:
+		using Deleter = std::function<void()>;
+
+		explicit LitDeletionQueue(LitTimeline& timeline);
+		~LitDeletionQueue();
+
+		LitDeletionQueue(const LitDeletionQueue&) = delete;
+		LitDeletionQueue& operator=(const LitDeletionQueue&) = delete;
+
+		// deleter only captures the handles it destroys, it may run on the next frame or much later
+		void Push(Deleter deleter);
+
+		// called by the renderer, BeginFrame runs the deleters the timeline reached and EndFrame ties everything pushed
+		// since the last frame to the timeline value the frame was submitted with
+		void BeginFrame();
+		void EndFrame(uint64_t timelineValue);
+
+		// waits for the GPU and runs everything, before objects the deleters use go away. Not while a frame records
+		void Flush();
+
+		size_t GetPendingCount();
+
+	private:
+		struct Entry
+		{
+			uint64_t timelineValue;
+			Deleter deleter;
+		};
+
+		LitTimeline& timeline;
+		std::mutex mutex;
+		bool bFrameInProgress = false;
+		// pushed since the last EndFrame, the value that covers them isn't known yet
+		std::vector<Deleter> frameDeleters;
+		// ascending timeline values
+		std::deque<Entry> entries;
+	};
+}
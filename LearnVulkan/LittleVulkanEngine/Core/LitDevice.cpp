@@ -1,4 +1,6 @@
 #include "LitDevice.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -46,11 +48,9 @@ namespace Lit
 	}
 	uint32_t LitDevice::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 	{
-		VkPhysicalDeviceMemoryProperties memproperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memproperties);
-		for (uint32_t i = 0; i < memproperties.memoryTypeCount; i++)
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
 		{
-			if ((typeFilter & (1 << i)) && (memproperties.memoryTypes[i].propertyFlags & properties) == properties)
+			if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
 			{
 				return i;
 			}
@@ -78,7 +78,8 @@ namespace Lit
 		throw std::runtime_error("failed to find supported format!");
 	}
 	void LitDevice::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
-		VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+		VkMemoryPropertyFlags properties, MemoryCategory category, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+		VkMemoryPropertyFlags* allocatedProperties /* = nullptr */)
 	{
 		VkBufferCreateInfo bufferInfo = {};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -101,12 +102,19 @@ namespace Lit
 		// maxMemoryAllocationCount for a physical device. Should create a custom
 		// allocator that batches together a large number of objects at once. See
 		// https://github.com/GPUOpen-LibrariesAndSDKs/VulkanMemoryAllocator
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) 
+		if (AllocateMemory(allocInfo, category, bufferMemory, size) != VK_SUCCESS) 
 		{
 			throw std::runtime_error("failed to allocate vertex buffer memory!");
 		}
 
 		vkBindBufferMemory(device, buffer, bufferMemory, 0);
+
+		// the chosen memory type may have more properties than requested (eg HOST_COHERENT),
+		// callers use this to skip flushes that the driver doesn't need
+		if (allocatedProperties != nullptr)
+		{
+			*allocatedProperties = memoryProperties.memoryTypes[allocInfo.memoryTypeIndex].propertyFlags;
+		}
 	}
 	VkCommandBuffer LitDevice::BeginSingleTimeCommands()
 	{
@@ -140,8 +148,8 @@ namespace Lit
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphicsQueue);
+		// the timeline counts up in submission order, so this also waits for the frames in flight submitted before it
+		timeline->Wait(timeline->Submit(graphicsQueue, submitInfo));
 
 		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 	}
@@ -270,8 +278,8 @@ namespace Lit
 		EndSingleTimeCommands(commandBuffer);
 	}
 	void LitDevice::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling,
-		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
-		VkImageCreateFlags flags, uint32_t arrayLayers)
+		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, VkImage& image,
+		VkDeviceMemory& imageMemory, VkImageCreateFlags flags, uint32_t arrayLayers)
 	{
 		VkImageCreateInfo imageInfo = {};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -300,7 +308,7 @@ namespace Lit
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+		if (AllocateMemory(allocInfo, category, imageMemory) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to allocate image memory!");
 		}
@@ -333,6 +341,13 @@ namespace Lit
 	void LitDevice::GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
 	{
 		VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+		GenerateMipmaps(commandBuffer, image, imageFormat, texWidth, texHeight, mipLevels);
+		EndSingleTimeCommands(commandBuffer);
+	}
+
+	void LitDevice::GenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t texWidth,
+		int32_t texHeight, uint32_t mipLevels)
+	{
 		// Check if image format supports linear blitting
 		VkFormatProperties formatProperties;
 		vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
@@ -429,22 +444,110 @@ namespace Lit
 			nullptr,
 			1,
 			&barrier);
+	}
 
-		EndSingleTimeCommands(commandBuffer);
+	void LitDevice::QueueMappedMemoryFlush(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size)
+	{
+		VkMappedMemoryRange mappedRange = {};
+		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedRange.memory = memory;
+		mappedRange.offset = offset;
+		mappedRange.size = size;
+		pendingFlushRanges.push_back(mappedRange);
+	}
+
+	VkResult LitDevice::FlushMappedMemoryRanges()
+	{
+		if (pendingFlushRanges.empty())
+		{
+			return VK_SUCCESS;
+		}
+
+		// merge overlapping or touching ranges of the same allocation so every memory object
+		// is flushed at most a few times, then hand everything to the driver in one call
+		std::sort(pendingFlushRanges.begin(), pendingFlushRanges.end(),
+			[](const VkMappedMemoryRange& a, const VkMappedMemoryRange& b)
+			{
+				return a.memory != b.memory ? a.memory < b.memory : a.offset < b.offset;
+			});
+
+		std::vector<VkMappedMemoryRange> mergedRanges;
+		mergedRanges.reserve(pendingFlushRanges.size());
+		for (const auto& range : pendingFlushRanges)
+		{
+			if (!mergedRanges.empty() && mergedRanges.back().memory == range.memory)
+			{
+				VkMappedMemoryRange& last = mergedRanges.back();
+				if (last.size == VK_WHOLE_SIZE)
+				{
+					continue;
+				}
+				VkDeviceSize lastEnd = last.offset + last.size;
+				if (range.offset <= lastEnd)
+				{
+					if (range.size == VK_WHOLE_SIZE)
+					{
+						last.size = VK_WHOLE_SIZE;
+					}
+					else
+					{
+						last.size = std::max(lastEnd, range.offset + range.size) - last.offset;
+					}
+					continue;
+				}
+			}
+			mergedRanges.push_back(range);
+		}
+		pendingFlushRanges.clear();
+
+		return vkFlushMappedMemoryRanges(device, static_cast<uint32_t>(mergedRanges.size()), mergedRanges.data());
+	}
+
+	VkResult LitDevice::AllocateMemory(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, VkDeviceMemory& memory,
+		VkDeviceSize usedBytes /* = VK_WHOLE_SIZE */)
+	{
+		VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+		if (result == VK_SUCCESS)
+		{
+			memoryBudget->OnAllocate(memory, allocInfo.allocationSize, allocInfo.memoryTypeIndex, category, usedBytes);
+		}
+		return result;
+	}
+
+	void LitDevice::FreeMemory(VkDeviceMemory memory)
+	{
+		if (memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		memoryBudget->OnFree(memory);
+		vkFreeMemory(device, memory, nullptr);
 	}
 
 	void LitDevice::Init()
 	{
+		if (!IsHeadless())
+		{
+			deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
 		CreateInstance();
 		CreateDebugMessenger();
 		CreateSurface();
 		PickPhyscialDevice();
 		CreateLogicalDevice();
+		memoryBudget = std::make_unique<LitMemoryBudget>(instance, physicalDevice, bMemoryBudget);
+		samplerCache = std::make_unique<LitSamplerCache>(device);
 		CreateCommandPool();
+		timeline = std::make_unique<LitTimeline>(device, bTimelineSemaphore);
+		deletionQueue = std::make_unique<LitDeletionQueue>(*timeline);
 	}
 
 	void LitDevice::CleanUp()
 	{
+		deletionQueue.reset();
+		timeline.reset();
+		memoryBudget.reset();
+		samplerCache.reset();
 		vkDestroyCommandPool(device, commandPool, nullptr);
 		vkDestroyDevice(device, nullptr);
 
@@ -452,7 +555,10 @@ namespace Lit
 		{
 			DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
 		}
-		vkDestroySurfaceKHR(instance, surface, nullptr);
+		if (surface != VK_NULL_HANDLE)
+		{
+			vkDestroySurfaceKHR(instance, surface, nullptr);
+		}
 		vkDestroyInstance(instance, nullptr);
 	}
 
@@ -469,7 +575,15 @@ namespace Lit
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// 1.2 for timeline semaphores where the loader has it, vkEnumerateInstanceVersion is missing from 1.0 loaders
+		uint32_t instanceVersion = VK_API_VERSION_1_0;
+		auto enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion");
+		if (enumerateInstanceVersion != nullptr)
+		{
+			enumerateInstanceVersion(&instanceVersion);
+		}
+		apiVersion = instanceVersion >= VK_API_VERSION_1_2 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+		appInfo.apiVersion = apiVersion;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -517,7 +631,10 @@ namespace Lit
 	}
 	void LitDevice::CreateSurface()
 	{
-		window.CreateWindowSurface(instance, &surface);
+		if (!IsHeadless())
+		{
+			window->CreateWindowSurface(instance, &surface);
+		}
 	}
 	void LitDevice::PickPhyscialDevice()
 	{
@@ -543,6 +660,7 @@ namespace Lit
 			throw std::runtime_error("failed to find a suitable GPU!");
 		}
 		vkGetPhysicalDeviceProperties(physicalDevice, &physicalProperties);
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
 
 		std::cout << "physical device: " << physicalProperties.deviceName << std::endl;
 	}
@@ -563,10 +681,51 @@ namespace Lit
 			queueCreateInfo.pQueuePriorities = &queuePriority;
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// optional, meshlet draws fall back to one vkCmdDrawIndexedIndirect per draw without it
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		// optional, LitGpuProfiler only measures time without it
+		deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+		// optional, LitTextureManager decodes BC textures on the CPU without it
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+		enabledFeatures = deviceFeatures;
+
+		// optional, LitTimeline falls back to fences without it
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		auto getPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+		if (apiVersion >= VK_API_VERSION_1_2 && physicalProperties.apiVersion >= VK_API_VERSION_1_2 && getPhysicalDeviceFeatures2 != nullptr)
+		{
+			VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+			supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures2.pNext = &timelineFeatures;
+			getPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+		}
+		bTimelineSemaphore = timelineFeatures.timelineSemaphore == VK_TRUE;
+		timelineFeatures.pNext = nullptr;
+
+		// optional, LitMemoryBudget guesses the budgets without it. Queried through vkGetPhysicalDeviceMemoryProperties2
+		uint32_t extensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+		bMemoryBudget = apiVersion >= VK_API_VERSION_1_2 && physicalProperties.apiVersion >= VK_API_VERSION_1_1 &&
+			std::any_of(availableExtensions.begin(), availableExtensions.end(), [](const VkExtensionProperties& extension)
+			{
+				return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+			});
+		if (bMemoryBudget)
+		{
+			deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = bTimelineSemaphore ? &timelineFeatures : nullptr;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
@@ -612,8 +771,9 @@ namespace Lit
 	{
 		QueueFamilyIndices indices = FindQueueFamilies(device);
 		bool extensionsSupported = CheckDeviceExtensionSupport(device);
-		bool swapChainAdequate = false;
-		if (extensionsSupported)
+		// nothing is presented headless
+		bool swapChainAdequate = IsHeadless();
+		if (extensionsSupported && !IsHeadless())
 		{
 			SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
 			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -627,9 +787,9 @@ namespace Lit
 
 	std::vector<const char*> LitDevice::GetRequiredExtensions()
 	{
+		// GLFW isn't initialized headless
 		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		const char** glfwExtensions = IsHeadless() ? nullptr : glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 		if (enableValidationLayers)
 		{
@@ -681,9 +841,16 @@ namespace Lit
 				indices.graphicsFamily = i;
 				indices.graphicsFamilyHasValue = true;
 			}
-			// Find Present Queue
+			// Find Present Queue, headless the graphics queue stands in for it
 			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			if (IsHeadless())
+			{
+				presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+			}
+			else
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			}
 			if (queueFamily.queueCount > 0 && presentSupport)
 			{
 				indices.presentFamily = i;
@@ -1,10 +1,15 @@
 #pragma once
+#include "LitDeletionQueue.h"
+#include "LitMemoryBudget.h"
+#include "LitSamplerCache.h"
+#include "LitTimeline.h"
 #include "LitWindow.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,7 +33,10 @@ namespace Lit
 	class LitDevice
 	{
 	public:
-		LitDevice(LitWindow& windowRef) : window(windowRef) { Init(); }
+		LitDevice(LitWindow& windowRef) : window(&windowRef) { Init(); }
+		// headless, without a surface or the swap chain extension. Renders offscreen only, on any device with a graphics
+		// queue including software ones like lavapipe (pick it with VK_ICD_FILENAMES)
+		LitDevice() { Init(); }
 
 		LitDevice(const LitDevice&) = delete;
 		LitDevice& operator=(const LitDevice&) = delete;
@@ -37,6 +45,7 @@ namespace Lit
 
 		VkDevice GetDevice() { return device; }
 		VkSurfaceKHR GetSurface() { return surface; }
+		bool IsHeadless() const { return window == nullptr; }
 		VkQueue GetGraphicsQueue() { return graphicsQueue; }
 		VkQueue GetPresentQueue() { return presentQueue; }
 
@@ -45,17 +54,34 @@ namespace Lit
 		uint32_t GetGraphicsQueueFamily() { return FindPhysicalQueueFamilies().graphicsFamily; }
 
 		VkPhysicalDeviceProperties GetPhysicalDeviceProperties() { return physicalProperties; }
+		VkDeviceSize GetNonCoherentAtomSize() { return physicalProperties.limits.nonCoherentAtomSize; }
+		bool SupportsMultiDrawIndirect() { return enabledFeatures.multiDrawIndirect == VK_TRUE; }
+		bool SupportsTimelineSemaphore() { return bTimelineSemaphore; }
+		bool SupportsPipelineStatisticsQuery() { return enabledFeatures.pipelineStatisticsQuery == VK_TRUE; }
+		bool SupportsTextureCompressionBC() { return enabledFeatures.textureCompressionBC == VK_TRUE; }
+		bool SupportsMemoryBudget() { return bMemoryBudget; }
+
+		// every submission to the graphics queue signals this, see LitTimeline
+		LitTimeline& GetTimeline() { return *timeline; }
+		// for objects the GPU may still use, see LitDeletionQueue
+		LitDeletionQueue& GetDeletionQueue() { return *deletionQueue; }
+		// what the allocations below take of each heap, see LitMemoryBudget
+		LitMemoryBudget& GetMemoryBudget() { return *memoryBudget; }
+		// samplers shared by everything that samples with the same settings
+		LitSamplerCache& GetSamplerCache() { return *samplerCache; }
 
 		// Command Pool
 		VkCommandPool GetCommandPool() { return commandPool; }
 		SwapChainSupportDetails GetSwapChainSupportDetail() { return QuerySwapChainSupport(physicalDevice); }
 		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+		const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() { return memoryProperties; }
 		QueueFamilyIndices FindPhysicalQueueFamilies() { return FindQueueFamilies(physicalDevice); }
 		VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
 		// Buffer And Image Helper Functions
 		void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, 
-				VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+				VkMemoryPropertyFlags properties, MemoryCategory category, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+				VkMemoryPropertyFlags* allocatedProperties = nullptr);
 		VkCommandBuffer BeginSingleTimeCommands();
 		void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
 
@@ -67,11 +93,24 @@ namespace Lit
 				VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount);
 
 		void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling,
-			VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
-			VkImageCreateFlags flags, uint32_t arrayLayers);
+			VkImageUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category, VkImage& image,
+			VkDeviceMemory& imageMemory, VkImageCreateFlags flags, uint32_t arrayLayers);
 		VkImageView CreateImageView(VkImage image, VkFormat format, 
 			VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType viewType);
 		void GenerateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
+		// records the blits into commandBuffer, mip 0 in TRANSFER_DST_OPTIMAL and every level SHADER_READ_ONLY_OPTIMAL after
+		void GenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t texWidth,
+			int32_t texHeight, uint32_t mipLevels);
+
+		// Non-coherent memory flushes, batched into a single vkFlushMappedMemoryRanges per frame
+		void QueueMappedMemoryFlush(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size);
+		VkResult FlushMappedMemoryRanges();
+
+		// vkAllocateMemory and vkFreeMemory that tell the memory budget, all device memory of the engine goes through
+		// these. usedBytes is what the resource needs of the allocation, all of it by default. Safe from any thread
+		VkResult AllocateMemory(const VkMemoryAllocateInfo& allocInfo, MemoryCategory category, VkDeviceMemory& memory,
+			VkDeviceSize usedBytes = VK_WHOLE_SIZE);
+		void FreeMemory(VkDeviceMemory memory);
 
 	private:
 		void Init();
@@ -97,13 +136,14 @@ namespace Lit
 
 	private:
 		VkDevice device;
-		VkSurfaceKHR surface;
+		VkSurfaceKHR surface = VK_NULL_HANDLE;
 
 		VkQueue graphicsQueue;
 		VkQueue presentQueue;
 		// The VK_LAYER_KHRONOS_validation contains all current validation functionality.
 		const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
-		const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+		// the swap chain extension unless headless
+		std::vector<const char*> deviceExtensions;
 #ifdef NDEBUG
 		const bool enableValidationLayers = false;
 #else
@@ -113,9 +153,20 @@ namespace Lit
 		VkDebugUtilsMessengerEXT debugMessenger;
 		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 		VkPhysicalDeviceProperties physicalProperties;
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		VkPhysicalDeviceFeatures enabledFeatures{};
+		uint32_t apiVersion = VK_API_VERSION_1_0;
+		bool bTimelineSemaphore = false;
+		std::unique_ptr<LitTimeline> timeline;
+		std::unique_ptr<LitDeletionQueue> deletionQueue;
+		bool bMemoryBudget = false;
+		std::unique_ptr<LitMemoryBudget> memoryBudget;
+		std::unique_ptr<LitSamplerCache> samplerCache;
+
+		std::vector<VkMappedMemoryRange> pendingFlushRanges;
 
 		VkCommandPool commandPool;
-		LitWindow& window;
+		LitWindow* window = nullptr;
 	};
 
 
@@ -0,0 +1,83 @@
+#include "LitDynamicResolution.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace Lit
+{
+	// exponential moving average weight of the newest frame
+	static const float FRAME_TIME_SMOOTHING = 0.1f;
+	// frames to wait after a change, about the time the moving average needs to follow it
+	static const uint32_t SETTLE_FRAMES = 16;
+	// below this fraction of the target there is room to scale up right away
+	static const float HEADROOM = 0.85f;
+	// waiting this many frames between the headroom and the target before probing upwards
+	static const uint32_t PROBE_FRAMES = 120;
+	static const float PROBE_STEP = 1.05f;
+	// largest change of the scale in one step, big jumps are visible
+	static const float MAX_STEP = 1.25f;
+
+	LitDynamicResolution::LitDynamicResolution(float inTargetFrameMilliseconds, float inMinScale, float inMaxScale)
+		: targetFrameMilliseconds{ inTargetFrameMilliseconds }, minScale{ inMinScale }, maxScale{ inMaxScale }, scale{ inMaxScale }
+	{
+	}
+
+	void LitDynamicResolution::Reset()
+	{
+		scale = maxScale;
+		smoothedFrameMilliseconds = 0.0f;
+		settleFrames = 0;
+	}
+
+	void LitDynamicResolution::SetEnabled(bool bInEnabled)
+	{
+		if (bInEnabled != bEnabled)
+		{
+			bEnabled = bInEnabled;
+			Reset();
+		}
+	}
+
+	void LitDynamicResolution::Update(float frameMilliseconds)
+	{
+		if (!bEnabled || frameMilliseconds <= 0.0f)
+		{
+			return;
+		}
+
+		smoothedFrameMilliseconds = smoothedFrameMilliseconds == 0.0f ? frameMilliseconds :
+			smoothedFrameMilliseconds + (frameMilliseconds - smoothedFrameMilliseconds) * FRAME_TIME_SMOOTHING;
+		settleFrames++;
+		if (settleFrames < SETTLE_FRAMES)
+		{
+			return;
+		}
+
+		float newScale = scale;
+		if (smoothedFrameMilliseconds > targetFrameMilliseconds || smoothedFrameMilliseconds < targetFrameMilliseconds * HEADROOM)
+		{
+			const float step = std::sqrt(targetFrameMilliseconds / smoothedFrameMilliseconds);
+			newScale = scale * std::clamp(step, 1.0f / MAX_STEP, MAX_STEP);
+		}
+		else if (settleFrames >= PROBE_FRAMES)
+		{
+			newScale = scale * PROBE_STEP;
+		}
+
+		newScale = std::clamp(newScale, minScale, maxScale);
+		if (newScale != scale)
+		{
+			scale = newScale;
+			settleFrames = 0;
+		}
+	}
+
+	VkExtent2D LitDynamicResolution::ScaleExtent(VkExtent2D extent) const
+	{
+		const float currentScale = GetScale();
+		return VkExtent2D{
+			std::max(static_cast<uint32_t>(std::lround(extent.width * currentScale)), 1u),
+			std::max(static_cast<uint32_t>(std::lround(extent.height * currentScale)), 1u) };
+	}
+}
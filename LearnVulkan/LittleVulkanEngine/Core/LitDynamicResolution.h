@@ -0,0 +1,43 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+
+namespace Lit
+{
+	// Picks the fraction of the output resolution the scene renders at to hold a frame time target. The cost of a
+	// GPU bound frame follows the pixel count, so the scale of each axis moves with the square root of how far the
+	// smoothed frame time is from the target. Inside the headroom band it probes upwards in small steps
+	// after a while, which is how it recovers when the frame time is capped by presentation
+	class LitDynamicResolution
+	{
+	public:
+		explicit LitDynamicResolution(float targetFrameMilliseconds = 16.6f, float minScale = 0.5f, float maxScale = 1.0f);
+
+		// once per frame with the time the last frame took
+		void Update(float frameMilliseconds);
+		// back to the maximum scale, e.g. after the frame time target changed
+		void Reset();
+
+		void SetEnabled(bool bInEnabled);
+		bool IsEnabled() const { return bEnabled; }
+		void SetTargetFrameMilliseconds(float milliseconds) { targetFrameMilliseconds = milliseconds; }
+		float GetTargetFrameMilliseconds() const { return targetFrameMilliseconds; }
+		float GetSmoothedFrameMilliseconds() const { return smoothedFrameMilliseconds; }
+		float GetScale() const { return bEnabled ? scale : maxScale; }
+
+		// the extent to render at for an output of this size, rounded to whole pixels and never empty
+		VkExtent2D ScaleExtent(VkExtent2D extent) const;
+
+	private:
+		float targetFrameMilliseconds;
+		float minScale;
+		float maxScale;
+		float scale;
+		float smoothedFrameMilliseconds = 0.0f;
+		// frames since the scale last changed, the smoothed time has to catch up with a change before the next one
+		uint32_t settleFrames = 0;
+		bool bEnabled = true;
+	};
+}
@@ -1,10 +1,18 @@
 #pragma once
 
 #include "LitCamera.h"
+#include "LitGpuProfiler.h"
 #include <vulkan/vulkan.h>
 
 namespace Lit
 {
+	// binding 0 of the global descriptor set
+	struct GlobalUBO
+	{
+		glm::mat4 projectionView{ 1.0f };
+		glm::vec3 lightDirection = glm::normalize(glm::vec3(1.0f, -3.0f, -1.0f));
+	};
+
 	struct FrameInfo
 	{
 		int frameIndex;
@@ -12,6 +20,8 @@ namespace Lit
 		VkCommandBuffer commandBuffer;
 		LitCamera& camera;
 		VkDescriptorSet globalDescriptorSet;
+		// scopes of the systems go here when set
+		LitGpuProfiler* gpuProfiler = nullptr;
 	};
 
 }
\ No newline at end of file
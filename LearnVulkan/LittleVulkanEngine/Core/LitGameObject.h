@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "LitModel.h"
+#include "LitTexture.h"
 
 namespace Lit
 {
@@ -55,6 +56,8 @@ namespace Lit
 
 	public:
 		std::shared_ptr<LitModel> model{};
+		// sampled with the model's uvs, the default white texture when null
+		std::shared_ptr<LitTexture> texture{};
 		glm::vec3 color{};
 		TransformComponent transform{};
 	private:
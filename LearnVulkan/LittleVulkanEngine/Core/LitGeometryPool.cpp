@@ -0,0 +1,160 @@
+#include "LitGeometryPool.h"
+
+// std
+#include <cassert>
+
+namespace Lit
+{
+	LitGeometryPool::RangeAllocator::RangeAllocator(VkDeviceSize capacity)
+	{
+		freeRanges[0] = capacity;
+	}
+
+	bool LitGeometryPool::RangeAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+	{
+		for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+		{
+			const VkDeviceSize rangeOffset = it->first;
+			const VkDeviceSize rangeSize = it->second;
+			const VkDeviceSize alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+			if (alignedOffset + size > rangeOffset + rangeSize)
+			{
+				continue;
+			}
+
+			// keep the alignment padding in front and the tail as separate free ranges
+			freeRanges.erase(it);
+			if (alignedOffset > rangeOffset)
+			{
+				freeRanges[rangeOffset] = alignedOffset - rangeOffset;
+			}
+			if (alignedOffset + size < rangeOffset + rangeSize)
+			{
+				freeRanges[alignedOffset + size] = rangeOffset + rangeSize - alignedOffset - size;
+			}
+			offset = alignedOffset;
+			usedSize += size;
+			return true;
+		}
+		return false;
+	}
+
+	void LitGeometryPool::RangeAllocator::Release(VkDeviceSize offset, VkDeviceSize size)
+	{
+		assert(usedSize >= size && "releasing more than was allocated");
+		usedSize -= size;
+
+		auto next = freeRanges.lower_bound(offset);
+		if (next != freeRanges.end() && offset + size == next->first)
+		{
+			size += next->second;
+			next = freeRanges.erase(next);
+		}
+		if (next != freeRanges.begin())
+		{
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += size;
+				return;
+			}
+		}
+		freeRanges[offset] = size;
+	}
+
+	LitGeometryPool::LitGeometryPool(LitDevice& inDevice, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity)
+		: device{ inDevice }, vertexRanges{ vertexCapacity }, indexRanges{ indexCapacity }
+	{
+		VkDeviceSize byteSize = 1;
+		vertexBuffer = std::make_unique<LitBuffer>(device, byteSize, static_cast<uint32_t>(vertexCapacity),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Mesh);
+		indexBuffer = std::make_unique<LitBuffer>(device, byteSize, static_cast<uint32_t>(indexCapacity),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Mesh);
+		ReportUsedBytes();
+	}
+
+	LitGeometryPool::~LitGeometryPool()
+	{
+	}
+
+	bool LitGeometryPool::Allocate(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount,
+		const void* indexData, VkIndexType indexType, uint32_t indexCount, Allocation& allocation)
+	{
+		const VkDeviceSize indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		Allocation result{};
+		result.indexType = indexType;
+		result.vertexSize = static_cast<VkDeviceSize>(vertexStride) * vertexCount;
+		result.indexSize = indexSize * indexCount;
+
+		// vertexOffset counts whole vertices, so the range has to start at a multiple of the stride
+		if (!vertexRanges.Allocate(result.vertexSize, vertexStride, result.vertexOffset))
+		{
+			return false;
+		}
+		// firstIndex counts whole indices of the model's type, the same as vkCmdBindIndexBuffer's offset alignment
+		if (indexCount > 0 && !indexRanges.Allocate(result.indexSize, indexSize, result.indexOffset))
+		{
+			vertexRanges.Release(result.vertexOffset, result.vertexSize);
+			return false;
+		}
+		result.baseVertex = static_cast<int32_t>(result.vertexOffset / vertexStride);
+		result.firstIndex = static_cast<uint32_t>(result.indexOffset / indexSize);
+
+		// both ranges go through one staging buffer and one submit
+		VkDeviceSize byteSize = 1;
+		LitBuffer stagingBuffer(device, byteSize, static_cast<uint32_t>(result.vertexSize + result.indexSize),
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
+		stagingBuffer.Map();
+		stagingBuffer.WriteToBuffer(const_cast<void*>(vertexData), result.vertexSize, 0);
+		if (indexCount > 0)
+		{
+			stagingBuffer.WriteToBuffer(const_cast<void*>(indexData), result.indexSize, result.vertexSize);
+		}
+
+		VkCommandBuffer commandBuffer = device.BeginSingleTimeCommands();
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = 0;
+		copyRegion.dstOffset = result.vertexOffset;
+		copyRegion.size = result.vertexSize;
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer.GetBuffer(), vertexBuffer->GetBuffer(), 1, &copyRegion);
+		if (indexCount > 0)
+		{
+			copyRegion.srcOffset = result.vertexSize;
+			copyRegion.dstOffset = result.indexOffset;
+			copyRegion.size = result.indexSize;
+			vkCmdCopyBuffer(commandBuffer, stagingBuffer.GetBuffer(), indexBuffer->GetBuffer(), 1, &copyRegion);
+		}
+		device.EndSingleTimeCommands(commandBuffer);
+
+		allocation = result;
+		ReportUsedBytes();
+		return true;
+	}
+
+	void LitGeometryPool::Free(const Allocation& allocation)
+	{
+		vertexRanges.Release(allocation.vertexOffset, allocation.vertexSize);
+		if (allocation.indexSize > 0)
+		{
+			indexRanges.Release(allocation.indexOffset, allocation.indexSize);
+		}
+		ReportUsedBytes();
+	}
+
+	void LitGeometryPool::ReportUsedBytes()
+	{
+		device.GetMemoryBudget().SetUsedBytes(vertexBuffer->GetMemory(), vertexRanges.GetUsedSize());
+		device.GetMemoryBudget().SetUsedBytes(indexBuffer->GetMemory(), indexRanges.GetUsedSize());
+	}
+
+	void LitGeometryPool::Bind(VkCommandBuffer commandBuffer, VkIndexType indexType)
+	{
+		VkBuffer buffers[] = { vertexBuffer->GetBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer->GetBuffer(), 0, indexType);
+	}
+}
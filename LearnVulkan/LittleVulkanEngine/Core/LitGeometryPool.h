@@ -0,0 +1,83 @@
+#pragma once
+#include "LitDevice.h"
+#include "LitBuffer.h"
+
+// std
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace Lit
+{
+	// One device local vertex buffer and one index buffer shared by every model. Models sub-allocate a range of
+	// each and draw with vertexOffset/firstIndex, so a whole scene needs a single vkCmdBindVertexBuffers and
+	// vkCmdBindIndexBuffer and all its draws can go into one multi-draw indirect call
+	class LitGeometryPool
+	{
+	public:
+		static constexpr VkDeviceSize DEFAULT_VERTEX_CAPACITY = 64 * 1024 * 1024;
+		static constexpr VkDeviceSize DEFAULT_INDEX_CAPACITY = 32 * 1024 * 1024;
+
+		// placement of one model's geometry, baseVertex and firstIndex are in elements as vkCmdDrawIndexed expects
+		struct Allocation
+		{
+			VkDeviceSize vertexOffset = 0;
+			VkDeviceSize vertexSize = 0;
+			VkDeviceSize indexOffset = 0;
+			VkDeviceSize indexSize = 0;
+			int32_t baseVertex = 0;
+			uint32_t firstIndex = 0;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		};
+
+		LitGeometryPool(LitDevice& device,
+			VkDeviceSize vertexCapacity = DEFAULT_VERTEX_CAPACITY, VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY);
+		~LitGeometryPool();
+
+		LitGeometryPool(const LitGeometryPool&) = delete;
+		LitGeometryPool& operator=(const LitGeometryPool&) = delete;
+
+		// copies the vertices and indices into the pool, returns false when either buffer has no free range large
+		// enough. Ranges are aligned to their element size: models of different vertex formats share the vertex
+		// buffer and 16 and 32 bit indices share the index buffer, which is bound with the type of the model drawn
+		bool Allocate(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount,
+			const void* indexData, VkIndexType indexType, uint32_t indexCount, Allocation& allocation);
+		// the caller must make sure the GPU no longer reads the range
+		void Free(const Allocation& allocation);
+
+		void Bind(VkCommandBuffer commandBuffer, VkIndexType indexType);
+
+		VkBuffer GetVertexBuffer() const { return vertexBuffer->GetBuffer(); }
+		VkBuffer GetIndexBuffer() const { return indexBuffer->GetBuffer(); }
+		VkDeviceSize GetVertexBytesUsed() const { return vertexRanges.GetUsedSize(); }
+		VkDeviceSize GetIndexBytesUsed() const { return indexRanges.GetUsedSize(); }
+
+	private:
+		// first fit free list over a byte range, neighbouring free ranges are merged on release
+		class RangeAllocator
+		{
+		public:
+			explicit RangeAllocator(VkDeviceSize capacity);
+
+			// returns false if no free range can hold size bytes at the given alignment
+			bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+			void Release(VkDeviceSize offset, VkDeviceSize size);
+			VkDeviceSize GetUsedSize() const { return usedSize; }
+
+		private:
+			// offset -> size
+			std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+			VkDeviceSize usedSize = 0;
+		};
+
+		// the memory budget counts the buffers as used as far as ranges are handed out
+		void ReportUsedBytes();
+
+		LitDevice& device;
+
+		std::unique_ptr<LitBuffer> vertexBuffer;
+		std::unique_ptr<LitBuffer> indexBuffer;
+		RangeAllocator vertexRanges;
+		RangeAllocator indexRanges;
+	};
+}
@@ -0,0 +1,245 @@
+#include "LitGpuProfiler.h"
+#include "LitSwapChain.h"
+
+// std
+#include <stdexcept>
+
+namespace Lit
+{
+	static const VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+	// begin and end of every scope and of the frame
+	static const uint32_t TIMESTAMP_QUERIES = LitGpuProfiler::MAX_SCOPES * 2 + 2;
+
+	LitGpuProfiler::LitGpuProfiler(LitDevice& inDevice) : device{ inDevice }
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(device.GetPhysicalDevice(), &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(device.GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+		const uint32_t validBits = queueFamilies[device.GetGraphicsQueueFamily()].timestampValidBits;
+
+		const VkPhysicalDeviceProperties properties = device.GetPhysicalDeviceProperties();
+		bTimestamps = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+		bPipelineStatistics = bTimestamps && device.SupportsPipelineStatisticsQuery();
+		if (!bTimestamps)
+		{
+			return;
+		}
+		timestampPeriod = properties.limits.timestampPeriod;
+		timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+		frameHistory.name = "frame";
+
+		frames.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (auto& frame : frames)
+		{
+			VkQueryPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolInfo.queryCount = TIMESTAMP_QUERIES;
+			if (vkCreateQueryPool(device.GetDevice(), &poolInfo, nullptr, &frame.timestampPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create timestamp query pool!");
+			}
+
+			if (bPipelineStatistics)
+			{
+				poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+				poolInfo.queryCount = MAX_SCOPES;
+				poolInfo.pipelineStatistics = PIPELINE_STATISTICS;
+				if (vkCreateQueryPool(device.GetDevice(), &poolInfo, nullptr, &frame.statisticsPool) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to create pipeline statistics query pool!");
+				}
+			}
+		}
+	}
+
+	LitGpuProfiler::~LitGpuProfiler()
+	{
+		for (auto& frame : frames)
+		{
+			vkDestroyQueryPool(device.GetDevice(), frame.timestampPool, nullptr);
+			if (frame.statisticsPool != VK_NULL_HANDLE)
+			{
+				vkDestroyQueryPool(device.GetDevice(), frame.statisticsPool, nullptr);
+			}
+		}
+	}
+
+	void LitGpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, int frameIndex)
+	{
+		currentFrame = nullptr;
+		if (!bTimestamps)
+		{
+			return;
+		}
+
+		FrameQueries& frame = frames[frameIndex];
+		if (frame.bRecorded)
+		{
+			ReadResults(frame);
+		}
+		frame.scopes.clear();
+		frame.timestampCount = 0;
+		frame.statisticsCount = 0;
+		frame.bRecorded = false;
+		if (!bEnabled)
+		{
+			return;
+		}
+
+		// every query has to be reset before it is written again
+		vkCmdResetQueryPool(commandBuffer, frame.timestampPool, 0, TIMESTAMP_QUERIES);
+		if (frame.statisticsPool != VK_NULL_HANDLE)
+		{
+			vkCmdResetQueryPool(commandBuffer, frame.statisticsPool, 0, MAX_SCOPES);
+		}
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestampPool, frame.timestampCount++);
+		currentFrame = &frame;
+		depth = 0;
+		activeStatisticsScope = INVALID_SCOPE;
+	}
+
+	void LitGpuProfiler::EndFrame(VkCommandBuffer commandBuffer)
+	{
+		if (currentFrame == nullptr)
+		{
+			return;
+		}
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentFrame->timestampPool,
+			currentFrame->timestampCount++);
+		currentFrame->bRecorded = true;
+		currentFrame = nullptr;
+	}
+
+	uint32_t LitGpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name, bool bWantStatistics)
+	{
+		// scopes past MAX_SCOPES are not timed
+		if (currentFrame == nullptr || currentFrame->scopes.size() >= MAX_SCOPES)
+		{
+			return INVALID_SCOPE;
+		}
+
+		RecordedScope scope{};
+		scope.history = FindOrAddHistory(name, depth);
+		scope.beginQuery = currentFrame->timestampCount++;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentFrame->timestampPool, scope.beginQuery);
+
+		const uint32_t index = static_cast<uint32_t>(currentFrame->scopes.size());
+		if (bWantStatistics && bPipelineStatistics && activeStatisticsScope == INVALID_SCOPE)
+		{
+			scope.statisticsQuery = currentFrame->statisticsCount++;
+			vkCmdBeginQuery(commandBuffer, currentFrame->statisticsPool, scope.statisticsQuery, 0);
+			activeStatisticsScope = index;
+		}
+		currentFrame->scopes.push_back(scope);
+		depth++;
+		return index;
+	}
+
+	void LitGpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scopeIndex)
+	{
+		if (currentFrame == nullptr || scopeIndex == INVALID_SCOPE)
+		{
+			return;
+		}
+
+		RecordedScope& scope = currentFrame->scopes[scopeIndex];
+		if (scope.statisticsQuery != INVALID_SCOPE)
+		{
+			vkCmdEndQuery(commandBuffer, currentFrame->statisticsPool, scope.statisticsQuery);
+			activeStatisticsScope = INVALID_SCOPE;
+		}
+		scope.endQuery = currentFrame->timestampCount++;
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentFrame->timestampPool, scope.endQuery);
+		depth--;
+	}
+
+	void LitGpuProfiler::ReadResults(FrameQueries& frame)
+	{
+		// the frame was waited for before its index came round again, the results are there without waiting
+		std::vector<uint64_t> timestamps(frame.timestampCount);
+		if (vkGetQueryPoolResults(device.GetDevice(), frame.timestampPool, 0, frame.timestampCount,
+			timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		{
+			return;
+		}
+
+		std::vector<PipelineStatistics> statistics(frame.statisticsCount);
+		static_assert(sizeof(PipelineStatistics) == 5 * sizeof(uint64_t), "one value per PIPELINE_STATISTICS bit");
+		if (frame.statisticsCount > 0 && vkGetQueryPoolResults(device.GetDevice(), frame.statisticsPool, 0, frame.statisticsCount,
+			statistics.size() * sizeof(PipelineStatistics), statistics.data(), sizeof(PipelineStatistics), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		{
+			statistics.clear();
+		}
+
+		auto elapsedMilliseconds = [this, &timestamps](uint32_t begin, uint32_t end)
+		{
+			const uint64_t ticks = (timestamps[end] - timestamps[begin]) & timestampMask;
+			return static_cast<float>(static_cast<double>(ticks) * timestampPeriod / 1000000.0);
+		};
+
+		frameMilliseconds.assign(scopes.size(), 0.0f);
+		frameStatistics.assign(scopes.size(), PipelineStatistics{});
+		frameHasStatistics.assign(scopes.size(), false);
+		for (const auto& scope : frame.scopes)
+		{
+			if (scope.endQuery == INVALID_SCOPE)
+			{
+				continue;
+			}
+			frameMilliseconds[scope.history] += elapsedMilliseconds(scope.beginQuery, scope.endQuery);
+			if (scope.statisticsQuery != INVALID_SCOPE && scope.statisticsQuery < statistics.size())
+			{
+				const PipelineStatistics& queried = statistics[scope.statisticsQuery];
+				PipelineStatistics& sum = frameStatistics[scope.history];
+				sum.inputAssemblyPrimitives += queried.inputAssemblyPrimitives;
+				sum.vertexShaderInvocations += queried.vertexShaderInvocations;
+				sum.clippingPrimitives += queried.clippingPrimitives;
+				sum.fragmentShaderInvocations += queried.fragmentShaderInvocations;
+				sum.computeShaderInvocations += queried.computeShaderInvocations;
+				frameHasStatistics[scope.history] = true;
+			}
+		}
+
+		PushSample(frameHistory, elapsedMilliseconds(0, frame.timestampCount - 1));
+		for (size_t i = 0; i < scopes.size(); i++)
+		{
+			PushSample(scopes[i], frameMilliseconds[i]);
+			if (frameHasStatistics[i])
+			{
+				scopes[i].bHasStatistics = true;
+				scopes[i].statistics = frameStatistics[i];
+			}
+		}
+	}
+
+	uint32_t LitGpuProfiler::FindOrAddHistory(const char* name, uint32_t scopeDepth)
+	{
+		auto found = scopeIndices.find(name);
+		if (found != scopeIndices.end())
+		{
+			return found->second;
+		}
+
+		const uint32_t index = static_cast<uint32_t>(scopes.size());
+		ScopeHistory history{};
+		history.name = name;
+		history.depth = scopeDepth;
+		scopes.push_back(history);
+		scopeIndices.emplace(name, index);
+		return index;
+	}
+
+	void LitGpuProfiler::PushSample(ScopeHistory& history, float milliseconds)
+	{
+		history.milliseconds[history.historyOffset] = milliseconds;
+		history.historyOffset = (history.historyOffset + 1) % HISTORY_LENGTH;
+		history.lastMilliseconds = milliseconds;
+	}
+}
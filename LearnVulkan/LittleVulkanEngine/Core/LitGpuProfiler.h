@@ -0,0 +1,145 @@
+#pragma once
+#include "LitDevice.h"
+
+// std
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Lit
+{
+	// GPU time of named scopes from timestamp queries, and primitive and shader invocation counts of the scopes that
+	// ask for pipeline statistics. Every frame in flight has its own query pools, a frame reads the results of the
+	// last frame with the same index, which the swap chain already waited for, so reading back never stalls.
+	// Does nothing on queues without timestamps
+	class LitGpuProfiler
+	{
+	public:
+		static constexpr uint32_t MAX_SCOPES = 64;
+		static constexpr uint32_t HISTORY_LENGTH = 128;
+		static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+		struct PipelineStatistics
+		{
+			uint64_t inputAssemblyPrimitives = 0;
+			uint64_t vertexShaderInvocations = 0;
+			uint64_t clippingPrimitives = 0;
+			uint64_t fragmentShaderInvocations = 0;
+			uint64_t computeShaderInvocations = 0;
+		};
+
+		// the measurements of one name, scopes with the same name in a frame add up
+		struct ScopeHistory
+		{
+			std::string name;
+			// nesting of the first scope with this name, for indenting
+			uint32_t depth = 0;
+			// ring buffer, the newest sample is at historyOffset - 1. Frames the scope didn't run in count as 0
+			std::array<float, HISTORY_LENGTH> milliseconds{};
+			uint32_t historyOffset = 0;
+			float lastMilliseconds = 0.0f;
+			bool bHasStatistics = false;
+			PipelineStatistics statistics;
+		};
+
+		explicit LitGpuProfiler(LitDevice& device);
+		~LitGpuProfiler();
+
+		LitGpuProfiler(const LitGpuProfiler&) = delete;
+		LitGpuProfiler& operator=(const LitGpuProfiler&) = delete;
+
+		// the first and last commands of a frame, outside a render pass
+		void BeginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+		void EndFrame(VkCommandBuffer commandBuffer);
+
+		// scopes nest. Pipeline statistics need the scope to begin and end outside a render pass or in the same
+		// subpass, and only one scope at a time gets them, nested requests are timed only
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name, bool bPipelineStatistics = false);
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+		bool IsSupported() const { return bTimestamps; }
+		bool SupportsPipelineStatistics() const { return bPipelineStatistics; }
+		void SetEnabled(bool bInEnabled) { bEnabled = bInEnabled; }
+		bool IsEnabled() const { return bEnabled; }
+
+		// GPU time between BeginFrame and EndFrame of the newest frame read back
+		const ScopeHistory& GetFrameHistory() const { return frameHistory; }
+		// in the order they first ran
+		const std::vector<ScopeHistory>& GetScopes() const { return scopes; }
+
+	private:
+		struct RecordedScope
+		{
+			uint32_t history;
+			uint32_t beginQuery;
+			uint32_t endQuery = INVALID_SCOPE;
+			uint32_t statisticsQuery = INVALID_SCOPE;
+		};
+
+		struct FrameQueries
+		{
+			VkQueryPool timestampPool = VK_NULL_HANDLE;
+			VkQueryPool statisticsPool = VK_NULL_HANDLE;
+			std::vector<RecordedScope> scopes;
+			uint32_t timestampCount = 0;
+			uint32_t statisticsCount = 0;
+			bool bRecorded = false;
+		};
+
+		void ReadResults(FrameQueries& frame);
+		uint32_t FindOrAddHistory(const char* name, uint32_t depth);
+		static void PushSample(ScopeHistory& history, float milliseconds);
+
+		LitDevice& device;
+		bool bTimestamps = false;
+		bool bPipelineStatistics = false;
+		bool bEnabled = true;
+		// nanoseconds per timestamp tick
+		float timestampPeriod = 1.0f;
+		uint64_t timestampMask = ~0ull;
+
+		std::vector<FrameQueries> frames;
+		FrameQueries* currentFrame = nullptr;
+		uint32_t depth = 0;
+		uint32_t activeStatisticsScope = INVALID_SCOPE;
+
+		ScopeHistory frameHistory;
+		std::vector<ScopeHistory> scopes;
+		std::unordered_map<std::string, uint32_t> scopeIndices;
+		// per history, summed while reading back a frame
+		std::vector<float> frameMilliseconds;
+		std::vector<PipelineStatistics> frameStatistics;
+		std::vector<bool> frameHasStatistics;
+	};
+
+	// times the commands recorded during its lifetime, does nothing without a profiler
+	class LitGpuScope
+	{
+	public:
+		LitGpuScope(LitGpuProfiler* inProfiler, VkCommandBuffer inCommandBuffer, const char* name, bool bPipelineStatistics = false)
+			: profiler{ inProfiler }, commandBuffer{ inCommandBuffer }
+		{
+			if (profiler != nullptr)
+			{
+				scope = profiler->BeginScope(commandBuffer, name, bPipelineStatistics);
+			}
+		}
+		~LitGpuScope()
+		{
+			if (profiler != nullptr)
+			{
+				profiler->EndScope(commandBuffer, scope);
+			}
+		}
+
+		LitGpuScope(const LitGpuScope&) = delete;
+		LitGpuScope& operator=(const LitGpuScope&) = delete;
+
+	private:
+		LitGpuProfiler* profiler;
+		VkCommandBuffer commandBuffer;
+		uint32_t scope = LitGpuProfiler::INVALID_SCOPE;
+	};
+}
@@ -0,0 +1,600 @@
+#include "LitHeadlessApp.h"
+#include "LitCpuProfiler.h"
+#include "LitFrameInfo.h"
+#include "LitGpuProfiler.h"
+#include "LitRenderGraph.h"
+#include "LitRenderTarget.h"
+#include "LitSwapChain.h"
+#include "System/simple_render_system.h"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace Lit
+{
+	static const uint32_t ORBIT_FRAMES = 600;
+	// camera distance and height in scene bounding sphere radii
+	static const float ORBIT_DISTANCE = 2.5f;
+	static const float ORBIT_HEIGHT = 0.75f;
+	// what the systems get as frame time, the wall clock doesn't change what is rendered
+	static const float FIXED_FRAME_TIME = 1.0f / 60.0f;
+	static const float MIN_FAR_PLANE = 100.0f;
+
+	static std::string JsonString(const std::string& value)
+	{
+		std::string result = "\"";
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+			}
+			result += c;
+		}
+		return result + "\"";
+	}
+
+	// nearest rank of sorted values
+	static float Percentile(const std::vector<float>& sortedValues, uint32_t percent)
+	{
+		return sortedValues[std::min(sortedValues.size() * percent / 100, sortedValues.size() - 1)];
+	}
+
+	static void WriteMillisecondsJson(std::ostream& file, const char* name, std::vector<float> values)
+	{
+		file << "  " << JsonString(name) << ": ";
+		if (values.empty())
+		{
+			file << "null,\n";
+			return;
+		}
+		std::sort(values.begin(), values.end());
+		const double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+		file << "{ \"mean\": " << mean << ", \"p50\": " << Percentile(values, 50) << ", \"p90\": " << Percentile(values, 90)
+			<< ", \"p99\": " << Percentile(values, 99) << ", \"max\": " << values.back() << " },\n";
+	}
+
+	// comma separated, empty entries are skipped
+	static std::vector<std::string> SplitList(const std::string& list)
+	{
+		std::vector<std::string> entries;
+		for (size_t start = 0; start <= list.size();)
+		{
+			size_t end = std::min(list.find(',', start), list.size());
+			if (end > start)
+			{
+				entries.push_back(list.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		return entries;
+	}
+
+	static void WriteCountJson(std::ostream& file, const char* name, const std::vector<uint32_t>& values)
+	{
+		const double mean = values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+		const uint32_t max = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+		file << "  " << JsonString(name) << ": { \"mean\": " << mean << ", \"max\": " << max << " },\n";
+	}
+
+	LitHeadlessApp::LitHeadlessApp(const Options& inOptions) : options{ inOptions }
+	{
+		globalDescriptorPool = LitDescriptorPool::Builder(device)
+			.SetMaxSets(LitSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LitSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.Build();
+
+		textureManager.SetStreamingEnabled(options.bTextureStreaming);
+		LoadGameObjects();
+		// loading isn't part of the measurement
+		textureManager.WaitIdle();
+		if (options.cameraPathFile.empty())
+		{
+			cameraPath = LitCameraPath::CreateOrbit(sceneBounds, ORBIT_FRAMES * FIXED_FRAME_TIME, ORBIT_DISTANCE, ORBIT_HEIGHT);
+		}
+		else if (!cameraPath.Load(options.cameraPathFile))
+		{
+			throw std::runtime_error("failed to load camera path " + options.cameraPathFile + "!");
+		}
+	}
+
+	LitHeadlessApp::~LitHeadlessApp()
+	{
+	}
+
+	VkFormat LitHeadlessApp::ChooseColorFormat(LitDevice& device)
+	{
+		return device.FindSupportedFormat({ VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB },
+			VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+	}
+
+	LitHeadlessApp::Result LitHeadlessApp::Run()
+	{
+		LitCpuProfiler::SetThreadName("main");
+
+		VkDeviceSize uniformBufferSize = sizeof(GlobalUBO);
+		std::vector<std::unique_ptr<LitBuffer>> uboBuffers(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (auto& uboBuffer : uboBuffers)
+		{
+			uboBuffer = std::make_unique<LitBuffer>(device, uniformBufferSize, 1,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, MemoryCategory::Uniform);
+			uboBuffer->Map();
+		}
+		auto globalSetLayout = LitDescriptorSetLayout::Builder(device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.Build();
+		std::vector<VkDescriptorSet> globalDescriptorSets(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (int i = 0; i < globalDescriptorSets.size(); i++)
+		{
+			auto bufferInfo = uboBuffers[i]->DescriptorInfo();
+			LitDescriptorWriter(*globalSetLayout, *globalDescriptorPool)
+				.WriteBuffer(0, &bufferInfo)
+				.Build(globalDescriptorSets[i]);
+		}
+
+		SimpleRenderSystem simpleRenderSystem{ device, renderer.GetRenderPass(), globalSetLayout->GetDescriptorSetLayout(),
+			textureManager };
+		simpleRenderSystem.SetOcclusionCulling(options.bOcclusionCulling);
+		simpleRenderSystem.SetDepthPrePass(options.bDepthPrePass);
+		LitRenderTarget sceneTarget{ device, renderer.GetColorFormat(), renderer.GetDepthFormat() };
+		sceneTarget.Resize(options.extent);
+		LitRenderGraph renderGraph{ device };
+		LitGpuProfiler gpuProfiler{ device };
+		renderGraph.SetProfiler(&gpuProfiler);
+
+		if (options.captureInterval > 0)
+		{
+			VkDeviceSize pixelSize = 4;
+			for (int i = 0; i < LitSwapChain::MAX_FRAMES_IN_FLIGHT; i++)
+			{
+				readbackBuffers.push_back(std::make_unique<LitBuffer>(device, pixelSize, options.extent.width * options.extent.height,
+					VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, MemoryCategory::Staging));
+				readbackBuffers.back()->Map();
+			}
+			readbackFrames.assign(LitSwapChain::MAX_FRAMES_IN_FLIGHT, UINT32_MAX);
+		}
+
+		// far enough for the whole scene from anywhere on the path, generated scenes can be large
+		const LitSphere sceneSphere = sceneBounds.BoundingSphere();
+		float farPlane = MIN_FAR_PLANE;
+		for (const LitCameraPath::Keyframe& keyframe : cameraPath.GetKeyframes())
+		{
+			farPlane = std::max(farPlane, glm::length(keyframe.position - sceneSphere.center) + sceneSphere.radius);
+		}
+		LitCamera camera{};
+		camera.SetPerspectiveProjection(glm::radians(50.f),
+			static_cast<float>(options.extent.width) / static_cast<float>(options.extent.height), 0.1f, farPlane);
+
+		Result result{};
+		result.frameMilliseconds.reserve(options.frameCount);
+		result.drawCounts.reserve(options.frameCount);
+		result.stateChanges.reserve(options.frameCount);
+		auto runStart = std::chrono::high_resolution_clock::now();
+		const uint32_t totalFrameCount = options.warmupFrames + options.frameCount;
+		for (uint32_t frame = 0; frame < totalFrameCount; frame++)
+		{
+			LIT_CPU_ZONE("frame");
+			const bool bMeasured = frame >= options.warmupFrames;
+			const auto frameStart = std::chrono::high_resolution_clock::now();
+			if (frame == options.warmupFrames)
+			{
+				runStart = frameStart;
+			}
+			VkCommandBuffer commandBuffer = renderer.BeginFrame();
+			const int frameIndex = renderer.GetFrameIndex();
+			textureManager.Update();
+			// the frame that used the slot before is done, so are its timestamps and its copy
+			gpuProfiler.BeginFrame(commandBuffer, frameIndex);
+			if (frame >= options.warmupFrames + LitSwapChain::MAX_FRAMES_IN_FLIGHT && gpuProfiler.IsSupported())
+			{
+				result.gpuMilliseconds.push_back(gpuProfiler.GetFrameHistory().lastMilliseconds);
+			}
+			if (!readbackFrames.empty() && readbackFrames[frameIndex] != UINT32_MAX)
+			{
+				result.capturedFrameCount += WriteCapture(frameIndex) ? 1 : 0;
+			}
+
+			// the warmup frames stay at the start of the path
+			glm::vec3 cameraPosition;
+			glm::vec3 cameraRotation;
+			cameraPath.Sample(bMeasured ? (frame - options.warmupFrames) * FIXED_FRAME_TIME : 0.0f, cameraPosition, cameraRotation);
+			camera.SetViewYXZ(cameraPosition, cameraRotation);
+			FrameInfo frameInfo{ frameIndex, FIXED_FRAME_TIME, commandBuffer, camera, globalDescriptorSets[frameIndex], &gpuProfiler };
+
+			GlobalUBO ubo{};
+			ubo.projectionView = camera.GetProjection() * camera.GetView();
+			uboBuffers[frameIndex]->WriteToBuffer(&ubo);
+			uboBuffers[frameIndex]->QueueFlush();
+
+			UpdateSceneBvh();
+			simpleRenderSystem.PrepareGameObjects(frameInfo, gameObjects, sceneBvh, options.extent);
+
+			renderGraph.Reset();
+			// kept at the end of the graph as if it was presented, so the scene passes are never culled
+			auto sceneColor = renderGraph.ImportImage("scene color", sceneTarget.GetColorImage(frameIndex),
+				sceneTarget.GetColorImageView(frameIndex), sceneTarget.GetColorFormat(), sceneTarget.GetExtent(),
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+			auto sceneDepth = renderGraph.ImportImage("scene depth", sceneTarget.GetDepthImage(frameIndex),
+				sceneTarget.GetDepthImageView(frameIndex), sceneTarget.GetDepthFormat(), sceneTarget.GetExtent(),
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+			const VkClearColorValue clearColor{ { 0.1f, 0.2f, 0.4f, 1.0f } };
+			const VkClearDepthStencilValue clearDepth{ 1.0f, 0 };
+			renderGraph.AddGraphicsPass("scene", [&](LitRenderGraph::PassBuilder& builder)
+			{
+				sceneColor = builder.WriteColor(sceneColor, &clearColor);
+				sceneDepth = builder.WriteDepth(sceneDepth, &clearDepth);
+			}, [&](VkCommandBuffer) { simpleRenderSystem.RenderGameObjects(frameInfo); });
+			if (options.bOcclusionCulling)
+			{
+				renderGraph.AddComputePass("occlusion cull", [&](LitRenderGraph::PassBuilder& builder)
+				{
+					builder.ReadImage(sceneDepth, LitRenderGraph::ImageUsage::SampledCompute);
+					builder.SetSideEffect();
+				}, [&](VkCommandBuffer)
+				{
+					simpleRenderSystem.CullOccludedGameObjects(frameInfo, sceneTarget.GetDepthImageView(frameIndex));
+				});
+				renderGraph.AddGraphicsPass("late scene", [&](LitRenderGraph::PassBuilder& builder)
+				{
+					sceneColor = builder.WriteColor(sceneColor);
+					sceneDepth = builder.WriteDepth(sceneDepth);
+				}, [&](VkCommandBuffer) { simpleRenderSystem.RenderLateGameObjects(frameInfo); });
+			}
+			if (!readbackBuffers.empty() && frame % options.captureInterval == 0)
+			{
+				auto readback = renderGraph.ImportBuffer("readback", readbackBuffers[frameIndex]->GetBuffer());
+				renderGraph.AddComputePass("readback", [&](LitRenderGraph::PassBuilder& builder)
+				{
+					builder.ReadImage(sceneColor, LitRenderGraph::ImageUsage::TransferSrc);
+					builder.WriteBuffer(readback, LitRenderGraph::BufferUsage::TransferDst);
+					builder.SetSideEffect();
+				}, [&](VkCommandBuffer passCommandBuffer)
+				{
+					VkBufferImageCopy region{};
+					region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					region.imageSubresource.layerCount = 1;
+					region.imageExtent = { options.extent.width, options.extent.height, 1 };
+					vkCmdCopyImageToBuffer(passCommandBuffer, sceneTarget.GetColorImage(frameIndex), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						readbackBuffers[frameIndex]->GetBuffer(), 1, &region);
+
+					// the host reads the copy once the frame is done
+					VkMemoryBarrier hostBarrier{};
+					hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+					hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+					vkCmdPipelineBarrier(passCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+						1, &hostBarrier, 0, nullptr, 0, nullptr);
+				});
+				readbackFrames[frameIndex] = frame;
+			}
+			{
+				LIT_CPU_ZONE("compile render graph");
+				renderGraph.Compile(frameIndex);
+			}
+			{
+				LIT_CPU_ZONE("record commands");
+				renderGraph.Execute(commandBuffer);
+			}
+			gpuProfiler.EndFrame(commandBuffer);
+			renderer.EndFrame();
+			if (bMeasured)
+			{
+				result.frameMilliseconds.push_back(std::chrono::duration<float, std::milli>(
+					std::chrono::high_resolution_clock::now() - frameStart).count());
+				const RenderQueueStatistics& sceneStatistics = simpleRenderSystem.GetRenderQueueStatistics();
+				const RenderQueueStatistics& prePassStatistics = simpleRenderSystem.GetDepthPrePassStatistics();
+				result.drawCounts.push_back(sceneStatistics.drawCount + prePassStatistics.drawCount);
+				result.stateChanges.push_back(sceneStatistics.StateChanges() + prePassStatistics.StateChanges());
+			}
+		}
+		LitMemoryBudget& memoryBudget = device.GetMemoryBudget();
+		result.memory = memoryBudget.GetStatistics();
+		result.memoryHeaps = memoryBudget.GetHeapStatistics();
+		for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+		{
+			result.memoryCategories.push_back(memoryBudget.GetCategoryStatistics(static_cast<MemoryCategory>(i)));
+		}
+		vkDeviceWaitIdle(device.GetDevice());
+		result.totalMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - runStart).count();
+
+		for (int i = 0; i < static_cast<int>(readbackFrames.size()); i++)
+		{
+			if (readbackFrames[i] != UINT32_MAX)
+			{
+				result.capturedFrameCount += WriteCapture(i) ? 1 : 0;
+			}
+		}
+		readbackBuffers.clear();
+		device.GetDeletionQueue().Flush();
+
+		const double averageMilliseconds = options.frameCount > 0 ? result.totalMilliseconds / options.frameCount : 0.0;
+		std::cout << device.GetPhysicalDeviceProperties().deviceName << ": " << options.frameCount << " frames at "
+			<< options.extent.width << "x" << options.extent.height << " in " << result.totalMilliseconds << " ms, "
+			<< averageMilliseconds << " ms/frame (" << (averageMilliseconds > 0.0 ? 1000.0 / averageMilliseconds : 0.0)
+			<< " fps), " << result.capturedFrameCount << " frames written" << std::endl;
+		if (!options.jsonFile.empty() && !WriteJson(result))
+		{
+			throw std::runtime_error("failed to write " + options.jsonFile + "!");
+		}
+		return result;
+	}
+
+	void LitHeadlessApp::LoadGameObjects()
+	{
+		LIT_CPU_ZONE("load game objects");
+		LitModel::LoadOptions loadOptions{};
+		loadOptions.geometryPool = &geometryPool;
+		if (options.bGenerateScene)
+		{
+			std::vector<std::shared_ptr<LitModel>> models;
+			for (const std::string& modelFile : options.scene.modelFiles)
+			{
+				models.push_back(LitModel::CreateModelFromFile(device, modelFile, loadOptions));
+			}
+			std::vector<std::shared_ptr<LitTexture>> textures;
+			for (const std::string& textureFile : options.scene.textureFiles)
+			{
+				textures.push_back(textureManager.Load(textureFile));
+			}
+			LitSceneGenerator::Generate(options.scene, models, textures, gameObjects);
+			UpdateSceneBvh();
+			return;
+		}
+
+		// the scene of LitApp
+		std::shared_ptr<LitModel> litModel = LitModel::CreateModelFromFile(device, "../models/smooth_vase.obj", loadOptions);
+		auto smoothVase = LitGameObject::CreateGameObject();
+		smoothVase.model = litModel;
+		smoothVase.texture = textureManager.Load("../textures/stripes.ltex");
+		smoothVase.transform.translation = glm::vec3{ .5f, .5f, 2.5f };
+		smoothVase.transform.scale = glm::vec3{ 3.f, 1.5f, 3.f };
+		gameObjects.push_back(std::move(smoothVase));
+
+		UpdateSceneBvh();
+	}
+
+	void LitHeadlessApp::UpdateSceneBvh()
+	{
+		// the objects never move, only new ones are inserted
+		for (uint32_t i = static_cast<uint32_t>(gameObjectProxies.size()); i < static_cast<uint32_t>(gameObjects.size()); i++)
+		{
+			const LitAABB bounds = gameObjects[i].model->GetBounds().Transform(gameObjects[i].transform.mat4());
+			gameObjectProxies.push_back(sceneBvh.Insert(bounds, i));
+			sceneBounds.Expand(bounds);
+		}
+	}
+
+	bool LitHeadlessApp::WriteCapture(int frameIndex)
+	{
+		LIT_CPU_ZONE("write capture");
+		const uint32_t frame = readbackFrames[frameIndex];
+		readbackFrames[frameIndex] = UINT32_MAX;
+		LitBuffer& buffer = *readbackBuffers[frameIndex];
+		if (!buffer.IsHostCoherent() && buffer.Invalidate() != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		char fileName[32];
+		std::snprintf(fileName, sizeof(fileName), "frame_%05u.ppm", frame);
+		std::ofstream file{ options.captureDirectory + "/" + fileName, std::ios::binary };
+		if (!file)
+		{
+			std::cerr << "failed to write " << options.captureDirectory << "/" << fileName << std::endl;
+			return false;
+		}
+		file << "P6\n" << options.extent.width << " " << options.extent.height << "\n255\n";
+
+		const bool bBgra = renderer.GetColorFormat() == VK_FORMAT_B8G8R8A8_SRGB;
+		const uint8_t* pixels = static_cast<const uint8_t*>(buffer.GetMappedMemory());
+		std::vector<uint8_t> row(options.extent.width * 3);
+		for (uint32_t y = 0; y < options.extent.height; y++)
+		{
+			for (uint32_t x = 0; x < options.extent.width; x++)
+			{
+				const uint8_t* pixel = pixels + (static_cast<size_t>(y) * options.extent.width + x) * 4;
+				row[x * 3 + 0] = pixel[bBgra ? 2 : 0];
+				row[x * 3 + 1] = pixel[1];
+				row[x * 3 + 2] = pixel[bBgra ? 0 : 2];
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), row.size());
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool LitHeadlessApp::WriteJson(const Result& result)
+	{
+		std::ofstream file{ options.jsonFile };
+		if (!file)
+		{
+			return false;
+		}
+		file << "{\n";
+		file << "  \"device\": " << JsonString(device.GetPhysicalDeviceProperties().deviceName) << ",\n";
+		file << "  \"extent\": [" << options.extent.width << ", " << options.extent.height << "],\n";
+		file << "  \"frames\": " << options.frameCount << ",\n";
+		file << "  \"warmup_frames\": " << options.warmupFrames << ",\n";
+		file << "  \"occlusion_culling\": " << (options.bOcclusionCulling ? "true" : "false") << ",\n";
+		file << "  \"depth_pre_pass\": " << (options.bDepthPrePass ? "true" : "false") << ",\n";
+		file << "  \"texture_streaming\": " << (options.bTextureStreaming ? "true" : "false") << ",\n";
+		file << "  \"camera_path\": " << (options.cameraPathFile.empty() ? JsonString("orbit") : JsonString(options.cameraPathFile)) << ",\n";
+		file << "  \"scene\": { \"layout\": " << JsonString(options.bGenerateScene ? LitSceneGenerator::GetLayoutName(options.scene.layout) : "app");
+		if (options.bGenerateScene)
+		{
+			file << ", \"seed\": " << options.scene.seed << ", \"models\": [";
+			for (size_t i = 0; i < options.scene.modelFiles.size(); i++)
+			{
+				file << (i > 0 ? ", " : "") << JsonString(options.scene.modelFiles[i]);
+			}
+			file << "], \"textures\": [";
+			for (size_t i = 0; i < options.scene.textureFiles.size(); i++)
+			{
+				file << (i > 0 ? ", " : "") << JsonString(options.scene.textureFiles[i]);
+			}
+			file << "]";
+		}
+		file << ", \"objects\": " << gameObjects.size() << " },\n";
+
+		file << "  \"total_ms\": " << result.totalMilliseconds << ",\n";
+		WriteMillisecondsJson(file, "cpu_frame_ms", result.frameMilliseconds);
+		WriteMillisecondsJson(file, "gpu_frame_ms", result.gpuMilliseconds);
+		WriteCountJson(file, "draws", result.drawCounts);
+		WriteCountJson(file, "state_changes", result.stateChanges);
+		const LitTextureManager::Statistics textureStatistics = textureManager.GetStatistics();
+		file << "  \"textures\": { \"count\": " << textureStatistics.textureCount << ", \"resident\": "
+			<< textureStatistics.residentCount << ", \"failed\": " << textureStatistics.failedCount << ", \"resident_bytes\": "
+			<< textureStatistics.residentBytes << ", \"compressed\": " << textureStatistics.compressedCount << ", \"cpu_decoded\": "
+			<< textureStatistics.cpuDecodedCount << ", \"system_bytes\": " << textureStatistics.systemBytes
+			<< ", \"streamed_levels\": " << textureStatistics.streamedLevelCount << ", \"streamed_in\": "
+			<< textureStatistics.streamedInCount << ", \"streamed_out\": " << textureStatistics.streamedOutCount
+			<< ", \"samplers\": " << textureStatistics.samplerCount << " },\n";
+
+		file << "  \"memory\": {\n    \"allocated_bytes\": " << result.memory.allocatedBytes << ", \"used_bytes\": "
+			<< result.memory.usedBytes << ", \"peak_allocated_bytes\": " << result.memory.peakAllocatedBytes
+			<< ", \"allocations\": " << result.memory.allocationCount << ", \"budget_extension\": "
+			<< (device.GetMemoryBudget().UsesBudgetExtension() ? "true" : "false") << ",\n    \"heaps\": [";
+		for (size_t i = 0; i < result.memoryHeaps.size(); i++)
+		{
+			const LitMemoryBudget::HeapStatistics& heap = result.memoryHeaps[i];
+			file << (i > 0 ? ", " : "") << "{ \"size\": " << heap.size << ", \"device_local\": " << (heap.bDeviceLocal ? "true" : "false")
+				<< ", \"budget\": " << heap.budget << ", \"usage\": " << heap.usage << ", \"allocated_bytes\": " << heap.allocatedBytes
+				<< ", \"used_bytes\": " << heap.usedBytes << " }";
+		}
+		file << "],\n    \"categories\": {";
+		for (size_t i = 0; i < result.memoryCategories.size(); i++)
+		{
+			const LitMemoryBudget::CategoryStatistics& category = result.memoryCategories[i];
+			file << (i > 0 ? ", " : " ") << JsonString(LitMemoryBudget::GetCategoryName(static_cast<MemoryCategory>(i)))
+				<< ": { \"allocated_bytes\": " << category.allocatedBytes << ", \"used_bytes\": " << category.usedBytes
+				<< ", \"peak_allocated_bytes\": " << category.peakAllocatedBytes << " }";
+		}
+		file << " }\n  }\n";
+		file << "}\n";
+		return static_cast<bool>(file);
+	}
+
+	bool LitHeadlessApp::ParseCommandLine(int argc, char** argv, Options& options)
+	{
+		// the windowed app ignores its command line
+		if (std::find_if(argv + 1, argv + argc, [](const char* arg) { return std::strcmp(arg, "--headless") == 0; }) == argv + argc)
+		{
+			return false;
+		}
+
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			// for the options that take one
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			if (std::strcmp(arg, "--headless") == 0)
+			{
+				continue;
+			}
+			if (std::strcmp(arg, "--occlusion-culling") == 0)
+			{
+				options.bOcclusionCulling = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--depth-pre-pass") == 0)
+			{
+				options.bDepthPrePass = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--no-texture-streaming") == 0)
+			{
+				options.bTextureStreaming = false;
+				continue;
+			}
+			if (value == nullptr)
+			{
+				throw std::runtime_error(std::string("unknown option or missing value: ") + arg);
+			}
+			if (std::strcmp(arg, "--frames") == 0)
+			{
+				options.frameCount = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--size") == 0)
+			{
+				unsigned int width = 0;
+				unsigned int height = 0;
+				if (std::sscanf(value, "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+				{
+					throw std::runtime_error(std::string("invalid size, expected WIDTHxHEIGHT: ") + value);
+				}
+				options.extent = VkExtent2D{ width, height };
+			}
+			else if (std::strcmp(arg, "--capture") == 0)
+			{
+				options.captureInterval = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--output") == 0)
+			{
+				options.captureDirectory = value;
+			}
+			else if (std::strcmp(arg, "--warmup") == 0)
+			{
+				options.warmupFrames = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--json") == 0)
+			{
+				options.jsonFile = value;
+			}
+			else if (std::strcmp(arg, "--camera-path") == 0)
+			{
+				options.cameraPathFile = value;
+			}
+			else if (std::strcmp(arg, "--scene") == 0)
+			{
+				if (!LitSceneGenerator::ParseLayout(value, options.scene.layout))
+				{
+					throw std::runtime_error(std::string("unknown scene layout, expected grid, cloud or hierarchy: ") + value);
+				}
+				options.bGenerateScene = true;
+			}
+			else if (std::strcmp(arg, "--instances") == 0)
+			{
+				options.scene.instanceCount = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--seed") == 0)
+			{
+				options.scene.seed = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--branches") == 0)
+			{
+				options.scene.branchCount = static_cast<uint32_t>(std::stoul(value));
+			}
+			else if (std::strcmp(arg, "--models") == 0)
+			{
+				options.scene.modelFiles = SplitList(value);
+				if (options.scene.modelFiles.empty())
+				{
+					throw std::runtime_error("--models needs at least one model");
+				}
+			}
+			else if (std::strcmp(arg, "--textures") == 0)
+			{
+				options.scene.textureFiles.clear();
+				if (std::strcmp(value, "none") != 0)
+				{
+					options.scene.textureFiles = SplitList(value);
+				}
+			}
+			else
+			{
+				throw std::runtime_error(std::string("unknown option: ") + arg);
+			}
+			i++;
+		}
+		return true;
+	}
+}
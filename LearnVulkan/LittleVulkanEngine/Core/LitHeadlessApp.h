@@ -0,0 +1,108 @@
+#pragma once
+#include "LitDevice.h"
+#include "LitBuffer.h"
+#include "LitHeadlessRenderer.h"
+#include "LitDescriptors.h"
+#include "LitGameObject.h"
+#include "LitGeometryPool.h"
+#include "LitBvh.h"
+#include "LitCameraPath.h"
+#include "LitSceneGenerator.h"
+#include "LitTextureManager.h"
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// Renders the scene of LitApp or a generated one without a window or display, for benchmarking on build machines:
+	// a fixed number of frames from a camera that orbits the scene or replays a recorded path by frame number, so
+	// every run renders the same images. Works on software devices (lavapipe). Can read frames back and write them as
+	// binary PPM, and the measurements as JSON for comparing runs
+	class LitHeadlessApp
+	{
+	public:
+		struct Options
+		{
+			VkExtent2D extent{ 1280, 720 };
+			uint32_t frameCount = 600;
+			// every captureInterval-th frame is written to captureDirectory, 0 writes none
+			uint32_t captureInterval = 0;
+			std::string captureDirectory = ".";
+			bool bOcclusionCulling = false;
+			bool bDepthPrePass = false;
+			// off keeps every mip of every texture resident
+			bool bTextureStreaming = true;
+			// a generated scene instead of the one of LitApp
+			bool bGenerateScene = false;
+			LitSceneGenerator::Settings scene;
+			// a recorded path to replay (see LitCameraPath::Load), the orbit when empty
+			std::string cameraPathFile;
+			// rendered before the frameCount measured ones, from the start of the camera path
+			uint32_t warmupFrames = 0;
+			// the result is written here as JSON, not at all when empty
+			std::string jsonFile;
+		};
+
+		struct Result
+		{
+			// CPU time of each frame from its start to its submission, including waits for the GPU to free a frame slot
+			std::vector<float> frameMilliseconds;
+			// GPU time of the frames the timestamps were read back for, empty without timestamp support
+			std::vector<float> gpuMilliseconds;
+			// of each frame, the scene and depth pre-pass together
+			std::vector<uint32_t> drawCounts;
+			std::vector<uint32_t> stateChanges;
+			// at the end of the last frame, the peaks are over the whole run including loading
+			LitMemoryBudget::Statistics memory;
+			std::vector<LitMemoryBudget::HeapStatistics> memoryHeaps;
+			std::vector<LitMemoryBudget::CategoryStatistics> memoryCategories;
+			double totalMilliseconds = 0.0;
+			uint32_t capturedFrameCount = 0;
+		};
+
+		explicit LitHeadlessApp(const Options& options);
+		~LitHeadlessApp();
+
+		LitHeadlessApp(const LitHeadlessApp&) = delete;
+		LitHeadlessApp& operator=(const LitHeadlessApp&) = delete;
+
+		Result Run();
+
+		// reads the options after --headless, false when the command line has no --headless.
+		// --frames N, --size WxH, --capture N (every Nth frame), --output DIR, --occlusion-culling, --depth-pre-pass,
+		// --no-texture-streaming, --warmup N, --json FILE, --camera-path FILE, --scene grid|cloud|hierarchy, --instances N, --seed N,
+		// --models A.obj,B.obj, --textures A.tga,B.tga|none, --branches N
+		static bool ParseCommandLine(int argc, char** argv, Options& options);
+
+	private:
+		// 8 bit RGBA or BGRA, whichever the device renders to
+		static VkFormat ChooseColorFormat(LitDevice& device);
+		void LoadGameObjects();
+		void UpdateSceneBvh();
+		// writes the frame read back into the buffer of frameIndex
+		bool WriteCapture(int frameIndex);
+		bool WriteJson(const Result& result);
+
+		Options options;
+		LitDevice device;
+		LitHeadlessRenderer renderer{ device, ChooseColorFormat(device) };
+
+		std::unique_ptr<LitDescriptorPool> globalDescriptorPool{};
+		// declared before gameObjects so the models release their ranges before the pool goes away
+		LitGeometryPool geometryPool{ device };
+		// declared before gameObjects for the same reason, the textures free their descriptor sets from its pool
+		LitTextureManager textureManager{ device };
+		std::vector<LitGameObject> gameObjects;
+		LitBvh sceneBvh;
+		std::vector<LitBvh::ProxyId> gameObjectProxies;
+		LitAABB sceneBounds;
+		LitCameraPath cameraPath;
+
+		// per frame in flight, the frame number waiting in it to be written or UINT32_MAX
+		std::vector<std::unique_ptr<LitBuffer>> readbackBuffers;
+		std::vector<uint32_t> readbackFrames;
+	};
+}
@@ -0,0 +1,133 @@
+#include "LitHeadlessRenderer.h"
+#include "LitCpuProfiler.h"
+#include "LitSwapChain.h"
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace Lit
+{
+	LitHeadlessRenderer::LitHeadlessRenderer(LitDevice& inDevice, VkFormat inColorFormat)
+		: device{ inDevice }, colorFormat{ inColorFormat }
+	{
+		depthFormat = device.FindSupportedFormat(
+			{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		CreateRenderPass();
+
+		commandBuffers.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		frameTimelineValues.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT, 0);
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = device.GetCommandPool();
+		allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+		if (vkAllocateCommandBuffers(device.GetDevice(), &allocInfo, commandBuffers.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate command buffers!");
+		}
+	}
+
+	LitHeadlessRenderer::~LitHeadlessRenderer()
+	{
+		vkFreeCommandBuffers(device.GetDevice(), device.GetCommandPool(),
+			static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+		vkDestroyRenderPass(device.GetDevice(), renderPass, nullptr);
+	}
+
+	int LitHeadlessRenderer::GetFrameIndex() const
+	{
+		assert(bIsFrameStarted && "Cannot get frame index when frame not in progress");
+		return currentFrameIndex;
+	}
+
+	VkCommandBuffer LitHeadlessRenderer::BeginFrame()
+	{
+		assert(!bIsFrameStarted && "Can't call beginFrame while already in progress");
+		LIT_CPU_ZONE("begin frame");
+		{
+			// the command buffer of the slot has to be done before it is recorded again
+			LIT_CPU_ZONE("wait for frame slot");
+			device.GetTimeline().Wait(frameTimelineValues[currentFrameIndex]);
+		}
+		bIsFrameStarted = true;
+		device.GetDeletionQueue().BeginFrame();
+		device.GetMemoryBudget().Update();
+
+		VkCommandBuffer commandBuffer = commandBuffers[currentFrameIndex];
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to begin recording command buffer!");
+		}
+		return commandBuffer;
+	}
+
+	void LitHeadlessRenderer::EndFrame()
+	{
+		assert(bIsFrameStarted && "Can't call endFrame while frame is not in progress");
+		LIT_CPU_ZONE("end frame");
+		VkCommandBuffer commandBuffer = commandBuffers[currentFrameIndex];
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to record command buffer!");
+		}
+		if (device.FlushMappedMemoryRanges() != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to flush mapped memory ranges!");
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		lastFrameTimelineValue = device.GetTimeline().Submit(device.GetGraphicsQueue(), submitInfo);
+		frameTimelineValues[currentFrameIndex] = lastFrameTimelineValue;
+		device.GetDeletionQueue().EndFrame(lastFrameTimelineValue);
+
+		bIsFrameStarted = false;
+		currentFrameIndex = (currentFrameIndex + 1) % LitSwapChain::MAX_FRAMES_IN_FLIGHT;
+	}
+
+	void LitHeadlessRenderer::CreateRenderPass()
+	{
+		// only the formats matter for compatibility, the render graph makes the passes that actually run
+		VkAttachmentDescription colorAttachment{};
+		colorAttachment.format = colorFormat;
+		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription depthAttachment = colorAttachment;
+		depthAttachment.format = depthFormat;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference colorAttachmentRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthAttachmentRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &colorAttachmentRef;
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+		const std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		if (vkCreateRenderPass(device.GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create render pass!");
+		}
+	}
+}
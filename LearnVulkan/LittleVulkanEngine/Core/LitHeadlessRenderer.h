@@ -0,0 +1,49 @@
+#pragma once
+#include "LitDevice.h"
+
+// std
+#include <array>
+#include <vector>
+
+namespace Lit
+{
+	// The frame loop of LitRenderer without a swap chain: no image to acquire and nothing to present. Frames render
+	// into offscreen images the app owns (see LitRenderTarget) and are only submitted, a frame slot waits on the
+	// timeline for the frame that last used it
+	class LitHeadlessRenderer
+	{
+	public:
+		LitHeadlessRenderer(LitDevice& device, VkFormat colorFormat);
+		~LitHeadlessRenderer();
+
+		LitHeadlessRenderer(const LitHeadlessRenderer&) = delete;
+		LitHeadlessRenderer& operator=(const LitHeadlessRenderer&) = delete;
+
+		// compatible with passes over one color and one depth attachment of the formats below, for creating pipelines
+		VkRenderPass GetRenderPass() const { return renderPass; }
+		VkFormat GetColorFormat() const { return colorFormat; }
+		VkFormat GetDepthFormat() const { return depthFormat; }
+
+		bool IsFrameInProgress() const { return bIsFrameStarted; }
+		int GetFrameIndex() const;
+		// device timeline value that is reached once the GPU finished the last frame, see LitTimeline
+		uint64_t GetLastFrameTimelineValue() const { return lastFrameTimelineValue; }
+
+		VkCommandBuffer BeginFrame();
+		void EndFrame();
+
+	private:
+		void CreateRenderPass();
+
+		LitDevice& device;
+		VkFormat colorFormat;
+		VkFormat depthFormat;
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> commandBuffers;
+		std::vector<uint64_t> frameTimelineValues;
+
+		int currentFrameIndex = 0;
+		bool bIsFrameStarted = false;
+		uint64_t lastFrameTimelineValue = 0;
+	};
+}
@@ -0,0 +1,264 @@
+#include "LitHzbPyramid.h"
+#include "LitSwapChain.h"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace Lit
+{
+	// the reduce shader has no mip loop, one dispatch per level and at most this many levels (a 32k texture)
+	static const uint32_t MAX_PYRAMID_MIPS = 16;
+	static const uint32_t REDUCE_GROUP_SIZE = 8;
+
+	struct ReducePushConstants
+	{
+		int32_t inputSize[2];
+		int32_t outputSize[2];
+	};
+
+	static uint32_t PreviousPowerOfTwo(uint32_t value)
+	{
+		uint32_t result = 1;
+		while (result * 2 <= value)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+
+	static VkImageView CreateMipView(LitDevice& device, VkImage image, uint32_t mip)
+	{
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = mip;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		VkImageView imageView;
+		if (vkCreateImageView(device.GetDevice(), &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create depth pyramid image view!");
+		}
+		return imageView;
+	}
+
+	static VkImageMemoryBarrier ImageBarrier(VkImage image, VkImageAspectFlags aspectMask, uint32_t baseMip, uint32_t mipCount,
+		VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = aspectMask;
+		barrier.subresourceRange.baseMipLevel = baseMip;
+		barrier.subresourceRange.levelCount = mipCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		return barrier;
+	}
+
+	LitHzbPyramid::LitHzbPyramid(LitDevice& inDevice) : device{ inDevice }
+	{
+		setLayout = LitDescriptorSetLayout::Builder(device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+			.Build();
+		descriptorPool = LitDescriptorPool::Builder(device)
+			.SetMaxSets(LitSwapChain::MAX_FRAMES_IN_FLIGHT * MAX_PYRAMID_MIPS)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, LitSwapChain::MAX_FRAMES_IN_FLIGHT * MAX_PYRAMID_MIPS)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, LitSwapChain::MAX_FRAMES_IN_FLIGHT * MAX_PYRAMID_MIPS)
+			.Build();
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(ReducePushConstants);
+
+		VkDescriptorSetLayout descriptorSetLayout = setLayout->GetDescriptorSetLayout();
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(device.GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+		reducePipeline = std::make_unique<LitComputePipeline>(device, "../Shaders/Spv/hzb_reduce.comp.spv", pipelineLayout);
+
+		// texelFetch only, the sampler just has to exist for the combined image sampler descriptors
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(MAX_PYRAMID_MIPS);
+		sampler = device.GetSamplerCache().GetSampler(samplerInfo);
+	}
+
+	LitHzbPyramid::~LitHzbPyramid()
+	{
+		DestroyResources();
+		reducePipeline = nullptr;
+		vkDestroyPipelineLayout(device.GetDevice(), pipelineLayout, nullptr);
+	}
+
+	void LitHzbPyramid::Resize(VkExtent2D inDepthExtent)
+	{
+		if (inDepthExtent.width == depthExtent.width && inDepthExtent.height == depthExtent.height)
+		{
+			return;
+		}
+
+		// the reduction reads whatever extent it is given, only a new pyramid size needs new images. Keeps
+		// dynamic resolution from waiting on the device for every scale change
+		if (image != VK_NULL_HANDLE && PreviousPowerOfTwo(inDepthExtent.width) == width &&
+			PreviousPowerOfTwo(inDepthExtent.height) == height)
+		{
+			depthExtent = inDepthExtent;
+			return;
+		}
+
+		// frames in flight still sample the old pyramid, resizes are rare enough to simply wait for them
+		vkDeviceWaitIdle(device.GetDevice());
+		DestroyResources();
+		depthExtent = inDepthExtent;
+		CreateResources();
+	}
+
+	void LitHzbPyramid::CreateResources()
+	{
+		width = PreviousPowerOfTwo(depthExtent.width);
+		height = PreviousPowerOfTwo(depthExtent.height);
+		mipCount = 1;
+		while ((std::max(width, height) >> mipCount) > 0 && mipCount < MAX_PYRAMID_MIPS)
+		{
+			mipCount++;
+		}
+
+		device.CreateImage(width, height, mipCount, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			MemoryCategory::Depth, image, imageMemory, 0, 1);
+		imageView = device.CreateImageView(image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, mipCount, VK_IMAGE_VIEW_TYPE_2D);
+		mipViews.resize(mipCount);
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			mipViews[mip] = CreateMipView(device, image, mip);
+		}
+
+		// the culling shader binds the pyramid before the first Build, so it has to be in GENERAL from the start
+		VkCommandBuffer commandBuffer = device.BeginSingleTimeCommands();
+		VkImageMemoryBarrier barrier = ImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount,
+			0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+		device.EndSingleTimeCommands(commandBuffer);
+
+		descriptorSets.assign(LitSwapChain::MAX_FRAMES_IN_FLIGHT, std::vector<VkDescriptorSet>(mipCount, VK_NULL_HANDLE));
+		for (auto& frameSets : descriptorSets)
+		{
+			for (uint32_t mip = 0; mip < mipCount; mip++)
+			{
+				if (!descriptorPool->AllocateDescriptor(setLayout->GetDescriptorSetLayout(), frameSets[mip]))
+				{
+					throw std::runtime_error("failed to allocate depth pyramid descriptor set!");
+				}
+				if (mip == 0)
+				{
+					// written every frame in Build, the depth view depends on the swap chain image
+					continue;
+				}
+
+				VkDescriptorImageInfo inputInfo{ sampler, mipViews[mip - 1], VK_IMAGE_LAYOUT_GENERAL };
+				VkDescriptorImageInfo outputInfo{ VK_NULL_HANDLE, mipViews[mip], VK_IMAGE_LAYOUT_GENERAL };
+				LitDescriptorWriter(*setLayout, *descriptorPool)
+					.WriteImage(0, &inputInfo)
+					.WriteImage(1, &outputInfo)
+					.OverWrite(frameSets[mip]);
+			}
+		}
+	}
+
+	void LitHzbPyramid::DestroyResources()
+	{
+		if (image == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		descriptorPool->ResetPool();
+		descriptorSets.clear();
+		for (auto mipView : mipViews)
+		{
+			vkDestroyImageView(device.GetDevice(), mipView, nullptr);
+		}
+		mipViews.clear();
+		vkDestroyImageView(device.GetDevice(), imageView, nullptr);
+		vkDestroyImage(device.GetDevice(), image, nullptr);
+		device.FreeMemory(imageMemory);
+		image = VK_NULL_HANDLE;
+		imageMemory = VK_NULL_HANDLE;
+		imageView = VK_NULL_HANDLE;
+	}
+
+	void LitHzbPyramid::Build(VkCommandBuffer commandBuffer, int frameIndex, VkImageView depthView)
+	{
+		assert(image != VK_NULL_HANDLE && "Resize the pyramid before building it");
+
+		// the previous frame may still read the pyramid, its content is rebuilt from scratch
+		VkImageMemoryBarrier pyramidBarrier = ImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount,
+			0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &pyramidBarrier);
+
+		std::vector<VkDescriptorSet>& frameSets = descriptorSets[frameIndex];
+		VkDescriptorImageInfo depthInfo{ sampler, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+		VkDescriptorImageInfo outputInfo{ VK_NULL_HANDLE, mipViews[0], VK_IMAGE_LAYOUT_GENERAL };
+		LitDescriptorWriter(*setLayout, *descriptorPool)
+			.WriteImage(0, &depthInfo)
+			.WriteImage(1, &outputInfo)
+			.OverWrite(frameSets[0]);
+
+		reducePipeline->Bind(commandBuffer);
+		int32_t inputWidth = static_cast<int32_t>(depthExtent.width);
+		int32_t inputHeight = static_cast<int32_t>(depthExtent.height);
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			const int32_t outputWidth = std::max(static_cast<int32_t>(width >> mip), 1);
+			const int32_t outputHeight = std::max(static_cast<int32_t>(height >> mip), 1);
+
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frameSets[mip], 0, nullptr);
+			ReducePushConstants push{ { inputWidth, inputHeight }, { outputWidth, outputHeight } };
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+			vkCmdDispatch(commandBuffer,
+				(outputWidth + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE,
+				(outputHeight + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, 1);
+
+			// the next level reads this one, the culling shader reads them all
+			VkImageMemoryBarrier mipBarrier = ImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, mip, 1,
+				VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &mipBarrier);
+
+			inputWidth = outputWidth;
+			inputHeight = outputHeight;
+		}
+	}
+}
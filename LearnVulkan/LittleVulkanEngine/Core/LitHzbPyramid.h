@@ -0,0 +1,63 @@
+#pragma once
+#include "LitDevice.h"
+#include "LitDescriptors.h"
+#include "LitPipeline.h"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace Lit
+{
+	// Hierarchical Z: R32 mip chain where every texel holds the farthest depth of the area it covers. Mip 0 is the
+	// largest power of two not above the depth extent, built from the depth attachment by hzb_reduce.comp
+	class LitHzbPyramid
+	{
+	public:
+		LitHzbPyramid(LitDevice& device);
+		~LitHzbPyramid();
+
+		LitHzbPyramid(const LitHzbPyramid&) = delete;
+		LitHzbPyramid& operator=(const LitHzbPyramid&) = delete;
+
+		// area of the depth attachment that was rendered. Recreates the pyramid when its size changes,
+		// that waits for the device to be idle
+		void Resize(VkExtent2D depthExtent);
+
+		// outside a render pass: reduces depthImage into the pyramid. depthImage has to be in
+		// DEPTH_STENCIL_READ_ONLY_OPTIMAL with its writes visible to compute shaders, the render graph takes care of
+		// that. The pyramid is left in GENERAL with its writes visible to compute shaders
+		void Build(VkCommandBuffer commandBuffer, int frameIndex, VkImageView depthView);
+
+		VkImageView GetImageView() const { return imageView; }
+		VkSampler GetSampler() const { return sampler; }
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		uint32_t GetMipCount() const { return mipCount; }
+
+	private:
+		void CreateResources();
+		void DestroyResources();
+
+		LitDevice& device;
+
+		VkExtent2D depthExtent{ 0, 0 };
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipCount = 0;
+
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+		VkImageView imageView = VK_NULL_HANDLE;
+		std::vector<VkImageView> mipViews;
+		// owned by the sampler cache of the device
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		std::unique_ptr<LitDescriptorSetLayout> setLayout;
+		std::unique_ptr<LitDescriptorPool> descriptorPool;
+		// [frame in flight][mip], mip 0 reads the depth image of whichever swap chain image is rendered
+		std::vector<std::vector<VkDescriptorSet>> descriptorSets;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		std::unique_ptr<LitComputePipeline> reducePipeline;
+	};
+}
@@ -0,0 +1,492 @@
+#include "LitImage.h"
+
+// std
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace Lit
+{
+	static const size_t TGA_HEADER_SIZE = 18;
+	// maxImageDimension2D every desktop GPU supports
+	static const uint32_t MAX_DIMENSION = 16384;
+	// after the KTX2 one, which the file can't be mistaken for
+	static const uint8_t CONTAINER_IDENTIFIER[12] = { 0xab, 'L', 'T', 'X', ' ', '1', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+	// vkFormat, width, height and level count
+	static const size_t CONTAINER_HEADER_SIZE = sizeof(CONTAINER_IDENTIFIER) + 4 * sizeof(uint32_t);
+	// byte offset and length of a level
+	static const size_t CONTAINER_LEVEL_SIZE = 2 * sizeof(uint64_t);
+	static const size_t CONTAINER_ALIGNMENT = 16;
+
+	static bool ReadFile(const std::string& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		if (!file)
+		{
+			return false;
+		}
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	static bool CheckDimensions(uint32_t width, uint32_t height, std::string& error)
+	{
+		if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+		{
+			error = "unsupported size " + std::to_string(width) + "x" + std::to_string(height);
+			return false;
+		}
+		return true;
+	}
+
+	static bool DecodeTga(const std::vector<uint8_t>& data, bool bSrgb, LitImageData& image, std::string& error)
+	{
+		if (data.size() < TGA_HEADER_SIZE)
+		{
+			error = "truncated TGA header";
+			return false;
+		}
+		const uint8_t idLength = data[0];
+		const uint8_t colorMapType = data[1];
+		const uint8_t imageType = data[2];
+		const uint32_t width = data[12] | (data[13] << 8);
+		const uint32_t height = data[14] | (data[15] << 8);
+		const uint32_t bytesPerPixel = data[16] / 8;
+		const uint8_t descriptor = data[17];
+
+		// 2 and 3 are uncompressed true color and grayscale, 10 and 11 the same run length encoded
+		const bool bGray = imageType == 3 || imageType == 11;
+		const bool bRle = imageType == 10 || imageType == 11;
+		if (colorMapType != 0 || (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11))
+		{
+			error = "unsupported TGA type " + std::to_string(imageType);
+			return false;
+		}
+		if (bGray ? bytesPerPixel != 1 : (bytesPerPixel != 3 && bytesPerPixel != 4))
+		{
+			error = "unsupported TGA pixel depth " + std::to_string(data[16]);
+			return false;
+		}
+		if (!CheckDimensions(width, height, error))
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+		// BGR(A) or gray to RGBA
+		auto readPixel = [&](const uint8_t* source, uint8_t* destination)
+		{
+			if (bGray)
+			{
+				destination[0] = destination[1] = destination[2] = source[0];
+				destination[3] = 255;
+				return;
+			}
+			destination[0] = source[2];
+			destination[1] = source[1];
+			destination[2] = source[0];
+			destination[3] = bytesPerPixel == 4 ? source[3] : 255;
+		};
+
+		const size_t pixelCount = static_cast<size_t>(width) * height;
+		size_t offset = TGA_HEADER_SIZE + idLength;
+		size_t pixel = 0;
+		while (pixel < pixelCount)
+		{
+			// uncompressed data is one raw packet over the whole image
+			size_t count = pixelCount;
+			bool bRepeat = false;
+			if (bRle)
+			{
+				if (offset >= data.size())
+				{
+					error = "truncated TGA data";
+					return false;
+				}
+				const uint8_t packet = data[offset++];
+				count = (packet & 0x7f) + 1u;
+				bRepeat = (packet & 0x80) != 0;
+				if (count > pixelCount - pixel)
+				{
+					error = "corrupt TGA run";
+					return false;
+				}
+			}
+			const size_t packetBytes = bRepeat ? bytesPerPixel : count * bytesPerPixel;
+			if (offset + packetBytes > data.size())
+			{
+				error = "truncated TGA data";
+				return false;
+			}
+			for (size_t i = 0; i < count; i++, pixel++)
+			{
+				readPixel(&data[offset + (bRepeat ? 0 : i * bytesPerPixel)], &pixels[pixel * 4]);
+			}
+			offset += packetBytes;
+		}
+
+		// rows are stored bottom to top unless bit 5 of the descriptor is set, bit 4 stores them right to left
+		const size_t rowBytes = static_cast<size_t>(width) * 4;
+		if ((descriptor & 0x20) == 0)
+		{
+			for (uint32_t y = 0; y < height / 2; y++)
+			{
+				std::swap_ranges(pixels.begin() + y * rowBytes, pixels.begin() + (y + 1) * rowBytes,
+					pixels.begin() + (height - 1 - y) * rowBytes);
+			}
+		}
+		if ((descriptor & 0x10) != 0)
+		{
+			uint32_t* texels = reinterpret_cast<uint32_t*>(pixels.data());
+			for (uint32_t y = 0; y < height; y++)
+			{
+				std::reverse(texels + static_cast<size_t>(y) * width, texels + static_cast<size_t>(y + 1) * width);
+			}
+		}
+		image = LitImage::CreateRgba8(width, height, bSrgb, std::move(pixels));
+		return true;
+	}
+
+	// the next whitespace separated number of a PPM header, skipping comments
+	static bool ReadPpmNumber(const std::vector<uint8_t>& data, size_t& offset, uint32_t& value)
+	{
+		while (offset < data.size() && (std::isspace(data[offset]) || data[offset] == '#'))
+		{
+			if (data[offset] == '#')
+			{
+				while (offset < data.size() && data[offset] != '\n')
+				{
+					offset++;
+				}
+			}
+			else
+			{
+				offset++;
+			}
+		}
+		if (offset >= data.size() || !std::isdigit(data[offset]))
+		{
+			return false;
+		}
+		value = 0;
+		while (offset < data.size() && std::isdigit(data[offset]) && value <= MAX_DIMENSION)
+		{
+			value = value * 10 + (data[offset++] - '0');
+		}
+		return true;
+	}
+
+	static bool DecodePpm(const std::vector<uint8_t>& data, bool bSrgb, LitImageData& image, std::string& error)
+	{
+		size_t offset = 2;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t maxValue = 0;
+		if (!ReadPpmNumber(data, offset, width) || !ReadPpmNumber(data, offset, height) ||
+			!ReadPpmNumber(data, offset, maxValue))
+		{
+			error = "corrupt PPM header";
+			return false;
+		}
+		if (maxValue == 0 || maxValue > 255)
+		{
+			error = "unsupported PPM maximum " + std::to_string(maxValue);
+			return false;
+		}
+		if (!CheckDimensions(width, height, error))
+		{
+			return false;
+		}
+		// a single whitespace separates the header from the samples
+		offset++;
+		const size_t pixelCount = static_cast<size_t>(width) * height;
+		if (offset + pixelCount * 3 > data.size())
+		{
+			error = "truncated PPM data";
+			return false;
+		}
+
+		std::vector<uint8_t> pixels(pixelCount * 4);
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				pixels[i * 4 + c] = static_cast<uint8_t>(data[offset + i * 3 + c] * 255u / maxValue);
+			}
+			pixels[i * 4 + 3] = 255;
+		}
+		image = LitImage::CreateRgba8(width, height, bSrgb, std::move(pixels));
+		return true;
+	}
+
+	// integers in the container are little endian, like every platform the engine runs on
+	template <typename T>
+	static T ReadValue(const std::vector<uint8_t>& data, size_t offset)
+	{
+		T value;
+		std::memcpy(&value, &data[offset], sizeof(T));
+		return value;
+	}
+
+	template <typename T>
+	static void WriteValue(std::vector<uint8_t>& data, T value)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+	static bool DecodeContainer(const std::vector<uint8_t>& data, LitImageData& image, std::string& error)
+	{
+		if (data.size() < CONTAINER_HEADER_SIZE)
+		{
+			error = "truncated texture header";
+			return false;
+		}
+		size_t offset = sizeof(CONTAINER_IDENTIFIER);
+		const VkFormat format = static_cast<VkFormat>(ReadValue<uint32_t>(data, offset));
+		const uint32_t width = ReadValue<uint32_t>(data, offset + 4);
+		const uint32_t height = ReadValue<uint32_t>(data, offset + 8);
+		const uint32_t levelCount = ReadValue<uint32_t>(data, offset + 12);
+		offset = CONTAINER_HEADER_SIZE;
+		if (!LitImage::IsSupportedFormat(format))
+		{
+			error = "unsupported texture format " + std::to_string(format);
+			return false;
+		}
+		if (!CheckDimensions(width, height, error))
+		{
+			return false;
+		}
+		if (levelCount == 0 || levelCount > LitImage::GetMipLevelCount(width, height))
+		{
+			error = "unsupported level count " + std::to_string(levelCount);
+			return false;
+		}
+		if (offset + levelCount * CONTAINER_LEVEL_SIZE > data.size())
+		{
+			error = "truncated texture level index";
+			return false;
+		}
+
+		image.format = format;
+		image.width = width;
+		image.height = height;
+		image.levels.clear();
+		image.data.clear();
+		for (uint32_t i = 0; i < levelCount; i++)
+		{
+			const uint64_t levelOffset = ReadValue<uint64_t>(data, offset + i * CONTAINER_LEVEL_SIZE);
+			const uint64_t levelSize = ReadValue<uint64_t>(data, offset + i * CONTAINER_LEVEL_SIZE + 8);
+			LitImageData::Level level;
+			level.width = std::max(width >> i, 1u);
+			level.height = std::max(height >> i, 1u);
+			level.offset = image.data.size();
+			level.size = LitImage::GetLevelSize(format, level.width, level.height);
+			if (levelSize != level.size || levelOffset > data.size() || levelSize > data.size() - levelOffset)
+			{
+				error = "corrupt texture level " + std::to_string(i);
+				return false;
+			}
+			image.data.insert(image.data.end(), data.begin() + static_cast<size_t>(levelOffset),
+				data.begin() + static_cast<size_t>(levelOffset + levelSize));
+			image.levels.push_back(level);
+		}
+		return true;
+	}
+
+	static float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static float LinearToSrgb(float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	bool LitImage::Load(const std::string& path, bool bSrgb, LitImageData& image, std::string& error)
+	{
+		std::vector<uint8_t> data;
+		if (!ReadFile(path, data))
+		{
+			error = "failed to open file";
+			return false;
+		}
+		if (data.size() >= sizeof(CONTAINER_IDENTIFIER) &&
+			std::memcmp(data.data(), CONTAINER_IDENTIFIER, sizeof(CONTAINER_IDENTIFIER)) == 0)
+		{
+			return DecodeContainer(data, image, error);
+		}
+		if (data.size() >= 2 && data[0] == 'P' && data[1] == '6')
+		{
+			return DecodePpm(data, bSrgb, image, error);
+		}
+		// TGA has no magic number, go by the extension
+		std::string extension = path.substr(std::min(path.find_last_of('.'), path.size()));
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+			[](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+		if (extension == ".tga")
+		{
+			return DecodeTga(data, bSrgb, image, error);
+		}
+		error = "unsupported image format";
+		return false;
+	}
+
+	bool LitImage::SaveContainer(const std::string& path, const LitImageData& image)
+	{
+		std::vector<uint8_t> data{ std::begin(CONTAINER_IDENTIFIER), std::end(CONTAINER_IDENTIFIER) };
+		WriteValue<uint32_t>(data, static_cast<uint32_t>(image.format));
+		WriteValue<uint32_t>(data, image.width);
+		WriteValue<uint32_t>(data, image.height);
+		WriteValue<uint32_t>(data, static_cast<uint32_t>(image.levels.size()));
+
+		uint64_t levelOffset = data.size() + image.levels.size() * CONTAINER_LEVEL_SIZE;
+		std::vector<uint64_t> levelOffsets;
+		for (const auto& level : image.levels)
+		{
+			levelOffset = (levelOffset + CONTAINER_ALIGNMENT - 1) / CONTAINER_ALIGNMENT * CONTAINER_ALIGNMENT;
+			levelOffsets.push_back(levelOffset);
+			WriteValue<uint64_t>(data, levelOffset);
+			WriteValue<uint64_t>(data, level.size);
+			levelOffset += level.size;
+		}
+		for (size_t i = 0; i < image.levels.size(); i++)
+		{
+			data.resize(static_cast<size_t>(levelOffsets[i]), 0);
+			const uint8_t* levelData = image.GetLevelData(i);
+			data.insert(data.end(), levelData, levelData + image.levels[i].size);
+		}
+
+		std::ofstream file{ path, std::ios::binary };
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return static_cast<bool>(file);
+	}
+
+	LitImageData LitImage::CreateRgba8(uint32_t width, uint32_t height, bool bSrgb, std::vector<uint8_t> pixels)
+	{
+		LitImageData image;
+		image.format = bSrgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		image.width = width;
+		image.height = height;
+		image.data = std::move(pixels);
+		LitImageData::Level level;
+		level.width = width;
+		level.height = height;
+		level.size = image.data.size();
+		image.levels.push_back(level);
+		return image;
+	}
+
+	void LitImage::GenerateMips(LitImageData& image)
+	{
+		const bool bSrgb = IsSrgb(image.format);
+		float toLinear[256];
+		for (int i = 0; i < 256; i++)
+		{
+			toLinear[i] = bSrgb ? SrgbToLinear(i / 255.0f) : i / 255.0f;
+		}
+
+		image.levels.resize(1);
+		image.data.resize(image.levels[0].size);
+		const uint32_t levelCount = GetMipLevelCount(image.width, image.height);
+		for (uint32_t i = 1; i < levelCount; i++)
+		{
+			const LitImageData::Level source = image.levels[i - 1];
+			LitImageData::Level level;
+			level.width = std::max(source.width / 2, 1u);
+			level.height = std::max(source.height / 2, 1u);
+			level.offset = image.data.size();
+			level.size = GetLevelSize(image.format, level.width, level.height);
+			image.data.resize(level.offset + level.size);
+			image.levels.push_back(level);
+
+			// the 2x2 texels under each texel, a level of odd size drops its last row or column
+			const uint8_t* sourceTexels = image.data.data() + source.offset;
+			uint8_t* texels = image.data.data() + level.offset;
+			for (uint32_t y = 0; y < level.height; y++)
+			{
+				const uint32_t y0 = std::min(y * 2, source.height - 1);
+				const uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+				for (uint32_t x = 0; x < level.width; x++)
+				{
+					const uint32_t x0 = std::min(x * 2, source.width - 1);
+					const uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+					const uint8_t* quad[4] = {
+						sourceTexels + (static_cast<size_t>(y0) * source.width + x0) * 4,
+						sourceTexels + (static_cast<size_t>(y0) * source.width + x1) * 4,
+						sourceTexels + (static_cast<size_t>(y1) * source.width + x0) * 4,
+						sourceTexels + (static_cast<size_t>(y1) * source.width + x1) * 4,
+					};
+					uint8_t* texel = texels + (static_cast<size_t>(y) * level.width + x) * 4;
+					for (int c = 0; c < 3; c++)
+					{
+						const float value = 0.25f * (toLinear[quad[0][c]] + toLinear[quad[1][c]] + toLinear[quad[2][c]] + toLinear[quad[3][c]]);
+						texel[c] = static_cast<uint8_t>(std::lround((bSrgb ? LinearToSrgb(value) : value) * 255.0f));
+					}
+					// alpha is linear either way
+					texel[3] = static_cast<uint8_t>((quad[0][3] + quad[1][3] + quad[2][3] + quad[3][3] + 2) / 4);
+				}
+			}
+		}
+	}
+
+	uint32_t LitImage::GetMipLevelCount(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+		{
+			levels++;
+		}
+		return levels;
+	}
+
+	bool LitImage::IsSupportedFormat(VkFormat format)
+	{
+		return GetLevelSize(format, 1, 1) != 0;
+	}
+
+	bool LitImage::IsBlockCompressed(VkFormat format)
+	{
+		return IsSupportedFormat(format) && format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB;
+	}
+
+	bool LitImage::IsSrgb(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	size_t LitImage::GetLevelSize(VkFormat format, uint32_t width, uint32_t height)
+	{
+		const size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+		switch (format)
+		{
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return static_cast<size_t>(width) * height * 4;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			return blocks * 8;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return blocks * 16;
+		default:
+			return 0;
+		}
+	}
+}
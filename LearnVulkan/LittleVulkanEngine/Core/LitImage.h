@@ -0,0 +1,62 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// A 2D image and its mip levels in one of the formats the texture pipeline knows: RGBA8 and the BC formats of
+	// LitBlockCompression. Rows run top to bottom, block compressed levels are rows of 4x4 blocks
+	struct LitImageData
+	{
+		struct Level
+		{
+			uint32_t width = 0;
+			uint32_t height = 0;
+			// bytes into data
+			size_t offset = 0;
+			size_t size = 0;
+		};
+
+		VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// level 0 first
+		std::vector<Level> levels;
+		std::vector<uint8_t> data;
+
+		const uint8_t* GetLevelData(size_t level) const { return data.data() + levels[level].offset; }
+		uint8_t* GetLevelData(size_t level) { return data.data() + levels[level].offset; }
+	};
+
+	// Reading and writing images without a device, shared by the engine, LitTextureCooker and the benchmarks.
+	// Cooked textures are stored in a container modeled on KTX2: an identifier, the VkFormat, the size and an index of
+	// the levels, each at a 16 byte aligned offset. It has no data format descriptor or supercompression, the VkFormat
+	// says everything the engine needs
+	class LitImage
+	{
+	public:
+		// TGA (uncompressed or RLE, 8, 24 or 32 bits) and binary PPM give one RGBA8 level, sRGB when bSrgb. Containers
+		// keep the format and the levels they were cooked with. Returns false and says why in error otherwise
+		static bool Load(const std::string& path, bool bSrgb, LitImageData& image, std::string& error);
+		static bool SaveContainer(const std::string& path, const LitImageData& image);
+
+		// one RGBA8 level of width x height
+		static LitImageData CreateRgba8(uint32_t width, uint32_t height, bool bSrgb, std::vector<uint8_t> pixels);
+		// replaces the levels of an RGBA8 image below level 0 with a box filtered chain down to 1x1. sRGB images are
+		// averaged in linear space so the mips don't darken
+		static void GenerateMips(LitImageData& image);
+
+		// levels down to 1x1
+		static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+		// RGBA8 and the BC formats of LitBlockCompression
+		static bool IsSupportedFormat(VkFormat format);
+		static bool IsBlockCompressed(VkFormat format);
+		static bool IsSrgb(VkFormat format);
+		// bytes of a level of width x height in format
+		static size_t GetLevelSize(VkFormat format, uint32_t width, uint32_t height);
+	};
+}
@@ -0,0 +1,243 @@
+#include "LitMemoryBudget.h"
+
+// std
+#include <algorithm>
+
+namespace Lit
+{
+	// without VK_EXT_memory_budget, the share of a heap the process may expect to get
+	static const double FALLBACK_BUDGET = 0.8;
+	// a heap over this share of its budget evicts until it is down to the target
+	static const double HEAP_PRESSURE = 0.9;
+	static const double HEAP_TARGET = 0.8;
+	// Updates between evictions, frees go through the deletion queue and land once the frames in flight are done
+	static const uint64_t EVICTION_INTERVAL = 4;
+
+	LitMemoryBudget::LitMemoryBudget(VkInstance instance, VkPhysicalDevice inPhysicalDevice, bool bInUseBudgetExtension)
+		: physicalDevice{ inPhysicalDevice }, bUseBudgetExtension{ bInUseBudgetExtension }
+	{
+		if (bUseBudgetExtension)
+		{
+			getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2");
+			bUseBudgetExtension = getMemoryProperties2 != nullptr;
+		}
+
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			memoryTypeHeaps.push_back(memoryProperties.memoryTypes[i].heapIndex);
+		}
+		heaps.resize(memoryProperties.memoryHeapCount);
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+		{
+			heaps[i].size = memoryProperties.memoryHeaps[i].size;
+			heaps[i].bDeviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+			heaps[i].budget = static_cast<VkDeviceSize>(heaps[i].size * FALLBACK_BUDGET);
+		}
+		QueryHeapBudgets();
+	}
+
+	const char* LitMemoryBudget::GetCategoryName(MemoryCategory category)
+	{
+		switch (category)
+		{
+		case MemoryCategory::Mesh: return "meshes";
+		case MemoryCategory::Uniform: return "uniforms";
+		case MemoryCategory::Staging: return "staging";
+		case MemoryCategory::Depth: return "depth";
+		case MemoryCategory::Texture: return "textures";
+		case MemoryCategory::RenderTarget: return "render targets";
+		case MemoryCategory::Other: return "other";
+		default: return "unknown";
+		}
+	}
+
+	void LitMemoryBudget::OnAllocate(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex,
+		MemoryCategory category, VkDeviceSize usedBytes)
+	{
+		const uint32_t heapIndex = memoryTypeHeaps[memoryTypeIndex];
+		usedBytes = std::min(usedBytes, size);
+
+		std::lock_guard<std::mutex> lock{ mutex };
+		allocations.emplace(memory, Allocation{ size, usedBytes, heapIndex, category });
+		for (Statistics* total : { &statistics, static_cast<Statistics*>(&categories[static_cast<size_t>(category)]) })
+		{
+			total->allocatedBytes += size;
+			total->usedBytes += usedBytes;
+			total->peakAllocatedBytes = std::max(total->peakAllocatedBytes, total->allocatedBytes);
+			total->allocationCount++;
+		}
+		heaps[heapIndex].allocatedBytes += size;
+		heaps[heapIndex].usedBytes += usedBytes;
+	}
+
+	void LitMemoryBudget::OnFree(VkDeviceMemory memory)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		auto it = allocations.find(memory);
+		if (it == allocations.end())
+		{
+			return;
+		}
+		const Allocation& allocation = it->second;
+		for (Statistics* total : { &statistics, static_cast<Statistics*>(&categories[static_cast<size_t>(allocation.category)]) })
+		{
+			total->allocatedBytes -= allocation.size;
+			total->usedBytes -= allocation.usedBytes;
+			total->allocationCount--;
+		}
+		heaps[allocation.heapIndex].allocatedBytes -= allocation.size;
+		heaps[allocation.heapIndex].usedBytes -= allocation.usedBytes;
+		allocations.erase(it);
+	}
+
+	void LitMemoryBudget::SetUsedBytes(VkDeviceMemory memory, VkDeviceSize usedBytes)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		auto it = allocations.find(memory);
+		if (it == allocations.end())
+		{
+			return;
+		}
+		Allocation& allocation = it->second;
+		usedBytes = std::min(usedBytes, allocation.size);
+		statistics.usedBytes = statistics.usedBytes - allocation.usedBytes + usedBytes;
+		CategoryStatistics& category = categories[static_cast<size_t>(allocation.category)];
+		category.usedBytes = category.usedBytes - allocation.usedBytes + usedBytes;
+		heaps[allocation.heapIndex].usedBytes = heaps[allocation.heapIndex].usedBytes - allocation.usedBytes + usedBytes;
+		allocation.usedBytes = usedBytes;
+	}
+
+	void LitMemoryBudget::SetSoftBudget(MemoryCategory category, VkDeviceSize bytes)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		categories[static_cast<size_t>(category)].softBudget = bytes;
+	}
+
+	LitMemoryBudget::HandlerId LitMemoryBudget::AddEvictionHandler(MemoryCategory category, EvictionHandler handler)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		handlers.push_back(Handler{ nextHandlerId, category, std::move(handler) });
+		return nextHandlerId++;
+	}
+
+	void LitMemoryBudget::RemoveEvictionHandler(HandlerId id)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [id](const Handler& handler) { return handler.id == id; }),
+			handlers.end());
+	}
+
+	void LitMemoryBudget::Update()
+	{
+		QueryHeapBudgets();
+		updateCount++;
+		if (lastEvictionUpdate != 0 && updateCount - lastEvictionUpdate < EVICTION_INTERVAL)
+		{
+			return;
+		}
+
+		// what is due, decided under the lock and evicted outside of it, the handlers free memory themselves
+		std::vector<std::pair<MemoryCategory, VkDeviceSize>> evictions;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			for (size_t i = 0; i < categories.size(); i++)
+			{
+				const CategoryStatistics& category = categories[i];
+				if (category.softBudget > 0 && category.allocatedBytes > category.softBudget)
+				{
+					evictions.emplace_back(static_cast<MemoryCategory>(i), category.allocatedBytes - category.softBudget);
+				}
+			}
+			for (const HeapStatistics& heap : heaps)
+			{
+				if (heap.budget > 0 && heap.usage > heap.budget * HEAP_PRESSURE)
+				{
+					evictions.emplace_back(MemoryCategory::Count, heap.usage - static_cast<VkDeviceSize>(heap.budget * HEAP_TARGET));
+				}
+			}
+		}
+		for (const auto& eviction : evictions)
+		{
+			Evict(eviction.first, eviction.second);
+		}
+		if (!evictions.empty())
+		{
+			lastEvictionUpdate = updateCount;
+		}
+	}
+
+	LitMemoryBudget::Statistics LitMemoryBudget::GetStatistics()
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		return statistics;
+	}
+
+	LitMemoryBudget::CategoryStatistics LitMemoryBudget::GetCategoryStatistics(MemoryCategory category)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		return categories[static_cast<size_t>(category)];
+	}
+
+	std::vector<LitMemoryBudget::HeapStatistics> LitMemoryBudget::GetHeapStatistics()
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		return heaps;
+	}
+
+	void LitMemoryBudget::QueryHeapBudgets()
+	{
+		if (!bUseBudgetExtension)
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			for (HeapStatistics& heap : heaps)
+			{
+				heap.usage = heap.allocatedBytes;
+			}
+			return;
+		}
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+		VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+		memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		memoryProperties.pNext = &budgetProperties;
+		getMemoryProperties2(physicalDevice, &memoryProperties);
+
+		std::lock_guard<std::mutex> lock{ mutex };
+		for (size_t i = 0; i < heaps.size(); i++)
+		{
+			heaps[i].budget = budgetProperties.heapBudget[i];
+			heaps[i].usage = budgetProperties.heapUsage[i];
+		}
+	}
+
+	void LitMemoryBudget::Evict(MemoryCategory category, VkDeviceSize bytesToFree)
+	{
+		std::vector<Handler> dueHandlers;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			for (const Handler& handler : handlers)
+			{
+				if (category == MemoryCategory::Count || handler.category == category)
+				{
+					dueHandlers.push_back(handler);
+				}
+			}
+		}
+
+		VkDeviceSize freedBytes = 0;
+		for (const Handler& handler : dueHandlers)
+		{
+			if (freedBytes >= bytesToFree)
+			{
+				break;
+			}
+			const VkDeviceSize handlerBytes = handler.handler(bytesToFree - freedBytes);
+			freedBytes += handlerBytes;
+			std::lock_guard<std::mutex> lock{ mutex };
+			categories[static_cast<size_t>(handler.category)].evictedBytes += handlerBytes;
+		}
+	}
+}
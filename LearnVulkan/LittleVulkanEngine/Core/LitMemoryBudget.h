@@ -0,0 +1,134 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Lit
+{
+	// what an allocation holds, for the breakdown of the memory use and the soft budgets
+	enum class MemoryCategory : uint32_t
+	{
+		Mesh,
+		Uniform,
+		Staging,
+		Depth,
+		Texture,
+		RenderTarget,
+		Other,
+		Count
+	};
+
+	// Bookkeeping of the device memory the engine allocates, by heap and by category. Allocated bytes are the size of
+	// the VkDeviceMemory, used bytes what the resources in it need (a sub-allocator reports the ranges it handed out).
+	// With VK_EXT_memory_budget it also knows how much of each heap the process uses and may use, allocations of the
+	// driver and the swap chain included. Categories can have a soft budget: nothing fails over it, but the eviction
+	// handlers of the category are asked to release cached resources. All of them are asked when a heap nears its budget
+	class LitMemoryBudget
+	{
+	public:
+		struct Statistics
+		{
+			VkDeviceSize allocatedBytes = 0;
+			VkDeviceSize usedBytes = 0;
+			VkDeviceSize peakAllocatedBytes = 0;
+			uint32_t allocationCount = 0;
+		};
+
+		struct HeapStatistics
+		{
+			VkDeviceSize size = 0;
+			bool bDeviceLocal = false;
+			// of the whole process, from VK_EXT_memory_budget. Without it the budget is a fraction of the size and the
+			// usage is what the engine allocated
+			VkDeviceSize budget = 0;
+			VkDeviceSize usage = 0;
+			// by the engine
+			VkDeviceSize allocatedBytes = 0;
+			VkDeviceSize usedBytes = 0;
+		};
+
+		struct CategoryStatistics : Statistics
+		{
+			// 0 for none
+			VkDeviceSize softBudget = 0;
+			// released by the eviction handlers so far
+			VkDeviceSize evictedBytes = 0;
+		};
+
+		// asked to release at least bytesToFree of cached resources, returns what it released. It may free through the
+		// deletion queue, the bytes then only show up as freed a few frames later. Runs on the thread calling Update
+		using EvictionHandler = std::function<VkDeviceSize(VkDeviceSize bytesToFree)>;
+		using HandlerId = uint32_t;
+
+		// bUseBudgetExtension when VK_EXT_memory_budget is enabled on the device
+		LitMemoryBudget(VkInstance instance, VkPhysicalDevice physicalDevice, bool bUseBudgetExtension);
+
+		LitMemoryBudget(const LitMemoryBudget&) = delete;
+		LitMemoryBudget& operator=(const LitMemoryBudget&) = delete;
+
+		static const char* GetCategoryName(MemoryCategory category);
+
+		// called by LitDevice::AllocateMemory and FreeMemory, from any thread
+		void OnAllocate(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, MemoryCategory category,
+			VkDeviceSize usedBytes);
+		void OnFree(VkDeviceMemory memory);
+		// for sub-allocators, the bytes of memory that hold live resources
+		void SetUsedBytes(VkDeviceMemory memory, VkDeviceSize usedBytes);
+
+		void SetSoftBudget(MemoryCategory category, VkDeviceSize bytes);
+		HandlerId AddEvictionHandler(MemoryCategory category, EvictionHandler handler);
+		void RemoveEvictionHandler(HandlerId id);
+
+		// once per frame by the renderer, refreshes the heap budgets and runs the eviction handlers that are due
+		void Update();
+
+		bool UsesBudgetExtension() const { return bUseBudgetExtension; }
+		Statistics GetStatistics();
+		CategoryStatistics GetCategoryStatistics(MemoryCategory category);
+		// as of the last Update
+		std::vector<HeapStatistics> GetHeapStatistics();
+
+	private:
+		struct Allocation
+		{
+			VkDeviceSize size;
+			VkDeviceSize usedBytes;
+			uint32_t heapIndex;
+			MemoryCategory category;
+		};
+
+		struct Handler
+		{
+			HandlerId id;
+			MemoryCategory category;
+			EvictionHandler handler;
+		};
+
+		void QueryHeapBudgets();
+		// calls the handlers of category, or of every category for MemoryCategory::Count, outside of the lock
+		void Evict(MemoryCategory category, VkDeviceSize bytesToFree);
+
+		VkPhysicalDevice physicalDevice;
+		bool bUseBudgetExtension;
+		// heap of every memory type
+		std::vector<uint32_t> memoryTypeHeaps;
+		PFN_vkGetPhysicalDeviceMemoryProperties2 getMemoryProperties2 = nullptr;
+
+		std::mutex mutex;
+		std::unordered_map<VkDeviceMemory, Allocation> allocations;
+		Statistics statistics;
+		std::array<CategoryStatistics, static_cast<size_t>(MemoryCategory::Count)> categories;
+		std::vector<HeapStatistics> heaps;
+		std::vector<Handler> handlers;
+		HandlerId nextHandlerId = 0;
+		// Update calls, and the last one that evicted, so deferred frees get to land before the next eviction
+		uint64_t updateCount = 0;
+		uint64_t lastEvictionUpdate = 0;
+	};
+}
@@ -0,0 +1,304 @@
+#include "LitMeshBvh.h"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// x64 always has SSE2, other targets fall back to the scalar loop
+#if defined(_M_X64) || defined(__SSE2__)
+#define LIT_MESH_BVH_SSE 1
+#include <emmintrin.h>
+#else
+#define LIT_MESH_BVH_SSE 0
+#endif
+
+namespace Lit
+{
+	static const uint32_t SAH_BIN_COUNT = 16;
+	// below this determinant the ray is parallel to the triangle
+	static const float PARALLEL_EPSILON = 1e-20f;
+
+	LitMeshBvh::LitMeshBvh(const std::vector<glm::vec3>& positions, const uint32_t* indices, uint32_t indexCount)
+	{
+		triangleCount = indexCount / 3;
+		std::vector<BuildTriangle> triangles(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			BuildTriangle& triangle = triangles[i];
+			triangle.index = i;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				triangle.bounds.Expand(positions[indices[i * 3 + corner]]);
+			}
+			triangle.centroid = triangle.bounds.Center();
+		}
+
+		// a full binary tree with leaves of at least one triangle, usually about half the triangle count
+		nodes.reserve(std::max(triangleCount, 1u));
+		packets.reserve(triangleCount / 2 + 1);
+		nodes.emplace_back();
+		if (triangleCount == 0)
+		{
+			nodes.front().first = 0;
+			nodes.front().count = 0;
+			return;
+		}
+		Build(0, triangles.data(), triangleCount, positions, indices);
+	}
+
+	void LitMeshBvh::Build(uint32_t node, BuildTriangle* triangles, uint32_t count,
+		const std::vector<glm::vec3>& positions, const uint32_t* indices)
+	{
+		LitAABB bounds;
+		LitAABB centroidBounds;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			bounds.Expand(triangles[i].bounds);
+			centroidBounds.Expand(triangles[i].centroid);
+		}
+		nodes[node].bounds = bounds;
+
+		if (count <= PACKET_SIZE)
+		{
+			TrianglePacket packet{};
+			for (uint32_t lane = 0; lane < count; lane++)
+			{
+				const uint32_t triangle = triangles[lane].index;
+				const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+				const glm::vec3 edge1 = positions[indices[triangle * 3 + 1]] - p0;
+				const glm::vec3 edge2 = positions[indices[triangle * 3 + 2]] - p0;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					packet.v0[axis][lane] = p0[axis];
+					packet.edge1[axis][lane] = edge1[axis];
+					packet.edge2[axis][lane] = edge2[axis];
+				}
+				packet.triangles[lane] = triangle;
+			}
+			nodes[node].first = static_cast<uint32_t>(packets.size());
+			nodes[node].count = count;
+			packets.push_back(packet);
+			return;
+		}
+
+		// binned SAH over the centroids, cost is area * count on both sides
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		const glm::vec3 centroidExtent = centroidBounds.Extent();
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (centroidExtent[axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			LitAABB binBounds[SAH_BIN_COUNT];
+			uint32_t binCounts[SAH_BIN_COUNT] = {};
+			const float binScale = SAH_BIN_COUNT / centroidExtent[axis];
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const uint32_t bin = std::min(static_cast<uint32_t>((triangles[i].centroid[axis] - centroidBounds.min[axis]) * binScale), SAH_BIN_COUNT - 1);
+				binBounds[bin].Expand(triangles[i].bounds);
+				binCounts[bin]++;
+			}
+
+			float rightCosts[SAH_BIN_COUNT];
+			LitAABB rightBounds;
+			uint32_t rightCount = 0;
+			for (uint32_t bin = SAH_BIN_COUNT - 1; bin > 0; bin--)
+			{
+				rightBounds.Expand(binBounds[bin]);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = rightCount > 0 ? rightBounds.SurfaceArea() * rightCount : 0.0f;
+			}
+
+			LitAABB leftBounds;
+			uint32_t leftCount = 0;
+			for (uint32_t split = 1; split < SAH_BIN_COUNT; split++)
+			{
+				leftBounds.Expand(binBounds[split - 1]);
+				leftCount += binCounts[split - 1];
+				if (leftCount == 0 || leftCount == count)
+				{
+					continue;
+				}
+				const float cost = leftBounds.SurfaceArea() * leftCount + rightCosts[split];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		uint32_t middle = count / 2;
+		if (bestAxis >= 0)
+		{
+			const float binScale = SAH_BIN_COUNT / centroidExtent[bestAxis];
+			const float splitMin = centroidBounds.min[bestAxis];
+			BuildTriangle* partition = std::partition(triangles, triangles + count, [&](const BuildTriangle& triangle)
+				{
+					return std::min(static_cast<uint32_t>((triangle.centroid[bestAxis] - splitMin) * binScale), SAH_BIN_COUNT - 1) < bestSplit;
+				});
+			middle = static_cast<uint32_t>(partition - triangles);
+		}
+		if (middle == 0 || middle == count)
+		{
+			// all centroids in one spot
+			middle = count / 2;
+		}
+
+		const uint32_t left = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+		nodes.emplace_back();
+		nodes[node].first = left;
+		nodes[node].count = 0;
+		Build(left, triangles, middle, positions, indices);
+		Build(left + 1, triangles + middle, count - middle, positions, indices);
+	}
+
+	bool LitMeshBvh::Raycast(const LitRay& ray, RayHit& hit) const
+	{
+		float entry;
+		if (packets.empty() || !ray.Intersects(nodes.front().bounds, hit.distance, entry))
+		{
+			return false;
+		}
+
+		bool bHit = false;
+		std::vector<uint32_t> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			// pushed before a closer hit shortened the ray
+			if (!ray.Intersects(node.bounds, hit.distance, entry))
+			{
+				continue;
+			}
+
+			if (node.count > 0)
+			{
+				bHit |= IntersectPacket(packets[node.first], node.count, ray, hit);
+				continue;
+			}
+
+			// nearer child last so it is popped first
+			float distances[2];
+			const bool bLeft = ray.Intersects(nodes[node.first].bounds, hit.distance, distances[0]);
+			const bool bRight = ray.Intersects(nodes[node.first + 1].bounds, hit.distance, distances[1]);
+			if (bLeft && bRight)
+			{
+				const bool bLeftFirst = distances[0] <= distances[1];
+				stack.push_back(bLeftFirst ? node.first + 1 : node.first);
+				stack.push_back(bLeftFirst ? node.first : node.first + 1);
+			}
+			else if (bLeft || bRight)
+			{
+				stack.push_back(bLeft ? node.first : node.first + 1);
+			}
+		}
+		return bHit;
+	}
+
+	// Moller-Trumbore on PACKET_SIZE triangles at once
+	bool LitMeshBvh::IntersectPacket(const TrianglePacket& packet, uint32_t count, const LitRay& ray, RayHit& hit) const
+	{
+		float t[PACKET_SIZE];
+		float u[PACKET_SIZE];
+		float v[PACKET_SIZE];
+		uint32_t hitMask = 0;
+
+#if LIT_MESH_BVH_SSE
+		const __m128 dx = _mm_set1_ps(ray.direction.x);
+		const __m128 dy = _mm_set1_ps(ray.direction.y);
+		const __m128 dz = _mm_set1_ps(ray.direction.z);
+		const __m128 e1x = _mm_loadu_ps(packet.edge1[0]);
+		const __m128 e1y = _mm_loadu_ps(packet.edge1[1]);
+		const __m128 e1z = _mm_loadu_ps(packet.edge1[2]);
+		const __m128 e2x = _mm_loadu_ps(packet.edge2[0]);
+		const __m128 e2y = _mm_loadu_ps(packet.edge2[1]);
+		const __m128 e2z = _mm_loadu_ps(packet.edge2[2]);
+
+		// p = d x e2, det = e1 . p
+		const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+		const __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		// s = o - v0, u = s . p / det
+		const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_loadu_ps(packet.v0[0]));
+		const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_loadu_ps(packet.v0[1]));
+		const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_loadu_ps(packet.v0[2]));
+		const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+		// q = s x e1, v = d . q / det, t = e2 . q / det
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+		const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+		const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+		const __m128 zero = _mm_setzero_ps();
+		__m128 mask = _mm_cmpgt_ps(absDet, _mm_set1_ps(PARALLEL_EPSILON));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(uu, zero));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+		mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+		mask = _mm_and_ps(mask, _mm_cmpgt_ps(tt, zero));
+		mask = _mm_and_ps(mask, _mm_cmplt_ps(tt, _mm_set1_ps(hit.distance)));
+		hitMask = static_cast<uint32_t>(_mm_movemask_ps(mask)) & ((1u << count) - 1);
+		if (hitMask == 0)
+		{
+			return false;
+		}
+		_mm_storeu_ps(t, tt);
+		_mm_storeu_ps(u, uu);
+		_mm_storeu_ps(v, vv);
+#else
+		for (uint32_t lane = 0; lane < count; lane++)
+		{
+			const glm::vec3 edge1{ packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane] };
+			const glm::vec3 edge2{ packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane] };
+			const glm::vec3 p = glm::cross(ray.direction, edge2);
+			const float det = glm::dot(edge1, p);
+			if (std::abs(det) <= PARALLEL_EPSILON)
+			{
+				continue;
+			}
+			const float inverseDet = 1.0f / det;
+			const glm::vec3 s = ray.origin - glm::vec3{ packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane] };
+			const glm::vec3 q = glm::cross(s, edge1);
+			u[lane] = glm::dot(s, p) * inverseDet;
+			v[lane] = glm::dot(ray.direction, q) * inverseDet;
+			t[lane] = glm::dot(edge2, q) * inverseDet;
+			if (u[lane] >= 0.0f && v[lane] >= 0.0f && u[lane] + v[lane] <= 1.0f && t[lane] > 0.0f && t[lane] < hit.distance)
+			{
+				hitMask |= 1u << lane;
+			}
+		}
+		if (hitMask == 0)
+		{
+			return false;
+		}
+#endif
+
+		for (uint32_t lane = 0; lane < count; lane++)
+		{
+			if ((hitMask & (1u << lane)) != 0 && t[lane] < hit.distance)
+			{
+				hit.triangle = packet.triangles[lane];
+				hit.distance = t[lane];
+				hit.u = u[lane];
+				hit.v = v[lane];
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "LitBounds.h"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace Lit
+{
+	// Static triangle BVH of one mesh for ray queries in model space. Built top down with a binned SAH, leaves hold
+	// at most PACKET_SIZE triangles stored as one structure of arrays packet that is intersected with SSE
+	class LitMeshBvh
+	{
+	public:
+		static constexpr uint32_t PACKET_SIZE = 4;
+
+		struct RayHit
+		{
+			uint32_t triangle = UINT32_MAX;	// index of the triangle in the indices the BVH was built from
+			float distance = 0.0f;
+			float u = 0.0f;					// barycentrics of the second and third vertex
+			float v = 0.0f;
+
+			bool IsHit() const { return triangle != UINT32_MAX; }
+		};
+
+		LitMeshBvh(const std::vector<glm::vec3>& positions, const uint32_t* indices, uint32_t indexCount);
+
+		// closest triangle, either side, nearer than hit.distance. Returns whether hit was updated
+		bool Raycast(const LitRay& ray, RayHit& hit) const;
+
+		const LitAABB& GetBounds() const { return nodes.front().bounds; }
+		uint32_t GetTriangleCount() const { return triangleCount; }
+		uint32_t GetNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+
+	private:
+		struct Node
+		{
+			LitAABB bounds;
+			uint32_t first;	// leaves: packet index, internal nodes: left child, the right one follows it
+			uint32_t count;	// triangles in the leaf packet, 0 for internal nodes
+		};
+
+		// first vertex and the two edges leaving it, degenerate padding lanes never hit
+		struct TrianglePacket
+		{
+			float v0[3][PACKET_SIZE];
+			float edge1[3][PACKET_SIZE];
+			float edge2[3][PACKET_SIZE];
+			uint32_t triangles[PACKET_SIZE];
+		};
+
+		struct BuildTriangle
+		{
+			LitAABB bounds;
+			glm::vec3 centroid;
+			uint32_t index;
+		};
+
+		void Build(uint32_t node, BuildTriangle* triangles, uint32_t count,
+			const std::vector<glm::vec3>& positions, const uint32_t* indices);
+		bool IntersectPacket(const TrianglePacket& packet, uint32_t count, const LitRay& ray, RayHit& hit) const;
+
+		std::vector<Node> nodes;
+		std::vector<TrianglePacket> packets;
+		uint32_t triangleCount = 0;
+	};
+}
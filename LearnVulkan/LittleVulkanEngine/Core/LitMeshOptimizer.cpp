@@ -0,0 +1,969 @@
+#include "LitMeshOptimizer.h"
+#include "LitBounds.h"
+
+// std
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace Lit
+{
+	// Forsyth scoring parameters, the values from the original paper
+	static const uint32_t FORSYTH_CACHE_SIZE = 32;
+	static const float CACHE_DECAY_POWER = 1.5f;
+	static const float LAST_TRIANGLE_SCORE = 0.75f;
+	static const float VALENCE_BOOST_SCALE = 2.0f;
+	static const float VALENCE_BOOST_POWER = 0.5f;
+
+	static float ScoreVertex(int32_t cachePosition, uint32_t remainingValence)
+	{
+		if (remainingValence == 0)
+		{
+			// no triangle left to emit, the vertex can't contribute anymore
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// used by the last triangle: deliberately lower so we don't keep drawing thin strips
+				score = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+				score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+
+		// boost vertices with few triangles left so we finish them off instead of leaving lonely triangles behind
+		score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingValence), -VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	// FIFO cache simulation: a vertex is a hit if it was transformed within the last cacheSize transforms
+	class FifoCache
+	{
+	public:
+		FifoCache(uint32_t vertexCount, uint32_t inCacheSize)
+			: timestamps(vertexCount, 0), cacheSize(inCacheSize), timestamp(inCacheSize + 1)
+		{
+		}
+
+		// returns true on a miss
+		bool Access(uint32_t vertex)
+		{
+			if (timestamp - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = timestamp++;
+				return true;
+			}
+			return false;
+		}
+
+		void Flush() { timestamp += cacheSize + 1; }
+
+	private:
+		std::vector<uint32_t> timestamps;
+		uint32_t cacheSize;
+		uint32_t timestamp;
+	};
+
+	VertexCacheStatistics LitMeshOptimizer::AnalyzeVertexCache(
+		const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+	{
+		assert(indices.size() % 3 == 0 && "index count must be a multiple of 3");
+
+		VertexCacheStatistics statistics{};
+		statistics.triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		statistics.vertexCount = vertexCount;
+
+		FifoCache cache(vertexCount, cacheSize);
+		for (uint32_t index : indices)
+		{
+			if (cache.Access(index))
+			{
+				statistics.vertexTransforms++;
+			}
+		}
+
+		statistics.acmr = statistics.triangleCount > 0 ?
+			static_cast<float>(statistics.vertexTransforms) / statistics.triangleCount : 0.0f;
+		statistics.atvr = vertexCount > 0 ?
+			static_cast<float>(statistics.vertexTransforms) / vertexCount : 0.0f;
+		return statistics;
+	}
+
+	void LitMeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		assert(indices.size() % 3 == 0 && "index count must be a multiple of 3");
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// per vertex list of the triangles using it, the first remainingValence entries are the ones not emitted yet
+		std::vector<uint32_t> remainingValence(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			remainingValence[index]++;
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount, 0);
+		uint32_t offset = 0;
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			adjacencyOffsets[vertex] = offset;
+			offset += remainingValence[vertex];
+		}
+
+		std::vector<uint32_t> adjacency(indices.size());
+		std::vector<uint32_t> adjacencyFill = adjacencyOffsets;
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				adjacency[adjacencyFill[indices[triangle * 3 + corner]]++] = triangle;
+			}
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			vertexScores[vertex] = ScoreVertex(-1, remainingValence[vertex]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		uint32_t bestTriangle = 0;
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			triangleScores[triangle] = vertexScores[indices[triangle * 3 + 0]] +
+				vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+			if (triangleScores[triangle] > triangleScores[bestTriangle])
+			{
+				bestTriangle = triangle;
+			}
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> newCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		uint32_t nextUnemitted = 0;
+
+		for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+		{
+			if (bestTriangle == UINT32_MAX)
+			{
+				// dead end, none of the cached vertices has triangles left: continue in input order
+				while (emitted[nextUnemitted])
+				{
+					nextUnemitted++;
+				}
+				bestTriangle = nextUnemitted;
+			}
+
+			emitted[bestTriangle] = true;
+			const uint32_t* triangleIndices = &indices[bestTriangle * 3];
+
+			newCache.clear();
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t vertex = triangleIndices[corner];
+				result.push_back(vertex);
+
+				uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+				uint32_t& valence = remainingValence[vertex];
+				for (uint32_t i = 0; i < valence; i++)
+				{
+					if (triangles[i] == bestTriangle)
+					{
+						std::swap(triangles[i], triangles[valence - 1]);
+						valence--;
+						break;
+					}
+				}
+
+				if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			// LRU: the triangle's vertices move to the front, everything else shifts back
+			const size_t triangleVertexCount = newCache.size();
+			for (uint32_t vertex : cache)
+			{
+				const auto triangleVerticesEnd = newCache.begin() + triangleVertexCount;
+				if (std::find(newCache.begin(), triangleVerticesEnd, vertex) == triangleVerticesEnd)
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			for (uint32_t i = 0; i < newCache.size(); i++)
+			{
+				const uint32_t vertex = newCache[i];
+				cachePositions[vertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+				vertexScores[vertex] = ScoreVertex(cachePositions[vertex], remainingValence[vertex]);
+			}
+
+			// only triangles touching the cache changed their score
+			bestTriangle = UINT32_MAX;
+			float bestScore = -1.0f;
+			for (uint32_t vertex : newCache)
+			{
+				const uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+				for (uint32_t i = 0; i < remainingValence[vertex]; i++)
+				{
+					const uint32_t triangle = triangles[i];
+					const float score = vertexScores[indices[triangle * 3 + 0]] +
+						vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+					triangleScores[triangle] = score;
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = triangle;
+					}
+				}
+			}
+
+			if (newCache.size() > FORSYTH_CACHE_SIZE)
+			{
+				newCache.resize(FORSYTH_CACHE_SIZE);
+			}
+			std::swap(cache, newCache);
+		}
+
+		indices.swap(result);
+	}
+
+	void LitMeshOptimizer::OptimizeOverdraw(
+		std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold)
+	{
+		assert(indices.size() % 3 == 0 && "index count must be a multiple of 3");
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		// hard boundaries: triangles missing all three vertices, the cache optimizer restarted there anyway
+		std::vector<uint32_t> triangleMisses(triangleCount, 0);
+		std::vector<uint32_t> hardClusters;
+		FifoCache cache(vertexCount, DEFAULT_CACHE_SIZE);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				triangleMisses[triangle] += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+			}
+			if (triangle == 0 || triangleMisses[triangle] == 3)
+			{
+				hardClusters.push_back(triangle);
+			}
+		}
+		hardClusters.push_back(triangleCount);
+
+		// soft boundaries: split a hard cluster again as soon as the part so far (starting from a cold cache)
+		// stays within threshold of the cluster's ACMR, so the reordering costs at most that much cache efficiency
+		std::vector<uint32_t> clusters;
+		for (size_t hard = 0; hard + 1 < hardClusters.size(); hard++)
+		{
+			const uint32_t begin = hardClusters[hard];
+			const uint32_t end = hardClusters[hard + 1];
+
+			uint32_t clusterMisses = 0;
+			for (uint32_t triangle = begin; triangle < end; triangle++)
+			{
+				clusterMisses += triangleMisses[triangle];
+			}
+			const float clusterAcmr = static_cast<float>(clusterMisses) / (end - begin);
+
+			cache.Flush();
+			uint32_t softBegin = begin;
+			uint32_t softMisses = 0;
+			clusters.push_back(begin);
+			for (uint32_t triangle = begin; triangle < end; triangle++)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					softMisses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+				}
+
+				const float softAcmr = static_cast<float>(softMisses) / (triangle + 1 - softBegin);
+				if (triangle + 1 < end && softAcmr <= clusterAcmr * threshold)
+				{
+					clusters.push_back(triangle + 1);
+					softBegin = triangle + 1;
+					softMisses = 0;
+					cache.Flush();
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+
+		// area weighted centroid and normal per cluster
+		const size_t clusterCount = clusters.size() - 1;
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{ 0.0f });
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{ 0.0f });
+		glm::vec3 meshCentroid{ 0.0f };
+		float meshArea = 0.0f;
+		for (size_t cluster = 0; cluster < clusterCount; cluster++)
+		{
+			float clusterArea = 0.0f;
+			for (uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++)
+			{
+				const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+				const glm::vec3& p1 = positions[indices[triangle * 3 + 1]];
+				const glm::vec3& p2 = positions[indices[triangle * 3 + 2]];
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float area = glm::length(normal);
+
+				clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+				clusterNormals[cluster] += normal;
+				clusterArea += area;
+			}
+
+			meshCentroid += clusterCentroids[cluster];
+			meshArea += clusterArea;
+			clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : positions[indices[clusters[cluster] * 3]];
+		}
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+		// clusters facing away from the centre are more likely to occlude the rest, draw them first
+		std::vector<float> sortKeys(clusterCount);
+		std::vector<uint32_t> clusterOrder(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; cluster++)
+		{
+			const float normalLength = glm::length(clusterNormals[cluster]);
+			sortKeys[cluster] = normalLength > 0.0f ?
+				glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster] / normalLength) : 0.0f;
+			clusterOrder[cluster] = static_cast<uint32_t>(cluster);
+		}
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+			[&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t cluster : clusterOrder)
+		{
+			result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+		}
+		indices.swap(result);
+	}
+
+	// maps every vertex to an id shared by all vertices with exactly the same position
+	static std::vector<uint32_t> WeldPositions(const std::vector<glm::vec3>& positions, uint32_t& positionCount)
+	{
+		const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		std::vector<uint32_t> sortedVertices(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			sortedVertices[vertex] = vertex;
+		}
+		std::sort(sortedVertices.begin(), sortedVertices.end(), [&positions](uint32_t a, uint32_t b)
+			{
+				const glm::vec3& pa = positions[a];
+				const glm::vec3& pb = positions[b];
+				return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z);
+			});
+
+		std::vector<uint32_t> positionIds(vertexCount);
+		positionCount = 0;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			if (i > 0 && !(positions[sortedVertices[i]] == positions[sortedVertices[i - 1]]))
+			{
+				positionCount++;
+			}
+			positionIds[sortedVertices[i]] = positionCount;
+		}
+		positionCount = vertexCount > 0 ? positionCount + 1 : 0;
+		return positionIds;
+	}
+
+	// symmetric 4x4 matrix of the summed squared plane distances, weight is the summed area so Evaluate / weight
+	// is a squared distance independent of the tessellation
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+		double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+		double a22 = 0.0, a23 = 0.0;
+		double a33 = 0.0;
+		double weight = 0.0;
+
+		void AddPlane(const glm::vec3& normal, float distance, float planeWeight)
+		{
+			const double x = normal.x, y = normal.y, z = normal.z, d = distance, w = planeWeight;
+			a00 += w * x * x; a01 += w * x * y; a02 += w * x * z; a03 += w * x * d;
+			a11 += w * y * y; a12 += w * y * z; a13 += w * y * d;
+			a22 += w * z * z; a23 += w * z * d;
+			a33 += w * d * d;
+			weight += w;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+			a11 += other.a11; a12 += other.a12; a13 += other.a13;
+			a22 += other.a22; a23 += other.a23;
+			a33 += other.a33;
+			weight += other.weight;
+		}
+
+		double Evaluate(const glm::vec3& p) const
+		{
+			const double x = p.x, y = p.y, z = p.z;
+			const double result = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+				a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+				a22 * z * z + 2.0 * a23 * z +
+				a33;
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	enum class CollapseKind : uint8_t
+	{
+		Manifold,	// interior vertex, can collapse along any edge
+		Border,		// on an open edge, can only collapse along the border
+		Locked,		// seam or non-manifold, never moves
+	};
+
+	struct Collapse
+	{
+		uint32_t source;
+		uint32_t target;
+		float error;
+		bool bBorder;
+	};
+
+	static uint64_t EdgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	std::vector<uint32_t> LitMeshOptimizer::Simplify(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+		size_t targetIndexCount, float targetError, float* resultError)
+	{
+		assert(indices.size() % 3 == 0 && "index count must be a multiple of 3");
+		const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+		// weld vertices by position, the collapse works on positions and carries the wedges (vertex copies) along
+		uint32_t positionCount = 0;
+		const std::vector<uint32_t> positionIds = WeldPositions(positions, positionCount);
+
+		LitAABB bounds;
+		for (const auto& position : positions)
+		{
+			bounds.Expand(position);
+		}
+		const glm::vec3 extent = bounds.IsValid() ? bounds.Extent() : glm::vec3{ 0.0f };
+		const float meshScale = std::max(extent.x, std::max(extent.y, extent.z));
+		const float maxError = targetError * meshScale;
+		const float maxErrorSquared = maxError * maxError;
+
+		std::vector<uint32_t> result = indices;
+
+		// area weighted face planes
+		std::vector<Quadric> quadrics(positionCount);
+		std::unordered_map<uint64_t, uint32_t> edgeUse;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const glm::vec3& p0 = positions[result[i + 0]];
+			const glm::vec3& p1 = positions[result[i + 1]];
+			const glm::vec3& p2 = positions[result[i + 2]];
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(normal);
+			if (area > 0.0f)
+			{
+				normal /= area;
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					quadrics[positionIds[result[i + corner]]].AddPlane(normal, -glm::dot(normal, p0), area);
+				}
+			}
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				edgeUse[EdgeKey(positionIds[result[i + corner]], positionIds[result[i + (corner + 1) % 3]])]++;
+			}
+		}
+
+		// open edges get a heavily weighted plane through the edge, perpendicular to the face, so borders keep their shape
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const glm::vec3& p0 = positions[result[i + 0]];
+			const glm::vec3& p1 = positions[result[i + 1]];
+			const glm::vec3& p2 = positions[result[i + 2]];
+			const glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t a = result[i + corner];
+				const uint32_t b = result[i + (corner + 1) % 3];
+				if (edgeUse[EdgeKey(positionIds[a], positionIds[b])] != 1)
+				{
+					continue;
+				}
+				const glm::vec3 edge = positions[b] - positions[a];
+				glm::vec3 normal = glm::cross(edge, faceNormal);
+				const float length = glm::length(normal);
+				if (length > 0.0f)
+				{
+					normal /= length;
+					const float edgeWeight = glm::dot(edge, edge) * 10.0f;
+					quadrics[positionIds[a]].AddPlane(normal, -glm::dot(normal, positions[a]), edgeWeight);
+					quadrics[positionIds[b]].AddPlane(normal, -glm::dot(normal, positions[a]), edgeWeight);
+				}
+			}
+		}
+
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			remap[vertex] = vertex;
+		}
+
+		std::vector<CollapseKind> kinds(positionCount);
+		std::vector<uint32_t> wedges(positionCount);
+		std::vector<uint32_t> adjacencyOffsets(positionCount + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<bool> locked(positionCount);
+		std::vector<Collapse> collapses;
+		float largestError = 0.0f;
+
+		while (result.size() > targetIndexCount)
+		{
+			// classify the positions for the current triangles
+			edgeUse.clear();
+			std::fill(wedges.begin(), wedges.end(), UINT32_MAX);
+			std::fill(kinds.begin(), kinds.end(), CollapseKind::Manifold);
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t vertex = result[i + corner];
+					const uint32_t id = positionIds[vertex];
+					if (wedges[id] != UINT32_MAX && wedges[id] != vertex)
+					{
+						kinds[id] = CollapseKind::Locked;
+					}
+					wedges[id] = vertex;
+					adjacencyOffsets[id + 1]++;
+					edgeUse[EdgeKey(id, positionIds[result[i + (corner + 1) % 3]])]++;
+				}
+			}
+			for (const auto& edge : edgeUse)
+			{
+				const uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+				const uint32_t b = static_cast<uint32_t>(edge.first & 0xffffffff);
+				if (edge.second > 2)
+				{
+					kinds[a] = CollapseKind::Locked;
+					kinds[b] = CollapseKind::Locked;
+				}
+				else if (edge.second == 1)
+				{
+					kinds[a] = kinds[a] == CollapseKind::Locked ? CollapseKind::Locked : CollapseKind::Border;
+					kinds[b] = kinds[b] == CollapseKind::Locked ? CollapseKind::Locked : CollapseKind::Border;
+				}
+			}
+
+			for (uint32_t id = 0; id < positionCount; id++)
+			{
+				adjacencyOffsets[id + 1] += adjacencyOffsets[id];
+			}
+			adjacency.resize(result.size());
+			std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					adjacency[adjacencyFill[positionIds[result[i + corner]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// cheapest valid direction per edge
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t a = result[i + corner];
+					const uint32_t b = result[i + (corner + 1) % 3];
+					const uint32_t idA = positionIds[a];
+					const uint32_t idB = positionIds[b];
+					const bool bBorderEdge = edgeUse[EdgeKey(idA, idB)] == 1;
+					// each interior edge is visited from both of its triangles, only keep one
+					if (!bBorderEdge && idA > idB)
+					{
+						continue;
+					}
+
+					Quadric merged = quadrics[idA];
+					merged.Add(quadrics[idB]);
+					const double weight = merged.weight > 0.0 ? merged.weight : 1.0;
+
+					Collapse best{ UINT32_MAX, UINT32_MAX, std::numeric_limits<float>::max(), bBorderEdge };
+					const uint32_t sources[2] = { a, b };
+					const uint32_t targets[2] = { b, a };
+					for (uint32_t direction = 0; direction < 2; direction++)
+					{
+						const CollapseKind kind = kinds[positionIds[sources[direction]]];
+						if (kind == CollapseKind::Locked || (kind == CollapseKind::Border && !bBorderEdge))
+						{
+							continue;
+						}
+						const float error = static_cast<float>(merged.Evaluate(positions[targets[direction]]) / weight);
+						if (error < best.error)
+						{
+							best.source = sources[direction];
+							best.target = targets[direction];
+							best.error = error;
+						}
+					}
+
+					if (best.source != UINT32_MAX && best.error <= maxErrorSquared)
+					{
+						collapses.push_back(best);
+					}
+				}
+			}
+
+			if (collapses.empty())
+			{
+				break;
+			}
+			std::sort(collapses.begin(), collapses.end(),
+				[](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			// apply the cheapest collapses whose endpoints are untouched this pass
+			std::fill(locked.begin(), locked.end(), false);
+			size_t triangleCount = result.size() / 3;
+			const size_t targetTriangleCount = targetIndexCount / 3;
+			uint32_t appliedCollapses = 0;
+			for (const auto& collapse : collapses)
+			{
+				if (triangleCount <= targetTriangleCount)
+				{
+					break;
+				}
+
+				const uint32_t sourceId = positionIds[collapse.source];
+				const uint32_t targetId = positionIds[collapse.target];
+				if (locked[sourceId] || locked[targetId])
+				{
+					continue;
+				}
+
+				// reject collapses that flip a remaining triangle around the source
+				bool bFlips = false;
+				for (uint32_t k = adjacencyOffsets[sourceId]; k < adjacencyOffsets[sourceId + 1] && !bFlips; k++)
+				{
+					const uint32_t triangle = adjacency[k];
+					glm::vec3 corners[3];
+					uint32_t cornerIds[3];
+					uint32_t sourceCorner = 0;
+					for (uint32_t corner = 0; corner < 3; corner++)
+					{
+						const uint32_t vertex = remap[result[triangle * 3 + corner]];
+						cornerIds[corner] = positionIds[vertex];
+						sourceCorner = cornerIds[corner] == sourceId ? corner : sourceCorner;
+						corners[corner] = positions[vertex];
+					}
+					// triangles on the collapsed edge disappear, ones already degenerate from this pass are dropped later
+					if (cornerIds[0] == targetId || cornerIds[1] == targetId || cornerIds[2] == targetId ||
+						cornerIds[0] == cornerIds[1] || cornerIds[1] == cornerIds[2] || cornerIds[2] == cornerIds[0])
+					{
+						continue;
+					}
+
+					const glm::vec3 oldNormal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					corners[sourceCorner] = positions[collapse.target];
+					const glm::vec3 newNormal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					bFlips = glm::dot(oldNormal, newNormal) <= 0.0f;
+				}
+				if (bFlips)
+				{
+					continue;
+				}
+
+				remap[collapse.source] = collapse.target;
+				quadrics[targetId].Add(quadrics[sourceId]);
+				locked[sourceId] = true;
+				locked[targetId] = true;
+				triangleCount -= collapse.bBorder ? 1 : 2;
+				largestError = std::max(largestError, collapse.error);
+				appliedCollapses++;
+			}
+
+			if (appliedCollapses == 0)
+			{
+				break;
+			}
+
+			// rewrite the triangles and drop the ones that collapsed to a line
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				uint32_t triangle[3];
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					uint32_t vertex = result[i + corner];
+					while (remap[vertex] != vertex)
+					{
+						vertex = remap[vertex];
+					}
+					triangle[corner] = vertex;
+				}
+
+				if (positionIds[triangle[0]] == positionIds[triangle[1]] ||
+					positionIds[triangle[1]] == positionIds[triangle[2]] ||
+					positionIds[triangle[2]] == positionIds[triangle[0]])
+				{
+					continue;
+				}
+				result[writeIndex++] = triangle[0];
+				result[writeIndex++] = triangle[1];
+				result[writeIndex++] = triangle[2];
+			}
+			result.resize(writeIndex);
+		}
+
+		if (resultError != nullptr)
+		{
+			*resultError = meshScale > 0.0f ? std::sqrt(largestError) / meshScale : 0.0f;
+		}
+		return result;
+	}
+
+	// bounding sphere around the AABB centre and the normal cone of a finished meshlet
+	static void ComputeMeshletBounds(LitMeshlet& meshlet, const uint32_t* indices, const std::vector<glm::vec3>& positions)
+	{
+		LitAABB box;
+		for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+		{
+			box.Expand(positions[indices[i]]);
+		}
+
+		meshlet.bounds.center = box.Center();
+		meshlet.bounds.radius = 0.0f;
+		for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+		{
+			meshlet.bounds.radius = std::max(meshlet.bounds.radius, glm::distance(meshlet.bounds.center, positions[indices[i]]));
+		}
+
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.triangleCount);
+		glm::vec3 axis{ 0.0f };
+		for (uint32_t triangle = 0; triangle < meshlet.triangleCount; triangle++)
+		{
+			const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+			const glm::vec3& p1 = positions[indices[triangle * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[triangle * 3 + 2]];
+			const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		meshlet.coneAxis = glm::vec3{ 0.0f, 0.0f, 1.0f };
+		meshlet.coneCutoff = 1.0f;
+		const float axisLength = glm::length(axis);
+		if (axisLength <= 0.0f)
+		{
+			return;
+		}
+		axis /= axisLength;
+
+		float minDot = 1.0f;
+		for (const auto& normal : normals)
+		{
+			minDot = std::min(minDot, glm::dot(axis, normal));
+		}
+
+		// wider than ~85 degrees can't be culled from anywhere useful
+		meshlet.coneAxis = axis;
+		if (minDot > 0.1f)
+		{
+			meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+		}
+	}
+
+	std::vector<LitMeshlet> LitMeshOptimizer::BuildMeshlets(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+		uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		assert(indices.size() % 3 == 0 && "index count must be a multiple of 3");
+		assert(maxVertices >= 3 && maxTriangles >= 1);
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+		// neighbours are found through positions so flat shaded meshes, which share no vertices, still grow
+		// connected meshlets. The vertex limit counts real vertices
+		uint32_t positionCount = 0;
+		const std::vector<uint32_t> positionIds = WeldPositions(positions, positionCount);
+		std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+		for (uint32_t index : indices)
+		{
+			adjacencyOffsets[positionIds[index] + 1]++;
+		}
+		for (uint32_t id = 0; id < positionCount; id++)
+		{
+			adjacencyOffsets[id + 1] += adjacencyOffsets[id];
+		}
+		std::vector<uint32_t> adjacency(indices.size());
+		std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				adjacency[adjacencyFill[positionIds[indices[triangle * 3 + corner]]]++] = triangle;
+			}
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+		// meshletIds[vertex] == current meshlet number marks the vertices already in the meshlet
+		std::vector<uint32_t> meshletIds(vertexCount, UINT32_MAX);
+		std::vector<uint32_t> meshletPositionIds(positionCount, UINT32_MAX);
+		std::vector<uint32_t> meshletVertices;
+		std::vector<uint32_t> meshletPositions;
+		meshletVertices.reserve(maxVertices);
+		meshletPositions.reserve(maxVertices);
+
+		std::vector<LitMeshlet> meshlets;
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		auto newVertexCount = [&](uint32_t triangle, uint32_t meshletId)
+		{
+			uint32_t count = 0;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t vertex = indices[triangle * 3 + corner];
+				// degenerate triangles may repeat a vertex, count it once
+				bool bRepeated = false;
+				for (uint32_t previous = 0; previous < corner; previous++)
+				{
+					bRepeated |= indices[triangle * 3 + previous] == vertex;
+				}
+				count += (meshletIds[vertex] != meshletId && !bRepeated) ? 1 : 0;
+			}
+			return count;
+		};
+
+		uint32_t nextSeed = 0;
+		uint32_t emittedCount = 0;
+		while (emittedCount < triangleCount)
+		{
+			while (emitted[nextSeed])
+			{
+				nextSeed++;
+			}
+
+			LitMeshlet meshlet{};
+			meshlet.firstIndex = static_cast<uint32_t>(result.size());
+			const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+			meshletVertices.clear();
+			meshletPositions.clear();
+			glm::vec3 centroid{ 0.0f };
+
+			uint32_t triangle = nextSeed;
+			while (triangle != UINT32_MAX)
+			{
+				emitted[triangle] = true;
+				emittedCount++;
+				meshlet.triangleCount++;
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t vertex = indices[triangle * 3 + corner];
+					result.push_back(vertex);
+					if (meshletIds[vertex] != meshletId)
+					{
+						meshletIds[vertex] = meshletId;
+						meshletVertices.push_back(vertex);
+					}
+					if (meshletPositionIds[positionIds[vertex]] != meshletId)
+					{
+						meshletPositionIds[positionIds[vertex]] = meshletId;
+						meshletPositions.push_back(positionIds[vertex]);
+						centroid += positions[vertex];
+					}
+				}
+
+				if (meshlet.triangleCount == maxTriangles)
+				{
+					break;
+				}
+
+				// best neighbour: fewest new vertices, then closest to the centroid
+				const glm::vec3 center = centroid / static_cast<float>(meshletPositions.size());
+				triangle = UINT32_MAX;
+				uint32_t bestNewVertices = UINT32_MAX;
+				float bestDistance = std::numeric_limits<float>::max();
+				for (uint32_t id : meshletPositions)
+				{
+					for (uint32_t k = adjacencyOffsets[id]; k < adjacencyOffsets[id + 1]; k++)
+					{
+						const uint32_t candidate = adjacency[k];
+						if (emitted[candidate])
+						{
+							continue;
+						}
+
+						const uint32_t newVertices = newVertexCount(candidate, meshletId);
+						if (meshletVertices.size() + newVertices > maxVertices || newVertices > bestNewVertices)
+						{
+							continue;
+						}
+
+						const glm::vec3 triangleCenter = (positions[indices[candidate * 3 + 0]] +
+							positions[indices[candidate * 3 + 1]] + positions[indices[candidate * 3 + 2]]) / 3.0f;
+						const glm::vec3 offset = triangleCenter - center;
+						const float distance = glm::dot(offset, offset);
+						if (newVertices < bestNewVertices || distance < bestDistance)
+						{
+							triangle = candidate;
+							bestNewVertices = newVertices;
+							bestDistance = distance;
+						}
+					}
+				}
+			}
+
+			meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+			ComputeMeshletBounds(meshlet, &result[meshlet.firstIndex], positions);
+			meshlets.push_back(meshlet);
+		}
+
+		indices.swap(result);
+		return meshlets;
+	}
+
+	std::vector<uint32_t> LitMeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+		uint32_t nextVertex = 0;
+		for (uint32_t& index : indices)
+		{
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = nextVertex++;
+			}
+			index = remap[index];
+		}
+		return remap;
+	}
+}
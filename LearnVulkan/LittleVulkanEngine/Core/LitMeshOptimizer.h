@@ -0,0 +1,84 @@
+#pragma once
+#include "LitMeshlet.h"
+
+//libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+//std
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Lit
+{
+	// Result of running an index buffer through a simulated FIFO post-transform cache
+	struct VertexCacheStatistics
+	{
+		uint32_t vertexTransforms = 0;
+		uint32_t triangleCount = 0;
+		uint32_t vertexCount = 0;
+		float acmr = 0.0f;	// average cache miss ratio: transforms per triangle, 0.5 is the best case for a regular grid, 3 the worst
+		float atvr = 0.0f;	// average transform to vertex ratio: transforms per vertex, 1 is optimal
+	};
+
+	// CPU only index/vertex reordering passes, they work on triangle lists and never touch the GPU
+	class LitMeshOptimizer
+	{
+	public:
+		static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+		static VertexCacheStatistics AnalyzeVertexCache(
+			const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+		// Forsyth's "Linear-Speed Vertex Cache Optimisation": greedily emits the triangle with the best score,
+		// scores favour vertices that are recent in an LRU cache and vertices with few remaining triangles
+		static void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+		// Splits the cache optimized index buffer into clusters and sorts them so outward facing clusters come first,
+		// see Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+		// threshold limits how much the ACMR may degrade to create more (smaller) clusters
+		static void OptimizeOverdraw(
+			std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f);
+
+		// Quadric error metric edge collapse (Garland & Heckbert) down to targetIndexCount indices. Vertices are never
+		// moved or created so the result indexes the same vertex buffer. Vertices sharing a position but not the other
+		// attributes (uv/normal seams) and non-manifold vertices are locked, border vertices only slide along the border.
+		// targetError is relative to the mesh extent, resultError receives the largest collapse error with the same scale
+		static std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+			size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		// Greedily grows meshlets over shared vertices, preferring triangles that add no new vertex and then the
+		// ones closest to the meshlet centre. indices is reordered so every meshlet is a contiguous range
+		static std::vector<LitMeshlet> BuildMeshlets(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+			uint32_t maxVertices = LitMeshlet::MAX_VERTICES, uint32_t maxTriangles = LitMeshlet::MAX_TRIANGLES);
+
+		// Rewrites the indices so vertices are numbered in first use order and returns the old -> new remap table,
+		// unreferenced vertices map to UINT32_MAX. Apply it to the vertex buffer with RemapVertices
+		static std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+		template<typename T>
+		static std::vector<T> RemapVertices(const std::vector<T>& vertices, const std::vector<uint32_t>& remap)
+		{
+			uint32_t newVertexCount = 0;
+			for (uint32_t target : remap)
+			{
+				if (target != UINT32_MAX)
+				{
+					newVertexCount = std::max(newVertexCount, target + 1);
+				}
+			}
+
+			std::vector<T> result(newVertexCount);
+			for (size_t i = 0; i < remap.size(); i++)
+			{
+				if (remap[i] != UINT32_MAX)
+				{
+					result[remap[i]] = vertices[i];
+				}
+			}
+			return result;
+		}
+	};
+}
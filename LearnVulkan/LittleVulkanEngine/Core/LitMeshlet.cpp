@@ -0,0 +1,76 @@
+#include "LitMeshlet.h"
+
+// std
+#include <cmath>
+
+namespace Lit
+{
+	LitMeshletCuller::LitMeshletCuller(const glm::mat4& viewProjection, const glm::vec3& inCameraPosition)
+		: frustum{ LitFrustum::FromMatrix(viewProjection) }, cameraPosition{ inCameraPosition }
+	{
+	}
+
+	uint32_t LitMeshletCuller::Cull(const std::vector<LitMeshlet>& meshlets, const glm::mat4& modelMatrix,
+		std::vector<VkDrawIndexedIndirectCommand>& draws, uint32_t firstIndex, int32_t baseVertex)
+	{
+		const glm::vec3 axisX{ modelMatrix[0] };
+		const glm::vec3 axisY{ modelMatrix[1] };
+		const glm::vec3 axisZ{ modelMatrix[2] };
+		const float scaleX = glm::length(axisX);
+		const float scaleY = glm::length(axisY);
+		const float scaleZ = glm::length(axisZ);
+		const float maxScale = std::fmax(scaleX, std::fmax(scaleY, scaleZ));
+		const float minScale = std::fmin(scaleX, std::fmin(scaleY, scaleZ));
+		// a non uniform scale bends the normals so the cones no longer bound them, only cull by frustum then
+		const bool bConeCulling = minScale > 0.0f && maxScale - minScale <= maxScale * 1e-3f;
+
+		const size_t firstDraw = draws.size();
+		uint32_t nextIndex = UINT32_MAX;
+		for (const auto& meshlet : meshlets)
+		{
+			statistics.meshletCount++;
+
+			const LitSphere worldBounds{
+				glm::vec3(modelMatrix * glm::vec4(meshlet.bounds.center, 1.0f)), meshlet.bounds.radius * maxScale };
+			if (!frustum.Intersects(worldBounds))
+			{
+				statistics.frustumCulled++;
+				continue;
+			}
+
+			if (bConeCulling && meshlet.coneCutoff < 1.0f)
+			{
+				// the whole sphere sees the cluster from behind if the view direction is inside the cone's back side
+				const glm::vec3 axis = glm::vec3(modelMatrix * glm::vec4(meshlet.coneAxis, 0.0f)) / maxScale;
+				const glm::vec3 toCenter = worldBounds.center - cameraPosition;
+				if (glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + worldBounds.radius)
+				{
+					statistics.backfaceCulled++;
+					continue;
+				}
+			}
+
+			statistics.triangleCount += meshlet.triangleCount;
+			if (nextIndex == meshlet.firstIndex && draws.size() > firstDraw)
+			{
+				// neighbouring meshlets in the index buffer merge into one draw
+				draws.back().indexCount += meshlet.triangleCount * 3;
+			}
+			else
+			{
+				VkDrawIndexedIndirectCommand draw{};
+				draw.indexCount = meshlet.triangleCount * 3;
+				draw.instanceCount = 1;
+				draw.firstIndex = firstIndex + meshlet.firstIndex;
+				draw.vertexOffset = baseVertex;
+				draw.firstInstance = 0;
+				draws.push_back(draw);
+			}
+			nextIndex = meshlet.firstIndex + meshlet.triangleCount * 3;
+		}
+
+		const uint32_t drawCount = static_cast<uint32_t>(draws.size() - firstDraw);
+		statistics.drawCount += drawCount;
+		return drawCount;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "LitBounds.h"
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace Lit
+{
+	// A cluster of at most MAX_VERTICES vertices and MAX_TRIANGLES triangles, stored as a contiguous
+	// range of the model's index buffer so the survivors of culling can be drawn with plain indexed draws
+	struct LitMeshlet
+	{
+		static constexpr uint32_t MAX_VERTICES = 64;
+		static constexpr uint32_t MAX_TRIANGLES = 124;
+
+		uint32_t firstIndex = 0;
+		uint32_t triangleCount = 0;
+		uint32_t vertexCount = 0;
+
+		LitSphere bounds;
+		// all triangle normals are within the cone around coneAxis, coneCutoff is the sine of its half angle.
+		// A cutoff of 1 means the normals spread too much to ever back face cull the cluster
+		glm::vec3 coneAxis{ 0.0f, 0.0f, 1.0f };
+		float coneCutoff = 1.0f;
+	};
+
+	struct MeshletCullStatistics
+	{
+		uint32_t meshletCount = 0;
+		uint32_t frustumCulled = 0;
+		uint32_t backfaceCulled = 0;
+		uint32_t drawCount = 0;
+		uint32_t triangleCount = 0;
+
+		void Reset() { *this = MeshletCullStatistics{}; }
+	};
+
+	// Per view culling of meshlets against the frustum and their normal cones, all tests in world space
+	class LitMeshletCuller
+	{
+	public:
+		LitMeshletCuller(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+
+		// appends one indexed draw per run of consecutive visible meshlets, returns the number of draws appended.
+		// firstIndex and baseVertex locate the model in the bound index/vertex buffers
+		uint32_t Cull(const std::vector<LitMeshlet>& meshlets, const glm::mat4& modelMatrix,
+			std::vector<VkDrawIndexedIndirectCommand>& draws, uint32_t firstIndex = 0, int32_t baseVertex = 0);
+
+		const MeshletCullStatistics& GetStatistics() const { return statistics; }
+		void ResetStatistics() { statistics.Reset(); }
+
+	private:
+		LitFrustum frustum;
+		glm::vec3 cameraPosition;
+		MeshletCullStatistics statistics;
+	};
+}
@@ -1,37 +1,24 @@
 #include "LitModel.h"
+#include "LitCpuProfiler.h"
+#include "LitMeshOptimizer.h"
 
 #include "LitUtils.h"
 
-// libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-
 // lib headers
 #define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
 
-namespace std
-{
-	// special partical template
-	template<>
-	struct hash<Lit::LitModel::Vertex>
-	{
-		size_t operator()(Lit::LitModel::Vertex const& vertex) const
-		{
-			size_t seed = 0;
-			//Lit::HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-			return seed;
-		}
-	};
-}
-
 namespace Lit
 {
 	std::vector<VkVertexInputBindingDescription> LitModel::Vertex::GetVertexInputBindingDesc()
@@ -69,147 +56,351 @@ namespace Lit
 		return attributeDescriptions;
 	}
 
-	LitModel::LitModel(LitDevice& inDevice, const Builder& builder):
-		device(inDevice)
+	// Octahedral normal encoding, see "A Survey of Efficient Representations for Independent Unit Vectors"
+	static glm::vec2 OctahedralEncode(glm::vec3 n)
+	{
+		n /= (glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z));
+		glm::vec2 result{ n.x, n.y };
+		if (n.z < 0.0f)
+		{
+			result.x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+			result.y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+		}
+		return result;
+	}
+
+	static uint32_t PackUnorm8(float value)
+	{
+		return static_cast<uint32_t>(glm::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+	}
+
+	static uint32_t PackSnorm16(float value)
+	{
+		return static_cast<uint16_t>(static_cast<int16_t>(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f)));
+	}
+
+	LitModel::PackedVertex LitModel::PackedVertex::Pack(const Vertex& vertex, const LitAABB& bounds)
+	{
+		PackedVertex packed{};
+
+		const glm::vec3 extent = bounds.Extent();
+		for (int i = 0; i < 3; i++)
+		{
+			float normalized = extent[i] > 0.0f ? (vertex.position[i] - bounds.min[i]) / extent[i] : 0.0f;
+			packed.position[i] = static_cast<uint16_t>(glm::round(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+		}
+		packed.position[3] = 0;
+
+		glm::vec3 normal = vertex.normal;
+		if (glm::dot(normal, normal) > 0.0f)
+		{
+			const glm::vec2 octahedral = OctahedralEncode(normal);
+			packed.normal = PackSnorm16(octahedral.x) | (PackSnorm16(octahedral.y) << 16);
+		}
+
+		packed.uv = static_cast<uint32_t>(glm::packHalf1x16(vertex.uv.x)) |
+			(static_cast<uint32_t>(glm::packHalf1x16(vertex.uv.y)) << 16);
+
+		packed.color = PackUnorm8(vertex.color.x) | (PackUnorm8(vertex.color.y) << 8) |
+			(PackUnorm8(vertex.color.z) << 16) | (PackUnorm8(1.0f) << 24);
+		return packed;
+	}
+
+	std::vector<VkVertexInputBindingDescription> LitModel::PackedVertex::GetVertexInputBindingDesc()
+	{
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1, VkVertexInputBindingDescription{});
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(PackedVertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	// same locations as Vertex, the formats let the input assembler do most of the decoding:
+	// shaders only have to expand the octahedral normal (see packed_shader.vert)
+	std::vector<VkVertexInputAttributeDescription> LitModel::PackedVertex::GetVertexInputAttributeDesc()
+	{
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4, VkVertexInputAttributeDescription{});
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = offsetof(PackedVertex, position);
+
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[1].offset = offsetof(PackedVertex, color);
+
+		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+		attributeDescriptions[2].offset = offsetof(PackedVertex, normal);
+
+		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[3].offset = offsetof(PackedVertex, uv);
+
+		return attributeDescriptions;
+	}
+
+	LitModel::LitModel(LitDevice& inDevice, const Builder& builder, VertexFormat format, LitGeometryPool* inGeometryPool):
+		device(inDevice), vertexFormat(format)
 	{ 
-		CreateVertexBuffer(builder.vertices);
-		createIndexBuffers(builder.indices);
+		for (const auto& vertex : builder.vertices)
+		{
+			bounds.Expand(vertex.position);
+		}
+
+		vertexCount = static_cast<uint32_t>(builder.vertices.size());
+		assert(vertexCount >= 3 && "vertex count must be at least 3");
+		std::vector<PackedVertex> packedVertices;
+		const void* vertexData = builder.vertices.data();
+		if (vertexFormat == VertexFormat::Packed)
+		{
+			packedVertices.reserve(vertexCount);
+			for (const auto& vertex : builder.vertices)
+			{
+				packedVertices.push_back(PackedVertex::Pack(vertex, bounds));
+			}
+			vertexData = packedVertices.data();
+		}
+
+		indexCount = static_cast<uint32_t>(builder.indices.size());
+		hasIndexBuffer = indexCount > 0;
+		// 0xffff is left out so the indices stay valid should primitive restart ever be enabled
+		std::vector<uint16_t> indices16;
+		const void* indexData = builder.indices.data();
+		if (vertexCount < std::numeric_limits<uint16_t>::max())
+		{
+			indexType = VK_INDEX_TYPE_UINT16;
+			indices16.assign(builder.indices.begin(), builder.indices.end());
+			indexData = indices16.data();
+		}
+
+		if (inGeometryPool != nullptr)
+		{
+			if (inGeometryPool->Allocate(vertexData, GetVertexStride(vertexFormat), vertexCount,
+				indexData, indexType, indexCount, poolAllocation))
+			{
+				geometryPool = inGeometryPool;
+			}
+			else
+			{
+				std::cout << "geometry pool is full, model gets its own buffers" << std::endl;
+			}
+		}
+		if (geometryPool == nullptr)
+		{
+			CreateVertexBuffer(vertexData);
+			createIndexBuffers(indexData);
+		}
+
+		lods = builder.lods;
+		meshlets = builder.meshlets;
+		if (lods.empty() && hasIndexBuffer)
+		{
+			lods.push_back(LodLevel{ 0, indexCount, 0.0f });
+		}
+
+		if (hasIndexBuffer)
+		{
+			std::vector<glm::vec3> positions;
+			positions.reserve(vertexCount);
+			for (const auto& vertex : builder.vertices)
+			{
+				positions.push_back(vertex.position);
+			}
+			meshBvh = std::make_unique<LitMeshBvh>(positions, builder.indices.data() + lods[0].firstIndex, lods[0].indexCount);
+		}
 	}
 	LitModel::~LitModel()
 	{
-
+		if (geometryPool != nullptr)
+		{
+			// the range may only be handed out again once frames in flight stopped drawing from it
+			LitGeometryPool* pool = geometryPool;
+			LitGeometryPool::Allocation allocation = poolAllocation;
+			device.GetDeletionQueue().Push([pool, allocation]() { pool->Free(allocation); });
+		}
 	}
-	std::unique_ptr<LitModel> LitModel::CreateModelFromFile(LitDevice& device, const std::string& filepath) 
+	std::unique_ptr<LitModel> LitModel::CreateModelFromFile(LitDevice& device, const std::string& filepath, VertexFormat format) 
 	{
+		LoadOptions options{};
+		options.vertexFormat = format;
+		return CreateModelFromFile(device, filepath, options);
+	}
+
+	std::unique_ptr<LitModel> LitModel::CreateModelFromFile(LitDevice& device, const std::string& filepath, const LoadOptions& options)
+	{
+		LIT_CPU_ZONE("load model");
 		Builder builder{};
 		builder.LoadModel(filepath);
-		return std::make_unique<LitModel>(device, builder);
+
+		const uint32_t loadedVertexCount = static_cast<uint32_t>(builder.vertices.size());
+		const VertexCacheStatistics before = LitMeshOptimizer::AnalyzeVertexCache(builder.indices, loadedVertexCount);
+		builder.GenerateLods(options);
+		builder.Optimize(options);
+		// statistics of the full resolution mesh, the LODs follow it in the index buffer
+		const std::vector<uint32_t> lod0Indices(builder.indices.begin(), builder.indices.begin() + before.triangleCount * 3);
+		const VertexCacheStatistics after =
+			LitMeshOptimizer::AnalyzeVertexCache(lod0Indices, static_cast<uint32_t>(builder.vertices.size()));
+
+		auto model = std::make_unique<LitModel>(device, builder, options.vertexFormat, options.geometryPool);
+
+		const uint32_t floatStride = GetVertexStride(VertexFormat::Float);
+		const uint32_t stride = GetVertexStride(options.vertexFormat);
+		std::cout << filepath << ": " << model->vertexCount << " vertices, "
+			<< floatStride << " -> " << stride << " bytes/vertex ("
+			<< model->vertexCount * floatStride << " -> " << model->vertexCount * stride << " bytes), "
+			<< "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+		std::cout << "  LOD triangles:";
+		for (const auto& lod : model->lods)
+		{
+			std::cout << " " << lod.indexCount / 3;
+		}
+		std::cout << ", " << model->meshlets.size() << " meshlets, "
+			<< (model->indexType == VK_INDEX_TYPE_UINT16 ? 16 : 32) << " bit indices" << std::endl;
+		return model;
+	}
+
+	uint32_t LitModel::GetVertexStride(VertexFormat format)
+	{
+		return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
 	}
-	void LitModel::CreateVertexBuffer(const std::vector<Vertex>& vertices)
+
+	std::vector<VkVertexInputBindingDescription> LitModel::GetPositionInputBindingDesc(VertexFormat format)
 	{
-		vertexCount = static_cast<uint32_t>(vertices.size());
-		assert(vertexCount >= 3 && "vertex count must be at least 3");
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-		VkDeviceSize vertexSize = sizeof(vertices[0]);
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1, VkVertexInputBindingDescription{});
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = GetVertexStride(format);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> LitModel::GetPositionInputAttributeDesc(VertexFormat format)
+	{
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(1, VkVertexInputAttributeDescription{});
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		if (format == VertexFormat::Packed)
+		{
+			attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+			attributeDescriptions[0].offset = offsetof(PackedVertex, position);
+		}
+		else
+		{
+			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+			attributeDescriptions[0].offset = offsetof(Vertex, position);
+		}
+		return attributeDescriptions;
+	}
+
+	glm::mat4 LitModel::GetDequantizeMatrix() const
+	{
+		if (vertexFormat != VertexFormat::Packed)
+		{
+			return glm::mat4{ 1.0f };
+		}
+		// positions are stored as (p - min) / extent, fold the inverse into the model matrix
+		glm::vec3 extent = bounds.Extent();
+		for (int i = 0; i < 3; i++)
+		{
+			extent[i] = extent[i] > 0.0f ? extent[i] : 1.0f;
+		}
+		return glm::scale(glm::translate(glm::mat4{ 1.0f }, bounds.min), extent);
+	}
+
+	void LitModel::CreateVertexBuffer(const void* vertexData)
+	{
+		VkDeviceSize vertexSize = GetVertexStride(vertexFormat);
+		VkDeviceSize bufferSize = vertexSize * vertexCount;
 		LitBuffer stagingBuffer(device, vertexSize, vertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
 		stagingBuffer.Map();
-		stagingBuffer.WriteToBuffer((void*)vertices.data());
+		stagingBuffer.WriteToBuffer(const_cast<void*>(vertexData));
 		vertexBuffer = std::make_unique<LitBuffer>(device, vertexSize, vertexCount,
 			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Mesh);
 		device.CopyBuffer(stagingBuffer.GetBuffer(), vertexBuffer->GetBuffer(), bufferSize);
 	}
 
-	void LitModel::createIndexBuffers(const std::vector<uint32_t>& indices) 
+	void LitModel::createIndexBuffers(const void* indexData) 
 	{
-		indexCount = static_cast<uint32_t>(indices.size());
-		hasIndexBuffer = indexCount > 0;
-
 		if (!hasIndexBuffer) {
 			return;
 		}
 
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-		VkDeviceSize indexSize = sizeof(indices[0]);
+		VkDeviceSize indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		VkDeviceSize bufferSize = indexSize * indexCount;
 		LitBuffer stagingBuffer(device, indexSize, indexCount,
 			VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging);
 		stagingBuffer.Map();
-		stagingBuffer.WriteToBuffer((void*)indices.data());
+		stagingBuffer.WriteToBuffer(const_cast<void*>(indexData));
 		indexBuffer = std::make_unique<LitBuffer>(device, indexSize, indexCount,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Mesh);
 		device.CopyBuffer(stagingBuffer.GetBuffer(), indexBuffer->GetBuffer(), bufferSize);
 	}
 
-	void LitModel::Draw(VkCommandBuffer commandBuffer)
+	uint32_t LitModel::SelectLod(float screenScale, float maxScreenError) const
+	{
+		uint32_t lod = 0;
+		while (lod + 1 < lods.size() && lods[lod + 1].error * screenScale <= maxScreenError)
+		{
+			lod++;
+		}
+		return lod;
+	}
+
+	void LitModel::Draw(VkCommandBuffer commandBuffer, uint32_t lod)
 	{
 		if (hasIndexBuffer)
 		{
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+			const LodLevel& level = lods[std::min(lod, static_cast<uint32_t>(lods.size()) - 1)];
+			vkCmdDrawIndexed(commandBuffer, level.indexCount, 1, poolAllocation.firstIndex + level.firstIndex,
+				poolAllocation.baseVertex, 0);
 		}
 		else {
-			vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+			vkCmdDraw(commandBuffer, vertexCount, 1, static_cast<uint32_t>(poolAllocation.baseVertex), 0);
 		}
 	}
 
+	void LitModel::DrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount)
+	{
+		assert(hasIndexBuffer && "indirect draws are indexed");
+		if (device.SupportsMultiDrawIndirect())
+		{
+			vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+			return;
+		}
+
+		for (uint32_t i = 0; i < drawCount; i++)
+		{
+			vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset + i * sizeof(VkDrawIndexedIndirectCommand), 1,
+				sizeof(VkDrawIndexedIndirectCommand));
+		}
+	}
+
+	VkBuffer LitModel::GetVertexBuffer() const
+	{
+		return geometryPool != nullptr ? geometryPool->GetVertexBuffer() : vertexBuffer->GetBuffer();
+	}
+
 	void LitModel::Bind(VkCommandBuffer commandBuffer)
 	{
+		if (geometryPool != nullptr)
+		{
+			geometryPool->Bind(commandBuffer, indexType);
+			return;
+		}
+
 		VkBuffer buffers[] = { vertexBuffer->GetBuffer() };
 		VkDeviceSize offsets[] = { 0 };
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
 		if (hasIndexBuffer) 
 		{
-			vkCmdBindIndexBuffer(commandBuffer, indexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
-		}
-	}
-
-	void LitModel::Builder::LoadModel(const std::string& filepath)
-	{
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
-
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
-			throw std::runtime_error(warn + err);
-		}
-
-		vertices.clear();
-		indices.clear();
-
-		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-		for (const auto& shape : shapes) {
-			for (const auto& index : shape.mesh.indices) {
-				Vertex vertex{};
-
-				if (index.vertex_index >= 0) {
-					vertex.position = glm::vec3{
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2],
-					};
-
-					//auto colorIndex = 3 * index.vertex_index + 2;
-					//if (colorIndex < attrib.colors.size()) {
-					//	vertex.color = glm::vec3{
-					//		attrib.colors[colorIndex - 2],
-					//		attrib.colors[colorIndex - 1],
-					//		attrib.colors[colorIndex - 0],
-					//	};
-					//}
-					//else {
-					//	vertex.color = glm::vec3{ 1.f, 1.f, 1.f };  // set default color
-					//}
-					vertex.color = glm::vec3{
-					   attrib.colors[3 * index.vertex_index + 0],
-					   attrib.colors[3 * index.vertex_index + 1],
-					   attrib.colors[3 * index.vertex_index + 2],
-					};
-				}
-
-				if (index.normal_index >= 0) {
-					vertex.normal = glm::vec3{
-						attrib.normals[3 * index.normal_index + 0],
-						attrib.normals[3 * index.normal_index + 1],
-						attrib.normals[3 * index.normal_index + 2],
-					};
-				}
-
-				if (index.texcoord_index >= 0) {
-					vertex.uv = glm::vec2{
-						attrib.texcoords[2 * index.texcoord_index + 0],
-						attrib.texcoords[2 * index.texcoord_index + 1],
-					};
-				}
-
-				if (uniqueVertices.count(vertex) == 0) {
-					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-					vertices.push_back(vertex);
-				}
-				indices.push_back(uniqueVertices[vertex]);
-			}
+			vkCmdBindIndexBuffer(commandBuffer, indexBuffer->GetBuffer(), 0, indexType);
 		}
 	}
-}
+}
\ No newline at end of file
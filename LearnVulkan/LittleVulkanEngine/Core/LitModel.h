@@ -1,6 +1,10 @@
 #pragma once
 #include "LitDevice.h"
 #include "LitBuffer.h"
+#include "LitBounds.h"
+#include "LitGeometryPool.h"
+#include "LitMeshBvh.h"
+#include "LitMeshlet.h"
 
 //libs
 #define GLM_FORCE_RADIANS
@@ -16,6 +20,13 @@ namespace Lit
 	class LitModel
 	{
 	public:
+		// Layout of the vertex buffer on the GPU, chosen per model at load time
+		enum class VertexFormat
+		{
+			Float,	// Vertex, 44 bytes
+			Packed,	// PackedVertex, 20 bytes
+		};
+
 		struct Vertex
 		{
 			glm::vec3 position;
@@ -30,38 +41,139 @@ namespace Lit
 					uv == other.uv;
 			}
 		};
+		// Compressed vertex:
+		// position: 16 bit unorm relative to the mesh bounds, see GetDequantizeMatrix
+		// normal: octahedral encoded in two 16 bit snorm
+		// uv: two half floats
+		// color: rgba8 unorm
+		struct PackedVertex
+		{
+			uint16_t position[4];
+			uint32_t normal;
+			uint32_t uv;
+			uint32_t color;
+
+			static PackedVertex Pack(const Vertex& vertex, const LitAABB& bounds);
+			static std::vector<VkVertexInputBindingDescription> GetVertexInputBindingDesc();
+			static std::vector<VkVertexInputAttributeDescription> GetVertexInputAttributeDesc();
+		};
+
+		struct LoadOptions
+		{
+			VertexFormat vertexFormat = VertexFormat::Float;
+			// reorder triangles for the post-transform cache
+			bool bOptimizeVertexCache = true;
+			// sort triangle clusters outside-in, trades a little cache efficiency for less overdraw
+			bool bOptimizeOverdraw = false;
+			// reorder the vertex buffer to match the order the indices reference it
+			bool bOptimizeVertexFetch = true;
+			// LOD chain including the full resolution mesh, 1 disables simplification
+			uint32_t maxLodCount = 4;
+			// triangle count of each LOD relative to the previous one
+			float lodReduction = 0.5f;
+			// simplification stops once the error exceeds this fraction of the model extent
+			float lodMaxError = 0.05f;
+			// split LOD0 into meshlets for cluster culling, skipped for models that would fit in one
+			bool bBuildMeshlets = true;
+			// shared vertex/index buffers to place the model in, null gives the model buffers of its own
+			LitGeometryPool* geometryPool = nullptr;
+		};
+
+		// range of the shared index buffer, error is the simplification error in model space units
+		struct LodLevel
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			float error;
+		};
+
 		struct Builder
 		{
 			std::vector<Vertex> vertices{};
 			std::vector<uint32_t> indices{};
+			// empty means a single LOD covering all indices
+			std::vector<LodLevel> lods{};
+			// contiguous triangle ranges of LOD0
+			std::vector<LitMeshlet> meshlets{};
 			void LoadModel(const std::string& filepath);
+			// appends simplified copies of the triangle list to indices, all LODs share the vertices
+			void GenerateLods(const LoadOptions& options);
+			// runs the LitMeshOptimizer passes enabled in options on the loaded triangle list
+			void Optimize(const LoadOptions& options);
 		};
 
-		LitModel(LitDevice& device, const Builder& builder);
+		LitModel(LitDevice& device, const Builder& builder, VertexFormat format = VertexFormat::Float,
+			LitGeometryPool* geometryPool = nullptr);
 		~LitModel();
 
 		LitModel(const LitModel&) = delete;
 		LitModel& operator=(const LitModel&) = delete;
 
 		static std::unique_ptr<LitModel> CreateModelFromFile(
-			LitDevice& device, const std::string& filepath);
+			LitDevice& device, const std::string& filepath, VertexFormat format = VertexFormat::Float);
+		static std::unique_ptr<LitModel> CreateModelFromFile(
+			LitDevice& device, const std::string& filepath, const LoadOptions& options);
+
+		void Draw(VkCommandBuffer commandBuffer, uint32_t lod = 0);
 
-		void Draw(VkCommandBuffer commandBuffer);
+		// draws from a buffer of VkDrawIndexedIndirectCommand, falls back to one call per draw without multiDrawIndirect
+		void DrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount);
 
 		void Bind(VkCommandBuffer commandBuffer);
+
+		// models in the same geometry pool return the same buffer, Bind only has to be called when it changes
+		VkBuffer GetVertexBuffer() const;
+		// 16 bit whenever every vertex can be addressed with it, models in a pool rebind when this changes
+		VkIndexType GetIndexType() const { return indexType; }
+		// where the model starts in the bound buffers, already applied by Draw
+		uint32_t GetFirstIndex() const { return poolAllocation.firstIndex; }
+		int32_t GetBaseVertex() const { return poolAllocation.baseVertex; }
+
+		static uint32_t GetVertexStride(VertexFormat format);
+		// vertex input that only reads location 0, for depth only pipelines
+		static std::vector<VkVertexInputBindingDescription> GetPositionInputBindingDesc(VertexFormat format);
+		static std::vector<VkVertexInputAttributeDescription> GetPositionInputAttributeDesc(VertexFormat format);
+		VertexFormat GetVertexFormat() const { return vertexFormat; }
+		const LitAABB& GetBounds() const { return bounds; }
+		uint32_t GetVertexCount() const { return vertexCount; }
+		// maps the vertex buffer positions to model space, identity unless positions are quantized
+		glm::mat4 GetDequantizeMatrix() const;
+
+		uint32_t GetLodCount() const { return static_cast<uint32_t>(lods.size()); }
+		const LodLevel& GetLod(uint32_t lod) const { return lods[lod]; }
+		// coarsest LOD whose error stays below maxScreenError once projected,
+		// screenScale is the screen height fraction covered by one model space unit at the object's distance
+		uint32_t SelectLod(float screenScale, float maxScreenError) const;
+
+		const std::vector<LitMeshlet>& GetMeshlets() const { return meshlets; }
+		bool HasIndexBuffer() const { return hasIndexBuffer; }
+		// triangles of LOD0 in model space for picking, null without an index buffer
+		const LitMeshBvh* GetMeshBvh() const { return meshBvh.get(); }
+
 	private:
-		void CreateVertexBuffer(const std::vector<Vertex>& vertices);
-		void createIndexBuffers(const std::vector<uint32_t>& indices);
+		void CreateVertexBuffer(const void* vertexData);
+		void createIndexBuffers(const void* indexData);
 
 	private:
 		LitDevice& device;
 
+		VertexFormat vertexFormat;
+		LitAABB bounds;
+
+		// either geometryPool is set and poolAllocation locates the model in it, or the model owns its buffers
+		LitGeometryPool* geometryPool = nullptr;
+		LitGeometryPool::Allocation poolAllocation{};
+
 		std::unique_ptr<LitBuffer> vertexBuffer;
 		uint32_t vertexCount;
 
 		bool hasIndexBuffer = false;
 		std::unique_ptr<LitBuffer> indexBuffer;
 		uint32_t indexCount;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		std::vector<LodLevel> lods;
+		std::vector<LitMeshlet> meshlets;
+		std::unique_ptr<LitMeshBvh> meshBvh;
 
 	};
 }
@@ -0,0 +1,239 @@
+#include "LitModel.h"
+#include "LitCpuProfiler.h"
+#include "LitMeshOptimizer.h"
+
+#include "LitUtils.h"
+
+// libs
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace std
+{
+	// special partical template
+	template<>
+	struct hash<Lit::LitModel::Vertex>
+	{
+		size_t operator()(Lit::LitModel::Vertex const& vertex) const
+		{
+			size_t seed = 0;
+			//Lit::HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+			return seed;
+		}
+	};
+}
+
+namespace Lit
+{
+	void LitModel::Builder::LoadModel(const std::string& filepath)
+	{
+		LIT_CPU_ZONE("parse obj");
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
+			throw std::runtime_error(warn + err);
+		}
+
+		vertices.clear();
+		indices.clear();
+
+		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+		for (const auto& shape : shapes) {
+			for (const auto& index : shape.mesh.indices) {
+				Vertex vertex{};
+
+				if (index.vertex_index >= 0) {
+					vertex.position = glm::vec3{
+						attrib.vertices[3 * index.vertex_index + 0],
+						attrib.vertices[3 * index.vertex_index + 1],
+						attrib.vertices[3 * index.vertex_index + 2],
+					};
+
+					//auto colorIndex = 3 * index.vertex_index + 2;
+					//if (colorIndex < attrib.colors.size()) {
+					//	vertex.color = glm::vec3{
+					//		attrib.colors[colorIndex - 2],
+					//		attrib.colors[colorIndex - 1],
+					//		attrib.colors[colorIndex - 0],
+					//	};
+					//}
+					//else {
+					//	vertex.color = glm::vec3{ 1.f, 1.f, 1.f };  // set default color
+					//}
+					vertex.color = glm::vec3{
+					   attrib.colors[3 * index.vertex_index + 0],
+					   attrib.colors[3 * index.vertex_index + 1],
+					   attrib.colors[3 * index.vertex_index + 2],
+					};
+				}
+
+				if (index.normal_index >= 0) {
+					vertex.normal = glm::vec3{
+						attrib.normals[3 * index.normal_index + 0],
+						attrib.normals[3 * index.normal_index + 1],
+						attrib.normals[3 * index.normal_index + 2],
+					};
+				}
+
+				if (index.texcoord_index >= 0) {
+					// OBJ has v = 0 at the bottom row of the image, Vulkan samples the first row at v = 0
+					vertex.uv = glm::vec2{
+						attrib.texcoords[2 * index.texcoord_index + 0],
+						1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
+					};
+				}
+
+				if (uniqueVertices.count(vertex) == 0) {
+					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+					vertices.push_back(vertex);
+				}
+				indices.push_back(uniqueVertices[vertex]);
+			}
+		}
+	}
+
+	// positions only, the simplifier and the overdraw pass don't look at the other attributes
+	static std::vector<glm::vec3> GetPositions(const std::vector<LitModel::Vertex>& vertices)
+	{
+		std::vector<glm::vec3> positions;
+		positions.reserve(vertices.size());
+		for (const auto& vertex : vertices)
+		{
+			positions.push_back(vertex.position);
+		}
+		return positions;
+	}
+
+	void LitModel::Builder::GenerateLods(const LoadOptions& options)
+	{
+		LIT_CPU_ZONE("generate lods");
+		lods.clear();
+		if (indices.empty())
+		{
+			return;
+		}
+		lods.push_back(LodLevel{ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+		const std::vector<glm::vec3> positions = GetPositions(vertices);
+		LitAABB meshBounds;
+		for (const auto& position : positions)
+		{
+			meshBounds.Expand(position);
+		}
+		const glm::vec3 extent = meshBounds.Extent();
+		const float meshScale = std::max(extent.x, std::max(extent.y, extent.z));
+
+		// each level is simplified from the previous one, so the errors add up
+		std::vector<uint32_t> previous = indices;
+		float accumulatedError = 0.0f;
+		while (lods.size() < options.maxLodCount)
+		{
+			const size_t targetIndexCount = static_cast<size_t>(previous.size() / 3 * options.lodReduction) * 3;
+			float error = 0.0f;
+			std::vector<uint32_t> lodIndices = LitMeshOptimizer::Simplify(
+				previous, positions, targetIndexCount, options.lodMaxError, &error);
+
+			// seams or the error limit stopped the simplifier, another level wouldn't save enough to be worth it
+			if (lodIndices.empty() || lodIndices.size() > previous.size() * 0.9f)
+			{
+				break;
+			}
+
+			accumulatedError += error * meshScale;
+			lods.push_back(LodLevel{ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), accumulatedError });
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+			previous.swap(lodIndices);
+		}
+	}
+
+	void LitModel::Builder::Optimize(const LoadOptions& options)
+	{
+		LIT_CPU_ZONE("optimize mesh");
+		if (indices.empty())
+		{
+			return;
+		}
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		const std::vector<glm::vec3> positions = options.bOptimizeOverdraw ? GetPositions(vertices) : std::vector<glm::vec3>{};
+		std::vector<LodLevel> ranges = lods;
+		if (ranges.empty())
+		{
+			ranges.push_back(LodLevel{ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+		}
+
+		// every LOD is drawn on its own, so the triangle order is optimized per range
+		for (const auto& range : ranges)
+		{
+			std::vector<uint32_t> lodIndices(indices.begin() + range.firstIndex, indices.begin() + range.firstIndex + range.indexCount);
+			if (options.bOptimizeVertexCache)
+			{
+				LitMeshOptimizer::OptimizeVertexCache(lodIndices, vertexCount);
+			}
+			if (options.bOptimizeOverdraw)
+			{
+				LitMeshOptimizer::OptimizeOverdraw(lodIndices, positions);
+			}
+			std::copy(lodIndices.begin(), lodIndices.end(), indices.begin() + range.firstIndex);
+		}
+
+		// meshlets replace the LOD0 triangle order, the cache order is restored inside each of them
+		meshlets.clear();
+		if (options.bBuildMeshlets && ranges[0].indexCount / 3 > LitMeshlet::MAX_TRIANGLES)
+		{
+			std::vector<uint32_t> lodIndices(indices.begin(), indices.begin() + ranges[0].indexCount);
+			meshlets = LitMeshOptimizer::BuildMeshlets(lodIndices, positions.empty() ? GetPositions(vertices) : positions);
+			if (options.bOptimizeVertexCache)
+			{
+				// the optimizer's tables are sized by vertexCount, so each meshlet is numbered with its own
+				// (at most MAX_VERTICES) vertices instead of the whole mesh's
+				std::vector<uint32_t> localIndices(vertexCount, UINT32_MAX);
+				std::vector<uint32_t> meshletVertices;
+				meshletVertices.reserve(LitMeshlet::MAX_VERTICES);
+				for (const auto& meshlet : meshlets)
+				{
+					std::vector<uint32_t> meshletIndices(lodIndices.begin() + meshlet.firstIndex,
+						lodIndices.begin() + meshlet.firstIndex + meshlet.triangleCount * 3);
+					for (uint32_t& index : meshletIndices)
+					{
+						if (localIndices[index] == UINT32_MAX)
+						{
+							localIndices[index] = static_cast<uint32_t>(meshletVertices.size());
+							meshletVertices.push_back(index);
+						}
+						index = localIndices[index];
+					}
+
+					LitMeshOptimizer::OptimizeVertexCache(meshletIndices, static_cast<uint32_t>(meshletVertices.size()));
+
+					for (uint32_t& index : meshletIndices)
+					{
+						index = meshletVertices[index];
+					}
+					for (uint32_t vertex : meshletVertices)
+					{
+						localIndices[vertex] = UINT32_MAX;
+					}
+					meshletVertices.clear();
+					std::copy(meshletIndices.begin(), meshletIndices.end(), lodIndices.begin() + meshlet.firstIndex);
+				}
+			}
+			std::copy(lodIndices.begin(), lodIndices.end(), indices.begin());
+		}
+
+		// LOD0 comes first in the index buffer, so its vertices end up at the front of the vertex buffer
+		if (options.bOptimizeVertexFetch)
+		{
+			const std::vector<uint32_t> remap = LitMeshOptimizer::OptimizeVertexFetch(indices, vertexCount);
+			vertices = LitMeshOptimizer::RemapVertices(vertices, remap);
+		}
+	}
+}
@@ -0,0 +1,194 @@
+#include "LitOcclusionCuller.h"
+#include "LitSwapChain.h"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace Lit
+{
+	static const uint32_t CULL_GROUP_SIZE = 64;
+	static const uint32_t PHASE_EARLY = 0;
+	static const uint32_t PHASE_LATE = 1;
+
+	struct CullPushConstants
+	{
+		glm::mat4 view;
+		glm::vec4 projection;	// P00, P11, P22, P32
+		glm::vec2 pyramidSize;
+		float znear;
+		uint32_t drawCount;
+		uint32_t phase;
+	};
+
+	LitOcclusionCuller::LitOcclusionCuller(LitDevice& inDevice) : device{ inDevice }, depthPyramid{ inDevice }
+	{
+		setLayout = LitDescriptorSetLayout::Builder(device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.Build();
+		descriptorPool = LitDescriptorPool::Builder(device)
+			.SetMaxSets(LitSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, LitSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, LitSwapChain::MAX_FRAMES_IN_FLIGHT * 4)
+			.Build();
+		descriptorSets.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (auto& descriptorSet : descriptorSets)
+		{
+			if (!descriptorPool->AllocateDescriptor(setLayout->GetDescriptorSetLayout(), descriptorSet))
+			{
+				throw std::runtime_error("failed to allocate occlusion culling descriptor set!");
+			}
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(CullPushConstants);
+
+		VkDescriptorSetLayout descriptorSetLayout = setLayout->GetDescriptorSetLayout();
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(device.GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+		cullPipeline = std::make_unique<LitComputePipeline>(device, "../Shaders/Spv/hzb_cull.comp.spv", pipelineLayout);
+
+		statisticsBuffers.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (auto& statisticsBuffer : statisticsBuffers)
+		{
+			VkDeviceSize statisticsSize = sizeof(OcclusionCullStatistics);
+			statisticsBuffer = std::make_unique<LitBuffer>(device, statisticsSize, 1,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+				MemoryCategory::Other);
+			statisticsBuffer->Map();
+			memset(statisticsBuffer->GetMappedMemory(), 0, sizeof(OcclusionCullStatistics));
+		}
+	}
+
+	LitOcclusionCuller::~LitOcclusionCuller()
+	{
+		cullPipeline = nullptr;
+		vkDestroyPipelineLayout(device.GetDevice(), pipelineLayout, nullptr);
+	}
+
+	void LitOcclusionCuller::EnsureVisibilityBuffer(VkCommandBuffer commandBuffer, uint32_t objectCount)
+	{
+		if (visibilityBuffer != nullptr && visibilityBuffer->GetInstanceCount() >= objectCount)
+		{
+			return;
+		}
+
+		// frames in flight still use the old buffer, LitBuffer defers destroying it
+		VkDeviceSize visibilitySize = sizeof(uint32_t);
+		visibilityBuffer = std::make_unique<LitBuffer>(device, visibilitySize, std::max(objectCount * 2, 256u),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			MemoryCategory::Other);
+
+		// without history everything counts as visible, the first frame draws it all early
+		vkCmdFillBuffer(commandBuffer, visibilityBuffer->GetBuffer(), 0, VK_WHOLE_SIZE, 1);
+	}
+
+	void LitOcclusionCuller::CullEarly(VkCommandBuffer commandBuffer, int frameIndex, VkExtent2D depthExtent,
+		VkDescriptorBufferInfo boundsInfo, VkDescriptorBufferInfo commandsInfo, uint32_t inDrawCount, uint32_t objectCount)
+	{
+		// the fence of this frame index was waited on, its counters are complete
+		LitBuffer& statisticsBuffer = *statisticsBuffers[frameIndex];
+		statisticsBuffer.Invalidate();
+		memcpy(&statistics, statisticsBuffer.GetMappedMemory(), sizeof(OcclusionCullStatistics));
+
+		drawCount = inDrawCount;
+		if (drawCount == 0)
+		{
+			return;
+		}
+
+		depthPyramid.Resize(depthExtent);
+		EnsureVisibilityBuffer(commandBuffer, objectCount);
+		vkCmdFillBuffer(commandBuffer, statisticsBuffer.GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+		// the fills above and the late phase of the previous frame wrote what this dispatch reads
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		VkDescriptorImageInfo pyramidInfo{ depthPyramid.GetSampler(), depthPyramid.GetImageView(), VK_IMAGE_LAYOUT_GENERAL };
+		VkDescriptorBufferInfo visibilityInfo = visibilityBuffer->DescriptorInfo();
+		VkDescriptorBufferInfo statisticsInfo = statisticsBuffer.DescriptorInfo();
+		LitDescriptorWriter(*setLayout, *descriptorPool)
+			.WriteImage(0, &pyramidInfo)
+			.WriteBuffer(1, &boundsInfo)
+			.WriteBuffer(2, &commandsInfo)
+			.WriteBuffer(3, &visibilityInfo)
+			.WriteBuffer(4, &statisticsInfo)
+			.OverWrite(descriptorSets[frameIndex]);
+
+		Dispatch(commandBuffer, frameIndex, PHASE_EARLY, glm::mat4{ 1.0f }, glm::mat4{ 1.0f });
+	}
+
+	void LitOcclusionCuller::CullLate(VkCommandBuffer commandBuffer, int frameIndex, const LitCamera& camera, VkImageView depthView)
+	{
+		if (drawCount == 0)
+		{
+			return;
+		}
+
+		depthPyramid.Build(commandBuffer, frameIndex, depthView);
+
+		// the early phase has read the history, the late phase sets the entries of objects with any visible draw.
+		// Objects the CPU culled this frame lose their history and are tested late when they come back
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 0, nullptr);
+		vkCmdFillBuffer(commandBuffer, visibilityBuffer->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+		// the early draws are done reading the commands the late phase rewrites
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		Dispatch(commandBuffer, frameIndex, PHASE_LATE, camera.GetView(), camera.GetProjection());
+	}
+
+	void LitOcclusionCuller::Dispatch(VkCommandBuffer commandBuffer, int frameIndex, uint32_t phase,
+		const glm::mat4& view, const glm::mat4& projection)
+	{
+		CullPushConstants push{};
+		push.view = view;
+		push.projection = glm::vec4(projection[0][0], projection[1][1], projection[2][2], projection[3][2]);
+		push.pyramidSize = glm::vec2(static_cast<float>(depthPyramid.GetWidth()), static_cast<float>(depthPyramid.GetHeight()));
+		// the projection maps z to (P22 * z + P32) / z, depth 0 is the near plane
+		push.znear = projection[2][2] != 0.0f ? -projection[3][2] / projection[2][2] : 0.0f;
+		push.drawCount = drawCount;
+		push.phase = phase;
+
+		cullPipeline->Bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+			&descriptorSets[frameIndex], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+		vkCmdDispatch(commandBuffer, (drawCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+		// the draws consume the commands, the host reads the counters once the frame's fence signaled
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "LitBuffer.h"
+#include "LitCamera.h"
+#include "LitDescriptors.h"
+#include "LitDevice.h"
+#include "LitHzbPyramid.h"
+#include "LitPipeline.h"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <memory>
+#include <vector>
+
+namespace Lit
+{
+	// one per indirect command, std430 layout of hzb_cull.comp
+	struct LitDrawBounds
+	{
+		glm::vec4 sphere;	// world space center and radius of the object the command belongs to
+		uint32_t objectIndex;
+		uint32_t padding[3];
+	};
+
+	struct OcclusionCullStatistics
+	{
+		uint32_t earlyDraws = 0;	// commands drawn because their object was visible last frame
+		uint32_t lateDraws = 0;		// commands that became visible this frame
+		uint32_t occluded = 0;
+		uint32_t tested = 0;
+
+		void Reset() { *this = OcclusionCullStatistics{}; }
+	};
+
+	// Two phase hierarchical Z culling on the GPU. The early phase enables the commands of objects that passed the
+	// test last frame, they are drawn and the depth they leave is reduced into a pyramid. The late phase tests every
+	// object against it, draws what became visible and remembers the result for the next frame.
+	// The command buffer holds drawCount early commands followed by their drawCount late copies, only instanceCount
+	// is written so the copies must match apart from it
+	class LitOcclusionCuller
+	{
+	public:
+		LitOcclusionCuller(LitDevice& device);
+		~LitOcclusionCuller();
+
+		LitOcclusionCuller(const LitOcclusionCuller&) = delete;
+		LitOcclusionCuller& operator=(const LitOcclusionCuller&) = delete;
+
+		// outside a render pass, before the early draws. objectIndex of every bound must be below objectCount,
+		// objects stay the same from frame to frame for the visibility history to mean anything
+		void CullEarly(VkCommandBuffer commandBuffer, int frameIndex, VkExtent2D depthExtent,
+			VkDescriptorBufferInfo boundsInfo, VkDescriptorBufferInfo commandsInfo, uint32_t drawCount, uint32_t objectCount);
+		// outside a render pass, after the early draws wrote the depth of depthView. Depth is read in
+		// DEPTH_STENCIL_READ_ONLY_OPTIMAL, see LitHzbPyramid::Build
+		void CullLate(VkCommandBuffer commandBuffer, int frameIndex, const LitCamera& camera, VkImageView depthView);
+
+		// read back from the GPU, MAX_FRAMES_IN_FLIGHT frames old
+		const OcclusionCullStatistics& GetStatistics() const { return statistics; }
+
+	private:
+		void Dispatch(VkCommandBuffer commandBuffer, int frameIndex, uint32_t phase, const glm::mat4& view, const glm::mat4& projection);
+		void EnsureVisibilityBuffer(VkCommandBuffer commandBuffer, uint32_t objectCount);
+
+		LitDevice& device;
+		LitHzbPyramid depthPyramid;
+
+		std::unique_ptr<LitDescriptorSetLayout> setLayout;
+		std::unique_ptr<LitDescriptorPool> descriptorPool;
+		std::vector<VkDescriptorSet> descriptorSets;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		std::unique_ptr<LitComputePipeline> cullPipeline;
+
+		// one uint per object, device local and kept across frames
+		std::unique_ptr<LitBuffer> visibilityBuffer;
+		// host visible counters, one per frame in flight
+		std::vector<std::unique_ptr<LitBuffer>> statisticsBuffers;
+		OcclusionCullStatistics statistics;
+		uint32_t drawCount = 0;
+	};
+}
@@ -0,0 +1,46 @@
+#include "LitPicker.h"
+
+namespace Lit
+{
+	LitPickResult LitPicker::Pick(const LitBvh& sceneBvh, const std::vector<LitPickInstance>& instances,
+		const LitRay& ray, float maxDistance)
+	{
+		LitPickResult result{};
+		const LitBvh::RayHit hit = sceneBvh.Raycast(ray, maxDistance,
+			[&](uint32_t objectIndex, const LitRay& worldRay, float entry, float& distance)
+			{
+				const LitPickInstance& instance = instances[objectIndex];
+				if (instance.meshBvh == nullptr)
+				{
+					if (entry >= distance)
+					{
+						return false;
+					}
+					distance = entry;
+					result.triangle = UINT32_MAX;
+					return true;
+				}
+
+				// direction is left unnormalized so distances carry over from world space
+				const LitRay modelRay{ glm::vec3(instance.inverseModelMatrix * glm::vec4(worldRay.origin, 1.0f)),
+					glm::vec3(instance.inverseModelMatrix * glm::vec4(worldRay.direction, 0.0f)) };
+				LitMeshBvh::RayHit meshHit{};
+				meshHit.distance = distance;
+				if (!instance.meshBvh->Raycast(modelRay, meshHit))
+				{
+					return false;
+				}
+				distance = meshHit.distance;
+				result.triangle = meshHit.triangle;
+				return true;
+			});
+
+		if (hit.IsHit())
+		{
+			result.objectIndex = hit.userData;
+			result.distance = hit.distance;
+			result.position = ray.At(hit.distance);
+		}
+		return result;
+	}
+}
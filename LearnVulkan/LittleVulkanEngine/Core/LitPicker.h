@@ -0,0 +1,42 @@
+#pragma once
+#include "LitBvh.h"
+#include "LitMeshBvh.h"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace Lit
+{
+	// what the picker needs of an object, indexed by the user data of its scene BVH proxy
+	struct LitPickInstance
+	{
+		// null hits the object at its box
+		const LitMeshBvh* meshBvh = nullptr;
+		glm::mat4 inverseModelMatrix{ 1.0f };
+	};
+
+	struct LitPickResult
+	{
+		uint32_t objectIndex = UINT32_MAX;
+		uint32_t triangle = UINT32_MAX;
+		float distance = 0.0f;
+		glm::vec3 position{ 0.0f };
+
+		bool IsHit() const { return objectIndex != UINT32_MAX; }
+	};
+
+	class LitPicker
+	{
+	public:
+		// nearest hit along the ray: the scene BVH visits the object boxes front to back and every box the ray
+		// still reaches has its triangles tested in model space, where the ray parameter is the same as in world space
+		static LitPickResult Pick(const LitBvh& sceneBvh, const std::vector<LitPickInstance>& instances,
+			const LitRay& ray, float maxDistance);
+	};
+}
@@ -78,6 +78,9 @@ namespace Lit
 		configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
 		configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
 		configInfo.dynamicStateInfo.flags = 0;
+
+		configInfo.bindingDescriptions = LitModel::Vertex::GetVertexInputBindingDesc();
+		configInfo.attributeDescriptions = LitModel::Vertex::GetVertexInputAttributeDesc();
 	}
 
 	LitPipeline::LitPipeline(
@@ -123,12 +126,17 @@ namespace Lit
 		const PipelineConfigInfo& configInfo)
 	{
 		auto vertCode = ReadFile(vertFilepath);
-		auto fragCode = ReadFile(fragFilepath);
 
 		//std::cout << "vertShaderCode size: " << vertCode.size() << '\n';
 		//std::cout << "fragShaderCode size: " << fragCode.size() << '\n';
 		vertShaderModule = CreateShaderModule(vertCode);
-		fragShaderModule = CreateShaderModule(fragCode);
+		// depth only pipelines have no fragment stage
+		const bool bHasFragmentStage = !fragFilepath.empty();
+		if (bHasFragmentStage)
+		{
+			auto fragCode = ReadFile(fragFilepath);
+			fragShaderModule = CreateShaderModule(fragCode);
+		}
 		VkPipelineShaderStageCreateInfo shaderStages[2];
 		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -145,8 +153,8 @@ namespace Lit
 		shaderStages[1].pNext = nullptr;
 		shaderStages[1].pSpecializationInfo = nullptr;
 
-		auto bindingDescriptions = LitModel::Vertex::GetVertexInputBindingDesc();
-		auto attributeDescriptions = LitModel::Vertex::GetVertexInputAttributeDesc();
+		auto& bindingDescriptions = configInfo.bindingDescriptions;
+		auto& attributeDescriptions = configInfo.attributeDescriptions;
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -161,7 +169,7 @@ namespace Lit
 
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
+		pipelineInfo.stageCount = bHasFragmentStage ? 2 : 1;
 		pipelineInfo.pStages = shaderStages;
 		pipelineInfo.pVertexInputState = &vertexInputInfo;
 		pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
@@ -205,4 +213,45 @@ namespace Lit
 		}
 		return shaderModule;
 	}
+
+	LitComputePipeline::LitComputePipeline(LitDevice& inDevice, const std::string& compFilepath, VkPipelineLayout pipelineLayout)
+		: device(inDevice)
+	{
+		auto compCode = LitPipeline::ReadFile(compFilepath);
+
+		VkShaderModuleCreateInfo moduleInfo = {};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = compCode.size();
+		moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+		if (vkCreateShaderModule(device.GetDevice(), &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create shader module!");
+		}
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = compShaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = pipelineLayout;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		if (vkCreateComputePipelines(device.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create compute pipeline!");
+		}
+	}
+
+	LitComputePipeline::~LitComputePipeline()
+	{
+		vkDestroyShaderModule(device.GetDevice(), compShaderModule, nullptr);
+		vkDestroyPipeline(device.GetDevice(), computePipeline, nullptr);
+	}
+
+	void LitComputePipeline::Bind(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+	}
 }
\ No newline at end of file
@@ -13,6 +13,8 @@ namespace Lit
 		PipelineConfigInfo(const PipelineConfigInfo&) = delete;
 		PipelineConfigInfo& operator=(const PipelineConfigInfo&) = delete;
 
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
 		VkViewport viewport;
 		VkRect2D scissor;
 		VkPipelineViewportStateCreateInfo viewportInfo;
@@ -34,6 +36,7 @@ namespace Lit
 	class LitPipeline
 	{
 	public:
+		// an empty fragFilepath creates a pipeline without fragment shader, e.g. for depth only passes
 		LitPipeline(
 			LitDevice& device,
 			const std::string& vertFilepath,
@@ -47,9 +50,10 @@ namespace Lit
 		
 		static void DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 
-	private:
 		static std::vector<char> ReadFile(const std::string& filename);
 
+	private:
+
 		void CreateGraphicsPipeline(const std::string& vertFilepath,
 			const std::string& fragFilepath,
 			const PipelineConfigInfo& configInfo);
@@ -60,7 +64,25 @@ namespace Lit
 
 		VkPipeline graphicsPipeline;
 		VkShaderModule vertShaderModule;
-		VkShaderModule fragShaderModule;
+		VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+	};
+
+	// single compute shader, the layout is owned by the caller like PipelineConfigInfo::pipelineLayout
+	class LitComputePipeline
+	{
+	public:
+		LitComputePipeline(LitDevice& device, const std::string& compFilepath, VkPipelineLayout pipelineLayout);
+		~LitComputePipeline();
+
+		LitComputePipeline(const LitComputePipeline&) = delete;
+		LitComputePipeline& operator=(const LitComputePipeline&) = delete;
+		void Bind(VkCommandBuffer commandBuffer);
+
+	private:
+		LitDevice& device;
+
+		VkPipeline computePipeline;
+		VkShaderModule compShaderModule;
 	};
 
 }  // namespace Lit
\ No newline at end of file
@@ -0,0 +1,1052 @@
+#include "LitRenderGraph.h"
+#include "LitSwapChain.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace Lit
+{
+	// accesses that write memory, everything a later access has to wait for to become visible
+	static const VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT |
+		VK_ACCESS_MEMORY_WRITE_BIT;
+
+	struct UsageInfo
+	{
+		VkPipelineStageFlags stages;
+		VkAccessFlags accessMask;
+		VkImageLayout layout;
+		VkImageUsageFlags imageUsage;
+	};
+
+	static bool IsDepthFormat(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static UsageInfo GetImageUsageInfo(LitRenderGraph::ImageUsage usage, bool bDepth)
+	{
+		// depth is sampled in the read only depth layout, it stays compatible with depth testing
+		const VkImageLayout sampledLayout = bDepth ?
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		switch (usage)
+		{
+		case LitRenderGraph::ImageUsage::SampledFragment:
+			return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, sampledLayout, VK_IMAGE_USAGE_SAMPLED_BIT };
+		case LitRenderGraph::ImageUsage::SampledCompute:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, sampledLayout, VK_IMAGE_USAGE_SAMPLED_BIT };
+		case LitRenderGraph::ImageUsage::StorageCompute:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+		case LitRenderGraph::ImageUsage::TransferSrc:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+		case LitRenderGraph::ImageUsage::TransferDst:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+		}
+		throw std::runtime_error("unknown render graph image usage!");
+	}
+
+	static UsageInfo GetBufferUsageInfo(LitRenderGraph::BufferUsage usage)
+	{
+		switch (usage)
+		{
+		case LitRenderGraph::BufferUsage::IndirectRead:
+			return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::VertexIndexRead:
+			return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::UniformRead:
+			return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::StorageReadCompute:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::StorageWriteCompute:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::TransferSrc:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		case LitRenderGraph::BufferUsage::TransferDst:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+		}
+		throw std::runtime_error("unknown render graph buffer usage!");
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::PassBuilder::WriteColor(ResourceHandle image, const VkClearColorValue* clear)
+	{
+		Access access{};
+		access.bWrite = true;
+		access.bColorAttachment = true;
+		access.bClear = clear != nullptr;
+		access.bDiscard = access.bClear;
+		if (clear != nullptr)
+		{
+			access.clearValue.color = *clear;
+		}
+		access.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		access.accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		access.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		access.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		return graph.AddAccess(pass, image, access);
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::PassBuilder::WriteDepth(ResourceHandle image, const VkClearDepthStencilValue* clear)
+	{
+		Access access{};
+		access.bWrite = true;
+		access.bDepthAttachment = true;
+		access.bClear = clear != nullptr;
+		access.bDiscard = access.bClear;
+		if (clear != nullptr)
+		{
+			access.clearValue.depthStencil = *clear;
+		}
+		access.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		access.accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		access.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		access.imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		return graph.AddAccess(pass, image, access);
+	}
+
+	void LitRenderGraph::PassBuilder::ReadImage(ResourceHandle image, ImageUsage usage)
+	{
+		if (!image.IsValid() || image.resource >= graph.resources.size())
+		{
+			throw std::runtime_error("render graph pass reads an invalid image!");
+		}
+		const UsageInfo info = GetImageUsageInfo(usage, IsDepthFormat(graph.resources[image.resource].desc.format));
+		Access access{};
+		access.stages = info.stages;
+		access.accessMask = info.accessMask;
+		access.layout = info.layout;
+		access.imageUsage = info.imageUsage;
+		graph.AddAccess(pass, image, access);
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::PassBuilder::WriteImage(ResourceHandle image, ImageUsage usage)
+	{
+		if (!image.IsValid() || image.resource >= graph.resources.size())
+		{
+			throw std::runtime_error("render graph pass writes an invalid image!");
+		}
+		const UsageInfo info = GetImageUsageInfo(usage, IsDepthFormat(graph.resources[image.resource].desc.format));
+		Access access{};
+		access.bWrite = true;
+		access.stages = info.stages;
+		access.accessMask = info.accessMask;
+		access.layout = info.layout;
+		access.imageUsage = info.imageUsage;
+		return graph.AddAccess(pass, image, access);
+	}
+
+	void LitRenderGraph::PassBuilder::ReadBuffer(ResourceHandle buffer, BufferUsage usage)
+	{
+		const UsageInfo info = GetBufferUsageInfo(usage);
+		Access access{};
+		access.stages = info.stages;
+		access.accessMask = info.accessMask;
+		graph.AddAccess(pass, buffer, access);
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::PassBuilder::WriteBuffer(ResourceHandle buffer, BufferUsage usage)
+	{
+		const UsageInfo info = GetBufferUsageInfo(usage);
+		Access access{};
+		access.bWrite = true;
+		access.stages = info.stages;
+		access.accessMask = info.accessMask;
+		return graph.AddAccess(pass, buffer, access);
+	}
+
+	void LitRenderGraph::PassBuilder::SetRenderArea(VkExtent2D extent)
+	{
+		graph.passes[pass].renderArea = extent;
+	}
+
+	void LitRenderGraph::PassBuilder::SetSideEffect()
+	{
+		graph.passes[pass].bSideEffect = true;
+	}
+
+	bool LitRenderGraph::TransientKey::operator==(const TransientKey& other) const
+	{
+		return format == other.format && extent.width == other.extent.width && extent.height == other.extent.height &&
+			usage == other.usage && firstUse == other.firstUse && lastUse == other.lastUse;
+	}
+
+	LitRenderGraph::LitRenderGraph(LitDevice& inDevice) : device{ inDevice }
+	{
+		frames.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+	}
+
+	LitRenderGraph::~LitRenderGraph()
+	{
+		for (auto& frame : frames)
+		{
+			for (VkFramebuffer frameBuffer : frame.frameBuffers)
+			{
+				vkDestroyFramebuffer(device.GetDevice(), frameBuffer, nullptr);
+			}
+			DestroyTransientImages(frame);
+		}
+		for (auto& entry : renderPassCache)
+		{
+			vkDestroyRenderPass(device.GetDevice(), entry.second, nullptr);
+		}
+	}
+
+	void LitRenderGraph::Reset()
+	{
+		passes.clear();
+		resources.clear();
+		executionOrder.clear();
+		finalBarriers = Pass{};
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::CreateImage(const std::string& name, const ImageDesc& desc)
+	{
+		assert(desc.extent.width > 0 && desc.extent.height > 0 && "Render graph images must not be empty");
+		Resource resource{};
+		resource.name = name;
+		resource.bImage = true;
+		resource.bImported = false;
+		resource.desc = desc;
+		resource.aspect = IsDepthFormat(desc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+		resources.push_back(resource);
+		return ResourceHandle{ static_cast<uint32_t>(resources.size() - 1), 0 };
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::ImportImage(const std::string& name, VkImage image, VkImageView view,
+		VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.bImage = true;
+		resource.bImported = true;
+		resource.desc = ImageDesc{ format, extent };
+		resource.aspect = IsDepthFormat(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+		resource.image = image;
+		resource.view = view;
+		resource.initialLayout = initialLayout;
+		resource.finalLayout = finalLayout;
+		resources.push_back(resource);
+		return ResourceHandle{ static_cast<uint32_t>(resources.size() - 1), 0 };
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.bImage = false;
+		resource.bImported = true;
+		resource.buffer = buffer;
+		resources.push_back(resource);
+		return ResourceHandle{ static_cast<uint32_t>(resources.size() - 1), 0 };
+	}
+
+	void LitRenderGraph::AddGraphicsPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+	{
+		const uint32_t pass = AddPass(name, true, setup, std::move(execute));
+		const auto& accesses = passes[pass].accesses;
+		if (std::none_of(accesses.begin(), accesses.end(), [](const Access& access) { return access.bColorAttachment || access.bDepthAttachment; }))
+		{
+			throw std::runtime_error("render graph graphics pass has no attachments!");
+		}
+	}
+
+	void LitRenderGraph::AddComputePass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+	{
+		AddPass(name, false, setup, std::move(execute));
+	}
+
+	uint32_t LitRenderGraph::AddPass(const std::string& name, bool bGraphics, const SetupFunction& setup, ExecuteFunction execute)
+	{
+		Pass pass{};
+		pass.name = name;
+		pass.bGraphics = bGraphics;
+		pass.execute = std::move(execute);
+		passes.push_back(std::move(pass));
+
+		const uint32_t index = static_cast<uint32_t>(passes.size() - 1);
+		PassBuilder builder{ *this, index };
+		setup(builder);
+		return index;
+	}
+
+	LitRenderGraph::ResourceHandle LitRenderGraph::AddAccess(uint32_t pass, ResourceHandle handle, const Access& inAccess)
+	{
+		if (!handle.IsValid() || handle.resource >= resources.size())
+		{
+			throw std::runtime_error("render graph pass uses an invalid resource!");
+		}
+		Resource& resource = resources[handle.resource];
+		Pass& owner = passes[pass];
+		// image accesses always name a layout, buffer accesses never do
+		if (resource.bImage != (inAccess.layout != VK_IMAGE_LAYOUT_UNDEFINED))
+		{
+			throw std::runtime_error("render graph pass uses a buffer as an image or an image as a buffer!");
+		}
+		if ((inAccess.bColorAttachment || inAccess.bDepthAttachment) && !owner.bGraphics)
+		{
+			throw std::runtime_error("render graph attachments need a graphics pass!");
+		}
+		// one layout per image and pass, and a pass can't wait for itself
+		for (const Access& other : owner.accesses)
+		{
+			if (other.resource == handle.resource)
+			{
+				throw std::runtime_error("render graph pass uses a resource twice!");
+			}
+		}
+
+		const uint32_t latestVersion = static_cast<uint32_t>(resource.writers.size() - 1);
+		Access access = inAccess;
+		access.resource = handle.resource;
+		if (access.bWrite)
+		{
+			// a second write on top of the same version would make the order of the two writers ambiguous
+			if (handle.version != latestVersion)
+			{
+				throw std::runtime_error("render graph resource is written on top of an old version!");
+			}
+			resource.writers.push_back(pass);
+			access.version = latestVersion + 1;
+		}
+		else
+		{
+			if (handle.version > latestVersion)
+			{
+				throw std::runtime_error("render graph pass reads a version that was never written!");
+			}
+			access.version = handle.version;
+		}
+		resource.usage |= access.imageUsage;
+		owner.accesses.push_back(access);
+		return ResourceHandle{ handle.resource, access.version };
+	}
+
+	void LitRenderGraph::CullPasses()
+	{
+		// results of the graph: side effects and the final versions of the imported resources that are kept
+		std::vector<uint32_t> pending;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(passes.size()); i++)
+		{
+			passes[i].bCulled = true;
+			if (passes[i].bSideEffect)
+			{
+				pending.push_back(i);
+			}
+		}
+		for (const Resource& resource : resources)
+		{
+			const bool bOutput = resource.bImported && (!resource.bImage || resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+			if (bOutput && resource.writers.back() != UINT32_MAX)
+			{
+				pending.push_back(resource.writers.back());
+			}
+		}
+
+		// everything a kept pass needs is kept
+		while (!pending.empty())
+		{
+			const uint32_t index = pending.back();
+			pending.pop_back();
+			if (!passes[index].bCulled)
+			{
+				continue;
+			}
+			passes[index].bCulled = false;
+			for (const Access& access : passes[index].accesses)
+			{
+				const Resource& resource = resources[access.resource];
+				const uint32_t neededVersion = access.bWrite ? access.version - 1 : access.version;
+				if ((!access.bWrite || !access.bDiscard) && resource.writers[neededVersion] != UINT32_MAX)
+				{
+					pending.push_back(resource.writers[neededVersion]);
+				}
+			}
+		}
+	}
+
+	void LitRenderGraph::SortPasses()
+	{
+		// readers[resource][version]
+		std::vector<std::vector<std::vector<uint32_t>>> readers(resources.size());
+		for (uint32_t i = 0; i < static_cast<uint32_t>(resources.size()); i++)
+		{
+			readers[i].resize(resources[i].writers.size());
+			resources[i].versionUsed.assign(resources[i].writers.size(), false);
+		}
+		for (uint32_t i = 0; i < static_cast<uint32_t>(passes.size()); i++)
+		{
+			if (passes[i].bCulled)
+			{
+				continue;
+			}
+			for (const Access& access : passes[i].accesses)
+			{
+				if (!access.bWrite)
+				{
+					readers[access.resource][access.version].push_back(i);
+					resources[access.resource].versionUsed[access.version] = true;
+				}
+				else if (!access.bDiscard)
+				{
+					resources[access.resource].versionUsed[access.version - 1] = true;
+				}
+			}
+		}
+		for (Resource& resource : resources)
+		{
+			if (resource.bImported && (!resource.bImage || resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED))
+			{
+				resource.versionUsed.back() = true;
+			}
+		}
+
+		// a version is written before it is read, and all of its readers are done before the next version is written
+		std::vector<std::vector<uint32_t>> successors(passes.size());
+		std::vector<uint32_t> predecessorCounts(passes.size(), 0);
+		auto addEdge = [&](uint32_t from, uint32_t to)
+		{
+			if (from != UINT32_MAX && from != to && !passes[from].bCulled)
+			{
+				successors[from].push_back(to);
+				predecessorCounts[to]++;
+			}
+		};
+		for (uint32_t i = 0; i < static_cast<uint32_t>(passes.size()); i++)
+		{
+			if (passes[i].bCulled)
+			{
+				continue;
+			}
+			for (const Access& access : passes[i].accesses)
+			{
+				const Resource& resource = resources[access.resource];
+				if (!access.bWrite)
+				{
+					addEdge(resource.writers[access.version], i);
+					continue;
+				}
+				addEdge(resource.writers[access.version - 1], i);
+				for (uint32_t reader : readers[access.resource][access.version - 1])
+				{
+					addEdge(reader, i);
+				}
+			}
+		}
+
+		// Kahn's algorithm, ties go to the pass declared first so independent passes keep the order they were added in
+		std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+		uint32_t keptCount = 0;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(passes.size()); i++)
+		{
+			if (!passes[i].bCulled)
+			{
+				keptCount++;
+				if (predecessorCounts[i] == 0)
+				{
+					ready.push(i);
+				}
+			}
+		}
+		executionOrder.clear();
+		while (!ready.empty())
+		{
+			const uint32_t index = ready.top();
+			ready.pop();
+			executionOrder.push_back(index);
+			for (uint32_t successor : successors[index])
+			{
+				if (--predecessorCounts[successor] == 0)
+				{
+					ready.push(successor);
+				}
+			}
+		}
+		if (executionOrder.size() != keptCount)
+		{
+			throw std::runtime_error("render graph has a dependency cycle!");
+		}
+
+		for (uint32_t position = 0; position < static_cast<uint32_t>(executionOrder.size()); position++)
+		{
+			for (const Access& access : passes[executionOrder[position]].accesses)
+			{
+				Resource& resource = resources[access.resource];
+				resource.firstUse = std::min(resource.firstUse, position);
+				resource.lastUse = std::max(resource.lastUse, position);
+			}
+		}
+	}
+
+	void LitRenderGraph::Compile(int frameIndex)
+	{
+		currentFrameIndex = frameIndex;
+		FrameResources& frame = frames[frameIndex];
+		// the commands of the last frame with this index are done, see LitRenderer::BeginFrame
+		for (VkFramebuffer frameBuffer : frame.frameBuffers)
+		{
+			vkDestroyFramebuffer(device.GetDevice(), frameBuffer, nullptr);
+		}
+		frame.frameBuffers.clear();
+
+		statistics = Statistics{};
+		CullPasses();
+		SortPasses();
+		CreateTransientImages(frame);
+		PlanBarriers(frame);
+		for (uint32_t index : executionOrder)
+		{
+			Pass& pass = passes[index];
+			if (pass.bGraphics)
+			{
+				pass.renderPass = GetOrCreateRenderPass(pass);
+			}
+		}
+		statistics.passCount = static_cast<uint32_t>(executionOrder.size());
+		statistics.culledPassCount = static_cast<uint32_t>(passes.size() - executionOrder.size());
+	}
+
+	void LitRenderGraph::CreateTransientImages(FrameResources& frame)
+	{
+		std::vector<TransientKey> keys;
+		std::vector<uint32_t> transientResources;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(resources.size()); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.bImported || resource.firstUse == UINT32_MAX)
+			{
+				continue;
+			}
+			resource.transient = static_cast<uint32_t>(keys.size());
+			keys.push_back(TransientKey{ resource.desc.format, resource.desc.extent, resource.usage, resource.firstUse, resource.lastUse });
+			transientResources.push_back(i);
+		}
+
+		if (!(keys == frame.keys))
+		{
+			DestroyTransientImages(frame);
+			frame.keys = keys;
+			frame.images.resize(keys.size());
+
+			std::vector<VkMemoryRequirements> requirements(keys.size());
+			for (size_t i = 0; i < keys.size(); i++)
+			{
+				VkImageCreateInfo imageInfo{};
+				imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageInfo.format = keys[i].format;
+				imageInfo.extent = { keys[i].extent.width, keys[i].extent.height, 1 };
+				imageInfo.mipLevels = 1;
+				imageInfo.arrayLayers = 1;
+				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.usage = keys[i].usage;
+				imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				if (vkCreateImage(device.GetDevice(), &imageInfo, nullptr, &frame.images[i].image) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to create render graph image!");
+				}
+				vkGetImageMemoryRequirements(device.GetDevice(), frame.images[i].image, &requirements[i]);
+				frame.images[i].size = requirements[i].size;
+			}
+
+			// largest first, each image goes into the first block whose images are all dead while it lives. Every
+			// image is bound at the start of its block, so the block is as large as its first image
+			struct MemoryBlock
+			{
+				VkDeviceSize size;
+				uint32_t memoryTypeBits;
+				std::vector<uint32_t> images;
+			};
+			std::vector<uint32_t> order(keys.size());
+			for (uint32_t i = 0; i < static_cast<uint32_t>(order.size()); i++)
+			{
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return requirements[a].size > requirements[b].size; });
+			std::vector<MemoryBlock> blocks;
+			for (uint32_t image : order)
+			{
+				auto overlaps = [&](uint32_t other)
+				{
+					return keys[image].firstUse <= keys[other].lastUse && keys[other].firstUse <= keys[image].lastUse;
+				};
+				uint32_t blockIndex = 0;
+				for (; blockIndex < static_cast<uint32_t>(blocks.size()); blockIndex++)
+				{
+					MemoryBlock& block = blocks[blockIndex];
+					if ((block.memoryTypeBits & requirements[image].memoryTypeBits) != 0 && requirements[image].size <= block.size &&
+						std::none_of(block.images.begin(), block.images.end(), overlaps))
+					{
+						break;
+					}
+				}
+				if (blockIndex == blocks.size())
+				{
+					blocks.push_back(MemoryBlock{ requirements[image].size, requirements[image].memoryTypeBits, {} });
+				}
+				blocks[blockIndex].memoryTypeBits &= requirements[image].memoryTypeBits;
+				blocks[blockIndex].images.push_back(image);
+				frame.images[image].block = blockIndex;
+			}
+
+			frame.allocatedBytes = 0;
+			for (const MemoryBlock& block : blocks)
+			{
+				VkMemoryAllocateInfo allocInfo{};
+				allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				allocInfo.allocationSize = block.size;
+				allocInfo.memoryTypeIndex = device.FindMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				VkDeviceMemory memory;
+				if (device.AllocateMemory(allocInfo, MemoryCategory::RenderTarget, memory) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to allocate render graph memory!");
+				}
+				frame.memoryBlocks.push_back(memory);
+				frame.allocatedBytes += block.size;
+			}
+			for (size_t i = 0; i < keys.size(); i++)
+			{
+				TransientImage& image = frame.images[i];
+				if (vkBindImageMemory(device.GetDevice(), image.image, frame.memoryBlocks[image.block], 0) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to bind render graph image memory!");
+				}
+				image.view = device.CreateImageView(image.image, keys[i].format,
+					IsDepthFormat(keys[i].format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_IMAGE_VIEW_TYPE_2D);
+			}
+		}
+
+		for (size_t i = 0; i < transientResources.size(); i++)
+		{
+			Resource& resource = resources[transientResources[i]];
+			resource.image = frame.images[i].image;
+			resource.view = frame.images[i].view;
+			statistics.transientBytes += frame.images[i].size;
+		}
+		statistics.transientImageCount = static_cast<uint32_t>(keys.size());
+		statistics.allocatedBytes = frame.allocatedBytes;
+	}
+
+	void LitRenderGraph::DestroyTransientImages(FrameResources& frame)
+	{
+		for (TransientImage& image : frame.images)
+		{
+			vkDestroyImageView(device.GetDevice(), image.view, nullptr);
+			vkDestroyImage(device.GetDevice(), image.image, nullptr);
+		}
+		for (VkDeviceMemory memory : frame.memoryBlocks)
+		{
+			device.FreeMemory(memory);
+		}
+		frame.keys.clear();
+		frame.images.clear();
+		frame.memoryBlocks.clear();
+		frame.allocatedBytes = 0;
+	}
+
+	void LitRenderGraph::PlanBarriers(FrameResources& frame)
+	{
+		std::vector<ResourceState> states(resources.size());
+		for (uint32_t i = 0; i < static_cast<uint32_t>(resources.size()); i++)
+		{
+			const Resource& resource = resources[i];
+			if (resource.bImported)
+			{
+				// whatever ran before the graph, waited for with the widest scope
+				states[i].layout = resource.initialLayout;
+				states[i].writeStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+				states[i].writeAccess = !resource.bImage || resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED ?
+					VK_ACCESS_MEMORY_WRITE_BIT : 0;
+			}
+		}
+		// the transient image that last used each memory block, the next one in the block waits for it
+		std::vector<uint32_t> blockOwners(frame.memoryBlocks.size(), UINT32_MAX);
+		// all reads of an image version in one layout, the barrier in front of the first one covers the others too
+		std::map<std::array<uint32_t, 3>, std::pair<VkPipelineStageFlags, VkAccessFlags>> versionReads;
+		for (uint32_t index : executionOrder)
+		{
+			for (const Access& access : passes[index].accesses)
+			{
+				if (!access.bWrite && resources[access.resource].bImage)
+				{
+					auto& reads = versionReads[{ access.resource, access.version, static_cast<uint32_t>(access.layout) }];
+					reads.first |= access.stages;
+					reads.second |= access.accessMask;
+				}
+			}
+		}
+
+		for (uint32_t index : executionOrder)
+		{
+			Pass& pass = passes[index];
+			for (const Access& access : pass.accesses)
+			{
+				Resource& resource = resources[access.resource];
+				ResourceState& state = states[access.resource];
+				if (resource.transient != UINT32_MAX && executionOrder[resource.firstUse] == index)
+				{
+					const uint32_t block = frame.images[resource.transient].block;
+					if (blockOwners[block] != UINT32_MAX)
+					{
+						const ResourceState& previous = states[blockOwners[block]];
+						state.writeStages = previous.writeStages | previous.readStages;
+						state.writeAccess = previous.writeAccess;
+					}
+					blockOwners[block] = access.resource;
+				}
+
+				if (!resource.bImage)
+				{
+					// buffers: a write waits for everything before it, a read for the last write if it isn't visible yet
+					const bool bVisible = (access.stages & ~state.visibleStages) == 0 && (access.accessMask & ~state.visibleAccess) == 0;
+					if (access.bWrite || (!bVisible && state.writeStages != 0))
+					{
+						const VkPipelineStageFlags srcStages = access.bWrite ? state.writeStages | state.readStages : state.writeStages;
+						if (srcStages != 0)
+						{
+							pass.srcStages |= srcStages;
+							pass.dstStages |= access.stages;
+							if (state.writeAccess != 0)
+							{
+								VkMemoryBarrier barrier{};
+								barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+								barrier.srcAccessMask = state.writeAccess;
+								barrier.dstAccessMask = access.accessMask;
+								pass.memoryBarriers.push_back(barrier);
+							}
+						}
+					}
+					if (access.bWrite)
+					{
+						state.writeStages = access.stages;
+						state.writeAccess = access.accessMask & WRITE_ACCESS;
+						state.readStages = 0;
+						state.visibleStages = 0;
+						state.visibleAccess = 0;
+					}
+					else
+					{
+						state.readStages |= access.stages;
+						state.visibleStages |= access.stages;
+						state.visibleAccess |= access.accessMask;
+					}
+					continue;
+				}
+
+				// a read makes the version visible to every later read of it in the same layout at once
+				VkPipelineStageFlags dstStages = access.stages;
+				VkAccessFlags dstAccess = access.accessMask;
+				if (!access.bWrite)
+				{
+					const auto& reads = versionReads[{ access.resource, access.version, static_cast<uint32_t>(access.layout) }];
+					dstStages = reads.first;
+					dstAccess = reads.second;
+				}
+
+				if (access.bWrite || access.layout != state.layout)
+				{
+					// a write or a layout transition waits for all earlier accesses
+					const VkImageLayout oldLayout = access.bDiscard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+					if (state.writeStages != 0 || state.readStages != 0 || oldLayout != access.layout)
+					{
+						AddBarrier(pass, resource, state.writeStages | state.readStages, state.writeAccess,
+							oldLayout, access.layout, dstStages, dstAccess);
+					}
+					state.layout = access.layout;
+					state.writeStages = access.stages;
+					state.writeAccess = access.bWrite ? access.accessMask & WRITE_ACCESS : 0;
+					state.readStages = access.bWrite ? 0 : access.stages;
+					state.visibleStages = access.bWrite ? 0 : dstStages;
+					state.visibleAccess = access.bWrite ? 0 : dstAccess;
+				}
+				else
+				{
+					// another read in the same layout, only a stage the last write isn't visible to yet needs a barrier
+					const bool bVisible = (access.stages & ~state.visibleStages) == 0 && (access.accessMask & ~state.visibleAccess) == 0;
+					if (!bVisible && state.writeStages != 0)
+					{
+						AddBarrier(pass, resource, state.writeStages, state.writeAccess, state.layout, state.layout, dstStages, dstAccess);
+						state.visibleStages |= dstStages;
+						state.visibleAccess |= dstAccess;
+					}
+					state.readStages |= access.stages;
+				}
+			}
+		}
+
+		// imported images end up in the layout the code after the graph expects
+		for (uint32_t i = 0; i < static_cast<uint32_t>(resources.size()); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.bImported && resource.bImage && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+				resource.finalLayout != states[i].layout)
+			{
+				AddBarrier(finalBarriers, resource, states[i].writeStages | states[i].readStages, states[i].writeAccess,
+					states[i].layout, resource.finalLayout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+			}
+		}
+
+		for (uint32_t index : executionOrder)
+		{
+			Pass& pass = passes[index];
+			// nothing to wait for is only worth saying when no other barrier of the batch waits for something
+			if (pass.srcStages != VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT)
+			{
+				pass.srcStages &= ~VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			}
+			statistics.barrierBatchCount += pass.srcStages != 0 ? 1 : 0;
+			statistics.imageBarrierCount += static_cast<uint32_t>(pass.imageBarriers.size());
+			statistics.memoryBarrierCount += static_cast<uint32_t>(pass.memoryBarriers.size());
+		}
+		statistics.barrierBatchCount += finalBarriers.srcStages != 0 ? 1 : 0;
+		statistics.imageBarrierCount += static_cast<uint32_t>(finalBarriers.imageBarriers.size());
+	}
+
+	void LitRenderGraph::AddBarrier(Pass& pass, const Resource& resource, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+		VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+	{
+		pass.srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		pass.dstStages |= dstStages;
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = resource.image;
+		// depth stencil formats transition both aspects together
+		barrier.subresourceRange.aspectMask = resource.aspect == VK_IMAGE_ASPECT_DEPTH_BIT && device.HasStencilFormat(resource.desc.format) ?
+			VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : resource.aspect;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		pass.imageBarriers.push_back(barrier);
+	}
+
+	VkRenderPass LitRenderGraph::GetOrCreateRenderPass(const Pass& pass)
+	{
+		// color attachments first, then depth
+		std::vector<const Access*> attachments;
+		for (const Access& access : pass.accesses)
+		{
+			if (access.bColorAttachment)
+			{
+				attachments.push_back(&access);
+			}
+		}
+		for (const Access& access : pass.accesses)
+		{
+			if (access.bDepthAttachment)
+			{
+				attachments.push_back(&access);
+			}
+		}
+
+		std::vector<VkAttachmentDescription> descriptions;
+		std::vector<uint32_t> key;
+		for (const Access* access : attachments)
+		{
+			const Resource& resource = resources[access->resource];
+			// nothing to load when the previous version was never written, nothing to store when no one uses the result
+			const bool bHasContents = access->version > 1 || (resource.bImported && resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+			VkAttachmentDescription description{};
+			description.format = resource.desc.format;
+			description.samples = VK_SAMPLE_COUNT_1_BIT;
+			description.loadOp = access->bClear ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+				bHasContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.storeOp = resource.versionUsed[access->version] ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			// the barriers before the pass do the layout transitions
+			description.initialLayout = access->layout;
+			description.finalLayout = access->layout;
+			descriptions.push_back(description);
+			key.insert(key.end(), { static_cast<uint32_t>(description.format), static_cast<uint32_t>(description.loadOp),
+				static_cast<uint32_t>(description.storeOp), access->bDepthAttachment ? 1u : 0u });
+		}
+
+		auto cached = renderPassCache.find(key);
+		if (cached != renderPassCache.end())
+		{
+			return cached->second;
+		}
+
+		std::vector<VkAttachmentReference> colorReferences;
+		VkAttachmentReference depthReference{};
+		bool bHasDepth = false;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(attachments.size()); i++)
+		{
+			if (attachments[i]->bDepthAttachment)
+			{
+				depthReference = { i, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+				bHasDepth = true;
+			}
+			else
+			{
+				colorReferences.push_back({ i, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			}
+		}
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+		subpass.pColorAttachments = colorReferences.data();
+		subpass.pDepthStencilAttachment = bHasDepth ? &depthReference : nullptr;
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+		renderPassInfo.pAttachments = descriptions.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		VkRenderPass renderPass;
+		if (vkCreateRenderPass(device.GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create render graph render pass!");
+		}
+		renderPassCache[key] = renderPass;
+		return renderPass;
+	}
+
+	void LitRenderGraph::Execute(VkCommandBuffer commandBuffer)
+	{
+		auto recordBarriers = [commandBuffer](const Pass& pass)
+		{
+			if (pass.srcStages != 0)
+			{
+				vkCmdPipelineBarrier(commandBuffer, pass.srcStages, pass.dstStages, 0,
+					static_cast<uint32_t>(pass.memoryBarriers.size()), pass.memoryBarriers.data(), 0, nullptr,
+					static_cast<uint32_t>(pass.imageBarriers.size()), pass.imageBarriers.data());
+			}
+		};
+
+		for (uint32_t index : executionOrder)
+		{
+			Pass& pass = passes[index];
+			recordBarriers(pass);
+			LitGpuScope scope{ profiler, commandBuffer, pass.name.c_str(), true };
+			if (pass.bGraphics)
+			{
+				BeginRenderPass(commandBuffer, pass);
+				pass.execute(commandBuffer);
+				vkCmdEndRenderPass(commandBuffer);
+			}
+			else
+			{
+				pass.execute(commandBuffer);
+			}
+		}
+		recordBarriers(finalBarriers);
+	}
+
+	void LitRenderGraph::BeginRenderPass(VkCommandBuffer commandBuffer, Pass& pass)
+	{
+		// same order as GetOrCreateRenderPass
+		std::vector<VkImageView> views;
+		std::vector<VkClearValue> clearValues;
+		VkExtent2D extent{ UINT32_MAX, UINT32_MAX };
+		for (int depth = 0; depth < 2; depth++)
+		{
+			for (const Access& access : pass.accesses)
+			{
+				if ((depth == 0 && access.bColorAttachment) || (depth == 1 && access.bDepthAttachment))
+				{
+					const Resource& resource = resources[access.resource];
+					views.push_back(resource.view);
+					clearValues.push_back(access.clearValue);
+					extent.width = std::min(extent.width, resource.desc.extent.width);
+					extent.height = std::min(extent.height, resource.desc.extent.height);
+				}
+			}
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = pass.renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+		framebufferInfo.pAttachments = views.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+		VkFramebuffer frameBuffer;
+		if (vkCreateFramebuffer(device.GetDevice(), &framebufferInfo, nullptr, &frameBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create render graph framebuffer!");
+		}
+		frames[currentFrameIndex].frameBuffers.push_back(frameBuffer);
+
+		const VkExtent2D renderArea = pass.renderArea.width == 0 || pass.renderArea.height == 0 ? extent :
+			VkExtent2D{ std::min(pass.renderArea.width, extent.width), std::min(pass.renderArea.height, extent.height) };
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = pass.renderPass;
+		renderPassInfo.framebuffer = frameBuffer;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = renderArea;
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassInfo.pClearValues = clearValues.data();
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(renderArea.width);
+		viewport.height = static_cast<float>(renderArea.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		VkRect2D scissor{ { 0, 0 }, renderArea };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	}
+
+	VkImage LitRenderGraph::GetImage(ResourceHandle image) const
+	{
+		return resources[image.resource].image;
+	}
+
+	VkImageView LitRenderGraph::GetImageView(ResourceHandle image) const
+	{
+		return resources[image.resource].view;
+	}
+
+	VkBuffer LitRenderGraph::GetBuffer(ResourceHandle buffer) const
+	{
+		return resources[buffer.resource].buffer;
+	}
+
+	std::vector<std::string> LitRenderGraph::GetExecutionOrder() const
+	{
+		std::vector<std::string> names;
+		for (uint32_t index : executionOrder)
+		{
+			names.push_back(passes[index].name);
+		}
+		return names;
+	}
+}
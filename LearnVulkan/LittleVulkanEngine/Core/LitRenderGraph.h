@@ -0,0 +1,270 @@
+#pragma once
+#include "LitDevice.h"
+#include "LitGpuProfiler.h"
+
+// std
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// A frame described as passes that declare what they read and write. Compile orders the passes, drops the ones
+	// nothing needs, places the transient images into shared memory where their lifetimes don't overlap and works
+	// out the barriers between passes, Execute records them with one vkCmdPipelineBarrier per pass.
+	// Rebuilt every frame: Reset, create or import resources, add passes, Compile, Execute. The Vulkan objects it
+	// creates (render passes, transient images and their memory) are cached across frames
+	class LitRenderGraph
+	{
+	public:
+		// one version of a resource. A write returns the next version, so the order of the passes follows from
+		// which version each of them uses
+		struct ResourceHandle
+		{
+			uint32_t resource = UINT32_MAX;
+			uint32_t version = 0;
+
+			bool IsValid() const { return resource != UINT32_MAX; }
+		};
+
+		enum class ImageUsage
+		{
+			SampledFragment,
+			SampledCompute,
+			StorageCompute,
+			TransferSrc,
+			TransferDst,
+		};
+
+		enum class BufferUsage
+		{
+			IndirectRead,
+			VertexIndexRead,
+			UniformRead,
+			StorageReadCompute,
+			StorageWriteCompute,
+			TransferSrc,
+			TransferDst,
+		};
+
+		struct ImageDesc
+		{
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			VkExtent2D extent{ 0, 0 };
+		};
+
+		struct Statistics
+		{
+			uint32_t passCount = 0;
+			uint32_t culledPassCount = 0;
+			// vkCmdPipelineBarrier calls and the barriers in them
+			uint32_t barrierBatchCount = 0;
+			uint32_t imageBarrierCount = 0;
+			uint32_t memoryBarrierCount = 0;
+			uint32_t transientImageCount = 0;
+			// what the transient images would take on their own and the memory they share
+			VkDeviceSize transientBytes = 0;
+			VkDeviceSize allocatedBytes = 0;
+		};
+
+		class PassBuilder
+		{
+		public:
+			// attachments of a graphics pass in declaration order. With a clear value the attachment is cleared,
+			// otherwise what the previous version holds is loaded
+			ResourceHandle WriteColor(ResourceHandle image, const VkClearColorValue* clear = nullptr);
+			ResourceHandle WriteDepth(ResourceHandle image, const VkClearDepthStencilValue* clear = nullptr);
+			void ReadImage(ResourceHandle image, ImageUsage usage);
+			// keeps the previous contents, e.g. a storage image a compute pass writes parts of
+			ResourceHandle WriteImage(ResourceHandle image, ImageUsage usage);
+			void ReadBuffer(ResourceHandle buffer, BufferUsage usage);
+			ResourceHandle WriteBuffer(ResourceHandle buffer, BufferUsage usage);
+			// graphics passes render to this top left area, the attachment extent by default
+			void SetRenderArea(VkExtent2D extent);
+			// never culled, for passes with results the graph doesn't see
+			void SetSideEffect();
+
+		private:
+			friend class LitRenderGraph;
+			PassBuilder(LitRenderGraph& inGraph, uint32_t inPass) : graph{ inGraph }, pass{ inPass } {}
+
+			LitRenderGraph& graph;
+			uint32_t pass;
+		};
+
+		using SetupFunction = std::function<void(PassBuilder& builder)>;
+		using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+		explicit LitRenderGraph(LitDevice& device);
+		~LitRenderGraph();
+
+		LitRenderGraph(const LitRenderGraph&) = delete;
+		LitRenderGraph& operator=(const LitRenderGraph&) = delete;
+
+		// forgets the passes and resources of the last frame
+		void Reset();
+
+		// an image that only lives during the graph, its memory may be shared with other transient images
+		ResourceHandle CreateImage(const std::string& name, const ImageDesc& desc);
+		// an image owned outside. It is in initialLayout when the graph starts and left in finalLayout, a finalLayout
+		// of VK_IMAGE_LAYOUT_UNDEFINED means its contents aren't needed afterwards
+		ResourceHandle ImportImage(const std::string& name, VkImage image, VkImageView view, VkFormat format,
+			VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout);
+		// buffers only get memory barriers, what the last pass writes to them is kept
+		ResourceHandle ImportBuffer(const std::string& name, VkBuffer buffer);
+
+		// setup runs right away and declares the resources of the pass, execute runs while recording. Graphics
+		// passes run inside a render pass over their attachments with the viewport and scissor set to the render area
+		void AddGraphicsPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+		void AddComputePass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+		// frameIndex selects the transient images, the ones of a frame in flight are not touched by the others
+		void Compile(int frameIndex);
+		void Execute(VkCommandBuffer commandBuffer);
+
+		// valid after Compile, for the execute functions
+		VkImage GetImage(ResourceHandle image) const;
+		VkImageView GetImageView(ResourceHandle image) const;
+		VkBuffer GetBuffer(ResourceHandle buffer) const;
+
+		// times every pass it executes, with pipeline statistics
+		void SetProfiler(LitGpuProfiler* inProfiler) { profiler = inProfiler; }
+
+		const Statistics& GetStatistics() const { return statistics; }
+		// names of the passes in the order of the last Compile, culled ones are left out
+		std::vector<std::string> GetExecutionOrder() const;
+
+	private:
+		struct Access
+		{
+			uint32_t resource;
+			// the version read, or the one a write produces
+			uint32_t version;
+			bool bWrite;
+			// a write that doesn't need what the resource held before
+			bool bDiscard;
+			bool bColorAttachment;
+			bool bDepthAttachment;
+			bool bClear;
+			VkClearValue clearValue;
+			VkPipelineStageFlags stages;
+			VkAccessFlags accessMask;
+			VkImageLayout layout;
+			VkImageUsageFlags imageUsage;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			bool bGraphics;
+			bool bSideEffect = false;
+			VkExtent2D renderArea{ 0, 0 };
+			std::vector<Access> accesses;
+			ExecuteFunction execute;
+
+			// compile results
+			bool bCulled = false;
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			std::vector<VkImageMemoryBarrier> imageBarriers;
+			std::vector<VkMemoryBarrier> memoryBarriers;
+			VkPipelineStageFlags srcStages = 0;
+			VkPipelineStageFlags dstStages = 0;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			bool bImage;
+			bool bImported;
+			ImageDesc desc;
+			VkImageAspectFlags aspect = 0;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// writers[v] is the pass that produced version v, version 0 is what the resource holds at the start
+			std::vector<uint32_t> writers{ UINT32_MAX };
+			VkImageUsageFlags usage = 0;
+
+			// compile results, positions in the execution order
+			uint32_t firstUse = UINT32_MAX;
+			uint32_t lastUse = 0;
+			uint32_t transient = UINT32_MAX;
+			// versionUsed[v]: a pass that runs reads version v or writes on top of it, or it is the result of the graph
+			std::vector<bool> versionUsed;
+		};
+
+		// where an earlier access left a resource, to find out what the next one has to wait for
+		struct ResourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// stages and writes of the last write or layout transition
+			VkPipelineStageFlags writeStages = 0;
+			VkAccessFlags writeAccess = 0;
+			// stages that read since then, a write has to wait for them too
+			VkPipelineStageFlags readStages = 0;
+			// where the last write is already visible
+			VkPipelineStageFlags visibleStages = 0;
+			VkAccessFlags visibleAccess = 0;
+		};
+
+		// a transient image of one frame in flight. Reused as long as the graph asks for the same images
+		struct TransientKey
+		{
+			VkFormat format;
+			VkExtent2D extent;
+			VkImageUsageFlags usage;
+			uint32_t firstUse;
+			uint32_t lastUse;
+
+			bool operator==(const TransientKey& other) const;
+		};
+
+		struct TransientImage
+		{
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			uint32_t block = 0;
+			VkDeviceSize size = 0;
+		};
+
+		struct FrameResources
+		{
+			std::vector<TransientKey> keys;
+			std::vector<TransientImage> images;
+			std::vector<VkDeviceMemory> memoryBlocks;
+			VkDeviceSize allocatedBytes = 0;
+			// created by the last Execute with this frame, its commands are done once the frame comes round again
+			std::vector<VkFramebuffer> frameBuffers;
+		};
+
+		uint32_t AddPass(const std::string& name, bool bGraphics, const SetupFunction& setup, ExecuteFunction execute);
+		ResourceHandle AddAccess(uint32_t pass, ResourceHandle handle, const Access& access);
+		void CullPasses();
+		void SortPasses();
+		void CreateTransientImages(FrameResources& frame);
+		void DestroyTransientImages(FrameResources& frame);
+		void PlanBarriers(FrameResources& frame);
+		// an image barrier in the batch before pass, a srcStages of 0 means there is nothing to wait for
+		void AddBarrier(Pass& pass, const Resource& resource, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+			VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
+		VkRenderPass GetOrCreateRenderPass(const Pass& pass);
+		void BeginRenderPass(VkCommandBuffer commandBuffer, Pass& pass);
+
+		LitDevice& device;
+		std::vector<Pass> passes;
+		std::vector<Resource> resources;
+		// passes that are not culled, in execution order
+		std::vector<uint32_t> executionOrder;
+		// barriers to the final layouts of the imported images, after the last pass
+		Pass finalBarriers;
+
+		std::vector<FrameResources> frames;
+		int currentFrameIndex = 0;
+		std::map<std::vector<uint32_t>, VkRenderPass> renderPassCache;
+		Statistics statistics;
+		LitGpuProfiler* profiler = nullptr;
+	};
+}
@@ -0,0 +1,149 @@
+#include "LitRenderQueue.h"
+
+// std
+#include <array>
+#include <cstring>
+
+namespace Lit
+{
+	static const uint32_t PIPELINE_BITS = 12;
+	static const uint32_t MATERIAL_BITS = 16;
+	static const uint32_t MESH_BITS = 15;
+	static const uint32_t DEPTH_BITS = 20;
+
+	// non negative floats compare like their bit patterns, keep the top bits below the sign
+	static uint64_t QuantizeDepth(float depth)
+	{
+		depth = depth > 0.0f ? depth : 0.0f;
+		uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return bits >> (31 - DEPTH_BITS);
+	}
+
+	void LitRenderQueue::Clear()
+	{
+		packets.clear();
+		entries.clear();
+		// ids only have to be unique within a frame, keeping them would grow the maps with every destroyed
+		// pipeline, material set and model until the ids wrap
+		pipelineIds.clear();
+		materialIds.clear();
+		meshIds.clear();
+	}
+
+	void LitRenderQueue::Submit(const LitDrawPacket& packet)
+	{
+		entries.push_back(SortEntry{ MakeSortKey(packet), static_cast<uint32_t>(packets.size()) });
+		packets.push_back(packet);
+	}
+
+	uint32_t LitRenderQueue::GetId(std::unordered_map<const void*, uint32_t>& ids, const void* object, uint32_t bitCount)
+	{
+		auto it = ids.find(object);
+		if (it == ids.end())
+		{
+			it = ids.emplace(object, static_cast<uint32_t>(ids.size())).first;
+		}
+		return it->second & ((1u << bitCount) - 1);
+	}
+
+	uint64_t LitRenderQueue::MakeSortKey(const LitDrawPacket& packet)
+	{
+		const uint64_t pipelineId = GetId(pipelineIds, packet.pipeline, PIPELINE_BITS);
+		const uint64_t materialId = packet.materialSet == VK_NULL_HANDLE ? 0 :
+			GetId(materialIds, reinterpret_cast<const void*>(packet.materialSet), MATERIAL_BITS);
+		// the index type sits above the mesh id so models sharing a geometry pool only rebind when it flips
+		const uint64_t indexType = packet.model->GetIndexType() == VK_INDEX_TYPE_UINT16 ? 0 : 1;
+		const uint64_t meshId = GetId(meshIds, packet.model, MESH_BITS);
+
+		uint64_t stateKey = pipelineId;
+		stateKey = (stateKey << MATERIAL_BITS) | materialId;
+		stateKey = (stateKey << 1) | indexType;
+		stateKey = (stateKey << MESH_BITS) | meshId;
+
+		const uint64_t depthKey = QuantizeDepth(packet.depth);
+		if (sortMode == SortMode::FrontToBack)
+		{
+			return (depthKey << (64 - DEPTH_BITS)) | stateKey;
+		}
+		return (stateKey << DEPTH_BITS) | depthKey;
+	}
+
+	void LitRenderQueue::RadixSort(std::vector<SortEntry>& keys, std::vector<SortEntry>& temp)
+	{
+		temp.resize(keys.size());
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			std::array<uint32_t, 256> counts{};
+			for (const auto& entry : keys)
+			{
+				counts[(entry.key >> shift) & 0xff]++;
+			}
+			if (counts[(keys[0].key >> shift) & 0xff] == keys.size())
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& count : counts)
+			{
+				const uint32_t bucketSize = count;
+				count = offset;
+				offset += bucketSize;
+			}
+			for (const auto& entry : keys)
+			{
+				temp[counts[(entry.key >> shift) & 0xff]++] = entry;
+			}
+			keys.swap(temp);
+		}
+	}
+
+	void LitRenderQueue::Sort()
+	{
+		if (entries.size() > 1)
+		{
+			RadixSort(entries, scratch);
+		}
+	}
+
+	void LitRenderQueue::Record(VkCommandBuffer commandBuffer, const DrawCallback& drawCallback)
+	{
+		statistics.Reset();
+
+		LitPipeline* boundPipeline = nullptr;
+		VkDescriptorSet boundMaterialSet = VK_NULL_HANDLE;
+		VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+		VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+		for (const auto& entry : entries)
+		{
+			const LitDrawPacket& packet = packets[entry.packetIndex];
+			if (packet.pipeline != boundPipeline)
+			{
+				packet.pipeline->Bind(commandBuffer);
+				boundPipeline = packet.pipeline;
+				statistics.pipelineBinds++;
+			}
+
+			if (packet.materialSet != VK_NULL_HANDLE && packet.materialSet != boundMaterialSet)
+			{
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipelineLayout,
+					MATERIAL_DESCRIPTOR_SET, 1, &packet.materialSet, 0, nullptr);
+				boundMaterialSet = packet.materialSet;
+				statistics.descriptorBinds++;
+			}
+
+			// models in one geometry pool share the buffers, they only differ by the index type they bind with
+			if (packet.model->GetVertexBuffer() != boundVertexBuffer || packet.model->GetIndexType() != boundIndexType)
+			{
+				packet.model->Bind(commandBuffer);
+				boundVertexBuffer = packet.model->GetVertexBuffer();
+				boundIndexType = packet.model->GetIndexType();
+				statistics.geometryBinds++;
+			}
+
+			drawCallback(commandBuffer, packet);
+			statistics.drawCount++;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "LitModel.h"
+#include "LitPipeline.h"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Lit
+{
+	struct RenderQueueStatistics
+	{
+		uint32_t drawCount = 0;
+		uint32_t pipelineBinds = 0;
+		uint32_t descriptorBinds = 0;
+		uint32_t geometryBinds = 0;
+
+		uint32_t StateChanges() const { return pipelineBinds + descriptorBinds + geometryBinds; }
+		void Reset() { *this = RenderQueueStatistics{}; }
+		RenderQueueStatistics& operator+=(const RenderQueueStatistics& other)
+		{
+			drawCount += other.drawCount;
+			pipelineBinds += other.pipelineBinds;
+			descriptorBinds += other.descriptorBinds;
+			geometryBinds += other.geometryBinds;
+			return *this;
+		}
+	};
+
+	// One draw submitted to the queue. The queue binds the pipeline, the material set and the geometry,
+	// the draw callback given to Record pushes constants and issues the draw itself
+	struct LitDrawPacket
+	{
+		LitPipeline* pipeline = nullptr;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		// bound to MATERIAL_DESCRIPTOR_SET, VK_NULL_HANDLE for pipelines without material data
+		VkDescriptorSet materialSet = VK_NULL_HANDLE;
+		LitModel* model = nullptr;
+		// view space depth, packets that share all state are drawn front to back
+		float depth = 0.0f;
+		// free for the submitter, usually an index into its own per object data
+		uint32_t userData = 0;
+	};
+
+	// Collects the draws of a frame, sorts them by a 64 bit key so draws sharing state end up next to each other
+	// and records them binding state only when it differs from the previous draw. Key layout from high to low bits:
+	// StateFirst: pipeline (12) | material (16) | index type (1) + mesh (15) | depth (20)
+	// FrontToBack: depth (20) | pipeline (12) | material (16) | index type (1) + mesh (15)
+	class LitRenderQueue
+	{
+	public:
+		static constexpr uint32_t MATERIAL_DESCRIPTOR_SET = 1;
+
+		enum class SortMode
+		{
+			StateFirst,		// fewest state changes, depth only orders draws that share all state
+			FrontToBack,	// nearest first for early depth rejection, state only orders draws at the same depth
+		};
+
+		using DrawCallback = std::function<void(VkCommandBuffer commandBuffer, const LitDrawPacket& packet)>;
+
+		// takes effect for packets submitted afterwards
+		void SetSortMode(SortMode mode) { sortMode = mode; }
+		SortMode GetSortMode() const { return sortMode; }
+
+		void Clear();
+		void Submit(const LitDrawPacket& packet);
+		// radix sorts the submitted packets by their keys
+		void Sort();
+		// records the packets in sorted order, the global descriptor set must already be bound
+		void Record(VkCommandBuffer commandBuffer, const DrawCallback& drawCallback);
+
+		size_t GetPacketCount() const { return packets.size(); }
+		// state changes of the last Record
+		const RenderQueueStatistics& GetStatistics() const { return statistics; }
+
+	private:
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t packetIndex;
+		};
+
+		// small ids in first submission order since the last Clear, truncated to the key field so a collision only costs a bind
+		static uint32_t GetId(std::unordered_map<const void*, uint32_t>& ids, const void* object, uint32_t bitCount);
+		uint64_t MakeSortKey(const LitDrawPacket& packet);
+		// least significant digit first, 8 bits per pass, passes where every key has the same digit are skipped
+		static void RadixSort(std::vector<SortEntry>& keys, std::vector<SortEntry>& temp);
+
+		SortMode sortMode = SortMode::StateFirst;
+		std::vector<LitDrawPacket> packets;
+		std::vector<SortEntry> entries;
+		std::vector<SortEntry> scratch;
+
+		std::unordered_map<const void*, uint32_t> pipelineIds;
+		std::unordered_map<const void*, uint32_t> materialIds;
+		std::unordered_map<const void*, uint32_t> meshIds;
+
+		RenderQueueStatistics statistics;
+	};
+}
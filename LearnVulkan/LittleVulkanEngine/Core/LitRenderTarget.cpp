@@ -0,0 +1,81 @@
+#include "LitRenderTarget.h"
+#include "LitSwapChain.h"
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace Lit
+{
+	LitRenderTarget::LitRenderTarget(LitDevice& inDevice, VkFormat inColorFormat, VkFormat inDepthFormat)
+		: device{ inDevice }, colorFormat{ inColorFormat }, depthFormat{ inDepthFormat }
+	{
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 0.0f;
+		sampler = device.GetSamplerCache().GetSampler(samplerInfo);
+	}
+
+	LitRenderTarget::~LitRenderTarget()
+	{
+		DestroyAttachments();
+	}
+
+	bool LitRenderTarget::Resize(VkExtent2D inExtent)
+	{
+		assert(inExtent.width > 0 && inExtent.height > 0 && "Render target extent must not be empty");
+		if (inExtent.width == extent.width && inExtent.height == extent.height)
+		{
+			return false;
+		}
+
+		DestroyAttachments();
+		extent = inExtent;
+		CreateAttachments();
+		return true;
+	}
+
+	void LitRenderTarget::CreateAttachments()
+	{
+		frames.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (auto& frame : frames)
+		{
+			device.CreateImage(extent.width, extent.height, 1, colorFormat, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::RenderTarget, frame.colorImage, frame.colorImageMemory, 0, 1);
+			frame.colorImageView = device.CreateImageView(frame.colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_IMAGE_VIEW_TYPE_2D);
+
+			device.CreateImage(extent.width, extent.height, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				MemoryCategory::Depth, frame.depthImage, frame.depthImageMemory, 0, 1);
+			frame.depthImageView = device.CreateImageView(frame.depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_VIEW_TYPE_2D);
+		}
+	}
+
+	void LitRenderTarget::DestroyAttachments()
+	{
+		// frames in flight may still render to or sample the old images
+		LitDevice* litDevice = &device;
+		VkDevice vkDevice = device.GetDevice();
+		device.GetDeletionQueue().Push([litDevice, vkDevice, oldFrames = std::move(frames)]()
+			{
+				for (auto& frame : oldFrames)
+				{
+					vkDestroyImageView(vkDevice, frame.colorImageView, nullptr);
+					vkDestroyImage(vkDevice, frame.colorImage, nullptr);
+					litDevice->FreeMemory(frame.colorImageMemory);
+					vkDestroyImageView(vkDevice, frame.depthImageView, nullptr);
+					vkDestroyImage(vkDevice, frame.depthImage, nullptr);
+					litDevice->FreeMemory(frame.depthImageMemory);
+				}
+			});
+		frames.clear();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "LitDevice.h"
+
+// std
+#include <vector>
+
+namespace Lit
+{
+	// Offscreen color and depth images, one set per frame in flight so the UI of a frame can sample the color while
+	// the next frame renders the scene. The formats are those of the swap chain (or the headless renderer), so pipelines
+	// created for its render pass are compatible with the render graph passes that write them. Color can be copied out.
+	// A frame may render to a smaller top left area than the images (dynamic resolution). The images are imported
+	// into the render graph, which owns their layouts while a frame is recorded
+	class LitRenderTarget
+	{
+	public:
+		LitRenderTarget(LitDevice& device, VkFormat colorFormat, VkFormat depthFormat);
+		~LitRenderTarget();
+
+		LitRenderTarget(const LitRenderTarget&) = delete;
+		LitRenderTarget& operator=(const LitRenderTarget&) = delete;
+
+		// recreates the images when the extent changed, that waits for the device to be idle.
+		// Returns whether the images (and so their views) were recreated
+		bool Resize(VkExtent2D extent);
+
+		VkExtent2D GetExtent() const { return extent; }
+		VkFormat GetColorFormat() const { return colorFormat; }
+		VkFormat GetDepthFormat() const { return depthFormat; }
+		VkImage GetColorImage(int frameIndex) const { return frames[frameIndex].colorImage; }
+		VkImageView GetColorImageView(int frameIndex) const { return frames[frameIndex].colorImageView; }
+		VkImage GetDepthImage(int frameIndex) const { return frames[frameIndex].depthImage; }
+		VkImageView GetDepthImageView(int frameIndex) const { return frames[frameIndex].depthImageView; }
+		// bilinear and clamped, to scale the rendered area up to the display size
+		VkSampler GetSampler() const { return sampler; }
+
+	private:
+		struct FrameAttachments
+		{
+			VkImage colorImage = VK_NULL_HANDLE;
+			VkDeviceMemory colorImageMemory = VK_NULL_HANDLE;
+			VkImageView colorImageView = VK_NULL_HANDLE;
+			VkImage depthImage = VK_NULL_HANDLE;
+			VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
+			VkImageView depthImageView = VK_NULL_HANDLE;
+		};
+
+		void CreateAttachments();
+		void DestroyAttachments();
+
+		LitDevice& device;
+		VkFormat colorFormat;
+		VkFormat depthFormat;
+		VkExtent2D extent{ 0, 0 };
+
+		// owned by the sampler cache of the device
+		VkSampler sampler = VK_NULL_HANDLE;
+		std::vector<FrameAttachments> frames;
+	};
+}
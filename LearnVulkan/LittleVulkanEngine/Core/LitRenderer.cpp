@@ -1,4 +1,5 @@
 #include "LitRenderer.h"
+#include "LitCpuProfiler.h"
 
 #include <array>
 #include <cassert>
@@ -20,12 +21,12 @@ namespace Lit
 
 	void LitRenderer::RecreateSwapChain()
 	{
+		LIT_CPU_ZONE("recreate swap chain");
 		auto extent = litWindow.GetExtent();
 		while (extent.width == 0 || extent.height == 0) {
 			extent = litWindow.GetExtent();
 			glfwWaitEvents();
 		}
-		vkDeviceWaitIdle(litDevice.GetDevice());
 
 		if (litSwapChain == nullptr) {
 			litSwapChain = std::make_unique<LitSwapChain>(litDevice, extent);
@@ -38,6 +39,10 @@ namespace Lit
 			{
 				throw std::runtime_error("Swap chain image(or depth) format has changed!");
 			}
+
+			// frames in flight still render to and present the old images, it goes once they are done
+			litDevice.GetDeletionQueue().Push([oldSwapChain]() mutable { oldSwapChain.reset(); });
+			swapChainRecreateCount++;
 		}
 	}
 	
@@ -68,6 +73,7 @@ namespace Lit
 	VkCommandBuffer LitRenderer::BeginFrame()
 	{
 		assert(!bIsFrameStarted && "Can't call beginFrame while already in progress");
+		LIT_CPU_ZONE("begin frame");
 
 		auto result = litSwapChain->AcquireNextImage(&currentImageIndex);
 
@@ -82,6 +88,9 @@ namespace Lit
 			throw std::runtime_error("failed to acquire swap chain image!");
 		}
 		bIsFrameStarted = true;
+		// the frame slot was waited on, so were the deletions of frames up to it
+		litDevice.GetDeletionQueue().BeginFrame();
+		litDevice.GetMemoryBudget().Update();
 		auto commandBuffer = GetCurrentCommandBuffer();
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -96,12 +105,20 @@ namespace Lit
 	void LitRenderer::EndFrame()
 	{
 		assert(bIsFrameStarted && "Can't call endFrame while frame is not in progress");
+		LIT_CPU_ZONE("end frame");
 		auto commandBuffer = GetCurrentCommandBuffer();
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
 			throw std::runtime_error("failed to record command buffer!");
 		}
 
+		// host writes to non-coherent buffers must be visible before the frame is submitted
+		if (litDevice.FlushMappedMemoryRanges() != VK_SUCCESS) {
+			throw std::runtime_error("failed to flush mapped memory ranges!");
+		}
+
 		auto result = litSwapChain->SumitCommandBuffers(&commandBuffer, &currentImageIndex);
+		lastFrameTimelineValue = litSwapChain->GetLastSubmittedTimelineValue();
+		litDevice.GetDeletionQueue().EndFrame(lastFrameTimelineValue);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || litWindow.IsWindowResized()) {
 			litWindow.ResetWindowResizedFlag();
 			RecreateSwapChain();
@@ -119,10 +136,23 @@ namespace Lit
 		assert(
 			commandBuffer == GetCurrentCommandBuffer() &&
 			"Can't begin render pass on command buffer from a different frame");
+		BeginRenderPass(commandBuffer, litSwapChain->GetRenderPass());
+	}
+
+	void LitRenderer::ResumeSwapChainRenderPass(VkCommandBuffer commandBuffer)
+	{
+		assert(bIsFrameStarted && "Can't call resumeSwapChainRenderPass if frame is not in progress");
+		assert(
+			commandBuffer == GetCurrentCommandBuffer() &&
+			"Can't resume render pass on command buffer from a different frame");
+		BeginRenderPass(commandBuffer, litSwapChain->GetResumeRenderPass());
+	}
 
+	void LitRenderer::BeginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass)
+	{
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = litSwapChain->GetRenderPass();
+		renderPassInfo.renderPass = renderPass;
 		renderPassInfo.framebuffer = litSwapChain->GetFrameBuffer(currentImageIndex);
 
 		renderPassInfo.renderArea.offset = { 0, 0 };
@@ -25,6 +25,14 @@ namespace Lit
 			return litSwapChain->GetRenderPass(); 
 		}
 		float GetAspectRatio() const {return litSwapChain->AspectRatio();}
+		VkExtent2D GetSwapChainExtent() const { return litSwapChain->GetSwapChainExtent(); }
+		VkFormat GetSwapChainImageFormat() const { return litSwapChain->GetSwapChainImageFormat(); }
+		// the image being rendered and its depth attachment, valid between BeginFrame and EndFrame
+		VkImage GetCurrentImage() const { return litSwapChain->GetImage(static_cast<int>(currentImageIndex)); }
+		VkImageView GetCurrentImageView() const { return litSwapChain->GetImageView(static_cast<int>(currentImageIndex)); }
+		VkImage GetCurrentDepthImage() const { return litSwapChain->GetDepthImage(static_cast<int>(currentImageIndex)); }
+		VkImageView GetCurrentDepthImageView() const { return litSwapChain->GetDepthImageView(static_cast<int>(currentImageIndex)); }
+		VkFormat GetDepthFormat() const { return litSwapChain->GetSwapChainDepthFormat(); }
 		bool IsFrameInProgress() const { return bIsFrameStarted; }
 		uint32_t GetImageCount() const { return litSwapChain->ImageCount(); }
 		VkCommandBuffer GetCurrentCommandBuffer() const 
@@ -39,15 +47,23 @@ namespace Lit
 			return currentFrameIndex;
 		}
 
+		// device timeline value that is reached once the GPU finished the last frame, see LitTimeline
+		uint64_t GetLastFrameTimelineValue() const { return lastFrameTimelineValue; }
+		uint32_t GetSwapChainRecreateCount() const { return swapChainRecreateCount; }
+
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
 		void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+		// begins the swap chain pass again after it was ended for work that can't run inside it (compute),
+		// color and depth keep what was rendered so far
+		void ResumeSwapChainRenderPass(VkCommandBuffer commandBuffer);
 		void EndSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
 	private:
 		void CreateCommandBuffers();
 		void FreeCommandBuffers();
 		void RecreateSwapChain();
+		void BeginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass);
 
 	private:
 		LitWindow& litWindow;
@@ -58,6 +74,8 @@ namespace Lit
 		uint32_t currentImageIndex;
 		int currentFrameIndex;
 		bool bIsFrameStarted;
+		uint64_t lastFrameTimelineValue = 0;
+		uint32_t swapChainRecreateCount = 0;
 
 	};
 }
@@ -0,0 +1,102 @@
+#include "LitResizeTest.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace Lit
+{
+	static const uint32_t RESIZE_FRAMES = 600;
+	// the size swings between these fractions of the start size, width and height at different rates
+	static const float MIN_SIZE_FRACTION = 0.5f;
+	static const float MAX_SIZE_FRACTION = 1.0f;
+	static const float WIDTH_PERIOD_FRAMES = 120.0f;
+	static const float HEIGHT_PERIOD_FRAMES = 170.0f;
+	static const float PI = 3.14159265f;
+
+	void LitResizeTest::Start(VkExtent2D windowExtent, uint32_t swapChainRecreateCount)
+	{
+		bRunning = true;
+		baseExtent = windowExtent;
+		frame = 0;
+		lastRecreateCount = swapChainRecreateCount;
+		samples.clear();
+		samples.reserve(RESIZE_FRAMES);
+		summary = Summary{};
+	}
+
+	VkExtent2D LitResizeTest::Step(float frameMilliseconds, uint32_t swapChainRecreateCount)
+	{
+		if (!bRunning)
+		{
+			return baseExtent;
+		}
+
+		// the first call measures the frame before the first resize
+		if (frame > 0)
+		{
+			samples.push_back(Sample{ frameMilliseconds, ScriptedExtent(frame - 1), swapChainRecreateCount - lastRecreateCount });
+		}
+		lastRecreateCount = swapChainRecreateCount;
+
+		if (frame == RESIZE_FRAMES)
+		{
+			bRunning = false;
+			Summarize();
+			return baseExtent;
+		}
+		return ScriptedExtent(frame++);
+	}
+
+	VkExtent2D LitResizeTest::ScriptedExtent(uint32_t scriptFrame) const
+	{
+		auto fraction = [scriptFrame](float periodFrames)
+		{
+			const float wave = 0.5f - 0.5f * std::cos(2.0f * PI * static_cast<float>(scriptFrame) / periodFrames);
+			return MAX_SIZE_FRACTION - (MAX_SIZE_FRACTION - MIN_SIZE_FRACTION) * wave;
+		};
+		return VkExtent2D{
+			std::max(static_cast<uint32_t>(baseExtent.width * fraction(WIDTH_PERIOD_FRAMES)), 1u),
+			std::max(static_cast<uint32_t>(baseExtent.height * fraction(HEIGHT_PERIOD_FRAMES)), 1u) };
+	}
+
+	void LitResizeTest::Summarize()
+	{
+		summary = Summary{};
+		summary.frameCount = static_cast<uint32_t>(samples.size());
+		if (samples.empty())
+		{
+			return;
+		}
+
+		std::vector<float> frameTimes;
+		frameTimes.reserve(samples.size());
+		for (const auto& sample : samples)
+		{
+			frameTimes.push_back(sample.frameMilliseconds);
+			summary.recreateCount += sample.recreateCount;
+		}
+		std::sort(frameTimes.begin(), frameTimes.end());
+		summary.medianMilliseconds = frameTimes[frameTimes.size() / 2];
+		summary.p99Milliseconds = frameTimes[std::min(frameTimes.size() * 99 / 100, frameTimes.size() - 1)];
+		summary.maxMilliseconds = frameTimes.back();
+	}
+
+	bool LitResizeTest::WriteCsv(const std::string& path) const
+	{
+		std::ofstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		file << "frame,milliseconds,width,height,recreations\n";
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			const Sample& sample = samples[i];
+			file << i << ',' << sample.frameMilliseconds << ',' << sample.windowExtent.width << ','
+				<< sample.windowExtent.height << ',' << sample.recreateCount << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// Drags the window through a fixed sequence of sizes, a new one every frame like a resize storm while the
+	// border is dragged, and records the frame times meanwhile. Swap chain recreation that stalls shows up as
+	// frames far above the median
+	class LitResizeTest
+	{
+	public:
+		struct Sample
+		{
+			float frameMilliseconds;
+			VkExtent2D windowExtent;
+			// swap chains recreated during the frame
+			uint32_t recreateCount;
+		};
+
+		struct Summary
+		{
+			uint32_t frameCount = 0;
+			uint32_t recreateCount = 0;
+			float medianMilliseconds = 0.0f;
+			float p99Milliseconds = 0.0f;
+			float maxMilliseconds = 0.0f;
+		};
+
+		// windowExtent is the size it goes back to at the end
+		void Start(VkExtent2D windowExtent, uint32_t swapChainRecreateCount);
+		bool IsRunning() const { return bRunning; }
+
+		// once per frame while running with the time of the last frame, returns the window size for the next one
+		VkExtent2D Step(float frameMilliseconds, uint32_t swapChainRecreateCount);
+
+		const Summary& GetSummary() const { return summary; }
+		// one line per frame: frame, milliseconds, width, height, recreations
+		bool WriteCsv(const std::string& path) const;
+
+	private:
+		VkExtent2D ScriptedExtent(uint32_t frame) const;
+		void Summarize();
+
+		bool bRunning = false;
+		VkExtent2D baseExtent{ 0, 0 };
+		uint32_t frame = 0;
+		uint32_t lastRecreateCount = 0;
+		std::vector<Sample> samples;
+		Summary summary;
+	};
+}
@@ -0,0 +1,91 @@
+#include "LitSamplerCache.h"
+
+// std
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+
+namespace Lit
+{
+	static void HashCombine(size_t& seed, size_t value)
+	{
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	LitSamplerCache::Key::Key(const VkSamplerCreateInfo& createInfo)
+		: flags{ createInfo.flags }, magFilter{ createInfo.magFilter }, minFilter{ createInfo.minFilter },
+		mipmapMode{ createInfo.mipmapMode }, addressModeU{ createInfo.addressModeU }, addressModeV{ createInfo.addressModeV },
+		addressModeW{ createInfo.addressModeW }, mipLodBias{ createInfo.mipLodBias }, anisotropyEnable{ createInfo.anisotropyEnable },
+		maxAnisotropy{ createInfo.anisotropyEnable ? createInfo.maxAnisotropy : 1.0f }, compareEnable{ createInfo.compareEnable },
+		compareOp{ createInfo.compareEnable ? createInfo.compareOp : VK_COMPARE_OP_NEVER }, minLod{ createInfo.minLod },
+		maxLod{ createInfo.maxLod }, borderColor{ createInfo.borderColor }, unnormalizedCoordinates{ createInfo.unnormalizedCoordinates }
+	{
+	}
+
+	bool LitSamplerCache::Key::operator==(const Key& other) const
+	{
+		return flags == other.flags && magFilter == other.magFilter && minFilter == other.minFilter &&
+			mipmapMode == other.mipmapMode && addressModeU == other.addressModeU && addressModeV == other.addressModeV &&
+			addressModeW == other.addressModeW && mipLodBias == other.mipLodBias && anisotropyEnable == other.anisotropyEnable &&
+			maxAnisotropy == other.maxAnisotropy && compareEnable == other.compareEnable && compareOp == other.compareOp &&
+			minLod == other.minLod && maxLod == other.maxLod && borderColor == other.borderColor &&
+			unnormalizedCoordinates == other.unnormalizedCoordinates;
+	}
+
+	size_t LitSamplerCache::KeyHash::operator()(const Key& key) const
+	{
+		size_t seed = 0;
+		for (uint32_t value : { static_cast<uint32_t>(key.flags), static_cast<uint32_t>(key.magFilter),
+			static_cast<uint32_t>(key.minFilter), static_cast<uint32_t>(key.mipmapMode), static_cast<uint32_t>(key.addressModeU),
+			static_cast<uint32_t>(key.addressModeV), static_cast<uint32_t>(key.addressModeW), key.anisotropyEnable,
+			key.compareEnable, static_cast<uint32_t>(key.compareOp), static_cast<uint32_t>(key.borderColor),
+			key.unnormalizedCoordinates })
+		{
+			HashCombine(seed, std::hash<uint32_t>{}(value));
+		}
+		for (float value : { key.mipLodBias, key.maxAnisotropy, key.minLod, key.maxLod })
+		{
+			HashCombine(seed, std::hash<float>{}(value));
+		}
+		return seed;
+	}
+
+	LitSamplerCache::LitSamplerCache(VkDevice inDevice) : device{ inDevice }
+	{
+	}
+
+	LitSamplerCache::~LitSamplerCache()
+	{
+		for (const auto& entry : samplers)
+		{
+			vkDestroySampler(device, entry.second, nullptr);
+		}
+	}
+
+	VkSampler LitSamplerCache::GetSampler(const VkSamplerCreateInfo& createInfo)
+	{
+		assert(createInfo.pNext == nullptr && "Sampler cache doesn't key pNext chains");
+		const Key key{ createInfo };
+
+		std::lock_guard<std::mutex> lock{ mutex };
+		auto it = samplers.find(key);
+		if (it != samplers.end())
+		{
+			return it->second;
+		}
+
+		VkSampler sampler;
+		if (vkCreateSampler(device, &createInfo, nullptr, &sampler) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create sampler!");
+		}
+		samplers.emplace(key, sampler);
+		return sampler;
+	}
+
+	size_t LitSamplerCache::GetSamplerCount()
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		return samplers.size();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace Lit
+{
+	// Samplers are immutable and a device only allows a few thousand of them, so everything that samples with the same
+	// settings shares one. Keyed by the fields of VkSamplerCreateInfo, pNext chains aren't part of the key and must be
+	// null. Owned by LitDevice, the samplers live until the device goes away
+	class LitSamplerCache
+	{
+	public:
+		explicit LitSamplerCache(VkDevice device);
+		~LitSamplerCache();
+
+		LitSamplerCache(const LitSamplerCache&) = delete;
+		LitSamplerCache& operator=(const LitSamplerCache&) = delete;
+
+		// creates the sampler the first time createInfo is asked for, from any thread
+		VkSampler GetSampler(const VkSamplerCreateInfo& createInfo);
+		size_t GetSamplerCount();
+
+	private:
+		struct Key
+		{
+			VkSamplerCreateFlags flags;
+			VkFilter magFilter;
+			VkFilter minFilter;
+			VkSamplerMipmapMode mipmapMode;
+			VkSamplerAddressMode addressModeU;
+			VkSamplerAddressMode addressModeV;
+			VkSamplerAddressMode addressModeW;
+			float mipLodBias;
+			VkBool32 anisotropyEnable;
+			float maxAnisotropy;
+			VkBool32 compareEnable;
+			VkCompareOp compareOp;
+			float minLod;
+			float maxLod;
+			VkBorderColor borderColor;
+			VkBool32 unnormalizedCoordinates;
+
+			explicit Key(const VkSamplerCreateInfo& createInfo);
+			bool operator==(const Key& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		VkDevice device;
+		std::mutex mutex;
+		std::unordered_map<Key, VkSampler, KeyHash> samplers;
+	};
+}
@@ -0,0 +1,182 @@
+#include "LitSceneGenerator.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace Lit
+{
+	// cell size in bounding sphere diameters of the largest model
+	static const float CELL_SPACING = 1.25f;
+	static const float CLOUD_MIN_SCALE = 0.5f;
+	static const float CLOUD_MAX_SCALE = 1.5f;
+	// levels of one tree, the scene is a row of trees once one is full
+	static const uint32_t HIERARCHY_DEPTH = 4;
+	// in cells and in the scale of the parent
+	static const float CHILD_DISTANCE = 1.0f;
+	static const float CHILD_HEIGHT = 0.5f;
+	static const float CHILD_SCALE = 0.5f;
+	static const float PI = 3.14159265f;
+
+	// [0, 1), from the top 24 bits so every value is exact in a float
+	static float NextFloat(std::mt19937& random)
+	{
+		return static_cast<float>(random() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	static float NextFloat(std::mt19937& random, float min, float max)
+	{
+		return min + (max - min) * NextFloat(random);
+	}
+
+	// the rotation about y of TransformComponent
+	static glm::vec3 RotateY(const glm::vec3& v, float angle)
+	{
+		const float c = std::cos(angle);
+		const float s = std::sin(angle);
+		return glm::vec3{ c * v.x + s * v.z, v.y, -s * v.x + c * v.z };
+	}
+
+	// an instance of model whose bounds are centered on position
+	static LitGameObject CreateInstance(const std::shared_ptr<LitModel>& model, const glm::vec3& position,
+		const glm::vec3& rotation, float scale)
+	{
+		auto gameObject = LitGameObject::CreateGameObject();
+		gameObject.model = model;
+		gameObject.transform.rotation = rotation;
+		gameObject.transform.scale = glm::vec3{ scale };
+		const glm::vec3 center = glm::vec3(gameObject.transform.mat4() * glm::vec4(model->GetBounds().Center(), 1.0f));
+		gameObject.transform.translation = position - center;
+		return gameObject;
+	}
+
+	const char* LitSceneGenerator::GetLayoutName(Layout layout)
+	{
+		switch (layout)
+		{
+		case Layout::Grid: return "grid";
+		case Layout::Cloud: return "cloud";
+		case Layout::Hierarchy: return "hierarchy";
+		}
+		return "unknown";
+	}
+
+	bool LitSceneGenerator::ParseLayout(const std::string& name, Layout& layout)
+	{
+		for (Layout candidate : { Layout::Grid, Layout::Cloud, Layout::Hierarchy })
+		{
+			if (name == GetLayoutName(candidate))
+			{
+				layout = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void LitSceneGenerator::Generate(const Settings& settings, const std::vector<std::shared_ptr<LitModel>>& models,
+		const std::vector<std::shared_ptr<LitTexture>>& textures, std::vector<LitGameObject>& gameObjects)
+	{
+		if (models.empty())
+		{
+			throw std::runtime_error("failed to generate scene, no models!");
+		}
+		float cellSize = 0.0f;
+		for (const auto& model : models)
+		{
+			cellSize = std::max(cellSize, model->GetBounds().BoundingSphere().radius * 2.0f * CELL_SPACING);
+		}
+
+		std::mt19937 random{ settings.seed };
+		const uint32_t count = settings.instanceCount;
+		const size_t firstObject = gameObjects.size();
+		gameObjects.reserve(gameObjects.size() + count);
+		switch (settings.layout)
+		{
+		case Layout::Grid:
+		{
+			const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const glm::vec3 position{ (static_cast<float>(i % side) - 0.5f * side) * cellSize, 0.0f,
+					(static_cast<float>(i / side) - 0.5f * side) * cellSize };
+				gameObjects.push_back(CreateInstance(models[i % models.size()], position, glm::vec3{ 0.0f }, 1.0f));
+			}
+			break;
+		}
+		case Layout::Cloud:
+		{
+			const float halfSide = 0.5f * std::cbrt(static_cast<float>(count)) * cellSize;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				// evaluated in a fixed order, the order of function arguments is not
+				const float x = NextFloat(random, -halfSide, halfSide);
+				const float y = NextFloat(random, -halfSide, halfSide);
+				const float z = NextFloat(random, -halfSide, halfSide);
+				const float pitch = NextFloat(random, -PI, PI);
+				const float yaw = NextFloat(random, -PI, PI);
+				const float roll = NextFloat(random, -PI, PI);
+				const float scale = NextFloat(random, CLOUD_MIN_SCALE, CLOUD_MAX_SCALE);
+				gameObjects.push_back(CreateInstance(models[i % models.size()], glm::vec3{ x, y, z },
+					glm::vec3{ pitch, yaw, roll }, scale));
+			}
+			break;
+		}
+		case Layout::Hierarchy:
+		{
+			// children only turn about y so their world transform stays a translation, a yaw and a scale
+			struct Node
+			{
+				glm::vec3 position;
+				float yaw;
+				float scale;
+				uint32_t depth;
+			};
+			const uint32_t branchCount = std::max(settings.branchCount, 1u);
+			// a tree reaches about CHILD_DISTANCE / (1 - CHILD_SCALE) cells from its root
+			const float treeSpacing = 2.0f * cellSize * (1.0f + CHILD_DISTANCE / (1.0f - CHILD_SCALE));
+			std::vector<Node> nodes;
+			uint32_t treeCount = 0;
+			uint32_t generated = 0;
+			while (generated < count)
+			{
+				// breadth first, so a tree that runs out of instances still has all its upper levels
+				nodes.clear();
+				nodes.push_back(Node{ glm::vec3{ treeSpacing * treeCount, 0.0f, 0.0f }, NextFloat(random, -PI, PI), 1.0f, 0 });
+				treeCount++;
+				for (size_t n = 0; n < nodes.size() && generated < count; n++)
+				{
+					const Node node = nodes[n];
+					gameObjects.push_back(CreateInstance(models[generated % models.size()], node.position,
+						glm::vec3{ 0.0f, node.yaw, 0.0f }, node.scale));
+					generated++;
+					if (node.depth + 1 >= HIERARCHY_DEPTH)
+					{
+						continue;
+					}
+					for (uint32_t c = 0; c < branchCount; c++)
+					{
+						const float angle = 2.0f * PI * (static_cast<float>(c) + NextFloat(random, -0.25f, 0.25f)) / branchCount;
+						// y points down
+						const glm::vec3 offset = glm::vec3{ std::cos(angle) * CHILD_DISTANCE, -CHILD_HEIGHT, std::sin(angle) * CHILD_DISTANCE } * cellSize;
+						const float yaw = NextFloat(random, -PI, PI);
+						nodes.push_back(Node{ node.position + RotateY(offset, node.yaw) * node.scale, node.yaw + yaw,
+							node.scale * CHILD_SCALE, node.depth + 1 });
+					}
+				}
+			}
+			break;
+		}
+		}
+
+		if (!textures.empty())
+		{
+			for (size_t i = firstObject; i < gameObjects.size(); i++)
+			{
+				gameObjects[i].texture = textures[(i - firstObject) % textures.size()];
+			}
+		}
+	}
+}
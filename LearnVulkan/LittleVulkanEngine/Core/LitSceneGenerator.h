@@ -0,0 +1,49 @@
+#pragma once
+#include "LitGameObject.h"
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Lit
+{
+	// Builds benchmark scenes from instances of a few models. The same settings give the same scene on every
+	// platform: the random numbers come from std::mt19937, whose output the standard fixes, not from the
+	// distributions, whose results depend on the standard library
+	class LitSceneGenerator
+	{
+	public:
+		enum class Layout
+		{
+			// rows on the XZ plane, one cell per instance
+			Grid,
+			// random positions, rotations and scales in a cube of the density of the grid
+			Cloud,
+			// trees of instances, every one with branchCount smaller children around it
+			Hierarchy,
+		};
+
+		struct Settings
+		{
+			Layout layout = Layout::Grid;
+			uint32_t instanceCount = 1000;
+			// instance i uses model i % models.size()
+			std::vector<std::string> modelFiles{ "../models/smooth_vase.obj", "../models/flat_vase.obj", "../models/cube.obj" };
+			// instance i uses texture i % textures.size(), none when empty. Cooked by LitTextureCooker from the .tga files
+			// next to them
+			std::vector<std::string> textureFiles{ "../textures/checker.ltex", "../textures/stripes.ltex" };
+			uint32_t seed = 1;
+			uint32_t branchCount = 4;
+		};
+
+		static const char* GetLayoutName(Layout layout);
+		// false for an unknown name
+		static bool ParseLayout(const std::string& name, Layout& layout);
+
+		// appends settings.instanceCount objects, models has one model per settings.modelFiles and textures one
+		// texture per settings.textureFiles
+		static void Generate(const Settings& settings, const std::vector<std::shared_ptr<LitModel>>& models,
+			const std::vector<std::shared_ptr<LitTexture>>& textures, std::vector<LitGameObject>& gameObjects);
+	};
+}
@@ -1,4 +1,5 @@
 #include "LitSwapChain.h"
+#include "LitCpuProfiler.h"
 #include <iostream>
 #include <array>
 namespace Lit
@@ -27,20 +28,13 @@ namespace Lit
 		{
 			vkDestroySemaphore(device.GetDevice(), renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(device.GetDevice(), imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(device.GetDevice(), inFlightFences[i], nullptr);
 		}
 	}
 
 	void LitSwapChain::CreateSwapChain()
 	{
-		// TODO That's all it takes to recreate the swap chain! However, the
-		// disadvantage of this approach is that we need to stop all rendering
-		// before creating the new swap chain. It is possible to create a new swap
-		// chain while drawing commands on an image from the old swap chain are
-		// still in-flight. You need to pass the previous swap chain to the
-		// oldSwapChain field in the VkSwapchainCreateInfoKHR struct and destroy the
-		// old swap chain as soon as you've finished using it. Also might be the
-		// reason frame drops on resizing or moving the window
+		// the previous swap chain is passed as oldSwapchain, rendering to its images may still be in flight.
+		// LitRenderer destroys it through the deletion queue once those frames are done
 		SwapChainSupportDetails swapChainSupport = device.GetSwapChainSupportDetail();
 		VkSurfaceFormatKHR surfaceFormat = ChooseSwapChainSurfaceFormat(swapChainSupport.formats);
 		VkPresentModeKHR presentMode = ChooseSwapChainPresentMode(swapChainSupport.presentModes);
@@ -107,11 +101,13 @@ namespace Lit
 
 	VkResult LitSwapChain::AcquireNextImage(uint32_t* imageIndex)
 	{
-		vkWaitForFences(device.GetDevice(),
-			1,
-			&inFlightFences[currentFrame],
-			VK_TRUE,
-			std::numeric_limits<uint64_t>::max());
+		// the last submission of this frame slot has to be done before its semaphores and command buffer are reused
+		{
+			LIT_CPU_ZONE("wait for frame slot");
+			device.GetTimeline().Wait(frameTimelineValues[currentFrame]);
+		}
+
+		LIT_CPU_ZONE("acquire image");
 
 		VkResult result = vkAcquireNextImageKHR(device.GetDevice(),
 			swapChain,
@@ -124,11 +120,8 @@ namespace Lit
 
 	VkResult LitSwapChain::SumitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex)
 	{
-		if (imagesInFight[*imageIndex] != VK_NULL_HANDLE)
-		{
-			vkWaitForFences(device.GetDevice(), 1, &imagesInFight[*imageIndex], VK_TRUE, UINT64_MAX);
-		}
-		imagesInFight[*imageIndex] = inFlightFences[currentFrame];
+		LIT_CPU_ZONE("submit and present");
+		device.GetTimeline().Wait(imageTimelineValues[*imageIndex]);
 
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -149,11 +142,9 @@ namespace Lit
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(device.GetDevice(), 1, &inFlightFences[currentFrame]);
-		if (vkQueueSubmit(device.GetGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to submit draw command buffer!");
-		}
+		lastSubmittedTimelineValue = device.GetTimeline().Submit(device.GetGraphicsQueue(), submitInfo);
+		frameTimelineValues[currentFrame] = lastSubmittedTimelineValue;
+		imageTimelineValues[*imageIndex] = lastSubmittedTimelineValue;
 
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -206,7 +197,7 @@ namespace Lit
 		{
 			vkDestroyImageView(device.GetDevice(), depthImageViews[i], nullptr);
 			vkDestroyImage(device.GetDevice(), depthImages[i], nullptr);
-			vkFreeMemory(device.GetDevice(), depthImageMemorys[i], nullptr);
+			device.FreeMemory(depthImageMemorys[i]);
 		}
 
 		for (auto framebuffer : swapChainFrameBuffers)
@@ -214,6 +205,7 @@ namespace Lit
 			vkDestroyFramebuffer(device.GetDevice(), framebuffer, nullptr);
 		}
 		vkDestroyRenderPass(device.GetDevice(), renderPass, nullptr);
+		vkDestroyRenderPass(device.GetDevice(), resumeRenderPass, nullptr);
 	}
 
 	void LitSwapChain::CreateDepthResources()
@@ -234,8 +226,9 @@ namespace Lit
 				1, // miplevels
 				depthFormat,
 				VK_IMAGE_TILING_OPTIMAL,
-				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				MemoryCategory::Depth,
 				depthImages[i],
 				depthImageMemorys[i],
 				0, // VkImageCreateFlags
@@ -248,29 +241,40 @@ namespace Lit
 				VK_IMAGE_ASPECT_DEPTH_BIT,
 				1,  // mip levels
 				VK_IMAGE_VIEW_TYPE_2D);
-
-			device.TransitionImageLayout(
-				depthImages[i],
-				depthFormat,
-				VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-				1,  // mip levels
-				1   // array layers
-			);
+			// no layout transition, the clearing render pass starts every frame from VK_IMAGE_LAYOUT_UNDEFINED
 		}
 	}
 
 	
 	void LitSwapChain::CreateRenderPass()
 	{
+		// the render passes only depend on the formats, taking them over keeps pipelines built against them valid
+		if (oldSwapChain != nullptr && oldSwapChain->swapChainImageFormat == swapChainImageFormat &&
+			oldSwapChain->FindDepthFormat() == FindDepthFormat())
+		{
+			renderPass = oldSwapChain->renderPass;
+			resumeRenderPass = oldSwapChain->resumeRenderPass;
+			oldSwapChain->renderPass = VK_NULL_HANDLE;
+			oldSwapChain->resumeRenderPass = VK_NULL_HANDLE;
+			return;
+		}
+		renderPass = CreateRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR);
+		resumeRenderPass = CreateRenderPass(VK_ATTACHMENT_LOAD_OP_LOAD);
+	}
+
+	VkRenderPass LitSwapChain::CreateRenderPass(VkAttachmentLoadOp loadOp)
+	{
+		// a resumed pass keeps what the first one stored, the layouts are where the first pass left them
+		const bool bLoad = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+
 		VkAttachmentDescription depthAttachment = {};
 		depthAttachment.format = FindDepthFormat();
 		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.loadOp = loadOp;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.initialLayout = bLoad ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 	
 
@@ -281,9 +285,9 @@ namespace Lit
 		VkAttachmentDescription colorAttachment = {};
 		colorAttachment.format = GetSwapChainImageFormat();
 		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.loadOp = loadOp;
 		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.initialLayout = bLoad ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_UNDEFINED;
 		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 		VkAttachmentReference colorAttachmentRef = {};
@@ -321,10 +325,12 @@ namespace Lit
 		renderPassInfo.pSubpasses = &subpass;
 		renderPassInfo.dependencyCount = 1;
 		renderPassInfo.pDependencies = &dependency;
-		if (vkCreateRenderPass(device.GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) 
+		VkRenderPass newRenderPass;
+		if (vkCreateRenderPass(device.GetDevice(), &renderPassInfo, nullptr, &newRenderPass) != VK_SUCCESS) 
 		{
 			throw std::runtime_error("failed to create render pass!");
 		}
+		return newRenderPass;
 	}
 
 	void LitSwapChain::CreateFrameBuffers()
@@ -360,21 +366,23 @@ namespace Lit
 	{
 		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
 		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-		imagesInFight.resize(ImageCount(), VK_NULL_HANDLE);
+		frameTimelineValues.resize(MAX_FRAMES_IN_FLIGHT, 0);
+		imageTimelineValues.resize(ImageCount(), 0);
+		if (oldSwapChain != nullptr)
+		{
+			// the device isn't idle, the frame slots go on where the old swap chain left them so their
+			// command buffers are still waited for. The new images were never used
+			frameTimelineValues = oldSwapChain->frameTimelineValues;
+			currentFrame = oldSwapChain->currentFrame;
+		}
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
 		{
 			if (vkCreateSemaphore(device.GetDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(device.GetDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(device.GetDevice(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) 
+				vkCreateSemaphore(device.GetDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) 
 			{
 				throw std::runtime_error("failed to create synchronization objects for a frame!");
 			}
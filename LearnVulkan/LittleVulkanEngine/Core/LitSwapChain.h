@@ -21,6 +21,8 @@ namespace Lit
 		{
 			Init();
 		}
+		// retires previousSwapChain and takes over its render passes when the formats match. The previous one
+		// has to stay alive until the frames that used its images are done
 		LitSwapChain(LitDevice& deviceRef, VkExtent2D windowExtent, std::shared_ptr<LitSwapChain> previousSwapChain);
 
 		LitSwapChain(const LitSwapChain&) = delete;
@@ -34,14 +36,24 @@ namespace Lit
 
 		size_t ImageCount() { return swapChainImages.size(); }
 		VkFormat GetSwapChainImageFormat() { return swapChainImageFormat; }
+		VkFormat GetSwapChainDepthFormat() { return swapChainDepthFormat; }
 		VkExtent2D GetSwapChainExtent() { return swapChainExtent; }
 		float AspectRatio() { return swapChainExtent.width / (float)swapChainExtent.height; }
 		VkFormat FindDepthFormat();
 		VkRenderPass GetRenderPass() { return renderPass; }
+		// compatible with GetRenderPass but loads color and depth, to continue rendering after work outside the pass
+		VkRenderPass GetResumeRenderPass() { return resumeRenderPass; }
 		VkFramebuffer GetFrameBuffer(int index) { return swapChainFrameBuffers[index]; }
+		VkImage GetImage(int index) { return swapChainImages[index]; }
+		VkImageView GetImageView(int index) { return swapChainImageViews[index]; }
+		// depth is stored and can be sampled once it left the render pass, e.g. to build a depth pyramid
+		VkImage GetDepthImage(int index) { return depthImages[index]; }
+		VkImageView GetDepthImageView(int index) { return depthImageViews[index]; }
 
 		VkResult AcquireNextImage(uint32_t* imageIndex);
 		VkResult SumitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+		// the device timeline value the last SumitCommandBuffers signals
+		uint64_t GetLastSubmittedTimelineValue() const { return lastSubmittedTimelineValue; }
 
 		bool CompareSwapFormats(const LitSwapChain& swapChain) const
 		{
@@ -58,6 +70,7 @@ namespace Lit
 		void CreateImageViews();
 		void CreateDepthResources();
 		void CreateRenderPass();
+		VkRenderPass CreateRenderPass(VkAttachmentLoadOp loadOp);
 		void CreateFrameBuffers();
 		void CreateSyncObjects();
 
@@ -71,6 +84,7 @@ namespace Lit
 		VkExtent2D windowExtent;
 
 		VkRenderPass renderPass;
+		VkRenderPass resumeRenderPass;
 
 		std::vector<VkImage> depthImages;
 		std::vector<VkDeviceMemory> depthImageMemorys;
@@ -89,8 +103,10 @@ namespace Lit
 
 		std::vector<VkSemaphore> imageAvailableSemaphores;
 		std::vector<VkSemaphore> renderFinishedSemaphores;
-		std::vector<VkFence> inFlightFences;
-		std::vector<VkFence> imagesInFight;
+		// device timeline values of the last submission per frame slot and per swap chain image, 0 when there was none
+		std::vector<uint64_t> frameTimelineValues;
+		std::vector<uint64_t> imageTimelineValues;
+		uint64_t lastSubmittedTimelineValue = 0;
 		size_t currentFrame = 0;
 	};
 
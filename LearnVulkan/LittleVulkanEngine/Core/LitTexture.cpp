@@ -0,0 +1,45 @@
+#include "LitTexture.h"
+#include "LitDescriptors.h"
+
+namespace Lit
+{
+	LitTexture::LitTexture(LitDevice& inDevice, const std::string& inPath, VkFormat inFormat)
+		: device{ inDevice }, path{ inPath }, format{ inFormat }
+	{
+	}
+
+	LitTexture::~LitTexture()
+	{
+		ReleaseImage();
+	}
+
+	void LitTexture::ReleaseImage()
+	{
+		if (image == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		LitDevice* litDevice = &device;
+		LitDescriptorPool* pool = descriptorPool;
+		VkDescriptorSet oldDescriptorSet = descriptorSet;
+		VkImageView oldImageView = imageView;
+		VkImage oldImage = image;
+		VkDeviceMemory oldMemory = imageMemory;
+		device.GetDeletionQueue().Push([litDevice, pool, oldDescriptorSet, oldImageView, oldImage, oldMemory]()
+			{
+				if (oldDescriptorSet != VK_NULL_HANDLE)
+				{
+					std::vector<VkDescriptorSet> sets{ oldDescriptorSet };
+					pool->FreeDescriptors(sets);
+				}
+				vkDestroyImageView(litDevice->GetDevice(), oldImageView, nullptr);
+				vkDestroyImage(litDevice->GetDevice(), oldImage, nullptr);
+				litDevice->FreeMemory(oldMemory);
+			});
+		descriptorSet = VK_NULL_HANDLE;
+		imageView = VK_NULL_HANDLE;
+		image = VK_NULL_HANDLE;
+		imageMemory = VK_NULL_HANDLE;
+		size = 0;
+	}
+}
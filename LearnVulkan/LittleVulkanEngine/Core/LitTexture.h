@@ -0,0 +1,84 @@
+#pragma once
+#include "LitDevice.h"
+#include "LitImage.h"
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Lit
+{
+	class LitDescriptorPool;
+
+	// A sampled 2D image with a full mip chain and the descriptor set that binds it. Created by LitTextureManager, which
+	// reads the file on a worker thread and uploads it together with the other textures that finished loading. Until
+	// then, or when the file can't be read, the manager hands out its default texture in its place. The whole chain
+	// stays in system memory, the GPU image only holds the levels from GetFirstResidentMip down, as many as the
+	// manager streamed in for how large the texture was drawn lately
+	class LitTexture
+	{
+	public:
+		enum class State
+		{
+			Loading,
+			Resident,
+			Failed,
+		};
+
+		LitTexture(LitDevice& device, const std::string& path, VkFormat format);
+		// the GPU objects go through the deletion queue, frames in flight may still sample them
+		~LitTexture();
+
+		LitTexture(const LitTexture&) = delete;
+		LitTexture& operator=(const LitTexture&) = delete;
+
+		const std::string& GetPath() const { return path; }
+		// RGBA8 sRGB or UNORM as it was loaded, once resident the format of the image, which a cooked file decides
+		VkFormat GetFormat() const { return format; }
+		State GetState() const { return state.load(); }
+		bool IsResident() const { return state.load() == State::Resident; }
+
+		// valid once resident, of the full chain
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		uint32_t GetMipLevels() const { return mipLevels; }
+		// the finest level on the GPU, level 0 of the image is this level of the chain
+		uint32_t GetFirstResidentMip() const { return firstResidentMip; }
+		VkImage GetImage() const { return image; }
+		VkImageView GetImageView() const { return imageView; }
+		VkSampler GetSampler() const { return sampler; }
+		VkDescriptorSet GetDescriptorSet() const { return descriptorSet; }
+		// of the image memory
+		VkDeviceSize GetSize() const { return size; }
+
+	private:
+		friend class LitTextureManager;
+
+		// hands the GPU objects to the deletion queue and forgets them
+		void ReleaseImage();
+
+		LitDevice& device;
+		std::string path;
+		VkFormat format;
+		std::atomic<State> state{ State::Loading };
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		uint32_t firstResidentMip = 0;
+		// every level, the source of the streamed ones
+		LitImageData source;
+		// frame each level was last requested in, by level
+		std::vector<uint64_t> mipRequestFrames;
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+		VkImageView imageView = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		// owned by the sampler cache of the device
+		VkSampler sampler = VK_NULL_HANDLE;
+		// allocated from the pool of the manager, which outlives its textures
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		LitDescriptorPool* descriptorPool = nullptr;
+	};
+}
@@ -0,0 +1,594 @@
+#include "LitTextureManager.h"
+#include "LitBlockCompression.h"
+#include "LitBuffer.h"
+#include "LitCpuProfiler.h"
+#include "LitSwapChain.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace Lit
+{
+	// a texture restreamed every frame holds its current descriptor set and one per frame in flight that retires
+	static const uint32_t MAX_TEXTURES = 1024;
+	static const uint32_t MAX_DESCRIPTOR_SETS = MAX_TEXTURES * (LitSwapChain::MAX_FRAMES_IN_FLIGHT + 1);
+	static const uint32_t MAX_WORKERS = 4;
+	// staging bytes of one upload batch, the rest waits for the next Update. A larger texture goes up alone
+	static const VkDeviceSize MAX_BATCH_BYTES = 64ull * 1024 * 1024;
+	// bufferOffset of a copy must be a multiple of the texel size, 16 covers every format
+	static const VkDeviceSize STAGING_ALIGNMENT = 16;
+	static const float MAX_ANISOTROPY = 16.0f;
+	// texels of the largest level that stays resident when nothing requests finer ones
+	static const uint32_t STREAMING_TAIL_SIZE = 64;
+	// frames a level stays resident after its last request, so objects at the edge of the frustum don't churn
+	static const uint64_t COLD_FRAMES = 120;
+	// staging bytes of the levels streamed in per frame, the next frames get the rest
+	static const VkDeviceSize MAX_STREAM_BYTES = 16ull * 1024 * 1024;
+
+	LitTextureManager::LitTextureManager(LitDevice& inDevice, uint32_t workerCount) : device{ inDevice }
+	{
+		setLayout = LitDescriptorSetLayout::Builder(device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.Build();
+		descriptorPool = LitDescriptorPool::Builder(device)
+			.SetMaxSets(MAX_DESCRIPTOR_SETS)
+			.SetPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_DESCRIPTOR_SETS)
+			.Build();
+
+		// trilinear and anisotropic over the whole mip chain, every texture shares it
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.anisotropyEnable = VK_TRUE;
+		samplerInfo.maxAnisotropy = std::min(MAX_ANISOTROPY, device.GetPhysicalDeviceProperties().limits.maxSamplerAnisotropy);
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+		sampler = device.GetSamplerCache().GetSampler(samplerInfo);
+
+		// the BC formats the device samples with linear filtering, cooked textures in the others are decoded on the CPU
+		if (device.SupportsTextureCompressionBC())
+		{
+			const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+			for (VkFormat format : { VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK, VK_FORMAT_BC3_UNORM_BLOCK,
+				VK_FORMAT_BC3_SRGB_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK })
+			{
+				VkFormatProperties properties;
+				vkGetPhysicalDeviceFormatProperties(device.GetPhysicalDevice(), format, &properties);
+				if ((properties.optimalTilingFeatures & requiredFeatures) == requiredFeatures)
+				{
+					sampledFormats.push_back(format);
+				}
+			}
+		}
+
+		// uploaded right away, every draw needs something to bind
+		defaultTexture = std::make_shared<LitTexture>(device, "default", VK_FORMAT_R8G8B8A8_UNORM);
+		defaultTexture->source = LitImage::CreateRgba8(1, 1, false, { 255, 255, 255, 255 });
+		defaultTexture->width = 1;
+		defaultTexture->height = 1;
+		defaultTexture->mipLevels = 1;
+		Upload({ UploadRequest{ defaultTexture.get(), 0 } });
+
+		evictionHandlerId = device.GetMemoryBudget().AddEvictionHandler(MemoryCategory::Texture,
+			[this](VkDeviceSize bytesToFree) { return EvictUnused(bytesToFree); });
+
+		if (workerCount == 0)
+		{
+			workerCount = std::min(std::max(std::thread::hardware_concurrency(), 2u) - 1, MAX_WORKERS);
+		}
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			workers.emplace_back([this]() { WorkerMain(); });
+		}
+	}
+
+	LitTextureManager::~LitTextureManager()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			bStopping = true;
+		}
+		workAvailable.notify_all();
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+		device.GetMemoryBudget().RemoveEvictionHandler(evictionHandlerId);
+
+		decodeQueue.clear();
+		decodedImages.clear();
+		textures.clear();
+		defaultTexture.reset();
+		// the textures free their descriptor sets from descriptorPool once the GPU is done with them
+		device.GetDeletionQueue().Flush();
+	}
+
+	std::shared_ptr<LitTexture> LitTextureManager::Load(const std::string& path, bool bSrgb)
+	{
+		const VkFormat format = bSrgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		const auto key = std::make_pair(path, format);
+		auto it = textures.find(key);
+		if (it != textures.end())
+		{
+			return it->second;
+		}
+		// the descriptor pool is sized for MAX_TEXTURES
+		if (textures.size() >= MAX_TEXTURES)
+		{
+			std::cerr << path << ": more than " << MAX_TEXTURES << " textures, not loaded" << std::endl;
+			return nullptr;
+		}
+
+		auto texture = std::make_shared<LitTexture>(device, path, format);
+		textures.emplace(key, texture);
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			decodeQueue.push_back(texture);
+			decodingCount++;
+		}
+		workAvailable.notify_one();
+		return texture;
+	}
+
+	void LitTextureManager::WorkerMain()
+	{
+		LitCpuProfiler::SetThreadName("texture worker");
+		while (true)
+		{
+			DecodedImage decoded;
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				workAvailable.wait(lock, [this]() { return bStopping || !decodeQueue.empty(); });
+				if (bStopping)
+				{
+					return;
+				}
+				decoded.texture = std::move(decodeQueue.front());
+				decodeQueue.pop_front();
+			}
+
+			{
+				LIT_CPU_ZONE("decode texture");
+				decoded.bSucceeded = LitImage::Load(decoded.texture->GetPath(), LitImage::IsSrgb(decoded.texture->GetFormat()),
+					decoded.image, decoded.error);
+				// cooked for a format the device can't sample, the same levels in RGBA8 then
+				if (decoded.bSucceeded && !CanSample(decoded.image.format))
+				{
+					LitImageData compressed = std::move(decoded.image);
+					decoded.bSucceeded = LitBlockCompression::Decompress(compressed, decoded.image, decoded.error);
+					decoded.bCpuDecoded = true;
+				}
+				// streaming needs every level in system memory, so plain images get their chain here
+				if (decoded.bSucceeded && decoded.image.levels.size() == 1 && !LitImage::IsBlockCompressed(decoded.image.format))
+				{
+					LitImage::GenerateMips(decoded.image);
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				decodedImages.push_back(std::move(decoded));
+				decodingCount--;
+			}
+			decodeFinished.notify_all();
+		}
+	}
+
+	void LitTextureManager::Update()
+	{
+		LIT_CPU_ZONE("update textures");
+		frame++;
+		LitTimeline& timeline = device.GetTimeline();
+		while (!uploadTimelineValues.empty() && timeline.IsComplete(uploadTimelineValues.front()))
+		{
+			uploadTimelineValues.pop_front();
+		}
+
+		std::vector<DecodedImage> batch;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			VkDeviceSize batchBytes = 0;
+			while (!decodedImages.empty())
+			{
+				const VkDeviceSize imageBytes = decodedImages.front().image.data.size();
+				if (!batch.empty() && batchBytes + imageBytes > MAX_BATCH_BYTES)
+				{
+					break;
+				}
+				batchBytes += imageBytes;
+				batch.push_back(std::move(decodedImages.front()));
+				decodedImages.pop_front();
+			}
+		}
+
+		// streamed before the new textures are added, they start at their tail anyway
+		std::vector<UploadRequest> uploads;
+		StreamMips(uploads);
+		for (auto& decoded : batch)
+		{
+			LitTexture& texture = *decoded.texture;
+			if (!decoded.bSucceeded)
+			{
+				std::cerr << texture.GetPath() << ": " << decoded.error << std::endl;
+				texture.state = LitTexture::State::Failed;
+				continue;
+			}
+			texture.source = std::move(decoded.image);
+			texture.format = texture.source.format;
+			texture.width = texture.source.width;
+			texture.height = texture.source.height;
+			texture.mipLevels = static_cast<uint32_t>(texture.source.levels.size());
+			texture.mipRequestFrames.assign(texture.mipLevels, 0);
+			cpuDecodedCount += decoded.bCpuDecoded ? 1 : 0;
+			uploads.push_back(UploadRequest{ &texture, GetTailMip(texture) });
+		}
+		if (!uploads.empty())
+		{
+			Upload(uploads);
+		}
+	}
+
+	uint32_t LitTextureManager::GetTailMip(const LitTexture& texture) const
+	{
+		if (!bStreaming)
+		{
+			return 0;
+		}
+		uint32_t level = 0;
+		while (level + 1 < texture.mipLevels &&
+			std::max(texture.source.levels[level].width, texture.source.levels[level].height) > STREAMING_TAIL_SIZE)
+		{
+			level++;
+		}
+		return level;
+	}
+
+	uint32_t LitTextureManager::GetWantedMip(const LitTexture& texture) const
+	{
+		const uint32_t tailMip = GetTailMip(texture);
+		for (uint32_t level = 0; level < tailMip; level++)
+		{
+			const uint64_t requestFrame = texture.mipRequestFrames[level];
+			if (requestFrame != 0 && frame - requestFrame <= COLD_FRAMES)
+			{
+				return level;
+			}
+		}
+		return tailMip;
+	}
+
+	uint64_t LitTextureManager::GetLastRequestFrame(const LitTexture& texture) const
+	{
+		uint64_t lastFrame = 0;
+		for (uint64_t requestFrame : texture.mipRequestFrames)
+		{
+			lastFrame = std::max(lastFrame, requestFrame);
+		}
+		return lastFrame;
+	}
+
+	void LitTextureManager::StreamMips(std::vector<UploadRequest>& uploads)
+	{
+		std::vector<UploadRequest> streamIns;
+		for (const auto& entry : textures)
+		{
+			LitTexture& texture = *entry.second;
+			if (!texture.IsResident())
+			{
+				// decoded, but the descriptor pool had no set left for its first upload
+				if (texture.GetState() == LitTexture::State::Loading && !texture.source.levels.empty())
+				{
+					uploads.push_back(UploadRequest{ &texture, GetTailMip(texture) });
+				}
+				continue;
+			}
+			const uint32_t wantedMip = GetWantedMip(texture);
+			if (wantedMip > texture.firstResidentMip)
+			{
+				// shrinking needs no budget, the smaller image replaces the larger one
+				uploads.push_back(UploadRequest{ &texture, wantedMip });
+				streamedOutCount++;
+			}
+			else if (wantedMip < texture.firstResidentMip)
+			{
+				streamIns.push_back(UploadRequest{ &texture, wantedMip });
+			}
+		}
+		if (streamIns.empty())
+		{
+			return;
+		}
+
+		// the textures missing the most levels first, they look the worst
+		std::sort(streamIns.begin(), streamIns.end(), [](const UploadRequest& a, const UploadRequest& b)
+			{
+				return a.texture->firstResidentMip - a.firstMip > b.texture->firstResidentMip - b.firstMip;
+			});
+		const LitMemoryBudget::CategoryStatistics category = device.GetMemoryBudget().GetCategoryStatistics(MemoryCategory::Texture);
+		VkDeviceSize streamBytes = 0;
+		for (const auto& request : streamIns)
+		{
+			const LitImageData& source = request.texture->source;
+			const VkDeviceSize requestBytes = source.data.size() - source.levels[request.firstMip].offset;
+			if (streamBytes > 0 && streamBytes + requestBytes > MAX_STREAM_BYTES)
+			{
+				break;
+			}
+			// the old image only goes away a few frames later, count the whole new one against the budget
+			if (category.softBudget != 0 && category.allocatedBytes + streamBytes + requestBytes > category.softBudget)
+			{
+				continue;
+			}
+			uploads.push_back(request);
+			streamBytes += requestBytes;
+			streamedInCount++;
+		}
+	}
+
+	void LitTextureManager::Upload(const std::vector<UploadRequest>& requests)
+	{
+		LIT_CPU_ZONE("upload textures");
+		// the sets of restreamed textures retire with the frames in flight. Should they use up the pool, a texture
+		// keeps its current image and the next Update asks again
+		std::vector<UploadRequest> uploads;
+		std::vector<VkDescriptorSet> descriptorSets;
+		for (const auto& request : requests)
+		{
+			VkDescriptorSet descriptorSet;
+			if (descriptorPool->AllocateDescriptor(setLayout->GetDescriptorSetLayout(), descriptorSet))
+			{
+				uploads.push_back(request);
+				descriptorSets.push_back(descriptorSet);
+			}
+		}
+		if (uploads.empty())
+		{
+			return;
+		}
+
+		// each level at an aligned offset of its own, whichever level the uploaded range starts at
+		std::vector<std::vector<VkDeviceSize>> levelOffsets(uploads.size());
+		VkDeviceSize stagingSize = 0;
+		for (size_t i = 0; i < uploads.size(); i++)
+		{
+			const LitImageData& source = uploads[i].texture->source;
+			for (size_t level = uploads[i].firstMip; level < source.levels.size(); level++)
+			{
+				levelOffsets[i].push_back(stagingSize);
+				stagingSize += (source.levels[level].size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+			}
+		}
+		// freed through the deletion queue when it goes out of scope, after the GPU read it
+		LitBuffer stagingBuffer{ device, stagingSize, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryCategory::Staging };
+		stagingBuffer.Map();
+
+		VkCommandBuffer commandBuffer = device.BeginSingleTimeCommands();
+		for (size_t i = 0; i < uploads.size(); i++)
+		{
+			LitTexture& texture = *uploads[i].texture;
+			const LitImageData& source = texture.source;
+			const uint32_t firstMip = uploads[i].firstMip;
+			const uint32_t levelCount = texture.mipLevels - firstMip;
+			for (uint32_t level = 0; level < levelCount; level++)
+			{
+				stagingBuffer.WriteToBuffer(const_cast<uint8_t*>(source.GetLevelData(firstMip + level)),
+					source.levels[firstMip + level].size, levelOffsets[i][level]);
+			}
+
+			// frames in flight keep sampling the old image until they retire
+			texture.ReleaseImage();
+			texture.firstResidentMip = firstMip;
+			device.CreateImage(source.levels[firstMip].width, source.levels[firstMip].height, levelCount, texture.format,
+				VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryCategory::Texture, texture.image, texture.imageMemory, 0, 1);
+			VkMemoryRequirements memoryRequirements;
+			vkGetImageMemoryRequirements(device.GetDevice(), texture.image, &memoryRequirements);
+			texture.size = memoryRequirements.size;
+
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = texture.image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+				0, nullptr, 0, nullptr, 1, &barrier);
+
+			std::vector<VkBufferImageCopy> regions;
+			for (uint32_t level = 0; level < levelCount; level++)
+			{
+				VkBufferImageCopy region{};
+				region.bufferOffset = levelOffsets[i][level];
+				region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+				region.imageExtent = { source.levels[firstMip + level].width, source.levels[firstMip + level].height, 1 };
+				regions.push_back(region);
+			}
+			vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.GetBuffer(), texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				static_cast<uint32_t>(regions.size()), regions.data());
+
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+				0, nullptr, 0, nullptr, 1, &barrier);
+
+			texture.imageView = device.CreateImageView(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT,
+				levelCount, VK_IMAGE_VIEW_TYPE_2D);
+			texture.sampler = sampler;
+			VkDescriptorImageInfo imageInfo{ texture.sampler, texture.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			texture.descriptorSet = descriptorSets[i];
+			LitDescriptorWriter(*setLayout, *descriptorPool).WriteImage(0, &imageInfo).OverWrite(texture.descriptorSet);
+			texture.descriptorPool = descriptorPool.get();
+		}
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		uploadTimelineValues.push_back(device.GetTimeline().Submit(device.GetGraphicsQueue(), submitInfo));
+
+		LitDevice* litDevice = &device;
+		device.GetDeletionQueue().Push([litDevice, commandBuffer]()
+			{
+				vkFreeCommandBuffers(litDevice->GetDevice(), litDevice->GetCommandPool(), 1, &commandBuffer);
+			});
+
+		for (const auto& request : uploads)
+		{
+			request.texture->state = LitTexture::State::Resident;
+		}
+		lastBatchTextureCount = static_cast<uint32_t>(uploads.size());
+		lastBatchBytes = stagingSize;
+	}
+
+	void LitTextureManager::WaitIdle()
+	{
+		LIT_CPU_ZONE("wait for textures");
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				decodeFinished.wait(lock, [this]() { return decodingCount == 0 || !decodedImages.empty(); });
+				if (decodingCount == 0 && decodedImages.empty())
+				{
+					break;
+				}
+			}
+			Update();
+		}
+		if (!uploadTimelineValues.empty())
+		{
+			device.GetTimeline().Wait(uploadTimelineValues.back());
+			uploadTimelineValues.clear();
+		}
+	}
+
+	bool LitTextureManager::CanSample(VkFormat format) const
+	{
+		return !LitImage::IsBlockCompressed(format) ||
+			std::find(sampledFormats.begin(), sampledFormats.end(), format) != sampledFormats.end();
+	}
+
+	VkDescriptorSet LitTextureManager::GetDescriptorSet(const LitTexture* texture) const
+	{
+		return texture != nullptr && texture->IsResident() ? texture->GetDescriptorSet() : defaultTexture->GetDescriptorSet();
+	}
+
+	void LitTextureManager::RequestMip(LitTexture* texture, float screenPixels)
+	{
+		if (texture == nullptr || !texture->IsResident())
+		{
+			return;
+		}
+		const float texels = static_cast<float>(std::max(texture->width, texture->height));
+		const float level = std::floor(std::log2(texels / std::max(screenPixels, 1.0f)));
+		const uint32_t mip = static_cast<uint32_t>(std::min(std::max(level, 0.0f), static_cast<float>(texture->mipLevels - 1)));
+		texture->mipRequestFrames[mip] = frame;
+	}
+
+	VkDeviceSize LitTextureManager::EvictUnused(VkDeviceSize bytesToFree)
+	{
+		VkDeviceSize freedBytes = 0;
+		for (auto it = textures.begin(); it != textures.end() && freedBytes < bytesToFree;)
+		{
+			// nothing but the cache refers to it, no object draws with it
+			if (it->second.use_count() == 1 && it->second->IsResident())
+			{
+				freedBytes += it->second->GetSize();
+				it = textures.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		if (freedBytes >= bytesToFree || !bStreaming)
+		{
+			return freedBytes;
+		}
+
+		// then the streamed levels of what wasn't drawn in the last frames, longest unseen first
+		std::vector<LitTexture*> candidates;
+		for (const auto& entry : textures)
+		{
+			LitTexture& texture = *entry.second;
+			if (texture.IsResident() && texture.firstResidentMip < GetTailMip(texture) && GetLastRequestFrame(texture) + 1 < frame)
+			{
+				candidates.push_back(&texture);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [this](const LitTexture* a, const LitTexture* b)
+			{
+				return GetLastRequestFrame(*a) < GetLastRequestFrame(*b);
+			});
+		std::vector<UploadRequest> uploads;
+		for (LitTexture* texture : candidates)
+		{
+			if (freedBytes >= bytesToFree)
+			{
+				break;
+			}
+			const uint32_t tailMip = GetTailMip(*texture);
+			const LitImageData& source = texture->source;
+			freedBytes += source.levels[tailMip].offset - source.levels[texture->firstResidentMip].offset;
+			// forgotten, or the next Update would stream them right back in
+			std::fill(texture->mipRequestFrames.begin(), texture->mipRequestFrames.begin() + tailMip, 0);
+			uploads.push_back(UploadRequest{ texture, tailMip });
+			streamedOutCount++;
+		}
+		if (!uploads.empty())
+		{
+			Upload(uploads);
+		}
+		return freedBytes;
+	}
+
+	LitTextureManager::Statistics LitTextureManager::GetStatistics()
+	{
+		Statistics statistics{};
+		for (const auto& entry : textures)
+		{
+			const LitTexture& texture = *entry.second;
+			statistics.textureCount++;
+			switch (texture.GetState())
+			{
+			case LitTexture::State::Loading: statistics.loadingCount++; break;
+			case LitTexture::State::Resident:
+				statistics.residentCount++;
+				statistics.residentBytes += texture.GetSize();
+				statistics.compressedCount += LitImage::IsBlockCompressed(texture.GetFormat()) ? 1 : 0;
+				statistics.systemBytes += texture.source.data.size();
+				statistics.streamedLevelCount += GetTailMip(texture) - std::min(texture.firstResidentMip, GetTailMip(texture));
+				break;
+			case LitTexture::State::Failed: statistics.failedCount++; break;
+			}
+		}
+		LitTimeline& timeline = device.GetTimeline();
+		for (uint64_t value : uploadTimelineValues)
+		{
+			statistics.uploadsInFlight += timeline.IsComplete(value) ? 0 : 1;
+		}
+		statistics.lastBatchTextureCount = lastBatchTextureCount;
+		statistics.lastBatchBytes = lastBatchBytes;
+		statistics.cpuDecodedCount = cpuDecodedCount;
+		statistics.streamedInCount = streamedInCount;
+		statistics.streamedOutCount = streamedOutCount;
+		statistics.samplerCount = device.GetSamplerCache().GetSamplerCount();
+		return statistics;
+	}
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "LitDescriptors.h"
+#include "LitTexture.h"
+
+// std
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Lit
+{
+	// Loads textures without stalling the frame: files are decoded on worker threads, which filter the mips of plain
+	// images, and Update uploads whatever finished decoding through one staging buffer and one submission. Textures
+	// cooked by LitTextureCooker bring their mips and stay block compressed when the device can sample their format,
+	// the workers decode them to RGBA8 when it can't. Textures are shared by path and bound through a descriptor set
+	// of their own, one that isn't resident yet binds a white default instead.
+	// The mips are streamed: a texture starts with the levels of at most STREAMING_TAIL_SIZE texels resident, the
+	// renderer requests the level an object needs for its size on screen, and Update reallocates the image with the
+	// finer levels from the copy in system memory, within a per frame upload limit and the soft budget of the texture
+	// category. Levels nothing requested for a while are dropped again, and when the budget runs over the textures
+	// off screen lose their streamed levels after the unreferenced textures are released. Load, Update and the
+	// statistics are for the thread that renders, and the textures must not outlive the manager
+	class LitTextureManager
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t textureCount = 0;
+			uint32_t residentCount = 0;
+			uint32_t loadingCount = 0;
+			uint32_t failedCount = 0;
+			VkDeviceSize residentBytes = 0;
+			// resident in a BC format, and cooked ones the device couldn't sample
+			uint32_t compressedCount = 0;
+			uint32_t cpuDecodedCount = 0;
+			// every level of the resident textures, kept in system memory. About what residentBytes would be without
+			// streaming
+			size_t systemBytes = 0;
+			// textures with levels streamed in or dropped since the manager was created, and the levels above their
+			// tail that are resident
+			uint32_t streamedInCount = 0;
+			uint32_t streamedOutCount = 0;
+			uint32_t streamedLevelCount = 0;
+			// submitted uploads the GPU hasn't finished
+			uint32_t uploadsInFlight = 0;
+			// textures and staging bytes of the last upload batch
+			uint32_t lastBatchTextureCount = 0;
+			VkDeviceSize lastBatchBytes = 0;
+			size_t samplerCount = 0;
+		};
+
+		// workerCount 0 picks one less than the hardware threads, at most 4
+		explicit LitTextureManager(LitDevice& device, uint32_t workerCount = 0);
+		~LitTextureManager();
+
+		LitTextureManager(const LitTextureManager&) = delete;
+		LitTextureManager& operator=(const LitTextureManager&) = delete;
+
+		// the texture of path, loading starts on first use. Color textures are sampled as sRGB, cooked ones are in
+		// the color space they were cooked for. nullptr once the manager holds as many textures as it has sets for
+		std::shared_ptr<LitTexture> Load(const std::string& path, bool bSrgb = true);
+
+		// once per frame before recording: uploads what finished decoding. The upload ends in a barrier that orders it
+		// before everything submitted to the graphics queue later, so the textures are resident once this returns
+		void Update();
+		// blocks until every texture loaded so far is resident or failed, for benchmarks that must not measure loading
+		void WaitIdle();
+
+		// RGBA8, and the BC formats the device samples with linear filtering
+		bool CanSample(VkFormat format) const;
+
+		// by the renderer for every object it draws with texture this frame, screenPixels across. Assumes the texture
+		// spans the object once, so the level with about a texel per pixel is the one it needs
+		void RequestMip(LitTexture* texture, float screenPixels);
+		// when off every texture keeps its whole chain resident
+		void SetStreamingEnabled(bool bEnabled) { bStreaming = bEnabled; }
+		bool IsStreamingEnabled() const { return bStreaming; }
+
+		VkDescriptorSetLayout GetSetLayout() const { return setLayout->GetDescriptorSetLayout(); }
+		// the set of texture when it is resident, of the default texture otherwise (also for nullptr)
+		VkDescriptorSet GetDescriptorSet(const LitTexture* texture) const;
+
+		// releases resident textures only the manager holds, then the streamed levels of textures nothing drew in the
+		// last frames, until bytesToFree are released. Returns what it released
+		VkDeviceSize EvictUnused(VkDeviceSize bytesToFree);
+
+		Statistics GetStatistics();
+
+	private:
+		struct DecodedImage
+		{
+			std::shared_ptr<LitTexture> texture;
+			LitImageData image;
+			bool bSucceeded = false;
+			bool bCpuDecoded = false;
+			std::string error;
+		};
+
+		// a texture to (re)create with the levels from firstMip down
+		struct UploadRequest
+		{
+			LitTexture* texture;
+			uint32_t firstMip;
+		};
+
+		void WorkerMain();
+		// the coarsest level streaming keeps resident, 0 when streaming is off
+		uint32_t GetTailMip(const LitTexture& texture) const;
+		// the finest level requested within the last frames, the tail if none was
+		uint32_t GetWantedMip(const LitTexture& texture) const;
+		uint64_t GetLastRequestFrame(const LitTexture& texture) const;
+		// queues the textures whose resident levels differ from the wanted ones
+		void StreamMips(std::vector<UploadRequest>& uploads);
+		// one staging buffer, one command buffer and one submission for the batch. Each texture gets a new image, the
+		// old one goes through the deletion queue. Requests the descriptor pool has no set left for are skipped
+		void Upload(const std::vector<UploadRequest>& requests);
+
+		LitDevice& device;
+		std::unique_ptr<LitDescriptorSetLayout> setLayout;
+		std::unique_ptr<LitDescriptorPool> descriptorPool;
+		VkSampler sampler = VK_NULL_HANDLE;
+		std::shared_ptr<LitTexture> defaultTexture;
+		LitMemoryBudget::HandlerId evictionHandlerId;
+		// BC formats the device can sample, read by the workers
+		std::vector<VkFormat> sampledFormats;
+
+		// by path and format
+		std::map<std::pair<std::string, VkFormat>, std::shared_ptr<LitTexture>> textures;
+		// timeline values of the uploads, oldest first
+		std::deque<uint64_t> uploadTimelineValues;
+		uint32_t lastBatchTextureCount = 0;
+		VkDeviceSize lastBatchBytes = 0;
+		uint32_t cpuDecodedCount = 0;
+		bool bStreaming = true;
+		// counts Update calls, the mip requests are stamped with it
+		uint64_t frame = 1;
+		uint32_t streamedInCount = 0;
+		uint32_t streamedOutCount = 0;
+
+		// shared with the workers
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable decodeFinished;
+		std::deque<std::shared_ptr<LitTexture>> decodeQueue;
+		std::deque<DecodedImage> decodedImages;
+		// queued or being decoded
+		uint32_t decodingCount = 0;
+		bool bStopping = false;
+		std::vector<std::thread> workers;
+	};
+}
@@ -0,0 +1,206 @@
+#include "LitTimeline.h"
+
+// std
+#include <limits>
+#include <stdexcept>
+
+namespace Lit
+{
+	LitTimeline::LitTimeline(VkDevice inDevice, bool bUseTimelineSemaphore) : device{ inDevice }, bTimelineSemaphore{ bUseTimelineSemaphore }
+	{
+		if (!bTimelineSemaphore)
+		{
+			return;
+		}
+
+		waitSemaphores = (PFN_vkWaitSemaphores)vkGetDeviceProcAddr(device, "vkWaitSemaphores");
+		getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValue");
+		if (waitSemaphores == nullptr || getSemaphoreCounterValue == nullptr)
+		{
+			throw std::runtime_error("failed to load timeline semaphore functions!");
+		}
+
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+		if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+	}
+
+	LitTimeline::~LitTimeline()
+	{
+		if (semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(device, semaphore, nullptr);
+		}
+		for (auto& pending : pendingFences)
+		{
+			vkDestroyFence(device, pending.second, nullptr);
+		}
+		for (VkFence fence : freeFences)
+		{
+			vkDestroyFence(device, fence, nullptr);
+		}
+	}
+
+	uint64_t LitTimeline::Submit(VkQueue queue, const VkSubmitInfo& submitInfo)
+	{
+		std::lock_guard<std::mutex> lock{ mutex };
+		const uint64_t value = lastSubmittedValue.load() + 1;
+
+		if (bTimelineSemaphore)
+		{
+			// binary semaphores in the batch take a value of 0, which is ignored
+			std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+			std::vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores,
+				submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+			signalSemaphores.push_back(semaphore);
+			std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+			signalValues.back() = value;
+
+			VkTimelineSemaphoreSubmitInfo timelineInfo{};
+			timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.pNext = submitInfo.pNext;
+			timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+			timelineInfo.pWaitSemaphoreValues = waitValues.data();
+			timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+			timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+			VkSubmitInfo timelineSubmitInfo = submitInfo;
+			timelineSubmitInfo.pNext = &timelineInfo;
+			timelineSubmitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+			timelineSubmitInfo.pSignalSemaphores = signalSemaphores.data();
+			if (vkQueueSubmit(queue, 1, &timelineSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to submit command buffer!");
+			}
+		}
+		else
+		{
+			VkFence fence = VK_NULL_HANDLE;
+			if (!freeFences.empty())
+			{
+				fence = freeFences.back();
+				freeFences.pop_back();
+			}
+			else
+			{
+				VkFenceCreateInfo fenceInfo{};
+				fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+				if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to create timeline fence!");
+				}
+			}
+
+			if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS)
+			{
+				freeFences.push_back(fence);
+				throw std::runtime_error("failed to submit command buffer!");
+			}
+			pendingFences.emplace_back(value, fence);
+		}
+
+		lastSubmittedValue.store(value);
+		return value;
+	}
+
+	uint64_t LitTimeline::GetCompletedValue()
+	{
+		if (bTimelineSemaphore)
+		{
+			uint64_t value = 0;
+			getSemaphoreCounterValue(device, semaphore, &value);
+			StoreCompletedValue(value);
+			return value;
+		}
+
+		std::lock_guard<std::mutex> lock{ mutex };
+		RetireFences();
+		return completedValue.load();
+	}
+
+	void LitTimeline::Wait(uint64_t value)
+	{
+		if (value <= completedValue.load())
+		{
+			return;
+		}
+		if (value > lastSubmittedValue.load())
+		{
+			throw std::runtime_error("waiting for a timeline value that was never submitted!");
+		}
+
+		if (bTimelineSemaphore)
+		{
+			VkSemaphoreWaitInfo waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &semaphore;
+			waitInfo.pValues = &value;
+			if (waitSemaphores(device, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to wait for timeline semaphore!");
+			}
+
+			StoreCompletedValue(value);
+			return;
+		}
+
+		// the fence of the submission with this value. The values of the pending fences follow each other, so it
+		// is found by its distance to the oldest one. The mutex stays held, a fence that gets recycled meanwhile
+		// would be reset under the wait
+		std::lock_guard<std::mutex> lock{ mutex };
+		RetireFences();
+		if (pendingFences.empty() || value <= completedValue.load())
+		{
+			return;
+		}
+		VkFence fence = pendingFences[static_cast<size_t>(value - pendingFences.front().first)].second;
+		if (vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to wait for timeline fence!");
+		}
+		RetireFences();
+	}
+
+	void LitTimeline::StoreCompletedValue(uint64_t value)
+	{
+		uint64_t completed = completedValue.load();
+		while (completed < value && !completedValue.compare_exchange_weak(completed, value))
+		{
+		}
+	}
+
+	void LitTimeline::RetireFences()
+	{
+		size_t signaledCount = 0;
+		while (signaledCount < pendingFences.size() &&
+			vkGetFenceStatus(device, pendingFences[signaledCount].second) == VK_SUCCESS)
+		{
+			signaledCount++;
+		}
+		if (signaledCount == 0)
+		{
+			return;
+		}
+
+		completedValue.store(pendingFences[signaledCount - 1].first);
+		std::vector<VkFence> signaledFences;
+		signaledFences.reserve(signaledCount);
+		for (size_t i = 0; i < signaledCount; i++)
+		{
+			signaledFences.push_back(pendingFences[i].second);
+		}
+		vkResetFences(device, static_cast<uint32_t>(signaledFences.size()), signaledFences.data());
+		freeFences.insert(freeFences.end(), signaledFences.begin(), signaledFences.end());
+		pendingFences.erase(pendingFences.begin(), pendingFences.begin() + signaledCount);
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Lit
+{
+	// One counter for all the work the engine submits. Every submission gets the next value and the counter reaches
+	// it once the GPU is done with the submission and everything submitted before it, so the CPU can wait for or
+	// poll a single number instead of keeping fences around. Uses a Vulkan 1.2 timeline semaphore when the device
+	// has one, otherwise a fence per submission that is recycled once it signaled
+	class LitTimeline
+	{
+	public:
+		LitTimeline(VkDevice device, bool bUseTimelineSemaphore);
+		~LitTimeline();
+
+		LitTimeline(const LitTimeline&) = delete;
+		LitTimeline& operator=(const LitTimeline&) = delete;
+
+		// vkQueueSubmit with one batch that also signals the timeline, returns the value it signals. The semaphores
+		// and command buffers of submitInfo are used as they are
+		uint64_t Submit(VkQueue queue, const VkSubmitInfo& submitInfo);
+
+		// the highest value the GPU has reached, doesn't block
+		uint64_t GetCompletedValue();
+		bool IsComplete(uint64_t value) { return value <= completedValue.load() || value <= GetCompletedValue(); }
+		// blocks until the GPU reached value, 0 is always reached
+		void Wait(uint64_t value);
+		void WaitIdle() { Wait(GetLastSubmittedValue()); }
+
+		uint64_t GetLastSubmittedValue() const { return lastSubmittedValue.load(); }
+		bool UsesTimelineSemaphore() const { return bTimelineSemaphore; }
+
+	private:
+		// raises the cached completed value, other threads may have seen a higher one already
+		void StoreCompletedValue(uint64_t value);
+		// recycles the fences that signaled, oldest first. Called with mutex held
+		void RetireFences();
+
+		VkDevice device;
+		bool bTimelineSemaphore;
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		// core in 1.2 but not exported by older loaders, so they are looked up
+		PFN_vkWaitSemaphores waitSemaphores = nullptr;
+		PFN_vkGetSemaphoreCounterValue getSemaphoreCounterValue = nullptr;
+
+		// submissions go to the queue in value order
+		std::mutex mutex;
+		std::atomic<uint64_t> lastSubmittedValue{ 0 };
+		std::atomic<uint64_t> completedValue{ 0 };
+
+		// without timeline semaphores: fences of the submissions the GPU may still run, oldest first
+		std::deque<std::pair<uint64_t, VkFence>> pendingFences;
+		std::vector<VkFence> freeFences;
+	};
+}
@@ -38,6 +38,8 @@ namespace Lit
 		ImGuiIO& io = ImGui::GetIO();
 		(void)io;
 		// io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+		// dragging inside the scene viewport picks objects instead of moving the window
+		io.ConfigWindowsMoveFromTitleBarOnly = true;
 		// io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
 
 		// Setup Dear ImGui style
@@ -99,6 +101,16 @@ namespace Lit
 		ImGui_ImplVulkan_RenderDrawData(drawdata, commandBuffer);
 	}
 
+	ImTextureID LitImGui::AddTexture(VkSampler sampler, VkImageView imageView, VkImageLayout imageLayout)
+	{
+		return (ImTextureID)ImGui_ImplVulkan_AddTexture(sampler, imageView, imageLayout);
+	}
+
+	void LitImGui::RemoveTexture(ImTextureID texture)
+	{
+		ImGui_ImplVulkan_RemoveTexture((VkDescriptorSet)texture);
+	}
+
 	void LitImGui::RunExample()
 	{
 		// 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can
@@ -149,4 +161,137 @@ namespace Lit
 		}
 	}
 
+	// graph height and the time at its top, a frame of 60 Hz fills it
+	static const float PROFILER_GRAPH_HEIGHT = 32.0f;
+	static const float PROFILER_GRAPH_MILLISECONDS = 16.6f;
+
+	static void PlotScopeHistory(const LitGpuProfiler::ScopeHistory& history, float scaleMilliseconds)
+	{
+		char overlay[64];
+		snprintf(overlay, sizeof(overlay), "%.3f ms", history.lastMilliseconds);
+		ImGui::PushID(history.name.c_str());
+		ImGui::PlotLines("", history.milliseconds.data(), static_cast<int>(history.milliseconds.size()),
+			static_cast<int>(history.historyOffset), overlay, 0.0f, scaleMilliseconds,
+			ImVec2(ImGui::GetContentRegionAvail().x, PROFILER_GRAPH_HEIGHT));
+		ImGui::PopID();
+	}
+
+	void LitImGui::DrawGpuProfiler(LitGpuProfiler& profiler)
+	{
+		ImGui::Begin("GPU Profiler");
+		if (!profiler.IsSupported())
+		{
+			ImGui::Text("the graphics queue has no timestamps");
+			ImGui::End();
+			return;
+		}
+
+		bool bEnabled = profiler.IsEnabled();
+		if (ImGui::Checkbox("enabled", &bEnabled))
+		{
+			profiler.SetEnabled(bEnabled);
+		}
+		if (!profiler.SupportsPipelineStatistics())
+		{
+			ImGui::SameLine();
+			ImGui::Text("(no pipeline statistics)");
+		}
+
+		ImGui::Text("frame");
+		PlotScopeHistory(profiler.GetFrameHistory(), PROFILER_GRAPH_MILLISECONDS);
+		// scopes share a scale so their graphs compare
+		const float scopeScale = PROFILER_GRAPH_MILLISECONDS * 0.5f;
+		for (const auto& scope : profiler.GetScopes())
+		{
+			const float indent = ImGui::GetStyle().IndentSpacing * static_cast<float>(scope.depth);
+			if (indent > 0.0f)
+			{
+				ImGui::Indent(indent);
+			}
+			ImGui::Text("%s", scope.name.c_str());
+			if (scope.bHasStatistics)
+			{
+				const LitGpuProfiler::PipelineStatistics& statistics = scope.statistics;
+				ImGui::Text("primitives %llu, after clipping %llu, vertices %llu, fragments %llu, compute %llu",
+					static_cast<unsigned long long>(statistics.inputAssemblyPrimitives),
+					static_cast<unsigned long long>(statistics.clippingPrimitives),
+					static_cast<unsigned long long>(statistics.vertexShaderInvocations),
+					static_cast<unsigned long long>(statistics.fragmentShaderInvocations),
+					static_cast<unsigned long long>(statistics.computeShaderInvocations));
+			}
+			PlotScopeHistory(scope, scopeScale);
+			if (indent > 0.0f)
+			{
+				ImGui::Unindent(indent);
+			}
+		}
+		ImGui::End();
+	}
+
+	static float ToMegabytes(VkDeviceSize bytes)
+	{
+		return static_cast<float>(static_cast<double>(bytes) / (1024.0 * 1024.0));
+	}
+
+	void LitImGui::DrawMemoryBudget(LitMemoryBudget& memoryBudget)
+	{
+		ImGui::Begin("Memory");
+		const LitMemoryBudget::Statistics statistics = memoryBudget.GetStatistics();
+		ImGui::Text("%u allocations, %.1f MB allocated, %.1f MB used, peak %.1f MB", statistics.allocationCount,
+			ToMegabytes(statistics.allocatedBytes), ToMegabytes(statistics.usedBytes), ToMegabytes(statistics.peakAllocatedBytes));
+		ImGui::Text("%s", memoryBudget.UsesBudgetExtension() ? "heap budgets from VK_EXT_memory_budget"
+			: "no VK_EXT_memory_budget, budgets are estimates and usage is the engine's only");
+
+		const std::vector<LitMemoryBudget::HeapStatistics> heaps = memoryBudget.GetHeapStatistics();
+		for (size_t i = 0; i < heaps.size(); i++)
+		{
+			const LitMemoryBudget::HeapStatistics& heap = heaps[i];
+			char overlay[128];
+			snprintf(overlay, sizeof(overlay), "%.0f / %.0f MB", ToMegabytes(heap.usage), ToMegabytes(heap.budget));
+			ImGui::Text("heap %zu%s: %.0f MB, engine %.1f MB allocated, %.1f MB used", i, heap.bDeviceLocal ? " (device local)" : "",
+				ToMegabytes(heap.size), ToMegabytes(heap.allocatedBytes), ToMegabytes(heap.usedBytes));
+			ImGui::ProgressBar(heap.budget > 0 ? static_cast<float>(static_cast<double>(heap.usage) / heap.budget) : 0.0f,
+				ImVec2(-1.0f, 0.0f), overlay);
+		}
+
+		if (ImGui::BeginTable("categories", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("category");
+			ImGui::TableSetupColumn("allocated MB");
+			ImGui::TableSetupColumn("used MB");
+			ImGui::TableSetupColumn("peak MB");
+			ImGui::TableSetupColumn("soft budget MB");
+			ImGui::TableSetupColumn("evicted MB");
+			ImGui::TableHeadersRow();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(MemoryCategory::Count); i++)
+			{
+				const MemoryCategory category = static_cast<MemoryCategory>(i);
+				const LitMemoryBudget::CategoryStatistics categoryStatistics = memoryBudget.GetCategoryStatistics(category);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", LitMemoryBudget::GetCategoryName(category));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", ToMegabytes(categoryStatistics.allocatedBytes));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", ToMegabytes(categoryStatistics.usedBytes));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", ToMegabytes(categoryStatistics.peakAllocatedBytes));
+				ImGui::TableNextColumn();
+				// 0 for none
+				int softBudgetMegabytes = static_cast<int>(categoryStatistics.softBudget / (1024 * 1024));
+				ImGui::PushID(static_cast<int>(i));
+				ImGui::SetNextItemWidth(-1.0f);
+				if (ImGui::InputInt("", &softBudgetMegabytes, 16, 256) && softBudgetMegabytes >= 0)
+				{
+					memoryBudget.SetSoftBudget(category, static_cast<VkDeviceSize>(softBudgetMegabytes) * 1024 * 1024);
+				}
+				ImGui::PopID();
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", ToMegabytes(categoryStatistics.evictedBytes));
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+
 }  // namespace lve
\ No newline at end of file
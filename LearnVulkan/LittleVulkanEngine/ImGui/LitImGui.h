@@ -4,6 +4,7 @@
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_vulkan.h>
 #include "Core/LitDevice.h"
+#include "Core/LitGpuProfiler.h"
 #include "Core/LitWindow.h"
 
 #include <stdexcept>
@@ -25,12 +26,22 @@ namespace Lit
 
 		void Render(VkCommandBuffer commandBuffer);
 
+		// texture for ImGui::Image, imageView has to be in imageLayout whenever the UI is drawn
+		ImTextureID AddTexture(VkSampler sampler, VkImageView imageView, VkImageLayout imageLayout);
+		// the texture must not be in use by a frame in flight
+		void RemoveTexture(ImTextureID texture);
+
 		// Example state
 		bool show_demo_window = true;
 		bool show_another_window = false;
 		ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 		void RunExample();
 
+		// a window with the rolling GPU time of every scope and the pipeline statistics of the newest frame
+		void DrawGpuProfiler(LitGpuProfiler& profiler);
+		// a window with the use and budget of every heap and the memory of every category, whose soft budgets it edits
+		void DrawMemoryBudget(LitMemoryBudget& memoryBudget);
+
 	private:
 		LitDevice& litDevice;
 
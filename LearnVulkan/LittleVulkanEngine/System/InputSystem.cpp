@@ -37,4 +37,19 @@ namespace Lit
 			gameObject.transform.translation += moveSpeed * dt * glm::normalize(moveDir);
 		}
 	}
+
+	bool InputSystem::PollPick(GLFWwindow* window, glm::vec2& cursor)
+	{
+		const bool bWasDown = bPickButtonDown;
+		bPickButtonDown = glfwGetMouseButton(window, keys.pick) == GLFW_PRESS;
+		if (!bPickButtonDown || bWasDown)
+		{
+			return false;
+		}
+
+		double x, y;
+		glfwGetCursorPos(window, &x, &y);
+		cursor = glm::vec2(static_cast<float>(x), static_cast<float>(y));
+		return true;
+	}
 }
\ No newline at end of file
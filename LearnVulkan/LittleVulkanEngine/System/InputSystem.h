@@ -19,12 +19,18 @@ namespace Lit
 			int lookRight = GLFW_KEY_RIGHT;
 			int lookUp = GLFW_KEY_UP;
 			int lookDown = GLFW_KEY_DOWN;
+			int pick = GLFW_MOUSE_BUTTON_LEFT;
 		};
 
 		void MoveInPlaneXZ(GLFWwindow* window, float dt, LitGameObject& gameObject);
+		// true on the frame the pick button went down, cursor receives its position in screen coordinates
+		bool PollPick(GLFWwindow* window, glm::vec2& cursor);
 
 		KeyMappings keys{};
 		float moveSpeed{ 3.f };
 		float lookSpeed{ 1.5f };
+
+	private:
+		bool bPickButtonDown = false;
 	};
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "simple_render_system.h"
+#include "Core/LitCpuProfiler.h"
+#include "Core/LitSwapChain.h"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -6,6 +8,7 @@
 #include <glm/glm.hpp>
 
 // std
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <stdexcept>
@@ -21,11 +24,59 @@ namespace Lit
 		glm::mat4 normalMatrix{ 1.f };
 	};
 
-	SimpleRenderSystem::SimpleRenderSystem(LitDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
-		: litDevice{ device }
+	// simplification error we accept on screen, as a fraction of the screen height (about a pixel at 1080p)
+	static const float MAX_LOD_SCREEN_ERROR = 1.0f / 1080.0f;
+
+	static LitSphere WorldBoundingSphere(const LitModel& model, const glm::mat4& modelMatrix, const glm::vec3& scale)
+	{
+		const LitAABB& bounds = model.GetBounds();
+		const float maxScale = glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+		return LitSphere{ glm::vec3(modelMatrix * glm::vec4(bounds.Center(), 1.0f)), glm::length(bounds.Extent()) * 0.5f * maxScale };
+	}
+
+	static uint32_t SelectLod(const LitCamera& camera, const LitModel& model, const glm::mat4& modelMatrix, const glm::vec3& scale)
+	{
+		if (model.GetLodCount() <= 1)
+		{
+			return 0;
+		}
+
+		const LitAABB& bounds = model.GetBounds();
+		const float maxScale = glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+		const float radius = glm::length(bounds.Extent()) * 0.5f * maxScale;
+		const glm::vec4 center = camera.GetView() * modelMatrix * glm::vec4(bounds.Center(), 1.0f);
+
+		// use the nearest point of the bounding sphere, view space looks down +z
+		const float depth = center.z - radius;
+		if (depth <= 0.0f)
+		{
+			return 0;
+		}
+
+		// projection[1][1] maps a unit at depth 1 to ndc, ndc spans 2 over the screen height
+		const float screenScale = maxScale * camera.GetProjection()[1][1] * 0.5f / depth;
+		return model.SelectLod(screenScale, MAX_LOD_SCREEN_ERROR);
+	}
+
+	// pixels the bounding sphere spans on a screen screenHeight high, what texture streaming sizes the mips for
+	static float ScreenPixels(const LitCamera& camera, const LitSphere& sphere, uint32_t screenHeight)
+	{
+		const float depth = (camera.GetView() * glm::vec4(sphere.center, 1.0f)).z - sphere.radius;
+		if (depth <= 0.0f)
+		{
+			// the camera is inside it, it covers the screen
+			return static_cast<float>(screenHeight);
+		}
+		return sphere.radius * camera.GetProjection()[1][1] / depth * static_cast<float>(screenHeight);
+	}
+
+	SimpleRenderSystem::SimpleRenderSystem(LitDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+		LitTextureManager& inTextureManager)
+		: litDevice{ device }, renderPass{ renderPass }, textureManager{ inTextureManager }
 	{
 		CreatePipelineLayout(globalSetLayout);
 		CreatePipeline(renderPass);
+		depthPrePassQueue.SetSortMode(LitRenderQueue::SortMode::FrontToBack);
 	}
 
 	SimpleRenderSystem::~SimpleRenderSystem() {
@@ -39,7 +90,9 @@ namespace Lit
 		pushConstantRange.offset = 0;
 		pushConstantRange.size = sizeof(SimplePushConstantData);
 
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+		// the texture goes in the material set the render queue binds
+		static_assert(LitRenderQueue::MATERIAL_DESCRIPTOR_SET == 1, "The texture set follows the global set");
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, textureManager.GetSetLayout() };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -56,22 +109,251 @@ namespace Lit
 	void SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass) {
 		assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
+		GetPipeline(LitModel::VertexFormat::Float, PipelineVariant::Shaded);
+	}
+
+	LitPipeline& SimpleRenderSystem::GetPipeline(LitModel::VertexFormat vertexFormat, PipelineVariant variant)
+	{
+		auto& pipeline = pipelines[static_cast<size_t>(vertexFormat)][static_cast<size_t>(variant)];
+		if (pipeline != nullptr)
+		{
+			return *pipeline;
+		}
+
+		const bool bPacked = vertexFormat == LitModel::VertexFormat::Packed;
 		PipelineConfigInfo pipelineConfig{};
 		LitPipeline::DefaultPipelineConfigInfo(pipelineConfig);
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = pipelineLayout;
-		litPipeline = std::make_unique<LitPipeline>(
+		if (variant == PipelineVariant::DepthOnly)
+		{
+			pipelineConfig.bindingDescriptions = LitModel::GetPositionInputBindingDesc(vertexFormat);
+			pipelineConfig.attributeDescriptions = LitModel::GetPositionInputAttributeDesc(vertexFormat);
+			pipelineConfig.colorBlendAttachment.colorWriteMask = 0;
+			pipeline = std::make_unique<LitPipeline>(
+				litDevice,
+				"../Shaders/Spv/depth_only.vert.spv",
+				"",
+				pipelineConfig);
+			return *pipeline;
+		}
+
+		if (bPacked)
+		{
+			pipelineConfig.bindingDescriptions = LitModel::PackedVertex::GetVertexInputBindingDesc();
+			pipelineConfig.attributeDescriptions = LitModel::PackedVertex::GetVertexInputAttributeDesc();
+		}
+		if (variant == PipelineVariant::ShadedDepthEqual)
+		{
+			pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+			pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		}
+		pipeline = std::make_unique<LitPipeline>(
 			litDevice,
-			"../Shaders/Spv/simple_shader.vert.spv",
+			bPacked ? "../Shaders/Spv/packed_shader.vert.spv" : "../Shaders/Spv/simple_shader.vert.spv",
 			"../Shaders/Spv/simple_shader.frag.spv",
 			pipelineConfig);
+		return *pipeline;
+	}
+
+	void SimpleRenderSystem::WriteIndirectDraws(int frameIndex)
+	{
+		if (indirectBuffers.empty())
+		{
+			indirectBuffers.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+			drawBoundsBuffers.resize(LitSwapChain::MAX_FRAMES_IN_FLIGHT);
+		}
+
+		// the buffer of this frame index is no longer in use once BeginFrame returned, so it can be replaced
+		auto& indirectBuffer = indirectBuffers[frameIndex];
+		const uint32_t drawCount = static_cast<uint32_t>(indirectDraws.size());
+		const uint32_t commandCount = bOcclusionCullingThisFrame ? drawCount * 2 : drawCount;
+		if (indirectBuffer == nullptr || indirectBuffer->GetInstanceCount() < commandCount)
+		{
+			VkDeviceSize drawSize = sizeof(VkDrawIndexedIndirectCommand);
+			indirectBuffer = std::make_unique<LitBuffer>(litDevice, drawSize, std::max(commandCount * 2, 256u),
+				VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+				MemoryCategory::Other);
+			indirectBuffer->Map();
+		}
+
+		const VkDeviceSize size = sizeof(VkDrawIndexedIndirectCommand) * drawCount;
+		indirectBuffer->WriteToBuffer(indirectDraws.data(), size);
+		if (bOcclusionCullingThisFrame)
+		{
+			// the culling shader only writes instanceCount, the late copy needs everything else
+			indirectBuffer->WriteToBuffer(indirectDraws.data(), size, size);
+		}
+		indirectBuffer->QueueFlush(sizeof(VkDrawIndexedIndirectCommand) * commandCount);
+
+		if (!bOcclusionCullingThisFrame)
+		{
+			return;
+		}
+
+		auto& drawBoundsBuffer = drawBoundsBuffers[frameIndex];
+		if (drawBoundsBuffer == nullptr || drawBoundsBuffer->GetInstanceCount() < drawCount)
+		{
+			VkDeviceSize boundsSize = sizeof(LitDrawBounds);
+			drawBoundsBuffer = std::make_unique<LitBuffer>(litDevice, boundsSize, std::max(drawCount * 2, 256u),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, MemoryCategory::Other);
+			drawBoundsBuffer->Map();
+		}
+		const VkDeviceSize boundsSize = sizeof(LitDrawBounds) * drawCount;
+		drawBoundsBuffer->WriteToBuffer(drawBounds.data(), boundsSize);
+		drawBoundsBuffer->QueueFlush(boundsSize);
 	}
 
-	void SimpleRenderSystem::RenderGameObjects(FrameInfo& frameInfo, std::vector<LitGameObject>& gameObjects)
+	void SimpleRenderSystem::PrepareGameObjects(FrameInfo& frameInfo, std::vector<LitGameObject>& gameObjects, const LitBvh& sceneBvh,
+		VkExtent2D depthExtent)
 	{
-		litPipeline->Bind(frameInfo.commandBuffer);
+		LIT_CPU_ZONE("prepare game objects");
+		bOcclusionCullingThisFrame = bOcclusionCulling;
+		if (bOcclusionCullingThisFrame && occlusionCuller == nullptr)
+		{
+			occlusionCuller = std::make_unique<LitOcclusionCuller>(litDevice);
+		}
+
 		auto projectionView = frameInfo.camera.GetProjection() * frameInfo.camera.GetView();
+		visibleObjects.clear();
+		sceneBvh.QueryFrustum(LitFrustum::FromMatrix(projectionView), visibleObjects);
+		// the query order depends on the tree shape, keep the submission order stable
+		std::sort(visibleObjects.begin(), visibleObjects.end());
+
+		// pick LODs and cull meshlets before recording, the indirect buffer must be complete before the first draw uses it
+		LitMeshletCuller meshletCuller{ projectionView, frameInfo.camera.GetPosition() };
+		objectDraws.clear();
+		indirectDraws.clear();
+		drawBounds.clear();
+		renderQueue.Clear();
+		depthPrePassQueue.Clear();
+		renderStatistics.Reset();
+		depthPrePassStatistics.Reset();
+		// with the pre-pass the main pass has no overdraw left to save, so it sorts for state instead
+		renderQueue.SetSortMode(bDepthPrePass ? LitRenderQueue::SortMode::StateFirst : LitRenderQueue::SortMode::FrontToBack);
+		for (uint32_t objectIndex : visibleObjects)
+		{
+			auto& obj = gameObjects[objectIndex];
+			ObjectDraw draw{};
+			draw.modelMatrix = obj.transform.mat4();
+			draw.normalMatrix = obj.transform.normalMatrix();
+			const LitSphere sphere = WorldBoundingSphere(*obj.model, draw.modelMatrix, obj.transform.scale);
+
+			draw.lod = SelectLod(frameInfo.camera, *obj.model, draw.modelMatrix, obj.transform.scale);
+			const bool bMeshlets = draw.lod == 0 && !obj.model->GetMeshlets().empty();
+			draw.bIndirect = bMeshlets || (bOcclusionCullingThisFrame && obj.model->HasIndexBuffer());
+			if (draw.bIndirect)
+			{
+				draw.firstIndirectDraw = static_cast<uint32_t>(indirectDraws.size());
+				if (bMeshlets)
+				{
+					draw.indirectDrawCount = meshletCuller.Cull(obj.model->GetMeshlets(), draw.modelMatrix, indirectDraws,
+						obj.model->GetFirstIndex(), obj.model->GetBaseVertex());
+				}
+				else
+				{
+					// one command for the whole LOD so the culling shader can switch it off
+					const LitModel::LodLevel& level = obj.model->GetLod(draw.lod);
+					indirectDraws.push_back(VkDrawIndexedIndirectCommand{
+						level.indexCount, 1, obj.model->GetFirstIndex() + level.firstIndex, obj.model->GetBaseVertex(), 0 });
+					draw.indirectDrawCount = 1;
+				}
+
+				if (bOcclusionCullingThisFrame)
+				{
+					LitDrawBounds bounds{};
+					bounds.sphere = glm::vec4(sphere.center, sphere.radius);
+					bounds.objectIndex = objectIndex;
+					drawBounds.resize(indirectDraws.size(), bounds);
+				}
+			}
+			objectDraws.push_back(draw);
+
+			if (draw.bIndirect && draw.indirectDrawCount == 0)
+			{
+				// every meshlet was culled
+				continue;
+			}
+
+			const LitModel::VertexFormat vertexFormat = obj.model->GetVertexFormat();
+			LitDrawPacket packet{};
+			packet.pipeline = &GetPipeline(vertexFormat, bDepthPrePass ? PipelineVariant::ShadedDepthEqual : PipelineVariant::Shaded);
+			packet.pipelineLayout = pipelineLayout;
+			packet.materialSet = textureManager.GetDescriptorSet(obj.texture.get());
+			if (obj.texture != nullptr)
+			{
+				textureManager.RequestMip(obj.texture.get(), ScreenPixels(frameInfo.camera, sphere, depthExtent.height));
+			}
+			packet.model = obj.model.get();
+			packet.depth = (frameInfo.camera.GetView() * glm::vec4(sphere.center, 1.0f)).z;
+			packet.userData = static_cast<uint32_t>(objectDraws.size() - 1);
+			renderQueue.Submit(packet);
+			if (bDepthPrePass)
+			{
+				packet.pipeline = &GetPipeline(vertexFormat, PipelineVariant::DepthOnly);
+				// depth doesn't sample, so textures don't split the pre-pass batches
+				packet.materialSet = VK_NULL_HANDLE;
+				depthPrePassQueue.Submit(packet);
+			}
+		}
+		meshletCullStatistics = meshletCuller.GetStatistics();
+
+		if (!indirectDraws.empty())
+		{
+			WriteIndirectDraws(frameInfo.frameIndex);
+		}
+		renderQueue.Sort();
+		depthPrePassQueue.Sort();
+
+		if (bOcclusionCullingThisFrame)
+		{
+			const uint32_t drawCount = static_cast<uint32_t>(indirectDraws.size());
+			VkDescriptorBufferInfo boundsInfo{};
+			VkDescriptorBufferInfo commandsInfo{};
+			if (drawCount > 0)
+			{
+				boundsInfo = drawBoundsBuffers[frameInfo.frameIndex]->DescriptorInfo(sizeof(LitDrawBounds) * drawCount);
+				commandsInfo = indirectBuffers[frameInfo.frameIndex]->DescriptorInfo(sizeof(VkDrawIndexedIndirectCommand) * drawCount * 2);
+			}
+			LitGpuScope scope{ frameInfo.gpuProfiler, frameInfo.commandBuffer, "occlusion cull early", true };
+			occlusionCuller->CullEarly(frameInfo.commandBuffer, frameInfo.frameIndex, depthExtent, boundsInfo, commandsInfo,
+				drawCount, static_cast<uint32_t>(gameObjects.size()));
+		}
+	}
 
+	void SimpleRenderSystem::RenderGameObjects(FrameInfo& frameInfo)
+	{
+		LIT_CPU_ZONE("render game objects");
+		RecordDraws(frameInfo, false);
+	}
+
+	void SimpleRenderSystem::CullOccludedGameObjects(FrameInfo& frameInfo, VkImageView depthView)
+	{
+		if (!bOcclusionCullingThisFrame)
+		{
+			return;
+		}
+		occlusionCuller->CullLate(frameInfo.commandBuffer, frameInfo.frameIndex, frameInfo.camera, depthView);
+	}
+
+	void SimpleRenderSystem::RenderLateGameObjects(FrameInfo& frameInfo)
+	{
+		if (!bOcclusionCullingThisFrame || indirectDraws.empty())
+		{
+			return;
+		}
+		LIT_CPU_ZONE("render late game objects");
+		RecordDraws(frameInfo, true);
+	}
+
+	const OcclusionCullStatistics& SimpleRenderSystem::GetOcclusionCullStatistics() const
+	{
+		static const OcclusionCullStatistics emptyStatistics{};
+		return occlusionCuller != nullptr ? occlusionCuller->GetStatistics() : emptyStatistics;
+	}
+
+	void SimpleRenderSystem::RecordDraws(FrameInfo& frameInfo, bool bLate)
+	{
 		vkCmdBindDescriptorSets(
 			frameInfo.commandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -82,21 +364,44 @@ namespace Lit
 			0,
 			nullptr);
 
-		for (auto& obj : gameObjects)
+		// the late commands follow the early ones, direct draws are never occlusion culled and only drawn early
+		const uint32_t commandBase = bLate ? static_cast<uint32_t>(indirectDraws.size()) : 0;
+
+		// both passes issue exactly the same draws, EQUAL only passes if the geometry matches the pre-pass
+		auto drawObject = [&](VkCommandBuffer commandBuffer, const LitDrawPacket& packet)
 		{
+			const ObjectDraw& draw = objectDraws[packet.userData];
+			if (bLate && !draw.bIndirect)
+			{
+				return;
+			}
+
 			SimplePushConstantData push{};
-			/*obj.transform.rotation.y = glm::mod(obj.transform.rotation.y + 0.0001f, 2.0f * PI);
-			obj.transform.rotation.x = glm::mod(obj.transform.rotation.x + 0.0005f, 2.0f * PI);*/
-			/*push.transform = projectionView * obj.transform.mat4();*/
+			push.modelMatrix = draw.modelMatrix * packet.model->GetDequantizeMatrix();
+			push.normalMatrix = draw.normalMatrix;
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+				0, sizeof(SimplePushConstantData), &push);
 
-			push.modelMatrix = obj.transform.mat4();
-			push.normalMatrix = obj.transform.normalMatrix();
+			if (draw.bIndirect)
+			{
+				packet.model->DrawIndirect(commandBuffer, indirectBuffers[frameInfo.frameIndex]->GetBuffer(),
+					(commandBase + draw.firstIndirectDraw) * sizeof(VkDrawIndexedIndirectCommand), draw.indirectDrawCount);
+			}
+			else
+			{
+				packet.model->Draw(commandBuffer, draw.lod);
+			}
+		};
 
-			vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0, sizeof(SimplePushConstantData), &push);
-			obj.model->Bind(frameInfo.commandBuffer);
-			obj.model->Draw(frameInfo.commandBuffer);
+		if (bDepthPrePass)
+		{
+			LitGpuScope scope{ frameInfo.gpuProfiler, frameInfo.commandBuffer, bLate ? "late depth pre-pass" : "depth pre-pass" };
+			depthPrePassQueue.Record(frameInfo.commandBuffer, drawObject);
+			depthPrePassStatistics += depthPrePassQueue.GetStatistics();
 		}
+		LitGpuScope scope{ frameInfo.gpuProfiler, frameInfo.commandBuffer, bLate ? "late draws" : "draws" };
+		renderQueue.Record(frameInfo.commandBuffer, drawObject);
+		renderStatistics += renderQueue.GetStatistics();
 	}
 
 }  // namespace lve
\ No newline at end of file
@@ -1,12 +1,18 @@
 #pragma once
+#include "Core/LitBuffer.h"
+#include "Core/LitBvh.h"
 #include "Core/LitCamera.h"
 #include "Core/LitDevice.h"
 #include "Core/LitGameObject.h"
+#include "Core/LitOcclusionCuller.h"
 #include "Core/LitPipeline.h"
 #include "Core/LitFrameInfo.h"
+#include "Core/LitRenderQueue.h"
+#include "Core/LitTextureManager.h"
 
 
 // std
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -15,20 +21,97 @@ namespace Lit
 	class SimpleRenderSystem 
 	{
 	public:
-		SimpleRenderSystem(LitDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+		// the objects sample their textures through the descriptor sets of textureManager
+		SimpleRenderSystem(LitDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+			LitTextureManager& textureManager);
 		~SimpleRenderSystem();
 
 		SimpleRenderSystem(const SimpleRenderSystem&) = delete;
 		SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
-		void RenderGameObjects(FrameInfo& frameInfo, std::vector<LitGameObject>& gameObjects);
-	private:																						  
+		// outside the render pass: frustum culls with sceneBvh, picks LODs, culls meshlets and runs the early occlusion
+		// phase. The user data of the sceneBvh proxies are gameObjects indices, depthExtent is the area of the
+		// depth attachment the frame renders to
+		void PrepareGameObjects(FrameInfo& frameInfo, std::vector<LitGameObject>& gameObjects, const LitBvh& sceneBvh,
+			VkExtent2D depthExtent);
+		// inside the render pass: the prepared objects, with occlusion culling only the ones visible last frame
+		void RenderGameObjects(FrameInfo& frameInfo);
+		// with occlusion culling, in a compute pass after the pass RenderGameObjects was recorded in. Tests every
+		// object against the depth it left, read in DEPTH_STENCIL_READ_ONLY_OPTIMAL. A second pass over the same
+		// attachments then runs RenderLateGameObjects
+		void CullOccludedGameObjects(FrameInfo& frameInfo, VkImageView depthView);
+		// inside the second render pass: the objects that became visible this frame
+		void RenderLateGameObjects(FrameInfo& frameInfo);
+
+		// meshlet culling results of the last PrepareGameObjects call
+		const MeshletCullStatistics& GetMeshletCullStatistics() const { return meshletCullStatistics; }
+		// draws and state changes recorded for the last frame, early and late draws together
+		const RenderQueueStatistics& GetRenderQueueStatistics() const { return renderStatistics; }
+		const RenderQueueStatistics& GetDepthPrePassStatistics() const { return depthPrePassStatistics; }
+		const OcclusionCullStatistics& GetOcclusionCullStatistics() const;
+
+		// lays down depth with a position only pipeline first, the main pass then tests EQUAL without writing depth
+		// so every pixel is shaded once. Without it the main pass sorts front to back to reject what it can early
+		void SetDepthPrePass(bool bEnable) { bDepthPrePass = bEnable; }
+		bool IsDepthPrePassEnabled() const { return bDepthPrePass; }
+
+		// draws every indexed object indirectly and lets LitOcclusionCuller switch the commands on and off,
+		// takes effect with the next PrepareGameObjects
+		void SetOcclusionCulling(bool bEnable) { bOcclusionCulling = bEnable; }
+		bool IsOcclusionCullingEnabled() const { return bOcclusionCulling; }
+	private:
+		enum class PipelineVariant
+		{
+			Shaded,
+			DepthOnly,
+			ShadedDepthEqual,	// main pass after the depth pre-pass
+			Count,
+		};
+
+		struct ObjectDraw
+		{
+			glm::mat4 modelMatrix;
+			glm::mat4 normalMatrix;
+			uint32_t lod;
+			// range in indirectDraws, only used when bIndirect is set
+			uint32_t firstIndirectDraw;
+			uint32_t indirectDrawCount;
+			bool bIndirect;
+		};
+																						  
 		void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout);
 		void CreatePipeline(VkRenderPass renderPass);
+		LitPipeline& GetPipeline(LitModel::VertexFormat vertexFormat, PipelineVariant variant);
+		void WriteIndirectDraws(int frameIndex);
+		void RecordDraws(FrameInfo& frameInfo, bool bLate);
 
 		LitDevice& litDevice;
+		VkRenderPass renderPass;
+		LitTextureManager& textureManager;
 
-		std::unique_ptr<LitPipeline> litPipeline;
+		// indexed by vertex format and variant, all but the float shaded pipeline are created on first use
+		std::array<std::array<std::unique_ptr<LitPipeline>, static_cast<size_t>(PipelineVariant::Count)>, 2> pipelines;
 		VkPipelineLayout pipelineLayout;
+		bool bDepthPrePass = false;
+		bool bOcclusionCulling = false;
+		// bOcclusionCulling latched by PrepareGameObjects, the UI may change it in the middle of the frame
+		bool bOcclusionCullingThisFrame = false;
+		// created on first use like the pipeline variants
+		std::unique_ptr<LitOcclusionCuller> occlusionCuller;
+
+		// filled every frame by the meshlet culling, one host visible buffer per frame in flight
+		std::vector<ObjectDraw> objectDraws;
+		std::vector<uint32_t> visibleObjects;
+		std::vector<VkDrawIndexedIndirectCommand> indirectDraws;
+		// with occlusion culling the buffers hold the early commands followed by a late copy of them
+		std::vector<std::unique_ptr<LitBuffer>> indirectBuffers;
+		// with occlusion culling, one per indirect draw
+		std::vector<LitDrawBounds> drawBounds;
+		std::vector<std::unique_ptr<LitBuffer>> drawBoundsBuffers;
+		MeshletCullStatistics meshletCullStatistics;
+		RenderQueueStatistics renderStatistics;
+		RenderQueueStatistics depthPrePassStatistics;
+		LitRenderQueue renderQueue;
+		LitRenderQueue depthPrePassQueue;
 	};
 }  // namespace lve
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Core/LitApp.h"
+#include "Core/LitHeadlessApp.h"
 
 // sys headers
 #include <cstdlib>
@@ -8,9 +9,30 @@
 #include <Windows.h>
 int WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd )
 #else
-int main()
+int main(int argc, char** argv)
 #endif
 {
+#if _WINDOWS
+	int argc = __argc;
+	char** argv = __argv;
+#endif
+	// --headless renders offscreen without a window, see LitHeadlessApp
+	try
+	{
+		Lit::LitHeadlessApp::Options headlessOptions{};
+		if (Lit::LitHeadlessApp::ParseCommandLine(argc, argv, headlessOptions))
+		{
+			Lit::LitHeadlessApp headlessApp{ headlessOptions };
+			headlessApp.Run();
+			return EXIT_SUCCESS;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
 	Lit::LitApp app;
 	try
 	{
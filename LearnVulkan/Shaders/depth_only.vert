@@ -0,0 +1,23 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform GlobalUBO
+{
+  mat4 projectionViewMatrix;
+  vec3 directionToLight;
+}ubo;
+
+// only the position attribute is bound, float or unorm16 both arrive as vec3
+layout(location = 0) in vec3 position;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix; 
+  mat4 normalMatrix;
+} push;
+
+// must match the main pass shaders bit for bit, they test against this depth with EQUAL
+invariant gl_Position;
+
+void main() 
+{
+  gl_Position = ubo.projectionViewMatrix * push.modelMatrix * vec4(position, 1.0);
+}
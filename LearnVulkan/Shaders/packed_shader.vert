@@ -0,0 +1,46 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform GlobalUBO
+{
+  mat4 projectionViewMatrix;
+  vec3 directionToLight;
+}ubo;
+
+// position is unorm16 inside the model bounds, modelMatrix carries the dequantize transform
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec2 normalOct;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix; 
+  mat4 normalMatrix;
+} push;
+
+// the depth pre-pass computes the same position, see depth_only.vert
+invariant gl_Position;
+
+const float AMBIENT = 0.02;
+
+vec3 OctahedralDecode(vec2 e)
+{
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+void main() 
+{
+  gl_Position = ubo.projectionViewMatrix * push.modelMatrix * vec4(position, 1.0);
+  vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * OctahedralDecode(normalOct));
+
+  float lightIntensity = AMBIENT + max(dot(normalWorldSpace, ubo.directionToLight), 0);
+
+  fragColor = lightIntensity * color;
+  fragUv = uv;
+}
@@ -1,12 +1,16 @@
 #version 450
 layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
 layout (location = 0) out vec4 outColor;
 
+// white while the texture of the object is still loading
+layout(set = 1, binding = 0) uniform sampler2D albedoTexture;
+
 layout(push_constant) uniform Push {
   mat4 modelMatrix; // projection * view * model
   mat4 normalMatrix;
 } push;
 
 void main() {
-   outColor = vec4(fragColor, 1.0);
+   outColor = vec4(fragColor * texture(albedoTexture, fragUv).rgb, 1.0);
 }
\ No newline at end of file
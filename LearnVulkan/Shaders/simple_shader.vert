@@ -19,12 +19,16 @@ layout(location = 2) in vec3 normal;
 layout(location = 3) in vec2 uv;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;
 
 layout(push_constant) uniform Push {
   mat4 modelMatrix; 
   mat4 normalMatrix;
 } push;
 
+// the depth pre-pass computes the same position, see depth_only.vert
+invariant gl_Position;
+
 const float AMBIENT = 0.02;
 
 void main() 
@@ -36,4 +40,5 @@ void main()
   float lightIntensity = AMBIENT + max(dot(normalWorldSpace, ubo.directionToLight), 0);
 
   fragColor = lightIntensity * color;
+  fragUv = uv;
 }
\ No newline at end of file
@@ -1,3 +1,7 @@
 C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\simple_shader.vert -o Shaders\Spv\simple_shader.vert.spv
 C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\simple_shader.frag -o Shaders\Spv\simple_shader.frag.spv
+C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\packed_shader.vert -o Shaders\Spv\packed_shader.vert.spv
+C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\depth_only.vert -o Shaders\Spv\depth_only.vert.spv
+C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\hzb_reduce.comp -o Shaders\Spv\hzb_reduce.comp.spv
+C:\VulkanSDK\1.2.198.1\Bin\glslc.exe Shaders\hzb_cull.comp -o Shaders\Spv\hzb_cull.comp.spv
 pause
\ No newline at end of file